@@ -0,0 +1,197 @@
+/**
+  src/base/omx_base_buffer_pool.c
+
+  Slab allocator for the payloads of the buffers allocated by the ports.
+  The live slabs are linked in a global list, so that a payload is returned
+  to its slab whatever the buffer header holding it when it is freed.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include "omx_comp_debug_levels.h"
+#include "omx_base_buffer_pool.h"
+
+struct omx_base_buffer_pool {
+  omx_base_buffer_pool* next;
+  omx_base_buffer_pool** ppOwner; /**< the port field pointing to the slab while it is the current one */
+  OMX_U8* pSlab;
+  size_t nSlabSize;
+  OMX_U32 nSlotSize;
+  OMX_U32 nSlots;
+  OMX_U32 nUsed; /**< number of slots handed out */
+  OMX_U32 nRefs; /**< number of payloads not yet freed */
+  OMX_BOOL bMapped; /**< the slab has been mapped on huge pages */
+};
+
+static pthread_mutex_t poolsMutex = PTHREAD_MUTEX_INITIALIZER;
+static omx_base_buffer_pool* pools = NULL;
+
+static OMX_U32 pool_alignment(OMX_U32 nAlignment) {
+  OMX_U32 nAlign = OMX_BASE_BUFFER_POOL_ALIGNMENT;
+
+  /* posix_memalign wants a power of two */
+  while (nAlign < nAlignment) {
+    nAlign <<= 1;
+  }
+  return nAlign;
+}
+
+static omx_base_buffer_pool* pool_create(OMX_U32 nSlots, OMX_U32 nSize, OMX_U32 nAlignment, OMX_U32 nFlags) {
+  omx_base_buffer_pool* pool;
+  OMX_U32 nAlign = pool_alignment(nAlignment);
+  void* pSlab = NULL;
+
+  pool = calloc(1, sizeof(omx_base_buffer_pool));
+  if (!pool) {
+    return NULL;
+  }
+  if (nSlots == 0) {
+    nSlots = 1;
+  }
+  pool->nSlots = nSlots;
+  pool->nSlotSize = (nSize + nAlign - 1) & ~(nAlign - 1);
+  pool->nSlabSize = (size_t)pool->nSlotSize * nSlots;
+
+#ifdef MAP_HUGETLB
+  if (nFlags & BUFFER_POOL_HUGEPAGES) {
+    size_t nMapSize = (pool->nSlabSize + OMX_BASE_BUFFER_POOL_HUGEPAGE_SIZE - 1) & ~((size_t)OMX_BASE_BUFFER_POOL_HUGEPAGE_SIZE - 1);
+    pSlab = mmap(NULL, nMapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (pSlab == MAP_FAILED) {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s no huge pages available for %lu bytes\n", __func__, (unsigned long)nMapSize);
+      pSlab = NULL;
+    } else {
+      /* anonymous mappings are already zeroed */
+      pool->nSlabSize = nMapSize;
+      pool->bMapped = OMX_TRUE;
+    }
+  }
+#endif
+  if (!pSlab) {
+    if (posix_memalign(&pSlab, nAlign, pool->nSlabSize) != 0) {
+      free(pool);
+      return NULL;
+    }
+    if (nFlags & BUFFER_POOL_ZERO) {
+      memset(pSlab, 0, pool->nSlabSize);
+    }
+  }
+  pool->pSlab = pSlab;
+  DEBUG(DEB_LEV_PARAMS, "In %s slab %p of %i slots of %i bytes\n", __func__, pool->pSlab, (int)pool->nSlots, (int)pool->nSlotSize);
+  return pool;
+}
+
+static void pool_destroy(omx_base_buffer_pool* pool) {
+  DEBUG(DEB_LEV_PARAMS, "In %s slab %p\n", __func__, pool->pSlab);
+  if (pool->bMapped) {
+    munmap(pool->pSlab, pool->nSlabSize);
+  } else {
+    free(pool->pSlab);
+  }
+  free(pool);
+}
+
+/** Checks whether the slab pool can hand out a payload of nSize bytes with
+ * the alignment nAlignment. Called with poolsMutex held
+ */
+static OMX_BOOL pool_fits(omx_base_buffer_pool* pool, OMX_U32 nSize, OMX_U32 nAlignment) {
+  return pool && pool->nUsed < pool->nSlots && nSize <= pool->nSlotSize &&
+         !((unsigned long)pool->pSlab & (pool_alignment(nAlignment) - 1));
+}
+
+OSCL_EXPORT_REF OMX_U8* omx_base_buffer_pool_Get(omx_base_buffer_pool** ppPool, OMX_U32 nSlots, OMX_U32 nSize, OMX_U32 nAlignment, OMX_U32 nFlags) {
+  omx_base_buffer_pool* pool;
+  omx_base_buffer_pool* pNewPool = NULL;
+  OMX_U8* pBuffer;
+
+  pthread_mutex_lock(&poolsMutex);
+  if (!pool_fits(*ppPool, nSize, nAlignment)) {
+    /* the slab is allocated without the lock, which only guards the list */
+    pthread_mutex_unlock(&poolsMutex);
+    pNewPool = pool_create(nSlots, nSize, nAlignment, nFlags);
+    if (!pNewPool) {
+      return NULL;
+    }
+    pthread_mutex_lock(&poolsMutex);
+    /* another buffer of the port may have installed a slab in the meantime */
+    if (!pool_fits(*ppPool, nSize, nAlignment)) {
+      /* the previous slab stays alive until its payloads are freed */
+      if (*ppPool) {
+        (*ppPool)->ppOwner = NULL;
+      }
+      pNewPool->ppOwner = ppPool;
+      *ppPool = pNewPool;
+      pNewPool->next = pools;
+      pools = pNewPool;
+      pNewPool = NULL;
+    }
+  }
+  pool = *ppPool;
+  pBuffer = pool->pSlab + (size_t)pool->nSlotSize * pool->nUsed;
+  pool->nUsed++;
+  pool->nRefs++;
+  pthread_mutex_unlock(&poolsMutex);
+  if (pNewPool) {
+    pool_destroy(pNewPool);
+  }
+  return pBuffer;
+}
+
+OSCL_EXPORT_REF void omx_base_buffer_pool_Free(OMX_U8* pBuffer) {
+  omx_base_buffer_pool** link;
+  omx_base_buffer_pool* pool;
+
+  if (!pBuffer) {
+    return;
+  }
+  pthread_mutex_lock(&poolsMutex);
+  for (link = &pools; *link; link = &(*link)->next) {
+    pool = *link;
+    if (pBuffer >= pool->pSlab && pBuffer < pool->pSlab + (size_t)pool->nSlotSize * pool->nSlots) {
+      pool->nRefs--;
+      if (pool->nRefs == 0) {
+        *link = pool->next;
+        if (pool->ppOwner) {
+          *pool->ppOwner = NULL;
+        }
+        pthread_mutex_unlock(&poolsMutex);
+        pool_destroy(pool);
+      } else {
+        pthread_mutex_unlock(&poolsMutex);
+      }
+      return;
+    }
+  }
+  pthread_mutex_unlock(&poolsMutex);
+  free(pBuffer);
+}
+
+OSCL_EXPORT_REF void omx_base_buffer_pool_Detach(omx_base_buffer_pool** ppPool) {
+  pthread_mutex_lock(&poolsMutex);
+  if (*ppPool) {
+    (*ppPool)->ppOwner = NULL;
+    *ppPool = NULL;
+  }
+  pthread_mutex_unlock(&poolsMutex);
+}
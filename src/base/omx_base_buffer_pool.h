@@ -0,0 +1,96 @@
+/**
+  src/base/omx_base_buffer_pool.h
+
+  Slab allocator for the payloads of the buffers allocated by the ports.
+  All the payloads of a port are cut from one aligned slab, so that the
+  allocation costs a single call and the payloads are contiguous in memory.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMX_BASE_BUFFER_POOL_H__
+#define __OMX_BASE_BUFFER_POOL_H__
+
+#ifdef ANDROID_COMPILATION
+#include <oscl_base_macros.h>
+#else
+#define OSCL_IMPORT_REF
+#define OSCL_EXPORT_REF
+#endif
+
+#include <OMX_Types.h>
+
+/** Name of the environment variable that makes all the ports
+ * request huge pages for their slabs
+ */
+#define OMX_BASE_BUFFER_POOL_HUGEPAGES_ENV "OMX_BELLAGIO_HUGEPAGES"
+
+/** Minimum alignment of the payloads, in bytes. It is a cache line,
+ * and it is raised to the nBufferAlignment of the port when bigger
+ */
+#define OMX_BASE_BUFFER_POOL_ALIGNMENT 64
+
+/** Size of a huge page. Slabs backed by huge pages are rounded up to it */
+#define OMX_BASE_BUFFER_POOL_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+/** The flags that select how a slab is allocated
+ */
+typedef enum BUFFER_POOL_FLAG {
+  BUFFER_POOL_ZERO = 0x0001,     /**< the payloads are filled with zeros when the slab is allocated */
+  BUFFER_POOL_HUGEPAGES = 0x0002 /**< the slab is mapped on huge pages if the system has any available */
+} BUFFER_POOL_FLAG;
+
+/** A slab of payloads. Each slab counts the payloads not yet freed, and it
+ * is released with the last one. The payloads can move among the buffers
+ * of the component, as done by the in place filters, so a slab can live
+ * longer than the port that allocated it.
+ */
+typedef struct omx_base_buffer_pool omx_base_buffer_pool;
+
+/** Takes a payload from the current slab of a port. When the slab has no
+ * free slots or its slots are too small, a new slab is allocated and
+ * becomes the current one
+ *
+ * @param ppPool the current slab of the port. It is updated if a slab is allocated
+ * @param nSlots number of payloads of the new slab, if one is needed
+ * @param nSize size of the payload
+ * @param nAlignment requested alignment of the payload. Zero selects the default one
+ * @param nFlags one or more BUFFER_POOL_FLAG
+ *
+ * @return the payload, or NULL if the memory is exhausted
+ */
+OSCL_IMPORT_REF OMX_U8* omx_base_buffer_pool_Get(omx_base_buffer_pool** ppPool, OMX_U32 nSlots, OMX_U32 nSize, OMX_U32 nAlignment, OMX_U32 nFlags);
+
+/** Frees a payload. The slab holding it is released when all its payloads
+ * have been freed. A payload that does not belong to any slab is
+ * released with free
+ *
+ * @param pBuffer the payload
+ */
+OSCL_IMPORT_REF void omx_base_buffer_pool_Free(OMX_U8* pBuffer);
+
+/** Detaches the current slab from a port that is being destroyed.
+ * The slab is released when its last payload is freed
+ *
+ * @param ppPool the current slab of the port. It is set to NULL
+ */
+OSCL_IMPORT_REF void omx_base_buffer_pool_Detach(omx_base_buffer_pool** ppPool);
+
+#endif
@@ -25,11 +25,13 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <sched.h>
 #include <omxcore.h>
 #include <OMX_Core.h>
 #include <OMX_Component.h>
 #include "omx_base_component.h"
 #include "omx_base_clock_port.h"
+#include "omx_trace.h"
 
 /**
   * @brief the base constructor for the generic OpenMAX ST Clock port
@@ -208,9 +210,11 @@ OMX_ERRORTYPE base_clock_port_SendBufferFunction(
     	   */
     	  return OMX_ErrorInsufficientResources;
       }
+      base_port_StatBufferReceived(openmaxStandPort);
+      OMX_TRACE(OMX_TraceBufferEnqueue, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pBuffer);
       tsem_up(openmaxStandPort->pBufferSem);
       DEBUG(DEB_LEV_PARAMS, "In %s Signalling bMgmtSem Port Index=%d\n",__func__, (int)portIndex);
-      tsem_up(omx_base_component_Private->bMgmtSem);
+      omx_base_component_SignalPortBuffer(openmaxStandPort);
   } else if(PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)){
 	  DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s received io:%d buffer\n",
 			  __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
@@ -231,3 +235,28 @@ OMX_ERRORTYPE base_clock_port_SendBufferFunction(
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s of component %p\n", __func__, omx_base_component_Private);
   return OMX_ErrorNone;
 }
+
+/** @brief copies a clock snapshot consistently
+ *
+ * The copy is taken while the clock is not writing the snapshot and is
+ * taken again if the clock updated it meanwhile, so that the fields in
+ * pCopy always belong to the same update.
+ */
+void base_clock_port_ReadSnapshot(
+  const OMX_BELLAGIOCLOCKSNAPSHOTTYPE* pSnapshot,
+  OMX_BELLAGIOCLOCKSNAPSHOTTYPE* pCopy) {
+  OMX_U32 nSequence;
+
+  do {
+    while ((nSequence = pSnapshot->nSequence) & 0x1) {
+      sched_yield();
+    }
+    __sync_synchronize();
+    pCopy->eState     = pSnapshot->eState;
+    pCopy->xScale     = pSnapshot->xScale;
+    pCopy->nMediaTime = pSnapshot->nMediaTime;
+    pCopy->nWallTime  = pSnapshot->nWallTime;
+    __sync_synchronize();
+  } while (pSnapshot->nSequence != nSequence);
+  pCopy->nSequence = nSequence;
+}
@@ -25,6 +25,7 @@
 
 #include "omx_classmagic.h"
 #include "omx_base_port.h"
+#include "extension_struct.h"
 
 #ifndef __OMX_BASE_CLOCK_PORT_H__
 #define __OMX_BASE_CLOCK_PORT_H__
@@ -88,4 +89,18 @@ OMX_ERRORTYPE base_clock_port_SendBufferFunction(
   omx_base_PortType *openmaxStandPort,
   OMX_BUFFERHEADERTYPE* pBuffer);
 
+/**
+  * @brief copies the snapshot the clock component publishes
+  *
+  * A client holding the snapshot of OMX_IndexConfigBellagioClockSnapshot
+  * reads the media time with it instead of waiting for clock buffers.
+  *
+  * @param pSnapshot the snapshot of the clock component
+  * @param pCopy receives a consistent copy of pSnapshot
+  */
+
+void base_clock_port_ReadSnapshot(
+  const OMX_BELLAGIOCLOCKSNAPSHOTTYPE* pSnapshot,
+  OMX_BELLAGIOCLOCKSNAPSHOTTYPE* pCopy);
+
 #endif
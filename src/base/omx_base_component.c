@@ -36,6 +36,11 @@ extern "C" {
 
 #include "tsemaphore.h"
 #include "queue.h"
+#include "omx_trace.h"
+
+/** True if the buffer management of the component runs on the shared executor */
+#define BUFFER_MGMT_ON_EXECUTOR(pPrivate) \
+  ((pPrivate)->pExecutorTask != NULL && (pPrivate)->pExecutorTask->bDetached == OMX_FALSE)
 
 /**
  * This function releases all the resources allocated by the base constructor if something fails.
@@ -69,7 +74,6 @@ void base_constructor_remove_garbage_collected(omx_base_component_PrivateType* o
 		free(omx_base_component_Private->messageSem);
 	}
 	if (omx_base_component_Private->messageQueue) {
-		queue_deinit(omx_base_component_Private->messageQueue);
 		free(omx_base_component_Private->messageQueue);
 	}
 	if (omx_base_component_Private) {
@@ -109,16 +113,12 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 	}
 
 	if(!omx_base_component_Private->messageQueue) {
-		omx_base_component_Private->messageQueue = calloc(1,sizeof(queue_t));
+		omx_base_component_Private->messageQueue = calloc(1,sizeof(mpsc_queue_t));
 		if (!omx_base_component_Private->messageQueue) {
 			base_constructor_remove_garbage_collected(omx_base_component_Private);
 			return OMX_ErrorInsufficientResources;
 		}
-		err = queue_init(omx_base_component_Private->messageQueue);
-		if (err != 0) {
-			base_constructor_remove_garbage_collected(omx_base_component_Private);
-			return OMX_ErrorInsufficientResources;
-		}
+		mpsc_queue_init(omx_base_component_Private->messageQueue);
 	}
 
 	if(!omx_base_component_Private->messageSem) {
@@ -193,6 +193,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
 		return OMX_ErrorInsufficientResources;
 	}
 	strcpy(omx_base_component_Private->name,cComponentName);
+	omx_trace_name_component(openmaxStandComp, cComponentName);
 	omx_base_component_Private->state = OMX_StateLoaded;
 	omx_base_component_Private->transientState = OMX_TransStateMax;
 	omx_base_component_Private->callbacks = NULL;
@@ -270,6 +271,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Constructor(OMX_COMPONENTTYPE *
  */
 OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  internalRequestMessageType *message;
   int err;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
   omx_base_component_Private->state = OMX_StateInvalid;
@@ -278,19 +280,30 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_Destructor(OMX_COMPONENTTYPE *o
   /*Send Dummy signal to Component Message handler to exit*/
   tsem_up(omx_base_component_Private->messageSem);
 
-  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s before pthread_detach\n", __func__);
-  err = pthread_detach(omx_base_component_Private->messageHandlerThread);
+  /*Wait for the message handler to leave, as it reads the private structure freed below*/
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s before pthread_join\n", __func__);
+  err = pthread_join(omx_base_component_Private->messageHandlerThread, NULL);
   if(err!=0) {
-    DEBUG(DEB_LEV_FUNCTION_NAME,"In %s pthread_detach returned err=%d\n", __func__, err);
+    DEBUG(DEB_LEV_FUNCTION_NAME,"In %s pthread_join returned err=%d\n", __func__, err);
   }
-  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s after pthread_detach\n", __func__);
-  /*Deinitialize and free message queue*/
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s after pthread_join\n", __func__);
+  /*Free the messages never processed and the message queue*/
   if(omx_base_component_Private->messageQueue) {
-    queue_deinit(omx_base_component_Private->messageQueue);
+    qlink_t* link = mpsc_queue_drain(omx_base_component_Private->messageQueue);
+    while(link != NULL) {
+      message = (internalRequestMessageType*)link;
+      link = link->next;
+      free(message);
+    }
     free(omx_base_component_Private->messageQueue);
     omx_base_component_Private->messageQueue=NULL;
   }
 
+  if(omx_base_component_Private->pExecutorTask) {
+    omx_base_executor_Detach(omx_base_component_Private->pExecutorTask);
+    free(omx_base_component_Private->pExecutorTask);
+    omx_base_component_Private->pExecutorTask=NULL;
+  }
 
   /*Deinitialize and free buffer management semaphore*/
   if(omx_base_component_Private->bMgmtSem){
@@ -357,6 +370,48 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_ComponentDeInit(
   return OMX_ErrorNone;
 }
 
+/** Runs one step of the buffer management of a component on the shared executor
+ */
+static OMX_BOOL base_component_ExecutorRun(void* data) {
+  OMX_COMPONENTTYPE* openmaxStandComp = (OMX_COMPONENTTYPE*)data;
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+
+  return omx_base_component_Private->BufferMgmtStep(openmaxStandComp);
+}
+
+/** Moves the buffer management of a component on the shared executor.
+ * It fails if the executor is not enabled or if the component has no
+ * BufferMgmtStep matching its BufferMgmtFunction, and the caller starts
+ * the buffer management thread
+ */
+static OMX_ERRORTYPE base_component_AttachToExecutor(OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+
+  if(omx_base_executor_IsEnabled() == OMX_FALSE ||
+     omx_base_component_Private->BufferMgmtStep == NULL ||
+     omx_base_component_Private->BufferMgmtFunction != omx_base_component_Private->BufferMgmtStepThread) {
+    return OMX_ErrorNotImplemented;
+  }
+  if(!omx_base_component_Private->pExecutorTask) {
+    omx_base_component_Private->pExecutorTask = calloc(1, sizeof(omx_base_executor_task));
+    if(!omx_base_component_Private->pExecutorTask) {
+      return OMX_ErrorInsufficientResources;
+    }
+    omx_base_component_Private->pExecutorTask->run = base_component_ExecutorRun;
+    omx_base_component_Private->pExecutorTask->data = openmaxStandComp;
+    omx_base_component_Private->pExecutorTask->bDetached = OMX_TRUE;
+  }
+  omx_base_component_Private->pStepBuffer[0] = NULL;
+  omx_base_component_Private->pStepBuffer[1] = NULL;
+  omx_base_component_Private->bStepFlushAcked = OMX_FALSE;
+  if(omx_base_executor_Attach(omx_base_component_Private->pExecutorTask) != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s the executor is not available, using a buffer management thread\n", __func__);
+    return OMX_ErrorInsufficientResources;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s component %s runs on the executor\n", __func__, omx_base_component_Private->name);
+  return OMX_ErrorNone;
+}
+
 /** Changes the state of a component taking proper actions depending on
  * the transition requested. This base function cover only the state
  * changes that do not involve any port
@@ -376,6 +431,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
   DEBUG(DEB_LEV_PARAMS, "Changing state from %i to %i\n", omx_base_component_Private->state, (int)destinationState);
+  OMX_TRACE(OMX_TraceStateChange, openmaxStandComp, OMX_TRACE_NO_PORT, ((OMX_U64)omx_base_component_Private->state << 32) | destinationState);
 
   if (omx_base_component_Private->state == OMX_StateLoaded && destinationState == OMX_StateIdle) {
 	  err = RM_getResource(openmaxStandComp);
@@ -443,6 +499,9 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
       }
       omx_base_component_Private->state = OMX_StateLoaded;
 
+      if(BUFFER_MGMT_ON_EXECUTOR(omx_base_component_Private)) {
+        omx_base_executor_Detach(omx_base_component_Private->pExecutorTask);
+      }
       if(omx_base_component_Private->bufferMgmtThreadID == 0 ){
         /*Signal Buffer Management thread to exit*/
         tsem_up(omx_base_component_Private->bMgmtSem);
@@ -535,6 +594,10 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
     	  break;
       }
       omx_base_component_Private->state = OMX_StateIdle;
+      /** running buffer management on the shared executor, if enabled and supported */
+      if(base_component_AttachToExecutor(openmaxStandComp) == OMX_ErrorNone) {
+        break;
+      }
       /** starting buffer management thread */
       omx_base_component_Private->bufferMgmtThreadID = pthread_create(&omx_base_component_Private->bufferMgmtThread,
 	      																NULL,
@@ -581,6 +644,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
       omx_base_component_Private->state = OMX_StateIdle;
       /*Signal buffer management thread if waiting at paused state*/
       tsem_signal(omx_base_component_Private->bStateSem);
+      omx_base_component_WakeBufferMgmt(openmaxStandComp);
       break;
     default:
       DEBUG(DEB_LEV_ERR, "In %s: state transition not allowed\n", __func__);
@@ -632,12 +696,13 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
             for(k=0;k<pPort->nNumTunnelBuffer;k++) {
               tsem_up(pPort->pBufferSem);
               /*signal buffer management thread availability of buffers*/
-              tsem_up(omx_base_component_Private->bMgmtSem);
+              omx_base_component_SignalPortBuffer(pPort);
             }
           }
         }
       }
       omx_base_component_Private->transientState = OMX_TransStateMax;
+      omx_base_component_WakeBufferMgmt(openmaxStandComp);
       err = OMX_ErrorNone;
       break;
     case OMX_StatePause:
@@ -658,13 +723,14 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
             (pPort->pBufferQueue->nelem == (pPort->pBufferSem->semval + pPort->sPortParam.nBufferCountActual))) {
             for(k=0; k < pPort->sPortParam.nBufferCountActual;k++) {
               tsem_up(pPort->pBufferSem);
-              tsem_up(omx_base_component_Private->bMgmtSem);
+              omx_base_component_SignalPortBuffer(pPort);
             }
           }
         }
       }
       /*Signal buffer management thread if waiting at paused state*/
       tsem_signal(omx_base_component_Private->bStateSem);
+      omx_base_component_WakeBufferMgmt(openmaxStandComp);
       break;
     case OMX_StateExecuting:
       err = OMX_ErrorSameState;
@@ -686,6 +752,9 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_DoStateSet(OMX_COMPONENTTYPE *o
     default:
       omx_base_component_Private->state = OMX_StateInvalid;
 
+      if(BUFFER_MGMT_ON_EXECUTOR(omx_base_component_Private)) {
+        omx_base_executor_Detach(omx_base_component_Private->pExecutorTask);
+      }
       if(omx_base_component_Private->bufferMgmtThreadID == 0 ){
         tsem_signal(omx_base_component_Private->bStateSem);
         /*Signal Buffer Management Thread to Exit*/
@@ -1076,6 +1145,12 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
       }
       old_nBufferCountActual         = pPortParam->nBufferCountActual;
       pPortParam->nBufferCountActual = pPortDef->nBufferCountActual;
+      /* the port is disabled or the component is Loaded, so the buffer queue is empty */
+      if(queue_resize(omx_base_component_Private->ports[pPortDef->nPortIndex]->pBufferQueue, pPortParam->nBufferCountActual) != 0) {
+        DEBUG(DEB_LEV_ERR, "In %s cannot resize the buffer queue to %i elements\n",__func__, (int)pPortParam->nBufferCountActual);
+        err = OMX_ErrorInsufficientResources;
+        break;
+      }
 
       switch(pPortDef->eDomain) {
       case OMX_PortDomainAudio:
@@ -1220,30 +1295,96 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetParameter(
 
 /** @brief base GetConfig function
  *
- * This base function is not implemented. If a derived component
- * needs to support any config, it must implement a derived
- * version of this function and assign it to the correct pointer
- * in the private component descriptor
+ * This base function only returns the buffer flow statistics of the ports.
+ * If a derived component needs to support any other config, it must
+ * implement a derived version of this function and assign it to the
+ * correct pointer in the private component descriptor
  */
 OSCL_EXPORT_REF OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_GetConfig(
   OMX_HANDLETYPE hComponent,
   OMX_INDEXTYPE nIndex,
   OMX_PTR pComponentConfigStructure) {
-  return OMX_ErrorNone;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  OMX_CONFIG_BELLAGIOPORTSTATSTYPE *pPortStats;
+  omx_base_PortType *pPort;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  if (pComponentConfigStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  switch((OMX_U32)nIndex) {
+  case OMX_IndexConfigBellagioPortStats:
+    pPortStats = (OMX_CONFIG_BELLAGIOPORTSTATSTYPE*)pComponentConfigStructure;
+    if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOPORTSTATSTYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    if (pPortStats->nPortIndex >= (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+                                   omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+                                   omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+                                   omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts)) {
+      return OMX_ErrorBadPortIndex;
+    }
+    pPort = omx_base_component_Private->ports[pPortStats->nPortIndex];
+    pPortStats->nBuffersReceived = pPort->nStatBuffersReceived;
+    pPortStats->nBuffersReturned = pPort->nStatBuffersReturned;
+    pPortStats->nQueueDepth = pPort->pBufferQueue->nelem;
+    pPortStats->nMaxQueueDepth = pPort->nStatMaxQueueDepth;
+    pPortStats->nCallbackTime = pPort->nStatCallbackTime;
+    pPortStats->nCallbackTimeMax = pPort->nStatCallbackTimeMax;
+    break;
+  default:
+    break;
+  }
+  return err;
 }
 
 /** @brief base SetConfig function
  *
- * This base function is not implemented. If a derived component
- * needs to support any config, it must implement a derived
- * version of this function and assign it to the correct pointer
- * in the private component descriptor
+ * This base function only sends batches of buffers to the ports.
+ * If a derived component needs to support any other config, it must
+ * implement a derived version of this function and assign it to the
+ * correct pointer in the private component descriptor
  */
 OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SetConfig(
   OMX_HANDLETYPE hComponent,
   OMX_INDEXTYPE nIndex,
   OMX_PTR pComponentConfigStructure) {
-  return OMX_ErrorNone;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  OMX_CONFIG_BELLAGIOBUFFERBATCHTYPE *pBufferBatch;
+  omx_base_PortType *pPort;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  if (pComponentConfigStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  switch((OMX_U32)nIndex) {
+  case OMX_IndexConfigBellagioBufferBatch:
+    pBufferBatch = (OMX_CONFIG_BELLAGIOBUFFERBATCHTYPE*)pComponentConfigStructure;
+    if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOBUFFERBATCHTYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    pBufferBatch->nBuffersSent = 0;
+    if (pBufferBatch->nPortIndex >= (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+                                     omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+                                     omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+                                     omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts)) {
+      return OMX_ErrorBadPortIndex;
+    }
+    if (pBufferBatch->ppBuffers == NULL && pBufferBatch->nBufferCount > 0) {
+      return OMX_ErrorBadParameter;
+    }
+    pPort = omx_base_component_Private->ports[pBufferBatch->nPortIndex];
+    err = pPort->Port_SendBufferBatchFunction(pPort, pBufferBatch->ppBuffers, pBufferBatch->nBufferCount, &pBufferBatch->nBuffersSent);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Out of %s for component %p with err %s after %i buffers\n", __func__, hComponent, errorName(err), (int)pBufferBatch->nBuffersSent);
+    }
+    break;
+  default:
+    break;
+  }
+  return err;
 }
 
 /** @brief base function not implemented
@@ -1259,6 +1400,10 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_GetExtensionIndex(
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
 	if(strcmp(cParameterName,"OMX.st.index.param.BellagioThreadsID") == 0) {
 		*pIndexType = OMX_IndexParameterThreadsID;
+	} else if(strcmp(cParameterName,"OMX.st.index.config.BellagioPortStats") == 0) {
+		*pIndexType = OMX_IndexConfigBellagioPortStats;
+	} else if(strcmp(cParameterName,"OMX.st.index.config.BellagioBufferBatch") == 0) {
+		*pIndexType = OMX_IndexConfigBellagioBufferBatch;
 	} else {
 		return OMX_ErrorBadParameter;
 	}
@@ -1294,12 +1439,11 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SendCommand(
   OMX_COMPONENTTYPE* omxComponent = (OMX_COMPONENTTYPE*)hComponent;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
   internalRequestMessageType *message;
-  queue_t* messageQueue;
+  mpsc_queue_t* messageQueue;
   tsem_t* messageSem;
   OMX_U32 i,j,k;
   omx_base_PortType *pPort;
   OMX_ERRORTYPE err = OMX_ErrorNone;
-  int errQue;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
 
   messageQueue = omx_base_component_Private->messageQueue;
@@ -1334,6 +1478,11 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SendCommand(
             pPort->bBufferStateAllocated = calloc(pPort->sPortParam.nBufferCountActual,sizeof(BUFFER_STATUS_FLAG));
           }
 
+          if(queue_resize(pPort->pBufferQueue, pPort->sPortParam.nBufferCountActual) != 0) {
+            free(message);
+            return OMX_ErrorInsufficientResources;
+          }
+
           for(k=0; k < pPort->sPortParam.nBufferCountActual; k++) {
             pPort->bBufferStateAllocated[k] = BUFFER_FREE;
           }
@@ -1415,15 +1564,14 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_SendCommand(
   }
 
   if (err == OMX_ErrorNone) {
-      errQue = queue(messageQueue, message);
-      if (errQue) {
-    	  /* /TODO the queue is full. This can be handled in a fine way with
-    	   * some retrials, or other checking. For the moment this is a critical error
-    	   * and simply causes the failure of this call
-    	   */
-    	  return OMX_ErrorInsufficientResources;
+      /* the message handler drains the whole queue at each wake up,
+       * so it is signalled only when the queue was empty
+       */
+      if (mpsc_queue_push(messageQueue, &message->link)) {
+        tsem_up(messageSem);
       }
-      tsem_up(messageSem);
+  } else {
+      free(message);
   }
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, hComponent);
   return err;
@@ -1439,6 +1587,7 @@ void* compMessageHandlerFunction(void* param) {
   OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)param;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
   internalRequestMessageType *message;
+  qlink_t* link;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
   omx_base_component_Private->bellagioThreads->nThreadMessageID = (long int)syscall(__NR_gettid);
@@ -1456,19 +1605,23 @@ void* compMessageHandlerFunction(void* param) {
         DEBUG(DEB_LEV_FUNCTION_NAME, "In %s Destructor has been called. So exit from the loop\n", __func__);
       break;
     }
-    /* Dequeue it */
-    message = dequeue(omx_base_component_Private->messageQueue);
-    if(message == NULL){
-      DEBUG(DEB_LEV_ERR, "In %s: ouch!! had null message!\n", __func__);
-      break;
+    /* Take all the pending messages and process them in order */
+    link = mpsc_queue_drain(omx_base_component_Private->messageQueue);
+    if(link == NULL){
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s: woken up with no pending message\n", __func__);
+      continue;
+    }
+    while(link != NULL) {
+      message = (internalRequestMessageType*)link;
+      link = link->next;
+      /* Process it by calling component's message handler method */
+      omx_base_component_Private->messageHandler(openmaxStandComp, message);
+      /* Message ownership has been transferred to us
+      * so we gonna free it when finished.
+      */
+      free(message);
+      message = NULL;
     }
-    /* Process it by calling component's message handler method */
-    omx_base_component_Private->messageHandler(openmaxStandComp, message);
-    /* Message ownership has been transferred to us
-    * so we gonna free it when finished.
-    */
-    free(message);
-    message = NULL;
   }
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
   return NULL;
@@ -1579,7 +1732,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYP
               for(k=0;k<pPort->nNumTunnelBuffer;k++) {
                 tsem_up(pPort->pBufferSem);
                 /*signal buffer management thread availability of buffers*/
-                tsem_up(omx_base_component_Private->bMgmtSem);
+                omx_base_component_SignalPortBuffer(pPort);
               }
             }
           }
@@ -1598,7 +1751,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYP
             for(j=0;j<omx_base_component_Private->ports[message->messageParam]->nNumTunnelBuffer;j++) {
               tsem_up(omx_base_component_Private->ports[message->messageParam]->pBufferSem);
               /*signal buffer management thread availability of buffers*/
-              tsem_up(omx_base_component_Private->bMgmtSem);
+              omx_base_component_SignalPortBuffer(omx_base_component_Private->ports[message->messageParam]);
             }
           }
       }
@@ -1714,7 +1867,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYP
           if (PORT_IS_BUFFER_SUPPLIER(pPort)) {
             for(i=0; i < pPort->sPortParam.nBufferCountActual;i++) {
               tsem_up(pPort->pBufferSem);
-              tsem_up(omx_base_component_Private->bMgmtSem);
+              omx_base_component_SignalPortBuffer(pPort);
             }
           }
         }
@@ -1745,7 +1898,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_MessageHandler(OMX_COMPONENTTYP
               if (PORT_IS_BUFFER_SUPPLIER(pPort)) {
                 for(k=0; k < pPort->sPortParam.nBufferCountActual;k++) {
                   tsem_up(pPort->pBufferSem);
-                  tsem_up(omx_base_component_Private->bMgmtSem);
+                  omx_base_component_SignalPortBuffer(pPort);
                 }
               }
             }
@@ -1973,7 +2126,185 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_setQualityLevel(OMX_COMPONENTTYPE *openma
 	}
 }
 
+/** Checks whether all the ports the buffer management thread waits for hold a buffer
+ */
+static OMX_BOOL base_component_WaitedPortsReady(omx_base_component_PrivateType* omx_base_component_Private) {
+  OMX_U32 i, nPorts;
+  omx_base_PortType* pPort;
+
+  nPorts = omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+           omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+           omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+           omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;
+  for(i = 0; i < nPorts; i++) {
+    pPort = omx_base_component_Private->ports[i];
+    if(pPort->bIsWaitedFor == OMX_TRUE && pPort->pBufferSem->semval == 0) {
+      return OMX_FALSE;
+    }
+  }
+  return OMX_TRUE;
+}
+
+OSCL_EXPORT_REF void omx_base_component_WaitForPorts(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  omx_base_PortType** pPorts,
+  OMX_U32 nPorts) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  OMX_BOOL bReady = OMX_TRUE;
+  OMX_U32 i;
+
+  omx_base_component_Private->bMgmtWaitsForPorts = OMX_TRUE;
+  for(i = 0; i < nPorts; i++) {
+    pPorts[i]->bIsWaitedFor = OMX_TRUE;
+  }
+  /* publish the wait before checking the ports, so that a buffer arriving
+   * in the meantime is either seen here or wakes us up */
+  __sync_lock_test_and_set(&omx_base_component_Private->nMgmtWaiting, 1);
+  __sync_synchronize();
+  for(i = 0; i < nPorts; i++) {
+    if(pPorts[i]->pBufferSem->semval == 0) {
+      bReady = OMX_FALSE;
+      break;
+    }
+  }
+  if(bReady == OMX_TRUE) {
+    if(!__sync_bool_compare_and_swap(&omx_base_component_Private->nMgmtWaiting, 1, 0)) {
+      /* a port has already claimed the wake up: consume it */
+      tsem_down(omx_base_component_Private->bMgmtSem);
+    }
+  } else {
+    DEBUG(DEB_LEV_FULL_SEQ, "In %s waiting for %i ports\n", __func__, (int)nPorts);
+    tsem_down(omx_base_component_Private->bMgmtSem);
+    __sync_bool_compare_and_swap(&omx_base_component_Private->nMgmtWaiting, 1, 0);
+  }
+  for(i = 0; i < nPorts; i++) {
+    pPorts[i]->bIsWaitedFor = OMX_FALSE;
+  }
+}
+
+OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_component_WaitForAnyPort(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 nMilliSeconds) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_BOOL bReady = OMX_FALSE;
+  OMX_U32 i, nWords;
+
+  nWords = (omx_base_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts +
+            omx_base_component_Private->sPortTypesParam[OMX_PortDomainVideo].nPorts +
+            omx_base_component_Private->sPortTypesParam[OMX_PortDomainImage].nPorts +
+            omx_base_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts + 63) / 64;
+  omx_base_component_Private->bMgmtWaitsForPorts = OMX_TRUE;
+  omx_base_component_Private->bMgmtWaitsForAny = OMX_TRUE;
+  /* same handshake as omx_base_component_WaitForPorts */
+  __sync_lock_test_and_set(&omx_base_component_Private->nMgmtWaiting, 1);
+  __sync_synchronize();
+  for(i = 0; i < nWords; i++) {
+    if(omx_base_component_Private->pSignalledPorts[i]) {
+      bReady = OMX_TRUE;
+      break;
+    }
+  }
+  if(bReady == OMX_FALSE) {
+    DEBUG(DEB_LEV_FULL_SEQ, "In %s waiting for a port up to %i ms\n", __func__, (int)nMilliSeconds);
+    if(nMilliSeconds == OMX_BASE_WAIT_FOREVER) {
+      tsem_down(omx_base_component_Private->bMgmtSem);
+      __sync_bool_compare_and_swap(&omx_base_component_Private->nMgmtWaiting, 1, 0);
+    } else if(tsem_timed_down(omx_base_component_Private->bMgmtSem, nMilliSeconds) == 0) {
+      __sync_bool_compare_and_swap(&omx_base_component_Private->nMgmtWaiting, 1, 0);
+    } else {
+      err = OMX_ErrorTimeout;
+      bReady = OMX_TRUE;
+    }
+  }
+  if(bReady == OMX_TRUE) {
+    if(!__sync_bool_compare_and_swap(&omx_base_component_Private->nMgmtWaiting, 1, 0)) {
+      /* a port has claimed the wake up in the meantime: consume it */
+      tsem_down(omx_base_component_Private->bMgmtSem);
+      err = OMX_ErrorNone;
+    }
+  }
+  omx_base_component_Private->bMgmtWaitsForAny = OMX_FALSE;
+  return err;
+}
+
+OSCL_EXPORT_REF void omx_base_component_SignalPortBuffer(
+  omx_base_PortType* openmaxStandPort) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_U32 nPortIndex = openmaxStandPort->sPortParam.nPortIndex;
+
+  /* mark the port before waking up the thread, so that it finds the mark */
+  if(omx_base_component_Private->pSignalledPorts) {
+    __sync_fetch_and_or(&omx_base_component_Private->pSignalledPorts[nPortIndex / 64], (OMX_U64)1 << (nPortIndex % 64));
+  }
+  if(BUFFER_MGMT_ON_EXECUTOR(omx_base_component_Private)) {
+    omx_base_executor_Schedule(omx_base_component_Private->pExecutorTask);
+    return;
+  }
+  if(omx_base_component_Private->bMgmtWaitsForPorts == OMX_FALSE) {
+    tsem_up(omx_base_component_Private->bMgmtSem);
+    return;
+  }
+  __sync_synchronize();
+  if(omx_base_component_Private->nMgmtWaiting &&
+     (omx_base_component_Private->bMgmtWaitsForAny == OMX_TRUE ||
+      (openmaxStandPort->bIsWaitedFor == OMX_TRUE && base_component_WaitedPortsReady(omx_base_component_Private) == OMX_TRUE)) &&
+     __sync_bool_compare_and_swap(&omx_base_component_Private->nMgmtWaiting, 1, 0)) {
+    tsem_up(omx_base_component_Private->bMgmtSem);
+  }
+}
+
+OSCL_EXPORT_REF void omx_base_component_WakeBufferMgmt(
+  OMX_COMPONENTTYPE *openmaxStandComp) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+
+  if(BUFFER_MGMT_ON_EXECUTOR(omx_base_component_Private)) {
+    omx_base_executor_Schedule(omx_base_component_Private->pExecutorTask);
+  }
+}
+
+OSCL_EXPORT_REF OMX_BOOL omx_base_component_StepFlush(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  omx_base_PortType** pPorts,
+  OMX_BUFFERHEADERTYPE** ppBuffers,
+  OMX_U32 nPorts) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  OMX_BOOL bFlushing = OMX_FALSE;
+  OMX_U32 i;
+
+  pthread_mutex_lock(&omx_base_component_Private->flush_mutex);
+  if(omx_base_component_Private->bStepFlushAcked == OMX_TRUE) {
+    /* the flushing thread has not completed yet: the step is scheduled again after it */
+    if(omx_base_component_Private->flush_condition->semval == 0) {
+      pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
+      return OMX_TRUE;
+    }
+    tsem_down(omx_base_component_Private->flush_condition);
+    omx_base_component_Private->bStepFlushAcked = OMX_FALSE;
+  }
+  for(i = 0; i < nPorts; i++) {
+    if(PORT_IS_BEING_FLUSHED(pPorts[i])) {
+      bFlushing = OMX_TRUE;
+    }
+  }
+  pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
+  if(bFlushing == OMX_FALSE) {
+    return OMX_FALSE;
+  }
+
+  for(i = 0; i < nPorts; i++) {
+    if(ppBuffers[i] != NULL && PORT_IS_BEING_FLUSHED(pPorts[i])) {
+      pPorts[i]->ReturnBufferFunction(pPorts[i], ppBuffers[i]);
+      ppBuffers[i] = NULL;
+      DEBUG(DEB_LEV_FULL_SEQ, "Ports are flushing,so returning buffer of port %i\n", (int)i);
+    }
+  }
+  DEBUG(DEB_LEV_FULL_SEQ, "In %s signalling flush all condition\n", __func__);
+  omx_base_component_Private->bStepFlushAcked = OMX_TRUE;
+  tsem_up(omx_base_component_Private->flush_all_condition);
+  return OMX_TRUE;
+}
+
 #ifdef __cplusplus
 }
 #endif
-
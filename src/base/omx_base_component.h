@@ -46,6 +46,7 @@
 #include "queue.h"
 #include "omx_classmagic.h"
 #include "omx_base_port.h"
+#include "omx_base_executor.h"
 #include "extension_struct.h"
 #include "omx_reference_resource_manager.h"
 
@@ -79,7 +80,15 @@ typedef enum OMX_INDEXVENDORTYPE {
 	OMX_IndexVendorOutputFilename,
 	OMX_IndexVendorCompPropTunnelFlags, /* Will use OMX_TUNNELSETUPTYPE structure*/
 	OMX_IndexParameterThreadsID,
-	OMX_VIDEO_CodingTheora
+	OMX_VIDEO_CodingTheora,
+	OMX_IndexConfigBellagioPortStats, /* Will use OMX_CONFIG_BELLAGIOPORTSTATSTYPE structure*/
+	OMX_IndexConfigBellagioBufferBatch, /* Will use OMX_CONFIG_BELLAGIOBUFFERBATCHTYPE structure*/
+	OMX_IndexConfigBellagioMixerPeriod, /* Will use OMX_CONFIG_BELLAGIOMIXERPERIODTYPE structure*/
+	OMX_IndexConfigBellagioChannelMatrix, /* Will use OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE structure*/
+	OMX_IndexConfigBellagioAudioLevels, /* Will use OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE structure*/
+	OMX_IndexConfigBellagioEqualizer, /* Will use OMX_CONFIG_BELLAGIOEQUALIZERTYPE structure*/
+	OMX_IndexConfigBellagioVideoQoS, /* Will use OMX_CONFIG_BELLAGIOVIDEOQOSTYPE structure*/
+	OMX_IndexConfigBellagioClockSnapshot /* Will use OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE structure*/
 } OMX_INDEXVENDORTYPE;
 
 /** This enum defines the transition states of the Component*/
@@ -111,6 +120,7 @@ typedef enum INTERNAL_MESSAGE_TYPE {
  * It is processed by the internal message handler thread
  */
 typedef struct internalRequestMessageType {
+  qlink_t link; /**< the link in the component message queue. It must be the first field */
   int messageType; /**< the flag that specifies if the message is a command, a warning or an error */
   int messageParam; /**< the second field of the message. Its use is the same as specified for the command in OpenMAX spec */
   OMX_PTR pCmdData; /**< This pointer could contain some proprietary data not covered by the standard */
@@ -136,7 +146,7 @@ CLASS(omx_base_component_PrivateType)
                                 as specified by the standard*/ \
 	OMX_PTR callbackData;/**< Private data that can be send with \
                         the client callbacks. Not specified by the standard */ \
-	queue_t* messageQueue;/**< the queue of all the messages recevied by the component */\
+	mpsc_queue_t* messageQueue;/**< the queue of all the messages recevied by the component */\
 	tsem_t* messageSem;/**< the semaphore that coordinates the access to the message queue */\
 	OMX_U32 nGroupPriority; /**< @param nGroupPriority Resource management field: component priority (common to a group of components) */\
 	OMX_U32 nGroupID; /**< @param nGroupID ID of a group of components that share the same logical chain */\
@@ -148,11 +158,20 @@ CLASS(omx_base_component_PrivateType)
 	tsem_t* flush_condition;  /** @param The flush_condition condition */ \
 	tsem_t* bMgmtSem;/**< @param bMgmtSem the semaphore that control BufferMgmtFunction processing */\
 	tsem_t* bStateSem;/**< @param bMgmtSem the semaphore that control BufferMgmtFunction processing */\
+	volatile int nMgmtWaiting; /**< @param nMgmtWaiting set while the buffer management thread waits in omx_base_component_WaitForPorts */\
+	OMX_BOOL bMgmtWaitsForPorts; /**< @param bMgmtWaitsForPorts true if the buffer management thread uses omx_base_component_WaitForPorts */\
+	volatile OMX_BOOL bMgmtWaitsForAny; /**< @param bMgmtWaitsForAny set while the buffer management thread waits in omx_base_component_WaitForAnyPort, where any port wakes it up */\
+	volatile OMX_U64* pSignalledPorts; /**< @param pSignalledPorts optional bitmask with one bit per port index, set by omx_base_component_SignalPortBuffer. A buffer management thread allocates it to find the ports with new buffers without scanning all of them */\
 	pthread_t messageHandlerThread; /** @param  messageHandlerThread This field contains the reference to the thread that receives messages for the components */ \
 	int bufferMgmtThreadID; /** @param  bufferMgmtThreadID The ID of the pthread that process buffers */ \
 	pthread_t bufferMgmtThread; /** @param  bufferMgmtThread This field contains the reference to the thread that process buffers */ \
 	void *loader; /**< pointer to the loader that created this component, used for destruction */ \
 	void* (*BufferMgmtFunction)(void* param); /** @param BufferMgmtFunction This function processes input output buffers */ \
+	OMX_BOOL (*BufferMgmtStep)(OMX_COMPONENTTYPE* openmaxStandComp); /** @param BufferMgmtStep Non blocking equivalent of BufferMgmtFunction, run by the shared executor. It returns OMX_TRUE if it can make more progress */ \
+	void* (*BufferMgmtStepThread)(void* param); /** @param BufferMgmtStepThread The BufferMgmtFunction that BufferMgmtStep replaces. If a derived component installs another BufferMgmtFunction its own thread is used */ \
+	omx_base_executor_task* pExecutorTask; /** @param pExecutorTask The executor task running BufferMgmtStep. It is detached when the buffer management thread is used */ \
+	OMX_BUFFERHEADERTYPE* pStepBuffer[2]; /** @param pStepBuffer The buffers held by BufferMgmtStep between two runs */ \
+	OMX_BOOL bStepFlushAcked; /** @param bStepFlushAcked true if BufferMgmtStep has acknowledged a flush and waits for flush_condition */ \
 	OMX_ERRORTYPE (*messageHandler)(OMX_COMPONENTTYPE*,internalRequestMessageType*);/** This function receives messages from the message queue. It is needed for each Linux ST OpenMAX component */ \
 	OMX_ERRORTYPE (*DoStateSet)(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32); /**< @param DoStateSet internal function called when a generic state transition is requested*/ \
 	OMX_ERRORTYPE (*destructor)(OMX_COMPONENTTYPE *openmaxStandComp); /** Component Destructor*/ \
@@ -429,4 +448,87 @@ OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_ComponentTunnelRequest(
   OMX_U32 nTunneledPort,
   OMX_TUNNELSETUPTYPE* pTunnelSetup);
 
+/** @brief Blocks the buffer management thread until all the given ports hold a buffer
+ *
+ * The thread is woken up once, when the last of the ports receives a buffer,
+ * or earlier by any other signal of bMgmtSem (state change, flush, ...).
+ * The caller must check the component state and the port semaphores again
+ * when the function returns.
+ *
+ * @param openmaxStandComp the component whose buffer management thread waits
+ * @param pPorts the ports that must all hold at least one buffer
+ * @param nPorts the number of ports in pPorts
+ */
+OSCL_IMPORT_REF void omx_base_component_WaitForPorts(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  omx_base_PortType** pPorts,
+  OMX_U32 nPorts);
+
+/** Timeout of omx_base_component_WaitForAnyPort that waits without limit */
+#define OMX_BASE_WAIT_FOREVER 0xFFFFFFFF
+
+/** @brief Blocks the buffer management thread until any port receives a
+ * buffer, or until a timeout expires
+ *
+ * It is used by the components that must produce their output at a given
+ * time, whatever the ports that are late. The component must have allocated
+ * pSignalledPorts, where it finds the ports that have received a buffer,
+ * so that it does not go through all of them. As for omx_base_component_WaitForPorts
+ * the caller must check the component state and the port semaphores again
+ * when the function returns.
+ *
+ * @param openmaxStandComp the component whose buffer management thread waits
+ * @param nMilliSeconds the longest wait, or OMX_BASE_WAIT_FOREVER
+ *
+ * @return OMX_ErrorTimeout if no port has woken up the thread in time,
+ * OMX_ErrorNone otherwise
+ */
+OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_component_WaitForAnyPort(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 nMilliSeconds);
+
+/** @brief Notifies the buffer management thread that a port received a buffer
+ *
+ * It must be called after the port buffer semaphore has been increased.
+ * If the buffer management thread waits in omx_base_component_WaitForPorts
+ * it is woken up only when all the ports it waits for hold a buffer, and
+ * in omx_base_component_WaitForAnyPort as soon as any port does.
+ * Otherwise bMgmtSem is simply signalled.
+ *
+ * @param openmaxStandPort the port that received the buffer
+ */
+OSCL_IMPORT_REF void omx_base_component_SignalPortBuffer(
+  omx_base_PortType* openmaxStandPort);
+
+/** @brief Wakes up the buffer management of a component after an event
+ *
+ * If the component runs on the shared executor its step is scheduled,
+ * otherwise the buffer management thread is woken by the callers through
+ * bMgmtSem and bStateSem as usual, so nothing is done.
+ *
+ * @param openmaxStandComp the component to wake up
+ */
+OSCL_IMPORT_REF void omx_base_component_WakeBufferMgmt(
+  OMX_COMPONENTTYPE *openmaxStandComp);
+
+/** @brief The flush handshake of a BufferMgmtStep function
+ *
+ * It is the non blocking equivalent of the flush loop of the buffer
+ * management threads. If one of the ports is being flushed the buffer held
+ * for it is returned and the flush is acknowledged, then the step must
+ * return until the flush is completed and the step is scheduled again.
+ *
+ * @param openmaxStandComp the component
+ * @param pPorts the ports handled by the step
+ * @param ppBuffers the buffers held for each port, NULL if none
+ * @param nPorts the number of ports in pPorts
+ *
+ * @return OMX_TRUE if a flush is in progress and the step must return
+ */
+OSCL_IMPORT_REF OMX_BOOL omx_base_component_StepFlush(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  omx_base_PortType** pPorts,
+  OMX_BUFFERHEADERTYPE** ppBuffers,
+  OMX_U32 nPorts);
+
 #endif
@@ -0,0 +1,271 @@
+/**
+  src/base/omx_base_executor.c
+
+  Shared work-stealing executor. Each worker owns a deque of ready tasks:
+  it takes work from the head of its own deque and, when that is empty,
+  steals from the tail of the deques of the other workers.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <omxcore.h>
+
+#include "omx_base_executor.h"
+
+#define EXECUTOR_TASK_IDLE    0
+#define EXECUTOR_TASK_QUEUED  1
+#define EXECUTOR_TASK_RUNNING 2
+#define EXECUTOR_TASK_RERUN   3
+
+/** Upper limit to the number of workers */
+#define EXECUTOR_MAX_WORKERS 64
+
+typedef struct executor_worker {
+  pthread_mutex_t mutex;
+  omx_base_executor_task* head;
+  omx_base_executor_task* tail;
+  pthread_t thread;
+  int index;
+} executor_worker;
+
+static executor_worker* workers = NULL;
+static int nworkers = 0;
+static int workersStarted = 0;
+static volatile unsigned roundRobin = 0;
+/** number of tasks in all the deques */
+static volatile int nqueued = 0;
+/** number of workers blocked, or about to block, on sleepCondition */
+static volatile int nsleeping = 0;
+static pthread_mutex_t sleepMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sleepCondition = PTHREAD_COND_INITIALIZER;
+/** signalled when a detached task goes idle, guarded by detachMutex */
+static pthread_mutex_t detachMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t detachCondition = PTHREAD_COND_INITIALIZER;
+static pthread_once_t executorOnce = PTHREAD_ONCE_INIT;
+/** index of the worker running on the current thread, -1 on other threads */
+static __thread int currentWorker = -1;
+
+static void executor_push(omx_base_executor_task* task) {
+  executor_worker* w;
+  int index = currentWorker;
+
+  if (index < 0) {
+    index = __sync_fetch_and_add(&roundRobin, 1) % nworkers;
+  }
+  w = &workers[index];
+  pthread_mutex_lock(&w->mutex);
+  task->prev = NULL;
+  task->next = w->head;
+  if (w->head) {
+    w->head->prev = task;
+  } else {
+    w->tail = task;
+  }
+  w->head = task;
+  pthread_mutex_unlock(&w->mutex);
+  __sync_fetch_and_add(&nqueued, 1);
+  if (nsleeping > 0) {
+    pthread_mutex_lock(&sleepMutex);
+    pthread_cond_signal(&sleepCondition);
+    pthread_mutex_unlock(&sleepMutex);
+  }
+}
+
+/** Removes a task from the head (own deque) or from the tail (stealing) */
+static omx_base_executor_task* executor_pop(executor_worker* w, int fromTail) {
+  omx_base_executor_task* task;
+
+  pthread_mutex_lock(&w->mutex);
+  task = fromTail ? w->tail : w->head;
+  if (task) {
+    if (task->prev) {
+      task->prev->next = task->next;
+    } else {
+      w->head = task->next;
+    }
+    if (task->next) {
+      task->next->prev = task->prev;
+    } else {
+      w->tail = task->prev;
+    }
+    task->prev = task->next = NULL;
+  }
+  pthread_mutex_unlock(&w->mutex);
+  if (task) {
+    __sync_fetch_and_sub(&nqueued, 1);
+  }
+  return task;
+}
+
+static omx_base_executor_task* executor_find(executor_worker* self) {
+  omx_base_executor_task* task;
+  int i;
+
+  task = executor_pop(self, 0);
+  for (i = 1; !task && i < nworkers; i++) {
+    task = executor_pop(&workers[(self->index + i) % nworkers], 1);
+  }
+  return task;
+}
+
+/** Wakes the threads waiting in omx_base_executor_Detach once a detached task is idle */
+static void executor_signal_detached(void) {
+  pthread_mutex_lock(&detachMutex);
+  pthread_cond_broadcast(&detachCondition);
+  pthread_mutex_unlock(&detachMutex);
+}
+
+static void executor_run(omx_base_executor_task* task) {
+  int budget = OMX_BASE_EXECUTOR_RUN_BUDGET;
+  OMX_BOOL bMore = OMX_TRUE;
+
+  __sync_bool_compare_and_swap(&task->state, EXECUTOR_TASK_QUEUED, EXECUTOR_TASK_RUNNING);
+  while (bMore && budget-- > 0 && !task->bDetached) {
+    bMore = task->run(task->data);
+  }
+  if (task->bDetached) {
+    task->state = EXECUTOR_TASK_IDLE;
+    executor_signal_detached();
+    return;
+  }
+  if (bMore) {
+    /* the budget is over: let the other ready tasks run first */
+    task->state = EXECUTOR_TASK_QUEUED;
+    executor_push(task);
+  } else if (!__sync_bool_compare_and_swap(&task->state, EXECUTOR_TASK_RUNNING, EXECUTOR_TASK_IDLE)) {
+    /* scheduled again while running */
+    task->state = EXECUTOR_TASK_QUEUED;
+    executor_push(task);
+  } else if (task->bDetached) {
+    /* detached after the run loop: the compare and swap ordered the idle state before this check */
+    executor_signal_detached();
+  }
+}
+
+static void* executor_worker_function(void* param) {
+  executor_worker* self = (executor_worker*)param;
+  omx_base_executor_task* task;
+
+  currentWorker = self->index;
+  while (1) {
+    task = executor_find(self);
+    if (task) {
+      executor_run(task);
+      continue;
+    }
+    pthread_mutex_lock(&sleepMutex);
+    __sync_fetch_and_add(&nsleeping, 1);
+    /* a pusher increments nqueued before reading nsleeping, so either it sees
+     * this worker sleeping or this worker sees its task */
+    __sync_synchronize();
+    if (nqueued == 0) {
+      pthread_cond_wait(&sleepCondition, &sleepMutex);
+    }
+    __sync_fetch_and_sub(&nsleeping, 1);
+    pthread_mutex_unlock(&sleepMutex);
+  }
+  return NULL;
+}
+
+static void executor_start(void) {
+  char* env = getenv(OMX_BASE_EXECUTOR_ENV);
+  int i, n;
+
+  n = env ? atoi(env) : 0;
+  if (n <= 0) {
+    n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  }
+  if (n <= 0) {
+    n = 1;
+  }
+  if (n > EXECUTOR_MAX_WORKERS) {
+    n = EXECUTOR_MAX_WORKERS;
+  }
+  workers = calloc(n, sizeof(executor_worker));
+  if (!workers) {
+    return;
+  }
+  for (i = 0; i < n; i++) {
+    pthread_mutex_init(&workers[i].mutex, NULL);
+    workers[i].index = i;
+  }
+  /* the deques must be usable before a worker can steal from them */
+  nworkers = n;
+  for (i = 0; i < n; i++) {
+    if (pthread_create(&workers[i].thread, NULL, executor_worker_function, &workers[i])) {
+      break;
+    }
+    pthread_detach(workers[i].thread);
+  }
+  if (i == 0) {
+    DEBUG(DEB_LEV_ERR, "In %s unable to start the executor workers\n", __func__);
+    return;
+  }
+  /* tasks pushed from outside go to the workers actually running */
+  nworkers = i;
+  workersStarted = 1;
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s started %i executor workers\n", __func__, i);
+}
+
+OSCL_EXPORT_REF OMX_BOOL omx_base_executor_IsEnabled(void) {
+  return getenv(OMX_BASE_EXECUTOR_ENV) ? OMX_TRUE : OMX_FALSE;
+}
+
+OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_executor_Attach(omx_base_executor_task* task) {
+  pthread_once(&executorOnce, executor_start);
+  if (!workersStarted) {
+    return OMX_ErrorInsufficientResources;
+  }
+  task->prev = task->next = NULL;
+  task->state = EXECUTOR_TASK_IDLE;
+  task->bDetached = OMX_FALSE;
+  __sync_synchronize();
+  omx_base_executor_Schedule(task);
+  return OMX_ErrorNone;
+}
+
+OSCL_EXPORT_REF void omx_base_executor_Schedule(omx_base_executor_task* task) {
+  while (!task->bDetached) {
+    if (__sync_bool_compare_and_swap(&task->state, EXECUTOR_TASK_IDLE, EXECUTOR_TASK_QUEUED)) {
+      executor_push(task);
+      return;
+    }
+    if (__sync_bool_compare_and_swap(&task->state, EXECUTOR_TASK_RUNNING, EXECUTOR_TASK_RERUN)) {
+      return;
+    }
+    if (task->state == EXECUTOR_TASK_QUEUED || task->state == EXECUTOR_TASK_RERUN) {
+      return;
+    }
+  }
+}
+
+OSCL_EXPORT_REF void omx_base_executor_Detach(omx_base_executor_task* task) {
+  task->bDetached = OMX_TRUE;
+  __sync_synchronize();
+  /* a queued task is dropped by the worker that pops it, which then signals the idle state */
+  pthread_mutex_lock(&detachMutex);
+  while (task->state != EXECUTOR_TASK_IDLE) {
+    pthread_cond_wait(&detachCondition, &detachMutex);
+  }
+  pthread_mutex_unlock(&detachMutex);
+}
@@ -0,0 +1,97 @@
+/**
+  src/base/omx_base_executor.h
+
+  Shared work-stealing executor. When enabled, the buffer processing of the
+  components derived from the base filter, source and sink classes runs as
+  tasks on one pool of worker threads instead of one thread per component.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMX_BASE_EXECUTOR_H__
+#define __OMX_BASE_EXECUTOR_H__
+
+#ifdef ANDROID_COMPILATION
+#include <oscl_base_macros.h>
+#else
+#define OSCL_IMPORT_REF
+#define OSCL_EXPORT_REF
+#endif
+
+#include <OMX_Types.h>
+#include <OMX_Core.h>
+
+/** Name of the environment variable that enables the shared executor.
+ * If it holds a positive number, that is the number of worker threads,
+ * any other value selects one worker per online processor.
+ * If it is not set each component keeps its own buffer management thread
+ */
+#define OMX_BASE_EXECUTOR_ENV "OMX_BELLAGIO_EXECUTOR"
+
+/** Maximum number of consecutive runs of a task before it is queued
+ * again behind the other ready tasks
+ */
+#define OMX_BASE_EXECUTOR_RUN_BUDGET 32
+
+/** A unit of work that can be scheduled on the executor.
+ *
+ * A task is queued at most once: scheduling a queued task does nothing
+ * and scheduling a running task makes it run again when it completes.
+ */
+typedef struct omx_base_executor_task omx_base_executor_task;
+struct omx_base_executor_task {
+  volatile int state; /**< idle, queued, running or running with a pending request */
+  volatile OMX_BOOL bDetached; /**< when set the task is not scheduled nor run any more */
+  OMX_BOOL (*run)(void* data); /**< the work. It returns OMX_TRUE if more work is immediately available */
+  void* data; /**< the argument of run */
+  omx_base_executor_task* prev; /**< link in the deque of a worker */
+  omx_base_executor_task* next; /**< link in the deque of a worker */
+};
+
+/** Returns OMX_TRUE if the shared executor has been enabled
+ * through the OMX_BASE_EXECUTOR_ENV environment variable
+ */
+OSCL_IMPORT_REF OMX_BOOL omx_base_executor_IsEnabled(void);
+
+/** Makes a task schedulable and schedules it once.
+ * The worker threads are started by the first call
+ *
+ * @param task the task to attach. run and data must be already set
+ *
+ * @return OMX_ErrorInsufficientResources if the workers cannot be started
+ */
+OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_executor_Attach(omx_base_executor_task* task);
+
+/** Queues a task on the executor, if it is attached and not already queued
+ *
+ * It can be called from any thread. When called from a worker the task
+ * is queued on the worker own deque, so that it runs on the same processor
+ *
+ * @param task the task to schedule
+ */
+OSCL_IMPORT_REF void omx_base_executor_Schedule(omx_base_executor_task* task);
+
+/** Stops scheduling a task and waits until it is neither queued nor running
+ *
+ * @param task the task to detach
+ */
+OSCL_IMPORT_REF void omx_base_executor_Detach(omx_base_executor_task* task);
+
+#endif
@@ -30,6 +30,7 @@
 #include <omxcore.h>
 
 #include "omx_base_filter.h"
+#include "omx_trace.h"
 
 OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_filter_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName) {
   OMX_ERRORTYPE err;
@@ -58,6 +59,10 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_filter_Constructor(OMX_COMPONENTTYPE *ope
   omx_base_filter_Private = openmaxStandComp->pComponentPrivate;
 
   omx_base_filter_Private->BufferMgmtFunction = omx_base_filter_BufferMgmtFunction;
+  omx_base_filter_Private->BufferMgmtStep = omx_base_filter_BufferMgmtStep;
+  omx_base_filter_Private->BufferMgmtStepThread = omx_base_filter_BufferMgmtFunction;
+  omx_base_filter_Private->bInPlace = OMX_FALSE;
+  omx_base_filter_Private->bCallbackOnEOS = OMX_FALSE;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s of component %p\n", __func__, openmaxStandComp);
   return OMX_ErrorNone;
@@ -75,6 +80,131 @@ OSCL_EXPORT_REF OMX_ERRORTYPE omx_base_filter_Destructor(OMX_COMPONENTTYPE *open
 	  return OMX_ErrorNone;
 }
 
+/** Handles the mark of an input buffer. The mark is signalled if this
+  * component is the target, otherwise it is passed to the next output buffer
+  */
+static void base_filter_ProcessInputMark(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer) {
+  omx_base_filter_PrivateType* omx_base_filter_Private = (omx_base_filter_PrivateType*)openmaxStandComp->pComponentPrivate;
+
+  if(pInputBuffer->hMarkTargetComponent != NULL){
+    if((OMX_COMPONENTTYPE*)pInputBuffer->hMarkTargetComponent ==(OMX_COMPONENTTYPE *)openmaxStandComp) {
+      /*Clear the mark and generate an event*/
+      (*(omx_base_filter_Private->callbacks->EventHandler))
+        (openmaxStandComp,
+        omx_base_filter_Private->callbackData,
+        OMX_EventMark, /* The command was completed */
+        1, /* The commands was a OMX_CommandStateSet */
+        0, /* The state has been changed in message->messageParam2 */
+        pInputBuffer->pMarkData);
+    } else {
+      /*If this is not the target component then pass the mark*/
+      omx_base_filter_Private->pMark.hMarkTargetComponent = pInputBuffer->hMarkTargetComponent;
+      omx_base_filter_Private->pMark.pMarkData            = pInputBuffer->pMarkData;
+    }
+    pInputBuffer->hMarkTargetComponent = NULL;
+  }
+}
+
+/** Returns OMX_TRUE if the memory of the buffers of the port can be moved to
+  * another port: the port is not tunneled and the component allocated all its buffers
+  */
+static OMX_BOOL base_filter_OwnsBufferMemory(omx_base_PortType *openmaxStandPort) {
+  OMX_U32 i;
+
+  if (PORT_IS_TUNNELED(openmaxStandPort)) {
+    return OMX_FALSE;
+  }
+  for (i = 0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++) {
+    if (openmaxStandPort->bBufferStateAllocated[i] != BUFFER_FREE &&
+        !(openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ALLOCATED)) {
+      return OMX_FALSE;
+    }
+  }
+  return OMX_TRUE;
+}
+
+/** Processes an input buffer into an output buffer: it propagates the mark,
+  * the timestamp and the flags, calls BufferMgmtCallback and signals EOS.
+  * It is shared by the buffer management thread and the executor step
+  */
+static void base_filter_ProcessBuffers(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_base_filter_PrivateType* omx_base_filter_Private = (omx_base_filter_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_PortType *pInPort=(omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  omx_base_PortType *pOutPort=(omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  OMX_U64 nCallbackStart, nCallbackTime;
+  OMX_U8* pOutputMemory = NULL;
+  OMX_U32 nOutputAllocLen = 0;
+  OMX_BOOL bInPlace;
+
+  if(omx_base_filter_Private->pMark.hMarkTargetComponent != NULL){
+    pOutputBuffer->hMarkTargetComponent = omx_base_filter_Private->pMark.hMarkTargetComponent;
+    pOutputBuffer->pMarkData            = omx_base_filter_Private->pMark.pMarkData;
+    omx_base_filter_Private->pMark.hMarkTargetComponent = NULL;
+    omx_base_filter_Private->pMark.pMarkData            = NULL;
+  }
+
+  pOutputBuffer->nTimeStamp = pInputBuffer->nTimeStamp;
+  if((pInputBuffer->nFlags & OMX_BUFFERFLAG_STARTTIME) == OMX_BUFFERFLAG_STARTTIME) {
+     DEBUG(DEB_LEV_FULL_SEQ, "Detected  START TIME flag in the input buffer filled len=%d\n", (int)pInputBuffer->nFilledLen);
+     pOutputBuffer->nFlags = pInputBuffer->nFlags;
+     pInputBuffer->nFlags = 0;
+  }
+
+  if(omx_base_filter_Private->state == OMX_StateExecuting)  {
+    if (omx_base_filter_Private->BufferMgmtCallback && (pInputBuffer->nFilledLen > 0 ||
+        (omx_base_filter_Private->bCallbackOnEOS && (pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS))) {
+      bInPlace = omx_base_filter_Private->bInPlace && pOutputBuffer->nFilledLen == 0 &&
+                 pInputBuffer->nAllocLen == pOutputBuffer->nAllocLen &&
+                 base_filter_OwnsBufferMemory(pInPort) && base_filter_OwnsBufferMemory(pOutPort);
+      if (bInPlace) {
+        /* the input data goes downstream in the output buffer, without copy */
+        pOutputMemory = pOutputBuffer->pBuffer;
+        nOutputAllocLen = pOutputBuffer->nAllocLen;
+        pOutputBuffer->pBuffer = pInputBuffer->pBuffer;
+        pOutputBuffer->nAllocLen = pInputBuffer->nAllocLen;
+        pOutputBuffer->nOffset = pInputBuffer->nOffset;
+      }
+      nCallbackStart = base_port_StatTime();
+      OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer);
+      (*(omx_base_filter_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer, pOutputBuffer);
+      OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer);
+      nCallbackTime = base_port_StatTime() - nCallbackStart;
+      base_port_StatCallbackTime(pInPort, nCallbackTime);
+      base_port_StatCallbackTime(pOutPort, nCallbackTime);
+      if (bInPlace) {
+        /* the input keeps what the callback left of it, moved to its new memory */
+        if (pInputBuffer->nFilledLen > 0) {
+          memcpy(pOutputMemory, pOutputBuffer->pBuffer + pInputBuffer->nOffset, pInputBuffer->nFilledLen);
+        }
+        pInputBuffer->pBuffer = pOutputMemory;
+        pInputBuffer->nAllocLen = nOutputAllocLen;
+        pInputBuffer->nOffset = 0;
+      }
+    } else {
+      /*It no buffer management call back the explicitly consume input buffer*/
+      pInputBuffer->nFilledLen = 0;
+    }
+  } else if(!(PORT_IS_BEING_FLUSHED(pInPort) || PORT_IS_BEING_FLUSHED(pOutPort))) {
+    DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%x)\n", __func__, (int)omx_base_filter_Private->state);
+  } else {
+      pInputBuffer->nFilledLen = 0;
+  }
+
+  if((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS && pInputBuffer->nFilledLen==0) {
+    DEBUG(DEB_LEV_FULL_SEQ, "Detected EOS flags in input buffer filled len=%d\n", (int)pInputBuffer->nFilledLen);
+    pOutputBuffer->nFlags=pInputBuffer->nFlags;
+    pInputBuffer->nFlags=0;
+    (*(omx_base_filter_Private->callbacks->EventHandler))
+      (openmaxStandComp,
+      omx_base_filter_Private->callbackData,
+      OMX_EventBufferFlag, /* The command was completed */
+      1, /* The commands was a OMX_CommandStateSet */
+      pOutputBuffer->nFlags, /* The state has been changed in message->messageParam2 */
+      NULL);
+    omx_base_filter_Private->bIsEOSReached = OMX_TRUE;
+  }
+}
+
 /** This is the central function for component processing. It
   * is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
@@ -93,6 +223,8 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
   OMX_BUFFERHEADERTYPE* pInputBuffer=NULL;
   OMX_BOOL isInputBufferNeeded=OMX_TRUE,isOutputBufferNeeded=OMX_TRUE;
   int inBufExchanged=0,outBufExchanged=0;
+  omx_base_PortType *pWaitPorts[2];
+  OMX_U32 nWaitPorts;
 
   omx_base_filter_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s of component %p\n", __func__, openmaxStandComp);
@@ -137,25 +269,20 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
     }
     pthread_mutex_unlock(&omx_base_filter_Private->flush_mutex);
 
-    /*No buffer to process. So wait here*/
-    if((isInputBufferNeeded==OMX_TRUE && pInputSem->semval==0) &&
-      (omx_base_filter_Private->state != OMX_StateLoaded && omx_base_filter_Private->state != OMX_StateInvalid)) {
-      //Signaled from EmptyThisBuffer or FillThisBuffer or some thing else
-      DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next input/output buffer\n");
-      tsem_down(omx_base_filter_Private->bMgmtSem);
-
+    /*No buffer to process. So wait here until both the needed buffers are available*/
+    nWaitPorts = 0;
+    if(isInputBufferNeeded==OMX_TRUE) {
+      pWaitPorts[nWaitPorts++] = pInPort;
     }
-    if(omx_base_filter_Private->state == OMX_StateLoaded || omx_base_filter_Private->state == OMX_StateInvalid) {
-      DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
-      break;
+    if(isOutputBufferNeeded==OMX_TRUE && !(PORT_IS_BEING_FLUSHED(pInPort) || PORT_IS_BEING_FLUSHED(pOutPort))) {
+      pWaitPorts[nWaitPorts++] = pOutPort;
     }
-    if((isOutputBufferNeeded==OMX_TRUE && pOutputSem->semval==0) &&
-      (omx_base_filter_Private->state != OMX_StateLoaded && omx_base_filter_Private->state != OMX_StateInvalid) &&
-       !(PORT_IS_BEING_FLUSHED(pInPort) || PORT_IS_BEING_FLUSHED(pOutPort))) {
+    if(((isInputBufferNeeded==OMX_TRUE && pInputSem->semval==0) ||
+        (nWaitPorts > 0 && pWaitPorts[nWaitPorts-1] == pOutPort && pOutputSem->semval==0)) &&
+      (omx_base_filter_Private->state != OMX_StateLoaded && omx_base_filter_Private->state != OMX_StateInvalid)) {
       //Signaled from EmptyThisBuffer or FillThisBuffer or some thing else
       DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next input/output buffer\n");
-      tsem_down(omx_base_filter_Private->bMgmtSem);
-
+      omx_base_component_WaitForPorts(openmaxStandComp, pWaitPorts, nWaitPorts);
     }
     if(omx_base_filter_Private->state == OMX_StateLoaded || omx_base_filter_Private->state == OMX_StateInvalid) {
       DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
@@ -169,6 +296,7 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
         inBufExchanged++;
         isInputBufferNeeded=OMX_FALSE;
         pInputBuffer = dequeue(pInputQueue);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer);
         if(pInputBuffer == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL input buffer!!\n");
           break;
@@ -182,6 +310,7 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
         outBufExchanged++;
         isOutputBufferNeeded=OMX_FALSE;
         pOutputBuffer = dequeue(pOutputQueue);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pOutPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer);
         if(pOutputBuffer == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL output buffer!! op is=%d,iq=%d\n",pOutputSem->semval,pOutputQueue->nelem);
           break;
@@ -190,67 +319,13 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
     }
 
     if(isInputBufferNeeded==OMX_FALSE) {
-      if(pInputBuffer->hMarkTargetComponent != NULL){
-        if((OMX_COMPONENTTYPE*)pInputBuffer->hMarkTargetComponent ==(OMX_COMPONENTTYPE *)openmaxStandComp) {
-          /*Clear the mark and generate an event*/
-          (*(omx_base_filter_Private->callbacks->EventHandler))
-            (openmaxStandComp,
-            omx_base_filter_Private->callbackData,
-            OMX_EventMark, /* The command was completed */
-            1, /* The commands was a OMX_CommandStateSet */
-            0, /* The state has been changed in message->messageParam2 */
-            pInputBuffer->pMarkData);
-        } else {
-          /*If this is not the target component then pass the mark*/
-          omx_base_filter_Private->pMark.hMarkTargetComponent = pInputBuffer->hMarkTargetComponent;
-          omx_base_filter_Private->pMark.pMarkData            = pInputBuffer->pMarkData;
-        }
-        pInputBuffer->hMarkTargetComponent = NULL;
-      }
+      base_filter_ProcessInputMark(openmaxStandComp, pInputBuffer);
     }
 
     if(isInputBufferNeeded==OMX_FALSE && isOutputBufferNeeded==OMX_FALSE) {
 
-      if(omx_base_filter_Private->pMark.hMarkTargetComponent != NULL){
-        pOutputBuffer->hMarkTargetComponent = omx_base_filter_Private->pMark.hMarkTargetComponent;
-        pOutputBuffer->pMarkData            = omx_base_filter_Private->pMark.pMarkData;
-        omx_base_filter_Private->pMark.hMarkTargetComponent = NULL;
-        omx_base_filter_Private->pMark.pMarkData            = NULL;
-      }
-
-      pOutputBuffer->nTimeStamp = pInputBuffer->nTimeStamp;
-      if((pInputBuffer->nFlags & OMX_BUFFERFLAG_STARTTIME) == OMX_BUFFERFLAG_STARTTIME) {
-         DEBUG(DEB_LEV_FULL_SEQ, "Detected  START TIME flag in the input buffer filled len=%d\n", (int)pInputBuffer->nFilledLen);
-         pOutputBuffer->nFlags = pInputBuffer->nFlags;
-         pInputBuffer->nFlags = 0;
-      }
-
-      if(omx_base_filter_Private->state == OMX_StateExecuting)  {
-        if (omx_base_filter_Private->BufferMgmtCallback && pInputBuffer->nFilledLen > 0) {
-          (*(omx_base_filter_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer, pOutputBuffer);
-        } else {
-          /*It no buffer management call back the explicitly consume input buffer*/
-          pInputBuffer->nFilledLen = 0;
-        }
-      } else if(!(PORT_IS_BEING_FLUSHED(pInPort) || PORT_IS_BEING_FLUSHED(pOutPort))) {
-        DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%x)\n", __func__, (int)omx_base_filter_Private->state);
-      } else {
-          pInputBuffer->nFilledLen = 0;
-      }
+      base_filter_ProcessBuffers(openmaxStandComp, pInputBuffer, pOutputBuffer);
 
-      if((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS && pInputBuffer->nFilledLen==0) {
-        DEBUG(DEB_LEV_FULL_SEQ, "Detected EOS flags in input buffer filled len=%d\n", (int)pInputBuffer->nFilledLen);
-        pOutputBuffer->nFlags=pInputBuffer->nFlags;
-        pInputBuffer->nFlags=0;
-        (*(omx_base_filter_Private->callbacks->EventHandler))
-          (openmaxStandComp,
-          omx_base_filter_Private->callbackData,
-          OMX_EventBufferFlag, /* The command was completed */
-          1, /* The commands was a OMX_CommandStateSet */
-          pOutputBuffer->nFlags, /* The state has been changed in message->messageParam2 */
-          NULL);
-        omx_base_filter_Private->bIsEOSReached = OMX_TRUE;
-      }
       if(omx_base_filter_Private->state==OMX_StatePause && !(PORT_IS_BEING_FLUSHED(pInPort) || PORT_IS_BEING_FLUSHED(pOutPort))) {
         /*Waiting at paused state*/
         tsem_wait(omx_base_filter_Private->bStateSem);
@@ -281,3 +356,61 @@ void* omx_base_filter_BufferMgmtFunction (void* param) {
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s of component %p\n", __func__, openmaxStandComp);
   return NULL;
 }
+
+/** This is the non blocking equivalent of omx_base_filter_BufferMgmtFunction,
+  * run by the shared executor. It takes the available buffers, processes them
+  * and returns, keeping the buffers not yet consumed in pStepBuffer.
+  */
+OSCL_EXPORT_REF OMX_BOOL omx_base_filter_BufferMgmtStep(OMX_COMPONENTTYPE* openmaxStandComp) {
+  omx_base_filter_PrivateType* omx_base_filter_Private = (omx_base_filter_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_PortType *pPorts[2];
+  OMX_BUFFERHEADERTYPE** ppInputBuffer = &omx_base_filter_Private->pStepBuffer[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  OMX_BUFFERHEADERTYPE** ppOutputBuffer = &omx_base_filter_Private->pStepBuffer[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  OMX_BOOL bProgress = OMX_FALSE;
+
+  pPorts[OMX_BASE_FILTER_INPUTPORT_INDEX] = (omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  pPorts[OMX_BASE_FILTER_OUTPUTPORT_INDEX] = (omx_base_PortType *)omx_base_filter_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+
+  if(!(omx_base_filter_Private->state == OMX_StateIdle || omx_base_filter_Private->state == OMX_StateExecuting ||
+    omx_base_filter_Private->state == OMX_StatePause || omx_base_filter_Private->transientState == OMX_TransStateLoadedToIdle)) {
+    return OMX_FALSE;
+  }
+  if(omx_base_component_StepFlush(openmaxStandComp, pPorts, omx_base_filter_Private->pStepBuffer, 2) == OMX_TRUE ||
+     omx_base_filter_Private->state == OMX_StatePause) {
+    return OMX_FALSE;
+  }
+
+  if(*ppInputBuffer == NULL && tsem_try_down(pPorts[OMX_BASE_FILTER_INPUTPORT_INDEX]->pBufferSem)) {
+    *ppInputBuffer = dequeue(pPorts[OMX_BASE_FILTER_INPUTPORT_INDEX]->pBufferQueue);
+    OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pPorts[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)*ppInputBuffer);
+    bProgress = OMX_TRUE;
+  }
+  if(*ppOutputBuffer == NULL && tsem_try_down(pPorts[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->pBufferSem)) {
+    *ppOutputBuffer = dequeue(pPorts[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->pBufferQueue);
+    OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pPorts[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)*ppOutputBuffer);
+    bProgress = OMX_TRUE;
+  }
+  if(*ppInputBuffer == NULL) {
+    return bProgress;
+  }
+  base_filter_ProcessInputMark(openmaxStandComp, *ppInputBuffer);
+
+  if(*ppOutputBuffer != NULL) {
+    base_filter_ProcessBuffers(openmaxStandComp, *ppInputBuffer, *ppOutputBuffer);
+
+    /*If EOS and Input buffer Filled Len Zero then Return output buffer immediately*/
+    if(((*ppOutputBuffer)->nFilledLen != 0) || (((*ppOutputBuffer)->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) || (omx_base_filter_Private->bIsEOSReached == OMX_TRUE)) {
+      pPorts[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->ReturnBufferFunction(pPorts[OMX_BASE_FILTER_OUTPUTPORT_INDEX], *ppOutputBuffer);
+      *ppOutputBuffer = NULL;
+      bProgress = OMX_TRUE;
+    }
+  }
+
+  /*Input Buffer has been completely consumed. So, return input buffer*/
+  if((*ppInputBuffer)->nFilledLen == 0) {
+    pPorts[OMX_BASE_FILTER_INPUTPORT_INDEX]->ReturnBufferFunction(pPorts[OMX_BASE_FILTER_INPUTPORT_INDEX], *ppInputBuffer);
+    *ppInputBuffer = NULL;
+    bProgress = OMX_TRUE;
+  }
+  return bProgress;
+}
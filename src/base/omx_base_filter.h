@@ -52,6 +52,19 @@ DERIVEDCLASS(omx_base_filter_PrivateType, omx_base_component_PrivateType)
 #define omx_base_filter_PrivateType_FIELDS omx_base_component_PrivateType_FIELDS \
   /** @param pPendingOutputBuffer pending Output Buffer pointer */ \
   OMX_BUFFERHEADERTYPE* pPendingOutputBuffer; \
+  /** @param bInPlace set by the derived component if BufferMgmtCallback can process the data in place. \
+   * When the buffers of both ports are allocated by the component and not tunneled, the output \
+   * buffer is then given the memory of the input buffer before the callback, so that \
+   * pInputBuffer->pBuffer == pOutputBuffer->pBuffer, and the input buffer takes the memory of \
+   * the output buffer afterwards. The payloads of the headers the client got from OMX_AllocateBuffer \
+   * are thus exchanged between them: a component setting bInPlace documents that its clients must \
+   * read pBuffer from the header at each EmptyBufferDone and FillBufferDone, not keep the pointer \
+   * they were allocated. The callback must not write output past the input it consumed; the input \
+   * it leaves, from nOffset for nFilledLen bytes, is copied to the new memory of the input buffer */ \
+  OMX_BOOL bInPlace; \
+  /** @param bCallbackOnEOS set by the derived component if BufferMgmtCallback must also be called \
+   * for an empty input buffer carrying the EOS flag, to flush the data it holds at the end of a stream */ \
+  OMX_BOOL bCallbackOnEOS; \
   /** @param BufferMgmtCallback function pointer for algorithm callback */ \
   void (*BufferMgmtCallback)(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* inputbuffer, OMX_BUFFERHEADERTYPE* outputbuffer);
 ENDCLASS(omx_base_filter_PrivateType)
@@ -79,4 +92,12 @@ OSCL_IMPORT_REF OMX_ERRORTYPE omx_base_filter_Destructor(OMX_COMPONENTTYPE *open
  */
 void* omx_base_filter_BufferMgmtFunction(void* param);
 
+/** This is the non blocking equivalent of omx_base_filter_BufferMgmtFunction.
+ * It is run by the shared executor, if enabled, instead of the buffer
+ * management thread.
+ *
+ * @return OMX_TRUE if more buffers can be processed immediately
+ */
+OSCL_IMPORT_REF OMX_BOOL omx_base_filter_BufferMgmtStep(OMX_COMPONENTTYPE* openmaxStandComp);
+
 #endif
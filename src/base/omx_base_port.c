@@ -25,12 +25,14 @@
 
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 #include <omxcore.h>
 #include <OMX_Core.h>
 #include <OMX_Component.h>
 
 #include "omx_base_component.h"
 #include "omx_base_port.h"
+#include "omx_trace.h"
 
 /** The default value for the number of needed buffers for each port. */
 #define DEFAULT_NUMBER_BUFFERS_PER_PORT 2
@@ -118,6 +120,7 @@ OMX_ERRORTYPE base_port_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,omx_base
   (*openmaxStandPort)->Port_DisablePort = &base_port_DisablePort;
   (*openmaxStandPort)->Port_EnablePort = &base_port_EnablePort;
   (*openmaxStandPort)->Port_SendBufferFunction = &base_port_SendBufferFunction;
+  (*openmaxStandPort)->Port_SendBufferBatchFunction = &base_port_SendBufferBatchFunction;
   (*openmaxStandPort)->FlushProcessingBuffers = &base_port_FlushProcessingBuffers;
   (*openmaxStandPort)->ReturnBufferFunction = &base_port_ReturnBufferFunction;
   (*openmaxStandPort)->ComponentTunnelRequest = &base_port_ComponentTunnelRequest;
@@ -125,7 +128,16 @@ OMX_ERRORTYPE base_port_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,omx_base
   (*openmaxStandPort)->Port_FreeTunnelBuffer = &base_port_FreeTunnelBuffer;
   (*openmaxStandPort)->bIsDestroying = OMX_FALSE;
   pthread_mutex_init(&((*openmaxStandPort)->exitMutex), NULL);
-
+  (*openmaxStandPort)->nStatBuffersReceived = 0;
+  (*openmaxStandPort)->nStatBuffersReturned = 0;
+  (*openmaxStandPort)->nStatMaxQueueDepth = 0;
+  (*openmaxStandPort)->nStatCallbackTime = 0;
+  (*openmaxStandPort)->nStatCallbackTimeMax = 0;
+  (*openmaxStandPort)->pBufferPool = NULL;
+  /* the payloads start zeroed, as they did when each one came from calloc */
+  (*openmaxStandPort)->nBufferPoolFlags = BUFFER_POOL_ZERO | (getenv(OMX_BASE_BUFFER_POOL_HUGEPAGES_ENV) ? BUFFER_POOL_HUGEPAGES : 0);
+  (*openmaxStandPort)->pHeaderSlab = NULL;
+  (*openmaxStandPort)->nHeaderSlabCount = 0;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
   return OMX_ErrorNone;
@@ -161,6 +173,12 @@ OMX_ERRORTYPE base_port_Destructor(omx_base_PortType *openmaxStandPort){
 		openmaxStandPort->pBufferSem=NULL;
 	}
 
+	omx_base_buffer_pool_Detach(&openmaxStandPort->pBufferPool);
+	if(openmaxStandPort->pHeaderSlab) {
+		free(openmaxStandPort->pHeaderSlab);
+		openmaxStandPort->pHeaderSlab=NULL;
+	}
+
 	pthread_mutex_destroy(&openmaxStandPort->exitMutex);
 
 	free(openmaxStandPort);
@@ -180,6 +198,7 @@ OMX_ERRORTYPE base_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPo
 
 	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for port %p\n", __func__, openmaxStandPort);
   omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_TRACE(OMX_TraceFlushBegin, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, 0);
 
   if(openmaxStandPort->sPortParam.eDomain!=OMX_PortDomainOther) { /* clock buffers not used in the clients buffer managment function */
     pthread_mutex_lock(&omx_base_component_Private->flush_mutex);
@@ -196,6 +215,7 @@ OMX_ERRORTYPE base_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPo
     DEBUG(DEB_LEV_FULL_SEQ, "In %s waiting for flush all condition port index =%d\n", __func__,(int)openmaxStandPort->sPortParam.nPortIndex);
     /* Wait until flush is completed */
     pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
+    omx_base_component_WakeBufferMgmt(openmaxStandPort->standCompContainer);
     tsem_down(omx_base_component_Private->flush_all_condition);
   }
 DEBUG(DEB_LEV_FUNCTION_NAME, "In %s flushed all the buffers under processing\n", __func__);
@@ -210,6 +230,10 @@ DEBUG(DEB_LEV_FUNCTION_NAME, "In %s flushed all the buffers under processing\n",
 
     tsem_down(openmaxStandPort->pBufferSem);
     pBuffer = dequeue(openmaxStandPort->pBufferQueue);
+    if (!PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort)) {
+      base_port_StatBufferReturned(openmaxStandPort);
+      OMX_TRACE(OMX_TraceBufferReturn, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pBuffer);
+    }
     if (PORT_IS_TUNNELED(openmaxStandPort) && !PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)) {
       DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s is returning io:%d buffer\n",
         __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
@@ -247,7 +271,9 @@ DEBUG(DEB_LEV_FUNCTION_NAME, "In %s flushed all the buffers under processing\n",
   openmaxStandPort->bIsPortFlushed=OMX_FALSE;
   pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
 
+  OMX_TRACE(OMX_TraceFlushEnd, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, 0);
   tsem_up(omx_base_component_Private->flush_condition);
+  omx_base_component_WakeBufferMgmt(openmaxStandPort->standCompContainer);
 
   DEBUG(DEB_LEV_FULL_SEQ, "Out %s Port Index=%d bIsPortFlushed=%d Component %s\n", __func__,
     (int)openmaxStandPort->sPortParam.nPortIndex,(int)openmaxStandPort->bIsPortFlushed,omx_base_component_Private->name);
@@ -286,6 +312,7 @@ OMX_ERRORTYPE base_port_DisablePort(omx_base_PortType *openmaxStandPort) {
       if(omx_base_component_Private->bMgmtSem->semval==0) {
         tsem_up(omx_base_component_Private->bMgmtSem);
       }
+      omx_base_component_WakeBufferMgmt(openmaxStandPort->standCompContainer);
       /*Wait till all buffers are freed*/
       tsem_down(openmaxStandPort->pAllocSem);
       tsem_reset(omx_base_component_Private->bMgmtSem);
@@ -360,7 +387,7 @@ OMX_ERRORTYPE base_port_EnablePort(omx_base_PortType *openmaxStandPort) {
     if (omx_base_component_Private->state==OMX_StateExecuting) {
       for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual;i++) {
         tsem_up(openmaxStandPort->pBufferSem);
-        tsem_up(omx_base_component_Private->bMgmtSem);
+        omx_base_component_SignalPortBuffer(openmaxStandPort);
       }
     }
     DEBUG(DEB_LEV_PARAMS, "In %s Qelem=%d BSem=%d\n", __func__,openmaxStandPort->pBufferQueue->nelem,openmaxStandPort->pBufferSem->semval);
@@ -372,6 +399,17 @@ OMX_ERRORTYPE base_port_EnablePort(omx_base_PortType *openmaxStandPort) {
   return OMX_ErrorNone;
 }
 
+/** Takes a payload for a buffer allocated by the port from the slab of the port.
+ * The slab, when needed, is sized for all the buffers the port is still missing
+ */
+static OMX_U8* base_port_AllocatePayload(omx_base_PortType *openmaxStandPort, OMX_U32 nSizeBytes) {
+  return omx_base_buffer_pool_Get(&openmaxStandPort->pBufferPool,
+                                  openmaxStandPort->sPortParam.nBufferCountActual - openmaxStandPort->nNumAssignedBuffers,
+                                  nSizeBytes,
+                                  openmaxStandPort->sPortParam.nBufferAlignment,
+                                  openmaxStandPort->nBufferPoolFlags);
+}
+
 /** @brief Called by the standard allocate buffer, it implements a base functionality.
  *
  * This function can be overriden if the allocation of the buffer is not a simply alloc call.
@@ -413,22 +451,41 @@ OMX_ERRORTYPE base_port_AllocateBuffer(
 
   for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
     if (openmaxStandPort->bBufferStateAllocated[i] == BUFFER_FREE) {
-      openmaxStandPort->pInternalBufferStorage[i] = calloc(1,sizeof(OMX_BUFFERHEADERTYPE));
-      if (!openmaxStandPort->pInternalBufferStorage[i]) {
-        return OMX_ErrorInsufficientResources;
+      /* the headers are taken from one array, allocated with the first buffer */
+      if (!openmaxStandPort->pHeaderSlab) {
+        openmaxStandPort->pHeaderSlab = calloc(openmaxStandPort->sPortParam.nBufferCountActual, sizeof(OMX_BUFFERHEADERTYPE));
+        if (!openmaxStandPort->pHeaderSlab) {
+          return OMX_ErrorInsufficientResources;
+        }
+        openmaxStandPort->nHeaderSlabCount = openmaxStandPort->sPortParam.nBufferCountActual;
+      }
+      if (i < openmaxStandPort->nHeaderSlabCount) {
+        openmaxStandPort->pInternalBufferStorage[i] = &openmaxStandPort->pHeaderSlab[i];
+        memset(openmaxStandPort->pInternalBufferStorage[i], 0, sizeof(OMX_BUFFERHEADERTYPE));
+        openmaxStandPort->bBufferStateAllocated[i] = HEADER_POOLED;
+      } else {
+        openmaxStandPort->pInternalBufferStorage[i] = calloc(1,sizeof(OMX_BUFFERHEADERTYPE));
+        if (!openmaxStandPort->pInternalBufferStorage[i]) {
+          return OMX_ErrorInsufficientResources;
+        }
+        openmaxStandPort->bBufferStateAllocated[i] = HEADER_ALLOCATED;
       }
       setHeader(openmaxStandPort->pInternalBufferStorage[i], sizeof(OMX_BUFFERHEADERTYPE));
       /* allocate the buffer */
-      openmaxStandPort->pInternalBufferStorage[i]->pBuffer = calloc(1,nSizeBytes);
+      openmaxStandPort->pInternalBufferStorage[i]->pBuffer = base_port_AllocatePayload(openmaxStandPort, nSizeBytes);
       if(openmaxStandPort->pInternalBufferStorage[i]->pBuffer==NULL) {
+        if (openmaxStandPort->bBufferStateAllocated[i] & HEADER_ALLOCATED) {
+          free(openmaxStandPort->pInternalBufferStorage[i]);
+        }
+        openmaxStandPort->pInternalBufferStorage[i] = NULL;
+        openmaxStandPort->bBufferStateAllocated[i] = BUFFER_FREE;
         return OMX_ErrorInsufficientResources;
       }
       openmaxStandPort->pInternalBufferStorage[i]->nAllocLen = nSizeBytes;
       openmaxStandPort->pInternalBufferStorage[i]->pPlatformPrivate = openmaxStandPort;
       openmaxStandPort->pInternalBufferStorage[i]->pAppPrivate = pAppPrivate;
       *pBuffer = openmaxStandPort->pInternalBufferStorage[i];
-      openmaxStandPort->bBufferStateAllocated[i] = BUFFER_ALLOCATED;
-      openmaxStandPort->bBufferStateAllocated[i] |= HEADER_ALLOCATED;
+      openmaxStandPort->bBufferStateAllocated[i] |= BUFFER_ALLOCATED;
       if (openmaxStandPort->sPortParam.eDir == OMX_DirInput) {
         openmaxStandPort->pInternalBufferStorage[i]->nInputPortIndex = openmaxStandPort->sPortParam.nPortIndex;
       } else {
@@ -581,7 +638,7 @@ OMX_ERRORTYPE base_port_FreeBuffer(
       if (openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ALLOCATED) {
         if(openmaxStandPort->pInternalBufferStorage[i]->pBuffer){
           DEBUG(DEB_LEV_PARAMS, "In %s freeing %i pBuffer=%p\n",__func__, (int)i, openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
-          free(openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
+          omx_base_buffer_pool_Free(openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
           openmaxStandPort->pInternalBufferStorage[i]->pBuffer=NULL;
         }
       } else if (openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ASSIGNED) {
@@ -590,6 +647,8 @@ OMX_ERRORTYPE base_port_FreeBuffer(
       if(openmaxStandPort->bBufferStateAllocated[i] & HEADER_ALLOCATED) {
         free(openmaxStandPort->pInternalBufferStorage[i]);
         openmaxStandPort->pInternalBufferStorage[i]=NULL;
+      } else if(openmaxStandPort->bBufferStateAllocated[i] & HEADER_POOLED) {
+        openmaxStandPort->pInternalBufferStorage[i]=NULL;
       }
 
       openmaxStandPort->bBufferStateAllocated[i] = BUFFER_FREE;
@@ -598,6 +657,11 @@ OMX_ERRORTYPE base_port_FreeBuffer(
       DEBUG(DEB_LEV_PARAMS, "openmaxStandPort->nNumAssignedBuffers %i\n", (int)openmaxStandPort->nNumAssignedBuffers);
 
       if (openmaxStandPort->nNumAssignedBuffers == 0) {
+        if(openmaxStandPort->pHeaderSlab) {
+          free(openmaxStandPort->pHeaderSlab);
+          openmaxStandPort->pHeaderSlab=NULL;
+          openmaxStandPort->nHeaderSlabCount=0;
+        }
         openmaxStandPort->sPortParam.bPopulated = OMX_FALSE;
         openmaxStandPort->bIsEmptyOfBuffers = OMX_TRUE;
         tsem_up(openmaxStandPort->pAllocSem);
@@ -668,6 +732,10 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
 		  return OMX_ErrorPortsNotCompatible;
 	  }
   }
+  if(queue_resize(openmaxStandPort->pBufferQueue, openmaxStandPort->sPortParam.nBufferCountActual) != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot resize the buffer queue\n",__func__);
+    return OMX_ErrorInsufficientResources;
+  }
   if (openmaxStandPort->sPortParam.nBufferCountActual == 0) {
       openmaxStandPort->sPortParam.bPopulated = OMX_TRUE;
       openmaxStandPort->bIsFullOfBuffers = OMX_TRUE;
@@ -676,7 +744,7 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
   }
   for(i=0; i < openmaxStandPort->sPortParam.nBufferCountActual; i++){
     if (openmaxStandPort->bBufferStateAllocated[i] == BUFFER_FREE) {
-      pBuffer = calloc(1,nBufferSize);
+      pBuffer = base_port_AllocatePayload(openmaxStandPort, nBufferSize);
       if(pBuffer==NULL) {
         return OMX_ErrorInsufficientResources;
       }
@@ -694,7 +762,7 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
             numRetry++;
             continue;
           }
-          free(pBuffer);
+          omx_base_buffer_pool_Free(pBuffer);
           pBuffer = NULL;
           return eError;
         }
@@ -710,7 +778,7 @@ OMX_ERRORTYPE base_port_AllocateTunnelBuffer(
         }
       }
       if(eError!=OMX_ErrorNone) {
-        free(pBuffer);
+        omx_base_buffer_pool_Free(pBuffer);
         pBuffer = NULL;
         DEBUG(DEB_LEV_ERR,"In %s Tunneled Component Couldn't Use Buffer err = %x \n",__func__,(int)eError);
         return eError;
@@ -774,7 +842,7 @@ OMX_ERRORTYPE base_port_FreeTunnelBuffer(omx_base_PortType *openmaxStandPort,OMX
 
       openmaxStandPort->bIsFullOfBuffers = OMX_FALSE;
       if (openmaxStandPort->bBufferStateAllocated[i] & BUFFER_ALLOCATED) {
-        free(openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
+        omx_base_buffer_pool_Free(openmaxStandPort->pInternalBufferStorage[i]->pBuffer);
         openmaxStandPort->pInternalBufferStorage[i]->pBuffer = NULL;
       }
       /*Retry more than once, if the tunneled component is not in Idle->Loaded State*/
@@ -888,9 +956,11 @@ OMX_ERRORTYPE base_port_SendBufferFunction(
     	   */
     	  return OMX_ErrorInsufficientResources;
       }
+      base_port_StatBufferReceived(openmaxStandPort);
+      OMX_TRACE(OMX_TraceBufferEnqueue, omxComponent, portIndex, (OMX_U64)(unsigned long)pBuffer);
       tsem_up(openmaxStandPort->pBufferSem);
       DEBUG(DEB_LEV_PARAMS, "In %s Signalling bMgmtSem Port Index=%d\n",__func__, (int)portIndex);
-      tsem_up(omx_base_component_Private->bMgmtSem);
+      omx_base_component_SignalPortBuffer(openmaxStandPort);
   }else if(PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)){
     DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s received io:%d buffer\n",
         __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
@@ -912,6 +982,92 @@ OMX_ERRORTYPE base_port_SendBufferFunction(
   return OMX_ErrorNone;
 }
 
+/** Sends the buffers one at a time, when they cannot be queued together
+ */
+static OMX_ERRORTYPE base_port_SendBufferEach(
+  omx_base_PortType *openmaxStandPort,
+  OMX_BUFFERHEADERTYPE** ppBuffers,
+  OMX_U32 nBuffers,
+  OMX_U32* pnBuffersSent) {
+  OMX_ERRORTYPE err;
+  OMX_U32 i;
+
+  for (i = 0; i < nBuffers; i++) {
+    err = openmaxStandPort->Port_SendBufferFunction(openmaxStandPort, ppBuffers[i]);
+    if (err != OMX_ErrorNone) {
+      return err;
+    }
+    (*pnBuffersSent)++;
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE base_port_SendBufferBatchFunction(
+  omx_base_PortType *openmaxStandPort,
+  OMX_BUFFERHEADERTYPE** ppBuffers,
+  OMX_U32 nBuffers,
+  OMX_U32* pnBuffersSent) {
+
+  OMX_ERRORTYPE err;
+  OMX_U32 i, portIndex;
+  OMX_COMPONENTTYPE* omxComponent = openmaxStandPort->standCompContainer;
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for port %p with %i buffers\n", __func__, openmaxStandPort, (int)nBuffers);
+  *pnBuffersSent = 0;
+  if (openmaxStandPort->Port_SendBufferFunction != &base_port_SendBufferFunction) {
+    return base_port_SendBufferEach(openmaxStandPort, ppBuffers, nBuffers, pnBuffersSent);
+  }
+
+  for (i = 0; i < nBuffers; i++) {
+    if (ppBuffers[i] == NULL) {
+      return OMX_ErrorBadParameter;
+    }
+    if ((err = checkHeader(ppBuffers[i], sizeof(OMX_BUFFERHEADERTYPE))) != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "In %s: received wrong buffer header %i\n", __func__, (int)i);
+      return err;
+    }
+    portIndex = (openmaxStandPort->sPortParam.eDir == OMX_DirInput)?ppBuffers[i]->nInputPortIndex:ppBuffers[i]->nOutputPortIndex;
+    if (portIndex != openmaxStandPort->sPortParam.nPortIndex) {
+      DEBUG(DEB_LEV_ERR, "In %s: wrong port for this operation portIndex=%d port->portIndex=%d\n", __func__, (int)portIndex, (int)openmaxStandPort->sPortParam.nPortIndex);
+      return OMX_ErrorBadPortIndex;
+    }
+  }
+
+  if(omx_base_component_Private->state == OMX_StateInvalid) {
+    DEBUG(DEB_LEV_ERR, "In %s: we are in OMX_StateInvalid\n", __func__);
+    return OMX_ErrorInvalidState;
+  }
+  if(omx_base_component_Private->state != OMX_StateExecuting &&
+    omx_base_component_Private->state != OMX_StatePause &&
+    omx_base_component_Private->state != OMX_StateIdle) {
+    DEBUG(DEB_LEV_ERR, "In %s: we are not in executing/paused/idle state, but in %d\n", __func__, omx_base_component_Private->state);
+    return OMX_ErrorIncorrectStateOperation;
+  }
+  if (!PORT_IS_ENABLED(openmaxStandPort) || PORT_IS_BEING_DISABLED(openmaxStandPort) || PORT_IS_BEING_FLUSHED(openmaxStandPort) ||
+      ((omx_base_component_Private->transientState == OMX_TransStateExecutingToIdle ||
+        omx_base_component_Private->transientState == OMX_TransStatePauseToIdle) &&
+      (PORT_IS_TUNNELED(openmaxStandPort) && !PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)))) {
+    /* the single buffer path knows how to deal with these cases */
+    return base_port_SendBufferEach(openmaxStandPort, ppBuffers, nBuffers, pnBuffersSent);
+  }
+
+  if (queue_n(openmaxStandPort->pBufferQueue, (void**)ppBuffers, (int)nBuffers)) {
+    DEBUG(DEB_LEV_ERR, "In %s: no room for %i buffers in the queue of port %i\n", __func__, (int)nBuffers, (int)openmaxStandPort->sPortParam.nPortIndex);
+    return OMX_ErrorInsufficientResources;
+  }
+  for (i = 0; i < nBuffers; i++) {
+    base_port_StatBufferReceived(openmaxStandPort);
+    OMX_TRACE(OMX_TraceBufferEnqueue, omxComponent, openmaxStandPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)ppBuffers[i]);
+  }
+  tsem_up_n(openmaxStandPort->pBufferSem, nBuffers);
+  omx_base_component_SignalPortBuffer(openmaxStandPort);
+  *pnBuffersSent = nBuffers;
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for port %p\n", __func__, openmaxStandPort);
+  return OMX_ErrorNone;
+}
+
 /**
  * Returns Input/Output Buffer to the IL client or Tunneled Component
  */
@@ -923,6 +1079,8 @@ OMX_ERRORTYPE base_port_ReturnBufferFunction(omx_base_PortType* openmaxStandPort
   int errQue;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for port %p\n", __func__, openmaxStandPort);
+  base_port_StatBufferReturned(openmaxStandPort);
+  OMX_TRACE(OMX_TraceBufferReturn, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pBuffer);
   if (PORT_IS_TUNNELED(openmaxStandPort) &&
     ! PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)) {
     if (openmaxStandPort->sPortParam.eDir == OMX_DirInput) {
@@ -1169,3 +1327,37 @@ OMX_ERRORTYPE base_port_ComponentTunnelRequest(omx_base_PortType* openmaxStandPo
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for port %p\n", __func__, openmaxStandPort);
   return OMX_ErrorNone;
 }
+
+OSCL_EXPORT_REF void base_port_StatBufferReceived(omx_base_PortType *openmaxStandPort) {
+  OMX_U32 nDepth = openmaxStandPort->pBufferQueue->nelem;
+  OMX_U32 nMax;
+
+  __sync_fetch_and_add(&openmaxStandPort->nStatBuffersReceived, 1);
+  while ((nMax = openmaxStandPort->nStatMaxQueueDepth) < nDepth) {
+    if (__sync_bool_compare_and_swap(&openmaxStandPort->nStatMaxQueueDepth, nMax, nDepth)) {
+      break;
+    }
+  }
+}
+
+OSCL_EXPORT_REF void base_port_StatBufferReturned(omx_base_PortType *openmaxStandPort) {
+  __sync_fetch_and_add(&openmaxStandPort->nStatBuffersReturned, 1);
+}
+
+OSCL_EXPORT_REF OMX_U64 base_port_StatTime(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (OMX_U64)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+OSCL_EXPORT_REF void base_port_StatCallbackTime(omx_base_PortType *openmaxStandPort, OMX_U64 nTime) {
+  OMX_U64 nMax;
+
+  __sync_fetch_and_add(&openmaxStandPort->nStatCallbackTime, nTime);
+  while ((nMax = openmaxStandPort->nStatCallbackTimeMax) < nTime) {
+    if (__sync_bool_compare_and_swap(&openmaxStandPort->nStatCallbackTimeMax, nMax, nTime)) {
+      break;
+    }
+  }
+}
@@ -26,6 +26,7 @@
 #include "tsemaphore.h"
 #include "queue.h"
 #include "omx_classmagic.h"
+#include "omx_base_buffer_pool.h"
 
 #ifndef __OMX_BASE_PORT_H__
 #define __OMX_BASE_PORT_H__
@@ -75,8 +76,10 @@ typedef enum BUFFER_STATUS_FLAG {
                  by the given port of the component */
   BUFFER_ASSIGNED = 0x0002, /**< This flag is applied to a buffer when it is assigned
                 from another port or by the IL client */
-  HEADER_ALLOCATED = 0x0004 /**< This flag is applied to a buffer when buffer header is allocated
+  HEADER_ALLOCATED = 0x0004, /**< This flag is applied to a buffer when buffer header is allocated
                 by the given port of the component */
+  HEADER_POOLED = 0x0008 /**< This flag is applied to a buffer when buffer header is taken from
+                the array of headers of the port, that is freed with the last buffer */
   } BUFFER_STATUS_FLAG;
 
 /** @brief the status of a port related to the tunneling with another component
@@ -125,11 +128,22 @@ CLASS(omx_base_PortType)
   OMX_BOOL bIsTransientToDisabled;/**< It indicates that the port is going from enabled to disabled */ \
   OMX_BOOL bIsFullOfBuffers; /**< It indicates if the port has all the buffers needed */ \
   OMX_BOOL bIsEmptyOfBuffers;/**< It indicates if the port has no buffers*/ \
+  volatile OMX_BOOL bIsWaitedFor; /**< It indicates that the buffer management thread is waiting for a buffer on this port */ \
+  volatile OMX_U32 nStatBuffersReceived; /**< Number of buffers received by the port, through EmptyThisBuffer or FillThisBuffer */ \
+  volatile OMX_U32 nStatBuffersReturned; /**< Number of buffers returned by the port to the IL client or to the tunneled component */ \
+  volatile OMX_U32 nStatMaxQueueDepth; /**< Highest number of buffers waiting in the port queue */ \
+  volatile OMX_U64 nStatCallbackTime; /**< Total time spent in BufferMgmtCallback on the buffers of the port, in nanoseconds */ \
+  volatile OMX_U64 nStatCallbackTimeMax; /**< Longest BufferMgmtCallback on a buffer of the port, in nanoseconds */ \
+  omx_base_buffer_pool* pBufferPool; /**< The slab the payloads allocated by the port are taken from */ \
+  OMX_U32 nBufferPoolFlags; /**< One or more BUFFER_POOL_FLAG, applied when a slab is allocated. BUFFER_POOL_ZERO is set by default */ \
+  OMX_BUFFERHEADERTYPE* pHeaderSlab; /**< The contiguous headers of the buffers allocated by the port */ \
+  OMX_U32 nHeaderSlabCount; /**< Number of headers in pHeaderSlab */ \
   OMX_ERRORTYPE (*PortConstructor)(OMX_COMPONENTTYPE *openmaxStandComp,omx_base_PortType **openmaxStandPort,OMX_U32 nPortIndex, OMX_BOOL isInput); /**< The contructor of the port. It fills all the other function pointers */ \
   OMX_ERRORTYPE (*PortDestructor)(omx_base_PortType *openmaxStandPort); /**< The destructor of the port*/ \
   OMX_ERRORTYPE (*Port_DisablePort)(omx_base_PortType *openmaxStandPort); /**< Disables the port */ \
   OMX_ERRORTYPE (*Port_EnablePort)(omx_base_PortType *openmaxStandPort); /**< Enables the port */ \
   OMX_ERRORTYPE (*Port_SendBufferFunction)(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer);  /**< Holds the EmptyThisBuffer of FillThisBuffer function, if the port is input or output */ \
+  OMX_ERRORTYPE (*Port_SendBufferBatchFunction)(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** ppBuffers, OMX_U32 nBuffers, OMX_U32* pnBuffersSent);  /**< Sends several buffers to the port at once */ \
   OMX_ERRORTYPE (*Port_AllocateBuffer)(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE** pBuffer, OMX_U32 nPortIndex, OMX_PTR pAppPrivate, OMX_U32 nSizeBytes);/**< Replaces the AllocateBuffer call for the base port. */   \
   OMX_ERRORTYPE (*Port_UseBuffer)(omx_base_PortType *openmaxStandPort,OMX_BUFFERHEADERTYPE** ppBufferHdr,OMX_U32 nPortIndex,OMX_PTR pAppPrivate,OMX_U32 nSizeBytes,OMX_U8* pBuffer);/**< The standard use buffer function applied to the port class */ \
   OMX_ERRORTYPE (*Port_FreeBuffer)(omx_base_PortType *openmaxStandPort,OMX_U32 nPortIndex,OMX_BUFFERHEADERTYPE* pBuffer); /**< The standard free buffer function applied to the port class */ \
@@ -193,6 +207,27 @@ OMX_ERRORTYPE base_port_SendBufferFunction(
   omx_base_PortType *openmaxStandPort,
   OMX_BUFFERHEADERTYPE* pBuffer);
 
+/** @brief Sends several buffers to the port with a single queue update
+ *
+ * The buffers are checked all together before any of them is queued,
+ * and the buffer management is woken up once. If the port is being
+ * flushed or disabled, or if the port class has replaced
+ * Port_SendBufferFunction, the buffers are sent one by one through
+ * Port_SendBufferFunction.
+ *
+ * @param openmaxStandPort the port receiving the buffers
+ * @param ppBuffers the buffers, all directed to this port
+ * @param nBuffers the number of buffers in ppBuffers
+ * @param pnBuffersSent returns the number of buffers accepted by the port
+ *
+ * @return the error of the first buffer that has not been accepted
+ */
+OMX_ERRORTYPE base_port_SendBufferBatchFunction(
+  omx_base_PortType *openmaxStandPort,
+  OMX_BUFFERHEADERTYPE** ppBuffers,
+  OMX_U32 nBuffers,
+  OMX_U32* pnBuffersSent);
+
 /** @brief Called by the standard allocate buffer, it implements a base functionality.
  *
  * This function can be overriden if the allocation of the buffer is not a simply malloc call.
@@ -271,5 +306,27 @@ OMX_ERRORTYPE base_port_FreeTunnelBuffer(
   omx_base_PortType *openmaxStandPort,
   OMX_U32 nPortIndex);
 
+/** @brief Accounts a buffer received and queued by the port
+ *
+ * It updates the received counter and the queue high water mark.
+ * It must be called after the buffer has been queued
+ */
+OSCL_IMPORT_REF void base_port_StatBufferReceived(omx_base_PortType *openmaxStandPort);
+
+/** @brief Accounts a buffer returned by the port
+ */
+OSCL_IMPORT_REF void base_port_StatBufferReturned(omx_base_PortType *openmaxStandPort);
+
+/** @return the current time in nanoseconds on the monotonic clock,
+ * used to measure the time spent in BufferMgmtCallback
+ */
+OSCL_IMPORT_REF OMX_U64 base_port_StatTime(void);
+
+/** @brief Accounts the time spent in BufferMgmtCallback on a buffer of the port
+ *
+ * @param openmaxStandPort the port that owns the buffer
+ * @param nTime the time spent in the callback, in nanoseconds
+ */
+OSCL_IMPORT_REF void base_port_StatCallbackTime(omx_base_PortType *openmaxStandPort, OMX_U64 nTime);
 
 #endif
@@ -27,6 +27,7 @@
 
 #include <omxcore.h>
 #include <omx_base_sink.h>
+#include <omx_trace.h>
 
 OMX_ERRORTYPE omx_base_sink_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName) {
   OMX_ERRORTYPE err = OMX_ErrorNone;
@@ -50,6 +51,8 @@ OMX_ERRORTYPE omx_base_sink_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_
   omx_base_sink_Private = openmaxStandComp->pComponentPrivate;
 
   omx_base_sink_Private->BufferMgmtFunction = omx_base_sink_BufferMgmtFunction;
+  omx_base_sink_Private->BufferMgmtStep = omx_base_sink_BufferMgmtStep;
+  omx_base_sink_Private->BufferMgmtStepThread = omx_base_sink_BufferMgmtFunction;
 
   return err;
 }
@@ -59,6 +62,69 @@ OMX_ERRORTYPE omx_base_sink_Destructor(OMX_COMPONENTTYPE *openmaxStandComp)
   return omx_base_component_Destructor(openmaxStandComp);
 }
 
+/** Processes an input buffer: it signals the EOS and the mark and calls
+  * BufferMgmtCallback. It is shared by the buffer management thread and
+  * the executor step
+  */
+static void base_sink_ProcessBuffer(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer) {
+  omx_base_component_PrivateType* omx_base_component_Private  = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_sink_PrivateType*      omx_base_sink_Private       = (omx_base_sink_PrivateType*)omx_base_component_Private;
+  omx_base_PortType               *pInPort                    = (omx_base_PortType *)omx_base_sink_Private->ports[OMX_BASE_SINK_INPUTPORT_INDEX];
+  OMX_COMPONENTTYPE*              target_component;
+  OMX_U64                         nCallbackStart;
+
+  if((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) ==OMX_BUFFERFLAG_EOS) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Detected EOS flags in input buffer\n");
+
+    (*(omx_base_component_Private->callbacks->EventHandler))
+      (openmaxStandComp,
+      omx_base_component_Private->callbackData,
+      OMX_EventBufferFlag, /* The command was completed */
+      0, /* The commands was a OMX_CommandStateSet */
+      pInputBuffer->nFlags, /* The state has been changed in message->messageParam2 */
+      NULL);
+    pInputBuffer->nFlags=0;
+  }
+
+  target_component=(OMX_COMPONENTTYPE*)pInputBuffer->hMarkTargetComponent;
+  if(target_component==(OMX_COMPONENTTYPE *)openmaxStandComp) {
+    /*Clear the mark and generate an event*/
+    (*(omx_base_component_Private->callbacks->EventHandler))
+      (openmaxStandComp,
+      omx_base_component_Private->callbackData,
+      OMX_EventMark, /* The command was completed */
+      1, /* The commands was a OMX_CommandStateSet */
+      0, /* The state has been changed in message->messageParam2 */
+      pInputBuffer->pMarkData);
+  } else if(pInputBuffer->hMarkTargetComponent!=NULL){
+    /*If this is not the target component then pass the mark*/
+    DEBUG(DEB_LEV_FULL_SEQ, "Can't Pass Mark. This is a Sink!!\n");
+  }
+
+  if((omx_base_sink_Private->state == OMX_StateExecuting) || (omx_base_sink_Private->state == OMX_StateIdle)) {
+    if ((omx_base_sink_Private->BufferMgmtCallback && pInputBuffer->nFilledLen > 0)
+    		|| (pInputBuffer->nFlags)){
+      nCallbackStart = base_port_StatTime();
+      OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer);
+      (*(omx_base_sink_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer);
+      OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer);
+      base_port_StatCallbackTime(pInPort, base_port_StatTime() - nCallbackStart);
+    }
+    else {
+      /*If no buffer management call back the explicitly consume input buffer*/
+      pInputBuffer->nFilledLen = 0;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%s) TrState (%s)\n",
+      __func__, stateName(omx_base_sink_Private->state),
+      transientStateName(omx_base_component_Private->transientState));
+    if(OMX_TransStateExecutingToIdle == omx_base_component_Private->transientState ||
+       OMX_TransStatePauseToIdle == omx_base_component_Private->transientState) {
+      pInputBuffer->nFilledLen = 0;
+    }
+  }
+}
+
 /** This is the central function for component processing. It
   * is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
@@ -72,7 +138,6 @@ void* omx_base_sink_BufferMgmtFunction (void* param) {
   tsem_t*                         pInputSem                   = pInPort->pBufferSem;
   queue_t*                        pInputQueue                 = pInPort->pBufferQueue;
   OMX_BUFFERHEADERTYPE*           pInputBuffer                = NULL;
-  OMX_COMPONENTTYPE*              target_component;
   OMX_BOOL                        isInputBufferNeeded         = OMX_TRUE;
   int                             inBufExchanged              = 0;
 
@@ -107,7 +172,7 @@ void* omx_base_sink_BufferMgmtFunction (void* param) {
     if((pInputSem->semval==0 && isInputBufferNeeded==OMX_TRUE ) &&
       (omx_base_sink_Private->state != OMX_StateLoaded && omx_base_sink_Private->state != OMX_StateInvalid)) {
       DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for input buffer \n");
-      tsem_down(omx_base_sink_Private->bMgmtSem);
+      omx_base_component_WaitForPorts(openmaxStandComp, &pInPort, 1);
     }
 
     if(omx_base_sink_Private->state == OMX_StateLoaded || omx_base_sink_Private->state == OMX_StateInvalid) {
@@ -122,6 +187,7 @@ void* omx_base_sink_BufferMgmtFunction (void* param) {
         inBufExchanged++;
         isInputBufferNeeded=OMX_FALSE;
         pInputBuffer = dequeue(pInputQueue);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer);
         if(pInputBuffer == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL input buffer!!\n");
           break;
@@ -130,52 +196,8 @@ void* omx_base_sink_BufferMgmtFunction (void* param) {
     }
 
     if(isInputBufferNeeded==OMX_FALSE) {
-    	if((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) ==OMX_BUFFERFLAG_EOS) {
-        DEBUG(DEB_LEV_SIMPLE_SEQ, "Detected EOS flags in input buffer\n");
-
-        (*(omx_base_component_Private->callbacks->EventHandler))
-          (openmaxStandComp,
-          omx_base_component_Private->callbackData,
-          OMX_EventBufferFlag, /* The command was completed */
-          0, /* The commands was a OMX_CommandStateSet */
-          pInputBuffer->nFlags, /* The state has been changed in message->messageParam2 */
-          NULL);
-        pInputBuffer->nFlags=0;
-      }
-
-      target_component=(OMX_COMPONENTTYPE*)pInputBuffer->hMarkTargetComponent;
-      if(target_component==(OMX_COMPONENTTYPE *)openmaxStandComp) {
-        /*Clear the mark and generate an event*/
-        (*(omx_base_component_Private->callbacks->EventHandler))
-          (openmaxStandComp,
-          omx_base_component_Private->callbackData,
-          OMX_EventMark, /* The command was completed */
-          1, /* The commands was a OMX_CommandStateSet */
-          0, /* The state has been changed in message->messageParam2 */
-          pInputBuffer->pMarkData);
-      } else if(pInputBuffer->hMarkTargetComponent!=NULL){
-        /*If this is not the target component then pass the mark*/
-        DEBUG(DEB_LEV_FULL_SEQ, "Can't Pass Mark. This is a Sink!!\n");
-      }
+      base_sink_ProcessBuffer(openmaxStandComp, pInputBuffer);
 
-      if((omx_base_sink_Private->state == OMX_StateExecuting) || (omx_base_sink_Private->state == OMX_StateIdle)) {
-        if ((omx_base_sink_Private->BufferMgmtCallback && pInputBuffer->nFilledLen > 0)
-        		|| (pInputBuffer->nFlags)){
-          (*(omx_base_sink_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer);
-        }
-        else {
-          /*If no buffer management call back the explicitly consume input buffer*/
-          pInputBuffer->nFilledLen = 0;
-        }
-      } else {
-        DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%s) TrState (%s)\n",
-          __func__, stateName(omx_base_sink_Private->state),
-          transientStateName(omx_base_component_Private->transientState));
-        if(OMX_TransStateExecutingToIdle == omx_base_component_Private->transientState ||
-           OMX_TransStatePauseToIdle == omx_base_component_Private->transientState) {
-          pInputBuffer->nFilledLen = 0;
-        }
-      }
       /*Input Buffer has been completely consumed. So, get new input buffer*/
 
       if(omx_base_sink_Private->state==OMX_StatePause && !PORT_IS_BEING_FLUSHED(pInPort)) {
@@ -208,6 +230,7 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
   omx_base_component_PrivateType* omx_base_component_Private=(omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
   omx_base_sink_PrivateType* omx_base_sink_Private = (omx_base_sink_PrivateType*)omx_base_component_Private;
   omx_base_PortType *pInPort[2];
+  OMX_U64 nCallbackStart;
   tsem_t* pInputSem[2];
   queue_t* pInputQueue[2];
   OMX_BUFFERHEADERTYPE* pInputBuffer[2];
@@ -268,7 +291,7 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
       (omx_base_sink_Private->state != OMX_StateLoaded && omx_base_sink_Private->state != OMX_StateInvalid)) {
       //Signalled from EmptyThisBuffer or FillThisBuffer or some thing else
       DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next Input buffer 0\n");
-      tsem_down(omx_base_sink_Private->bMgmtSem);
+      omx_base_component_WaitForPorts(openmaxStandComp, &pInPort[0], 1);
 
     }
     if(omx_base_sink_Private->state == OMX_StateLoaded || omx_base_sink_Private->state == OMX_StateInvalid) {
@@ -280,7 +303,7 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
        !(PORT_IS_BEING_FLUSHED(pInPort[0]) || PORT_IS_BEING_FLUSHED(pInPort[1]))) {
       //Signalled from EmptyThisBuffer or FillThisBuffer or some thing else
       DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next Input buffer 1\n");
-      tsem_down(omx_base_sink_Private->bMgmtSem);
+      omx_base_component_WaitForPorts(openmaxStandComp, &pInPort[1], 1);
 
     }
     if(omx_base_sink_Private->state == OMX_StateLoaded || omx_base_sink_Private->state == OMX_StateInvalid) {
@@ -295,6 +318,7 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
         outBufExchanged[0]++;
         isInputBufferNeeded[0]=OMX_FALSE;
         pInputBuffer[0] = dequeue(pInputQueue[0]);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pInPort[0]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer[0]);
         if(pInputBuffer[0] == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL Input buffer!!\n");
           break;
@@ -309,6 +333,7 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
         outBufExchanged[1]++;
         isInputBufferNeeded[1]=OMX_FALSE;
         pInputBuffer[1] = dequeue(pInputQueue[1]);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pInPort[1]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer[1]);
         if(pInputBuffer[1] == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL Input buffer!! op is=%d,iq=%d\n",pInputSem[1]->semval,pInputQueue[1]->nelem);
           break;
@@ -349,7 +374,11 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
 
           if(omx_base_sink_Private->state == OMX_StateExecuting)  {
             if (omx_base_sink_Private->BufferMgmtCallback && pInputBuffer[i]->nFilledLen > 0) {
+              nCallbackStart = base_port_StatTime();
+              OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, pInPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer[i]);
               (*(omx_base_sink_Private->BufferMgmtCallback))(openmaxStandComp, pInputBuffer[i]);
+              OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, pInPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pInputBuffer[i]);
+              base_port_StatCallbackTime(pInPort[i], base_port_StatTime() - nCallbackStart);
             } else {
               /*If no buffer management call back then don't produce any Input buffer*/
               pInputBuffer[i]->nFilledLen = 0;
@@ -398,3 +427,39 @@ void* omx_base_sink_twoport_BufferMgmtFunction (void* param) {
   DEBUG(DEB_LEV_SIMPLE_SEQ,"Exiting Buffer Management Thread\n");
   return NULL;
 }
+
+/** This is the non blocking equivalent of omx_base_sink_BufferMgmtFunction,
+  * run by the shared executor. The input buffer not yet consumed is kept
+  * in pStepBuffer until the next run.
+  */
+OMX_BOOL omx_base_sink_BufferMgmtStep(OMX_COMPONENTTYPE* openmaxStandComp) {
+  omx_base_component_PrivateType* omx_base_component_Private  = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_sink_PrivateType*      omx_base_sink_Private       = (omx_base_sink_PrivateType*)omx_base_component_Private;
+  omx_base_PortType               *pInPort                    = (omx_base_PortType *)omx_base_sink_Private->ports[OMX_BASE_SINK_INPUTPORT_INDEX];
+  OMX_BUFFERHEADERTYPE**          ppInputBuffer               = &omx_base_sink_Private->pStepBuffer[0];
+
+  if(!(omx_base_component_Private->state == OMX_StateIdle || omx_base_component_Private->state == OMX_StateExecuting ||
+    omx_base_component_Private->state == OMX_StatePause || omx_base_component_Private->transientState == OMX_TransStateLoadedToIdle)) {
+    return OMX_FALSE;
+  }
+  if(omx_base_component_StepFlush(openmaxStandComp, &pInPort, ppInputBuffer, 1) == OMX_TRUE ||
+     omx_base_sink_Private->state == OMX_StatePause) {
+    return OMX_FALSE;
+  }
+
+  if(*ppInputBuffer == NULL) {
+    if(!tsem_try_down(pInPort->pBufferSem)) {
+      return OMX_FALSE;
+    }
+    *ppInputBuffer = dequeue(pInPort->pBufferQueue);
+    OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pInPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)*ppInputBuffer);
+  }
+  base_sink_ProcessBuffer(openmaxStandComp, *ppInputBuffer);
+
+  /*Input Buffer has been completely consumed. So, return input buffer*/
+  if((*ppInputBuffer)->nFilledLen == 0) {
+    pInPort->ReturnBufferFunction(pInPort, *ppInputBuffer);
+    *ppInputBuffer = NULL;
+  }
+  return OMX_TRUE;
+}
@@ -64,6 +64,14 @@ OMX_ERRORTYPE omx_base_sink_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
  */
 void* omx_base_sink_BufferMgmtFunction(void* param);
 
+/** This is the non blocking equivalent of omx_base_sink_BufferMgmtFunction.
+ * It is run by the shared executor, if enabled, instead of the buffer
+ * management thread.
+ *
+ * @return OMX_TRUE if more buffers can be processed immediately
+ */
+OMX_BOOL omx_base_sink_BufferMgmtStep(OMX_COMPONENTTYPE* openmaxStandComp);
+
 void* omx_base_sink_twoport_BufferMgmtFunction (void* param);
 
 #endif
@@ -28,6 +28,7 @@
 
 #include <omxcore.h>
 #include <omx_base_source.h>
+#include <omx_trace.h>
 
 OMX_ERRORTYPE omx_base_source_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
 
@@ -51,6 +52,8 @@ OMX_ERRORTYPE omx_base_source_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, O
   * e.g. we can override the function pointers in the private struct  */
   omx_base_source_Private = openmaxStandComp->pComponentPrivate;
   omx_base_source_Private->BufferMgmtFunction = omx_base_source_BufferMgmtFunction;
+  omx_base_source_Private->BufferMgmtStep = omx_base_source_BufferMgmtStep;
+  omx_base_source_Private->BufferMgmtStepThread = omx_base_source_BufferMgmtFunction;
 
   return err;
 }
@@ -60,6 +63,59 @@ OMX_ERRORTYPE omx_base_source_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
   return omx_base_component_Destructor(openmaxStandComp);
 }
 
+/** Fills an output buffer: it propagates the mark and calls
+  * BufferMgmtCallback. It is shared by the buffer management thread and
+  * the executor step
+  */
+static void base_source_ProcessBuffer(OMX_COMPONENTTYPE* openmaxStandComp, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_source_PrivateType* omx_base_source_Private = (omx_base_source_PrivateType*)omx_base_component_Private;
+  omx_base_PortType *pOutPort = (omx_base_PortType *)omx_base_source_Private->ports[OMX_BASE_SOURCE_OUTPUTPORT_INDEX];
+  OMX_COMPONENTTYPE* target_component;
+  OMX_U64 nCallbackStart;
+
+  if((pOutputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+    pOutputBuffer->nFlags = 0;
+  }
+
+  if(omx_base_source_Private->pMark.hMarkTargetComponent != NULL){
+    pOutputBuffer->hMarkTargetComponent = omx_base_source_Private->pMark.hMarkTargetComponent;
+    pOutputBuffer->pMarkData            = omx_base_source_Private->pMark.pMarkData;
+    omx_base_source_Private->pMark.hMarkTargetComponent = NULL;
+    omx_base_source_Private->pMark.pMarkData            = NULL;
+  }
+
+  target_component = (OMX_COMPONENTTYPE*)pOutputBuffer->hMarkTargetComponent;
+  if(target_component == (OMX_COMPONENTTYPE *)openmaxStandComp) {
+    /*Clear the mark and generate an event*/
+    (*(omx_base_component_Private->callbacks->EventHandler))
+      (openmaxStandComp,
+      omx_base_component_Private->callbackData,
+      OMX_EventMark, /* The command was completed */
+      1, /* The commands was a OMX_CommandStateSet */
+      0, /* The state has been changed in message->messageParam2 */
+      pOutputBuffer->pMarkData);
+  } else if(pOutputBuffer->hMarkTargetComponent != NULL) {
+    /*If this is not the target component then pass the mark*/
+    DEBUG(DEB_LEV_FULL_SEQ, "Pass Mark. This is a Source!!\n");
+  }
+
+  if(omx_base_source_Private->state == OMX_StateExecuting)  {
+    if (omx_base_source_Private->BufferMgmtCallback && pOutputBuffer->nFilledLen == 0) {
+      nCallbackStart = base_port_StatTime();
+      OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, pOutPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer);
+      (*(omx_base_source_Private->BufferMgmtCallback))(openmaxStandComp, pOutputBuffer);
+      OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, pOutPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer);
+      base_port_StatCallbackTime(pOutPort, base_port_StatTime() - nCallbackStart);
+    } else {
+      /*It no buffer management call back then don't produce any output buffer*/
+      pOutputBuffer->nFilledLen = 0;
+    }
+  } else {
+    DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%x)\n", __func__, (int)omx_base_source_Private->state);
+  }
+}
+
 /** This is the central function for component processing. It
   * is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
@@ -74,7 +130,6 @@ void* omx_base_source_BufferMgmtFunction (void* param) {
   tsem_t* pOutputSem = pOutPort->pBufferSem;
   queue_t* pOutputQueue = pOutPort->pBufferQueue;
   OMX_BUFFERHEADERTYPE* pOutputBuffer = NULL;
-  OMX_COMPONENTTYPE* target_component;
   OMX_BOOL isOutputBufferNeeded = OMX_TRUE;
   int outBufExchanged = 0;
 
@@ -109,7 +164,7 @@ void* omx_base_source_BufferMgmtFunction (void* param) {
     if((isOutputBufferNeeded==OMX_TRUE && pOutputSem->semval==0) &&
       (omx_base_source_Private->state != OMX_StateLoaded && omx_base_source_Private->state != OMX_StateInvalid)) {
       DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for output buffer \n");
-      tsem_down(omx_base_source_Private->bMgmtSem);
+      omx_base_component_WaitForPorts(openmaxStandComp, &pOutPort, 1);
     }
 
     if(omx_base_source_Private->state == OMX_StateLoaded || omx_base_source_Private->state == OMX_StateInvalid) {
@@ -124,6 +179,7 @@ void* omx_base_source_BufferMgmtFunction (void* param) {
         outBufExchanged++;
         isOutputBufferNeeded = OMX_FALSE;
         pOutputBuffer = dequeue(pOutputQueue);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pOutPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer);
         if(pOutputBuffer == NULL){
           DEBUG(DEB_LEV_ERR, "In %s Had NULL output buffer!!\n",__func__);
           break;
@@ -132,42 +188,7 @@ void* omx_base_source_BufferMgmtFunction (void* param) {
     }
 
     if(isOutputBufferNeeded == OMX_FALSE) {
-      if((pOutputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
-        pOutputBuffer->nFlags = 0;
-      }
-
-      if(omx_base_source_Private->pMark.hMarkTargetComponent != NULL){
-        pOutputBuffer->hMarkTargetComponent = omx_base_source_Private->pMark.hMarkTargetComponent;
-        pOutputBuffer->pMarkData            = omx_base_source_Private->pMark.pMarkData;
-        omx_base_source_Private->pMark.hMarkTargetComponent = NULL;
-        omx_base_source_Private->pMark.pMarkData            = NULL;
-      }
-
-      target_component = (OMX_COMPONENTTYPE*)pOutputBuffer->hMarkTargetComponent;
-      if(target_component == (OMX_COMPONENTTYPE *)openmaxStandComp) {
-        /*Clear the mark and generate an event*/
-        (*(omx_base_component_Private->callbacks->EventHandler))
-          (openmaxStandComp,
-          omx_base_component_Private->callbackData,
-          OMX_EventMark, /* The command was completed */
-          1, /* The commands was a OMX_CommandStateSet */
-          0, /* The state has been changed in message->messageParam2 */
-          pOutputBuffer->pMarkData);
-      } else if(pOutputBuffer->hMarkTargetComponent != NULL) {
-        /*If this is not the target component then pass the mark*/
-        DEBUG(DEB_LEV_FULL_SEQ, "Pass Mark. This is a Source!!\n");
-      }
-
-      if(omx_base_source_Private->state == OMX_StateExecuting)  {
-        if (omx_base_source_Private->BufferMgmtCallback && pOutputBuffer->nFilledLen == 0) {
-          (*(omx_base_source_Private->BufferMgmtCallback))(openmaxStandComp, pOutputBuffer);
-        } else {
-          /*It no buffer management call back then don't produce any output buffer*/
-          pOutputBuffer->nFilledLen = 0;
-        }
-      } else {
-        DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%x)\n", __func__, (int)omx_base_source_Private->state);
-      }
+      base_source_ProcessBuffer(openmaxStandComp, pOutputBuffer);
       if(omx_base_source_Private->state == OMX_StatePause && !PORT_IS_BEING_FLUSHED(pOutPort)) {
         /*Waiting at paused state*/
         tsem_wait(omx_base_source_Private->bStateSem);
@@ -213,6 +234,7 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
   omx_base_component_PrivateType* omx_base_component_Private=(omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
   omx_base_source_PrivateType* omx_base_source_Private = (omx_base_source_PrivateType*)omx_base_component_Private;
   omx_base_PortType *pOutPort[2];
+  OMX_U64 nCallbackStart;
   tsem_t* pOutputSem[2];
   queue_t* pOutputQueue[2];
   OMX_BUFFERHEADERTYPE* pOutputBuffer[2];
@@ -273,7 +295,7 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
       (omx_base_source_Private->state != OMX_StateLoaded && omx_base_source_Private->state != OMX_StateInvalid)) {
       //Signalled from EmptyThisBuffer or FillThisBuffer or some thing else
       DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next output buffer 0\n");
-      tsem_down(omx_base_source_Private->bMgmtSem);
+      omx_base_component_WaitForPorts(openmaxStandComp, &pOutPort[0], 1);
 
     }
     if(omx_base_source_Private->state == OMX_StateLoaded || omx_base_source_Private->state == OMX_StateInvalid) {
@@ -285,7 +307,7 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
        !(PORT_IS_BEING_FLUSHED(pOutPort[0]) || PORT_IS_BEING_FLUSHED(pOutPort[1]))) {
       //Signalled from EmptyThisBuffer or FillThisBuffer or some thing else
       DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next output buffer 1\n");
-      tsem_down(omx_base_source_Private->bMgmtSem);
+      omx_base_component_WaitForPorts(openmaxStandComp, &pOutPort[1], 1);
 
     }
     if(omx_base_source_Private->state == OMX_StateLoaded || omx_base_source_Private->state == OMX_StateInvalid) {
@@ -300,6 +322,7 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
         outBufExchanged[0]++;
         isOutputBufferNeeded[0]=OMX_FALSE;
         pOutputBuffer[0] = dequeue(pOutputQueue[0]);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pOutPort[0]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer[0]);
         if(pOutputBuffer[0] == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL output buffer!!\n");
           break;
@@ -313,6 +336,7 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
         outBufExchanged[1]++;
         isOutputBufferNeeded[1]=OMX_FALSE;
         pOutputBuffer[1] = dequeue(pOutputQueue[1]);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pOutPort[1]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer[1]);
         if(pOutputBuffer[1] == NULL){
           DEBUG(DEB_LEV_ERR, "Had NULL output buffer!! op is=%d,iq=%d\n",pOutputSem[1]->semval,pOutputQueue[1]->nelem);
           break;
@@ -352,7 +376,11 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
 
           if(omx_base_source_Private->state == OMX_StateExecuting)  {
             if (omx_base_source_Private->BufferMgmtCallback && pOutputBuffer[i]->nFilledLen == 0) {
+              nCallbackStart = base_port_StatTime();
+              OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, pOutPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer[i]);
               (*(omx_base_source_Private->BufferMgmtCallback))(openmaxStandComp, pOutputBuffer[i]);
+              OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, pOutPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer[i]);
+              base_port_StatCallbackTime(pOutPort[i], base_port_StatTime() - nCallbackStart);
             } else {
               /*If no buffer management call back then don't produce any output buffer*/
               pOutputBuffer[i]->nFilledLen = 0;
@@ -396,3 +424,53 @@ void* omx_base_source_twoport_BufferMgmtFunction (void* param) {
   DEBUG(DEB_LEV_SIMPLE_SEQ,"Exiting Buffer Management Thread\n");
   return NULL;
 }
+
+/** This is the non blocking equivalent of omx_base_source_BufferMgmtFunction,
+  * run by the shared executor. The output buffer not yet filled is kept
+  * in pStepBuffer until the next run.
+  */
+OMX_BOOL omx_base_source_BufferMgmtStep(OMX_COMPONENTTYPE* openmaxStandComp) {
+  omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
+  omx_base_source_PrivateType* omx_base_source_Private = (omx_base_source_PrivateType*)omx_base_component_Private;
+  omx_base_PortType *pOutPort = (omx_base_PortType *)omx_base_source_Private->ports[OMX_BASE_SOURCE_OUTPUTPORT_INDEX];
+  OMX_BUFFERHEADERTYPE** ppOutputBuffer = &omx_base_source_Private->pStepBuffer[0];
+
+  if(!(omx_base_component_Private->state == OMX_StateIdle || omx_base_component_Private->state == OMX_StateExecuting ||
+    omx_base_component_Private->state == OMX_StatePause || omx_base_component_Private->transientState == OMX_TransStateLoadedToIdle)) {
+    return OMX_FALSE;
+  }
+  if(omx_base_component_StepFlush(openmaxStandComp, &pOutPort, ppOutputBuffer, 1) == OMX_TRUE ||
+     omx_base_source_Private->state == OMX_StatePause) {
+    return OMX_FALSE;
+  }
+
+  if(*ppOutputBuffer == NULL) {
+    if(!tsem_try_down(pOutPort->pBufferSem)) {
+      return OMX_FALSE;
+    }
+    *ppOutputBuffer = dequeue(pOutPort->pBufferQueue);
+    OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pOutPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)*ppOutputBuffer);
+  }
+  base_source_ProcessBuffer(openmaxStandComp, *ppOutputBuffer);
+
+  if(((*ppOutputBuffer)->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Detected EOS flags in output buffer\n");
+
+    (*(omx_base_component_Private->callbacks->EventHandler))
+      (openmaxStandComp,
+      omx_base_component_Private->callbackData,
+      OMX_EventBufferFlag, /* The command was completed */
+      0, /* The commands was a OMX_CommandStateSet */
+      (*ppOutputBuffer)->nFlags, /* The state has been changed in message->messageParam2 */
+      NULL);
+    omx_base_source_Private->bIsEOSReached = OMX_TRUE;
+  }
+
+  /*Output Buffer has been produced or EOS. So, return output buffer and get new buffer*/
+  if(((*ppOutputBuffer)->nFilledLen != 0) || (((*ppOutputBuffer)->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) || (omx_base_source_Private->bIsEOSReached == OMX_TRUE)) {
+    pOutPort->ReturnBufferFunction(pOutPort, *ppOutputBuffer);
+    *ppOutputBuffer = NULL;
+  }
+  /* a source is never idle while it holds a buffer in Executing */
+  return (*ppOutputBuffer == NULL || omx_base_source_Private->state == OMX_StateExecuting) ? OMX_TRUE : OMX_FALSE;
+}
@@ -68,6 +68,14 @@ OMX_ERRORTYPE omx_base_source_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
  */
 void* omx_base_source_BufferMgmtFunction(void* param);
 
+/** This is the non blocking equivalent of omx_base_source_BufferMgmtFunction.
+ * It is run by the shared executor, if enabled, instead of the buffer
+ * management thread.
+ *
+ * @return OMX_TRUE if more buffers can be processed immediately
+ */
+OMX_BOOL omx_base_source_BufferMgmtStep(OMX_COMPONENTTYPE* openmaxStandComp);
+
 /** This is the central function for buffer processing of a two port source component.
   * It is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
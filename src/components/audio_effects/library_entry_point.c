@@ -31,6 +31,10 @@
 #include <st_static_component_loader.h>
 #include <omx_volume_component.h>
 #include <omx_audiomixer_component.h>
+#include <omx_resampler_component.h>
+#include <omx_converter_component.h>
+#include <omx_meter_component.h>
+#include <omx_equalizer_component.h>
 
 /** @brief The library entry point. It must have the same name for each
   * library of the components loaded by the ST static component loader.
@@ -51,7 +55,7 @@ int omx_component_library_Setup(stLoaderComponentType **stComponents) {
 
   if (stComponents == NULL) {
     DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s \n",__func__);
-    return 2; // Return Number of Components - one for audio volume component
+    return 6; // Return Number of Components - volume, mixer, resampler, converter, meter and equalizer
   }
 
   /** component 1 - volume component */
@@ -136,6 +140,170 @@ int omx_component_library_Setup(stLoaderComponentType **stComponents) {
 	  stComponents[1]->multiResourceLevel[i]->MemoryResourceRequested = mixerQualityLevels[i * 2 + 1];
   }
 
+  /** component 3 - audio resampler component */
+  stComponents[2]->componentVersion.s.nVersionMajor = 1;
+  stComponents[2]->componentVersion.s.nVersionMinor = 1;
+  stComponents[2]->componentVersion.s.nRevision = 1;
+  stComponents[2]->componentVersion.s.nStep = 1;
+
+  stComponents[2]->name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (stComponents[2]->name == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strcpy(stComponents[2]->name, RESAMPLER_COMP_NAME);
+  stComponents[2]->name_specific_length = 1;
+  stComponents[2]->constructor = omx_resampler_component_Constructor;
+
+  stComponents[2]->name_specific = calloc(stComponents[2]->name_specific_length,sizeof(char *));
+  stComponents[2]->role_specific = calloc(stComponents[2]->name_specific_length,sizeof(char *));
+
+  for(i=0;i<stComponents[2]->name_specific_length;i++) {
+    stComponents[2]->name_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[2]->name_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  for(i=0;i<stComponents[2]->name_specific_length;i++) {
+    stComponents[2]->role_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[2]->role_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+
+  strcpy(stComponents[2]->name_specific[0], RESAMPLER_COMP_NAME);
+  strcpy(stComponents[2]->role_specific[0], RESAMPLER_COMP_ROLE);
+
+  stComponents[2]->nqualitylevels = RESAMPLER_QUALITY_LEVELS;
+  stComponents[2]->multiResourceLevel = malloc(stComponents[2]->nqualitylevels * sizeof(multiResourceDescriptor *));
+  for (i=0; i<stComponents[2]->nqualitylevels; i++) {
+	  stComponents[2]->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  stComponents[2]->multiResourceLevel[i]->CPUResourceRequested = resamplerQualityLevels[i * 2];
+	  stComponents[2]->multiResourceLevel[i]->MemoryResourceRequested = resamplerQualityLevels[i * 2 + 1];
+  }
+
+  /** component 4 - audio converter component */
+  stComponents[3]->componentVersion.s.nVersionMajor = 1;
+  stComponents[3]->componentVersion.s.nVersionMinor = 1;
+  stComponents[3]->componentVersion.s.nRevision = 1;
+  stComponents[3]->componentVersion.s.nStep = 1;
+
+  stComponents[3]->name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (stComponents[3]->name == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strcpy(stComponents[3]->name, CONVERTER_COMP_NAME);
+  stComponents[3]->name_specific_length = 1;
+  stComponents[3]->constructor = omx_converter_component_Constructor;
+
+  stComponents[3]->name_specific = calloc(stComponents[3]->name_specific_length,sizeof(char *));
+  stComponents[3]->role_specific = calloc(stComponents[3]->name_specific_length,sizeof(char *));
+
+  for(i=0;i<stComponents[3]->name_specific_length;i++) {
+    stComponents[3]->name_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[3]->name_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  for(i=0;i<stComponents[3]->name_specific_length;i++) {
+    stComponents[3]->role_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[3]->role_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+
+  strcpy(stComponents[3]->name_specific[0], CONVERTER_COMP_NAME);
+  strcpy(stComponents[3]->role_specific[0], CONVERTER_COMP_ROLE);
+
+  stComponents[3]->nqualitylevels = CONVERTER_QUALITY_LEVELS;
+  stComponents[3]->multiResourceLevel = malloc(stComponents[3]->nqualitylevels * sizeof(multiResourceDescriptor *));
+  for (i=0; i<stComponents[3]->nqualitylevels; i++) {
+	  stComponents[3]->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  stComponents[3]->multiResourceLevel[i]->CPUResourceRequested = converterQualityLevels[i * 2];
+	  stComponents[3]->multiResourceLevel[i]->MemoryResourceRequested = converterQualityLevels[i * 2 + 1];
+  }
+
+  /** component 5 - audio meter component */
+  stComponents[4]->componentVersion.s.nVersionMajor = 1;
+  stComponents[4]->componentVersion.s.nVersionMinor = 1;
+  stComponents[4]->componentVersion.s.nRevision = 1;
+  stComponents[4]->componentVersion.s.nStep = 1;
+
+  stComponents[4]->name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (stComponents[4]->name == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strcpy(stComponents[4]->name, METER_COMP_NAME);
+  stComponents[4]->name_specific_length = 1;
+  stComponents[4]->constructor = omx_meter_component_Constructor;
+
+  stComponents[4]->name_specific = calloc(stComponents[4]->name_specific_length,sizeof(char *));
+  stComponents[4]->role_specific = calloc(stComponents[4]->name_specific_length,sizeof(char *));
+
+  for(i=0;i<stComponents[4]->name_specific_length;i++) {
+    stComponents[4]->name_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[4]->name_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  for(i=0;i<stComponents[4]->name_specific_length;i++) {
+    stComponents[4]->role_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[4]->role_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+
+  strcpy(stComponents[4]->name_specific[0], METER_COMP_NAME);
+  strcpy(stComponents[4]->role_specific[0], METER_COMP_ROLE);
+
+  stComponents[4]->nqualitylevels = METER_QUALITY_LEVELS;
+  stComponents[4]->multiResourceLevel = malloc(stComponents[4]->nqualitylevels * sizeof(multiResourceDescriptor *));
+  for (i=0; i<stComponents[4]->nqualitylevels; i++) {
+	  stComponents[4]->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  stComponents[4]->multiResourceLevel[i]->CPUResourceRequested = meterQualityLevels[i * 2];
+	  stComponents[4]->multiResourceLevel[i]->MemoryResourceRequested = meterQualityLevels[i * 2 + 1];
+  }
+
+  /** component 6 - audio equalizer component */
+  stComponents[5]->componentVersion.s.nVersionMajor = 1;
+  stComponents[5]->componentVersion.s.nVersionMinor = 1;
+  stComponents[5]->componentVersion.s.nRevision = 1;
+  stComponents[5]->componentVersion.s.nStep = 1;
+
+  stComponents[5]->name = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+  if (stComponents[5]->name == NULL) {
+    return OMX_ErrorInsufficientResources;
+  }
+  strcpy(stComponents[5]->name, EQUALIZER_COMP_NAME);
+  stComponents[5]->name_specific_length = 1;
+  stComponents[5]->constructor = omx_equalizer_component_Constructor;
+
+  stComponents[5]->name_specific = calloc(stComponents[5]->name_specific_length,sizeof(char *));
+  stComponents[5]->role_specific = calloc(stComponents[5]->name_specific_length,sizeof(char *));
+
+  for(i=0;i<stComponents[5]->name_specific_length;i++) {
+    stComponents[5]->name_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[5]->name_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  for(i=0;i<stComponents[5]->name_specific_length;i++) {
+    stComponents[5]->role_specific[i] = calloc(1, OMX_MAX_STRINGNAME_SIZE);
+    if (stComponents[5]->role_specific[i] == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+
+  strcpy(stComponents[5]->name_specific[0], EQUALIZER_COMP_NAME);
+  strcpy(stComponents[5]->role_specific[0], EQUALIZER_COMP_ROLE);
+
+  stComponents[5]->nqualitylevels = EQUALIZER_QUALITY_LEVELS;
+  stComponents[5]->multiResourceLevel = malloc(stComponents[5]->nqualitylevels * sizeof(multiResourceDescriptor *));
+  for (i=0; i<stComponents[5]->nqualitylevels; i++) {
+	  stComponents[5]->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  stComponents[5]->multiResourceLevel[i]->CPUResourceRequested = equalizerQualityLevels[i * 2];
+	  stComponents[5]->multiResourceLevel[i]->MemoryResourceRequested = equalizerQualityLevels[i * 2 + 1];
+  }
+
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s \n",__func__);
-  return 2;
+  return 6;
 }
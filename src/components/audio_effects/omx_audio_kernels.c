@@ -0,0 +1,1450 @@
+/**
+  src/components/audio_effects/omx_audio_kernels.c
+
+  Sample processing kernels shared by the audio effect components.
+  The gains are in Q15, and the integer products are rounded to the
+  nearest value before being saturated to the range of the format.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <omxcore.h>
+#include <extension_struct.h>
+#include "omx_audio_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AUDIO_KERNELS_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* NEON is selected at build time: it is always present on aarch64 */
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AUDIO_KERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+#define Q15_ROUND 0x4000
+
+/** Number of samples mixed at a time. The accumulators of a block stay in the first level cache */
+#define MIX_BLOCK AUDIO_MIX_BLOCK
+
+/** Number of samples of all the channels measured at a time */
+#define LEVELS_BLOCK 1024
+
+/** The states of the biquad sections smaller than this are flushed to 0,
+ * far below the resolution of the formats */
+#define BIQUAD_QUIET 1e-15f
+
+typedef void (*volume_kernel)(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain);
+typedef void (*to_float_kernel)(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples);
+typedef void (*from_float_kernel)(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples);
+
+/** A set of kernels for one instruction set */
+typedef struct audio_kernels {
+  const char* name;
+  volume_kernel volume[AUDIO_SAMPLE_FORMATS];
+  void (*mix_s16)(int32_t* pAcc, const OMX_S16* pSrc, OMX_U32 nSamples, OMX_S32 nGain); /**< adds the scaled samples to the accumulators */
+  void (*store_s16)(OMX_S16* pDst, const int32_t* pAcc, OMX_U32 nSamples); /**< rounds and saturates the accumulators */
+  void (*mix_float)(float* pAcc, const float* pSrc, OMX_U32 nSamples, float fGain);
+  void (*store_float)(float* pDst, const float* pAcc, OMX_U32 nSamples);
+  float (*dot_float)(const float* pX, const float* pH, OMX_U32 nSamples); /**< returns the sum of the products */
+  void (*levels_float)(const float* pSrc, OMX_U32 nChannels, OMX_U32 nFrames, float fClip,
+                       float* pPeak, float* pSquares, OMX_U32* pClips); /**< accumulates the levels of each channel of interleaved samples */
+  void (*biquad_float)(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                       OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState); /**< filters one channel through the cascade */
+  to_float_kernel to_float[AUDIO_SAMPLE_FORMATS]; /**< the vector versions convert contiguous samples, and leave the strided ones to the scalar versions */
+  from_float_kernel from_float[AUDIO_SAMPLE_FORMATS];
+} audio_kernels;
+
+static inline OMX_S32 saturate(OMX_S64 nValue, OMX_S32 nMin, OMX_S32 nMax) {
+  return nValue < nMin ? nMin : (nValue > nMax ? nMax : (OMX_S32)nValue);
+}
+
+static inline OMX_S32 load_s24(const OMX_U8* p) {
+  /* the third byte holds the sign */
+  return (int32_t)((uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)(int8_t)p[2] << 16));
+}
+
+static inline void store_s24(OMX_U8* p, OMX_S32 nValue) {
+  p[0] = (OMX_U8)nValue;
+  p[1] = (OMX_U8)(nValue >> 8);
+  p[2] = (OMX_U8)(nValue >> 16);
+}
+
+/* scalar kernels. The vector kernels use them for the last samples.
+ * OMX_S32 can be wider than 32 bits, so the 32 bit samples use int32_t */
+
+static void volume_s16_scalar(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const OMX_S16* src = pSrc;
+  OMX_S16* dst = pDst;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    dst[i] = (OMX_S16)saturate(((OMX_S32)src[i] * nGain + Q15_ROUND) >> 15, -32768, 32767);
+  }
+}
+
+static void volume_s24_scalar(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const OMX_U8* src = pSrc;
+  OMX_U8* dst = pDst;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++, src += 3, dst += 3) {
+    store_s24(dst, saturate(((OMX_S64)load_s24(src) * nGain + Q15_ROUND) >> 15, -8388608, 8388607));
+  }
+}
+
+static void volume_s32_scalar(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const int32_t* src = pSrc;
+  int32_t* dst = pDst;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    dst[i] = (int32_t)saturate(((OMX_S64)src[i] * nGain + Q15_ROUND) >> 15, INT32_MIN, INT32_MAX);
+  }
+}
+
+static void volume_float_scalar(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const float* src = pSrc;
+  float* dst = pDst;
+  float fGain = (float)nGain / AUDIO_GAIN_UNITY;
+  float fValue;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    fValue = src[i] * fGain;
+    dst[i] = fValue < -1.0f ? -1.0f : (fValue > 1.0f ? 1.0f : fValue);
+  }
+}
+
+static void mix_s16_scalar(int32_t* pAcc, const OMX_S16* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pAcc[i] += (int32_t)pSrc[i] * (int32_t)nGain;
+  }
+}
+
+static void store_s16_scalar(OMX_S16* pDst, const int32_t* pAcc, OMX_U32 nSamples) {
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pDst[i] = (OMX_S16)saturate((pAcc[i] + Q15_ROUND) >> 15, -32768, 32767);
+  }
+}
+
+static void mix_float_scalar(float* pAcc, const float* pSrc, OMX_U32 nSamples, float fGain) {
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pAcc[i] += pSrc[i] * fGain;
+  }
+}
+
+static void store_float_scalar(float* pDst, const float* pAcc, OMX_U32 nSamples) {
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pDst[i] = pAcc[i] < -1.0f ? -1.0f : (pAcc[i] > 1.0f ? 1.0f : pAcc[i]);
+  }
+}
+
+static float dot_float_scalar(const float* pX, const float* pH, OMX_U32 nSamples) {
+  float fSum = 0.0f;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    fSum += pX[i] * pH[i];
+  }
+  return fSum;
+}
+
+static void levels_float_scalar(const float* pSrc, OMX_U32 nChannels, OMX_U32 nFrames, float fClip,
+                                float* pPeak, float* pSquares, OMX_U32* pClips) {
+  float fAbs;
+  OMX_U32 i, c;
+
+  for (i = 0; i < nFrames; i++) {
+    for (c = 0; c < nChannels; c++) {
+      fAbs = fabsf(pSrc[i * nChannels + c]);
+      pPeak[c] = fAbs > pPeak[c] ? fAbs : pPeak[c];
+      pSquares[c] += fAbs * fAbs;
+      pClips[c] += fAbs >= fClip;
+    }
+  }
+}
+
+/* Each section runs over all the samples before the next one, with its
+ * state in registers */
+static void biquad_float_scalar(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                                OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState) {
+  float b0, b1, b2, a1, a2, z1, z2, x, y;
+  OMX_U32 i, s;
+
+  for (s = 0; s < nSections; s++) {
+    b0 = pCoeffs->b0[s];
+    b1 = pCoeffs->b1[s];
+    b2 = pCoeffs->b2[s];
+    a1 = pCoeffs->a1[s];
+    a2 = pCoeffs->a2[s];
+    z1 = pState->z1[s];
+    z2 = pState->z2[s];
+    for (i = 0; i < nFrames; i++) {
+      x = pSamples[i * nStride];
+      y = b0 * x + z1;
+      z1 = b1 * x - a1 * y + z2;
+      z2 = b2 * x - a2 * y;
+      pSamples[i * nStride] = y;
+    }
+    pState->z1[s] = z1;
+    pState->z2[s] = z2;
+  }
+}
+
+/* The conversions from float round to the nearest integer, the halves
+ * to the even one as the vector conversions do, so that all the
+ * instruction sets give the same samples */
+
+static void to_float_s16_scalar(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const OMX_S16* src = pSrc;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pDst[i] = src[i * nStride] * (1.0f / 32768.0f);
+  }
+}
+
+static void to_float_s24_scalar(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const OMX_U8* src = pSrc;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pDst[i] = load_s24(src + i * nStride * 3) * (1.0f / 8388608.0f);
+  }
+}
+
+static void to_float_s32_scalar(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const int32_t* src = pSrc;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    pDst[i] = (float)src[i * nStride] * (1.0f / 2147483648.0f);
+  }
+}
+
+static void to_float_float_scalar(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const float* src = pSrc;
+  OMX_U32 i;
+
+  if (nStride == 1) {
+    memcpy(pDst, src, nSamples * sizeof(float));
+    return;
+  }
+  for (i = 0; i < nSamples; i++) {
+    pDst[i] = src[i * nStride];
+  }
+}
+
+static void from_float_s16_scalar(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  OMX_S16* dst = pDst;
+  float fValue;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    fValue = pSrc[i] * 32768.0f;
+    fValue = fValue < -32768.0f ? -32768.0f : (fValue > 32767.0f ? 32767.0f : fValue);
+    dst[i * nStride] = (OMX_S16)lrintf(fValue);
+  }
+}
+
+static void from_float_s24_scalar(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  OMX_U8* dst = pDst;
+  float fValue;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    fValue = pSrc[i] * 8388608.0f;
+    fValue = fValue < -8388608.0f ? -8388608.0f : (fValue > 8388607.0f ? 8388607.0f : fValue);
+    store_s24(dst + i * nStride * 3, (OMX_S32)lrintf(fValue));
+  }
+}
+
+/* 2^31 is the first float out of range, INT32_MAX has no float value */
+static void from_float_s32_scalar(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  int32_t* dst = pDst;
+  float fValue;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    fValue = pSrc[i] * 2147483648.0f;
+    dst[i * nStride] = fValue >= 2147483648.0f ? INT32_MAX : (fValue <= -2147483648.0f ? INT32_MIN : (int32_t)lrintf(fValue));
+  }
+}
+
+static void from_float_float_scalar(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  float* dst = pDst;
+  OMX_U32 i;
+
+  for (i = 0; i < nSamples; i++) {
+    dst[i * nStride] = pSrc[i] < -1.0f ? -1.0f : (pSrc[i] > 1.0f ? 1.0f : pSrc[i]);
+  }
+}
+
+static const audio_kernels scalarKernels = {
+  "scalar",
+  { NULL, volume_s16_scalar, volume_s24_scalar, volume_s32_scalar, volume_float_scalar },
+  mix_s16_scalar, store_s16_scalar, mix_float_scalar, store_float_scalar, dot_float_scalar, levels_float_scalar,
+  biquad_float_scalar,
+  { NULL, to_float_s16_scalar, to_float_s24_scalar, to_float_s32_scalar, to_float_float_scalar },
+  { NULL, from_float_s16_scalar, from_float_s24_scalar, from_float_s32_scalar, from_float_float_scalar }
+};
+
+#ifdef AUDIO_KERNELS_X86
+
+/* The 16 bit products are rebuilt as 32 bit values from their low and high
+ * halves, and packed back with saturation. The gain is below AUDIO_GAIN_UNITY,
+ * so it fits in a 16 bit lane */
+TARGET_SSE2 static void volume_s16_sse2(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const OMX_S16* src = pSrc;
+  OMX_S16* dst = pDst;
+  __m128i vGain = _mm_set1_epi16((short)nGain);
+  __m128i vRound = _mm_set1_epi32(Q15_ROUND);
+  __m128i x, lo, hi, p0, p1;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    x = _mm_loadu_si128((const __m128i*)(src + i));
+    lo = _mm_mullo_epi16(x, vGain);
+    hi = _mm_mulhi_epi16(x, vGain);
+    p0 = _mm_srai_epi32(_mm_add_epi32(_mm_unpacklo_epi16(lo, hi), vRound), 15);
+    p1 = _mm_srai_epi32(_mm_add_epi32(_mm_unpackhi_epi16(lo, hi), vRound), 15);
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+  }
+  volume_s16_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+TARGET_SSE2 static void volume_float_sse2(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const float* src = pSrc;
+  float* dst = pDst;
+  __m128 vGain = _mm_set1_ps((float)nGain / AUDIO_GAIN_UNITY);
+  __m128 vMin = _mm_set1_ps(-1.0f);
+  __m128 vMax = _mm_set1_ps(1.0f);
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    _mm_storeu_ps(dst + i, _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(src + i), vGain), vMin), vMax));
+  }
+  volume_float_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+/* Each sample is paired with itself and multiplied by the two halves of
+ * the gain, so that a gain equal to the unity is still exact */
+TARGET_SSE2 static void mix_s16_sse2(int32_t* pAcc, const OMX_S16* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  __m128i vGain = _mm_set1_epi32((int)(((OMX_U32)(nGain - (nGain >> 1)) << 16) | (OMX_U32)(nGain >> 1)));
+  __m128i x;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    x = _mm_loadu_si128((const __m128i*)(pSrc + i));
+    _mm_storeu_si128((__m128i*)(pAcc + i), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(pAcc + i)), _mm_madd_epi16(_mm_unpacklo_epi16(x, x), vGain)));
+    _mm_storeu_si128((__m128i*)(pAcc + i + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(pAcc + i + 4)), _mm_madd_epi16(_mm_unpackhi_epi16(x, x), vGain)));
+  }
+  mix_s16_scalar(pAcc + i, pSrc + i, nSamples - i, nGain);
+}
+
+TARGET_SSE2 static void store_s16_sse2(OMX_S16* pDst, const int32_t* pAcc, OMX_U32 nSamples) {
+  __m128i vRound = _mm_set1_epi32(Q15_ROUND);
+  __m128i p0, p1;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    p0 = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(pAcc + i)), vRound), 15);
+    p1 = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i*)(pAcc + i + 4)), vRound), 15);
+    _mm_storeu_si128((__m128i*)(pDst + i), _mm_packs_epi32(p0, p1));
+  }
+  store_s16_scalar(pDst + i, pAcc + i, nSamples - i);
+}
+
+TARGET_SSE2 static void mix_float_sse2(float* pAcc, const float* pSrc, OMX_U32 nSamples, float fGain) {
+  __m128 vGain = _mm_set1_ps(fGain);
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    _mm_storeu_ps(pAcc + i, _mm_add_ps(_mm_loadu_ps(pAcc + i), _mm_mul_ps(_mm_loadu_ps(pSrc + i), vGain)));
+  }
+  mix_float_scalar(pAcc + i, pSrc + i, nSamples - i, fGain);
+}
+
+TARGET_SSE2 static void store_float_sse2(float* pDst, const float* pAcc, OMX_U32 nSamples) {
+  __m128 vMin = _mm_set1_ps(-1.0f);
+  __m128 vMax = _mm_set1_ps(1.0f);
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    _mm_storeu_ps(pDst + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pAcc + i), vMin), vMax));
+  }
+  store_float_scalar(pDst + i, pAcc + i, nSamples - i);
+}
+
+/* two accumulators hide the latency of the additions */
+TARGET_SSE2 static float dot_float_sse2(const float* pX, const float* pH, OMX_U32 nSamples) {
+  __m128 vSum0 = _mm_setzero_ps();
+  __m128 vSum1 = _mm_setzero_ps();
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_mm_loadu_ps(pX + i), _mm_loadu_ps(pH + i)));
+    vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(_mm_loadu_ps(pX + i + 4), _mm_loadu_ps(pH + i + 4)));
+  }
+  vSum0 = _mm_add_ps(vSum0, vSum1);
+  vSum0 = _mm_add_ps(vSum0, _mm_movehl_ps(vSum0, vSum0));
+  vSum0 = _mm_add_ss(vSum0, _mm_shuffle_ps(vSum0, vSum0, 1));
+  return _mm_cvtss_f32(vSum0) + dot_float_scalar(pX + i, pH + i, nSamples - i);
+}
+
+/* The lanes hold the channels in turn, so the vector versions take the
+ * channel counts that divide their width and fold the lanes at the end */
+TARGET_SSE2 static void levels_float_sse2(const float* pSrc, OMX_U32 nChannels, OMX_U32 nFrames, float fClip,
+                                          float* pPeak, float* pSquares, OMX_U32* pClips) {
+  __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 vClip = _mm_set1_ps(fClip);
+  __m128 vPeak = _mm_setzero_ps();
+  __m128 vSum = _mm_setzero_ps();
+  __m128i vClips = _mm_setzero_si128();
+  __m128 x;
+  float peak[4], sum[4];
+  int32_t clips[4];
+  OMX_U32 nSamples = nFrames * nChannels, i, k;
+
+  if (4 % nChannels != 0) {
+    levels_float_scalar(pSrc, nChannels, nFrames, fClip, pPeak, pSquares, pClips);
+    return;
+  }
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    x = _mm_and_ps(_mm_loadu_ps(pSrc + i), vAbs);
+    vPeak = _mm_max_ps(x, vPeak);
+    vSum = _mm_add_ps(vSum, _mm_mul_ps(x, x));
+    vClips = _mm_sub_epi32(vClips, _mm_castps_si128(_mm_cmpge_ps(x, vClip)));
+  }
+  _mm_storeu_ps(peak, vPeak);
+  _mm_storeu_ps(sum, vSum);
+  _mm_storeu_si128((__m128i*)clips, vClips);
+  for (k = 0; k < 4; k++) {
+    pPeak[k % nChannels] = peak[k] > pPeak[k % nChannels] ? peak[k] : pPeak[k % nChannels];
+    pSquares[k % nChannels] += sum[k];
+    pClips[k % nChannels] += clips[k];
+  }
+  levels_float_scalar(pSrc + i, nChannels, (nSamples - i) / nChannels, fClip, pPeak, pSquares, pClips);
+}
+
+/* The sections of a group run as a pipeline over the lanes: at step t
+ * the lane k filters the sample t - k with the section s + k, taking the
+ * output of the lane k - 1 at the previous step. While the pipeline fills
+ * and drains, the lanes without a sample keep their state */
+TARGET_SSE2 static void biquad4_sse2(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                                     OMX_U32 s, AUDIO_BIQUAD_STATE* pState) {
+  __m128 b0 = _mm_loadu_ps(pCoeffs->b0 + s);
+  __m128 b1 = _mm_loadu_ps(pCoeffs->b1 + s);
+  __m128 b2 = _mm_loadu_ps(pCoeffs->b2 + s);
+  __m128 a1 = _mm_loadu_ps(pCoeffs->a1 + s);
+  __m128 a2 = _mm_loadu_ps(pCoeffs->a2 + s);
+  __m128 z1 = _mm_loadu_ps(pState->z1 + s);
+  __m128 z2 = _mm_loadu_ps(pState->z2 + s);
+  __m128 y = _mm_setzero_ps();
+  __m128i vLane = _mm_set_epi32(3, 2, 1, 0);
+  __m128i vFrames = _mm_set1_epi32((int)nFrames);
+  __m128i vSample;
+  __m128 x, z1n, z2n, vMask;
+  OMX_U32 t;
+
+  for (t = 0; t < nFrames + 3; t++) {
+    x = _mm_set_ss(t < nFrames ? pSamples[t * nStride] : 0.0f);
+    x = _mm_move_ss(_mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(y), 4)), x);
+    y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+    z1n = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+    z2n = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+    if (t >= 3 && t < nFrames) {
+      z1 = z1n;
+      z2 = z2n;
+    } else {
+      vSample = _mm_sub_epi32(_mm_set1_epi32((int)t), vLane);
+      vMask = _mm_castsi128_ps(_mm_and_si128(_mm_cmpgt_epi32(vSample, _mm_set1_epi32(-1)), _mm_cmplt_epi32(vSample, vFrames)));
+      z1 = _mm_or_ps(_mm_and_ps(vMask, z1n), _mm_andnot_ps(vMask, z1));
+      z2 = _mm_or_ps(_mm_and_ps(vMask, z2n), _mm_andnot_ps(vMask, z2));
+    }
+    if (t >= 3) {
+      pSamples[(t - 3) * nStride] = _mm_cvtss_f32(_mm_shuffle_ps(y, y, 0xFF));
+    }
+  }
+  _mm_storeu_ps(pState->z1 + s, z1);
+  _mm_storeu_ps(pState->z2 + s, z2);
+}
+
+TARGET_SSE2 static void biquad_float_sse2(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                                          OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState) {
+  OMX_U32 s;
+
+  for (s = 0; s < nSections; s += 4) {
+    biquad4_sse2(pSamples, nStride, nFrames, pCoeffs, s, pState);
+  }
+}
+
+TARGET_SSE2 static void to_float_s16_sse2(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const OMX_S16* src = pSrc;
+  __m128 vScale = _mm_set1_ps(1.0f / 32768.0f);
+  __m128i x;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 8 <= nSamples; i += 8) {
+      x = _mm_loadu_si128((const __m128i*)(src + i));
+      _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)), vScale));
+      _mm_storeu_ps(pDst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)), vScale));
+    }
+  }
+  to_float_s16_scalar(pDst + i, src + i * nStride, nStride, nSamples - i);
+}
+
+TARGET_SSE2 static void to_float_s32_sse2(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const int32_t* src = pSrc;
+  __m128 vScale = _mm_set1_ps(1.0f / 2147483648.0f);
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 4 <= nSamples; i += 4) {
+      _mm_storeu_ps(pDst + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(src + i))), vScale));
+    }
+  }
+  to_float_s32_scalar(pDst + i, src + i * nStride, nStride, nSamples - i);
+}
+
+/* the samples are clamped before the conversion, which rounds to the even integer */
+TARGET_SSE2 static void from_float_s16_sse2(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  OMX_S16* dst = pDst;
+  __m128 vScale = _mm_set1_ps(32768.0f);
+  __m128 vMin = _mm_set1_ps(-32768.0f);
+  __m128 vMax = _mm_set1_ps(32767.0f);
+  __m128i p0, p1;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 8 <= nSamples; i += 8) {
+      p0 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i), vScale), vMin), vMax));
+      p1 = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(pSrc + i + 4), vScale), vMin), vMax));
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(p0, p1));
+    }
+  }
+  from_float_s16_scalar(dst + i * nStride, nStride, pSrc + i, nSamples - i);
+}
+
+/* an out of range conversion gives INT32_MIN, turned into INT32_MAX for the positive samples */
+TARGET_SSE2 static void from_float_s32_sse2(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  int32_t* dst = pDst;
+  __m128 vScale = _mm_set1_ps(2147483648.0f);
+  __m128 x;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 4 <= nSamples; i += 4) {
+      x = _mm_mul_ps(_mm_loadu_ps(pSrc + i), vScale);
+      _mm_storeu_si128((__m128i*)(dst + i), _mm_xor_si128(_mm_cvtps_epi32(x), _mm_castps_si128(_mm_cmpge_ps(x, vScale))));
+    }
+  }
+  from_float_s32_scalar(dst + i * nStride, nStride, pSrc + i, nSamples - i);
+}
+
+TARGET_SSE2 static void from_float_float_sse2(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  if (nStride == 1) {
+    store_float_sse2(pDst, pSrc, nSamples);
+  } else {
+    from_float_float_scalar(pDst, nStride, pSrc, nSamples);
+  }
+}
+
+/* SSE2 has no signed 32 bit multiply, so the wider formats stay scalar */
+static const audio_kernels sse2Kernels = {
+  "sse2",
+  { NULL, volume_s16_sse2, volume_s24_scalar, volume_s32_scalar, volume_float_sse2 },
+  mix_s16_sse2, store_s16_sse2, mix_float_sse2, store_float_sse2, dot_float_sse2, levels_float_sse2,
+  biquad_float_sse2,
+  { NULL, to_float_s16_sse2, to_float_s24_scalar, to_float_s32_sse2, to_float_float_scalar },
+  { NULL, from_float_s16_sse2, from_float_s24_scalar, from_float_s32_sse2, from_float_float_sse2 }
+};
+
+/* unpack and pack work inside each 128 bit lane, so the order is kept */
+TARGET_AVX2 static void volume_s16_avx2(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const OMX_S16* src = pSrc;
+  OMX_S16* dst = pDst;
+  __m256i vGain = _mm256_set1_epi16((short)nGain);
+  __m256i vRound = _mm256_set1_epi32(Q15_ROUND);
+  __m256i x, lo, hi, p0, p1;
+  OMX_U32 i;
+
+  for (i = 0; i + 16 <= nSamples; i += 16) {
+    x = _mm256_loadu_si256((const __m256i*)(src + i));
+    lo = _mm256_mullo_epi16(x, vGain);
+    hi = _mm256_mulhi_epi16(x, vGain);
+    p0 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpacklo_epi16(lo, hi), vRound), 15);
+    p1 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_unpackhi_epi16(lo, hi), vRound), 15);
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm256_packs_epi32(p0, p1));
+  }
+  volume_s16_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+/* The even and odd samples are multiplied as 64 bit products. With a gain
+ * below the unity the result always fits in 32 bits, so the low half of
+ * each shifted product is the result */
+TARGET_AVX2 static void volume_s32_avx2(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const int32_t* src = pSrc;
+  int32_t* dst = pDst;
+  __m256i vGain = _mm256_set1_epi32(nGain);
+  __m256i vRound = _mm256_set1_epi64x(Q15_ROUND);
+  __m256i x, even, odd;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    x = _mm256_loadu_si256((const __m256i*)(src + i));
+    even = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epi32(x, vGain), vRound), 15);
+    odd = _mm256_srli_epi64(_mm256_add_epi64(_mm256_mul_epi32(_mm256_srli_epi64(x, 32), vGain), vRound), 15);
+    _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA));
+  }
+  volume_s32_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+TARGET_AVX2 static void volume_float_avx2(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const float* src = pSrc;
+  float* dst = pDst;
+  __m256 vGain = _mm256_set1_ps((float)nGain / AUDIO_GAIN_UNITY);
+  __m256 vMin = _mm256_set1_ps(-1.0f);
+  __m256 vMax = _mm256_set1_ps(1.0f);
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(src + i), vGain), vMin), vMax));
+  }
+  volume_float_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+TARGET_AVX2 static void mix_s16_avx2(int32_t* pAcc, const OMX_S16* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  __m256i vGain = _mm256_set1_epi32((int)nGain);
+  __m256i x;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(pSrc + i)));
+    _mm256_storeu_si256((__m256i*)(pAcc + i), _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(pAcc + i)), _mm256_mullo_epi32(x, vGain)));
+  }
+  mix_s16_scalar(pAcc + i, pSrc + i, nSamples - i, nGain);
+}
+
+/* pack works inside each 128 bit lane, so the 64 bit blocks are put back in order */
+TARGET_AVX2 static void store_s16_avx2(OMX_S16* pDst, const int32_t* pAcc, OMX_U32 nSamples) {
+  __m256i vRound = _mm256_set1_epi32(Q15_ROUND);
+  __m256i p0, p1;
+  OMX_U32 i;
+
+  for (i = 0; i + 16 <= nSamples; i += 16) {
+    p0 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(pAcc + i)), vRound), 15);
+    p1 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(pAcc + i + 8)), vRound), 15);
+    _mm256_storeu_si256((__m256i*)(pDst + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(p0, p1), 0xD8));
+  }
+  store_s16_scalar(pDst + i, pAcc + i, nSamples - i);
+}
+
+TARGET_AVX2 static void mix_float_avx2(float* pAcc, const float* pSrc, OMX_U32 nSamples, float fGain) {
+  __m256 vGain = _mm256_set1_ps(fGain);
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    _mm256_storeu_ps(pAcc + i, _mm256_add_ps(_mm256_loadu_ps(pAcc + i), _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), vGain)));
+  }
+  mix_float_scalar(pAcc + i, pSrc + i, nSamples - i, fGain);
+}
+
+TARGET_AVX2 static void store_float_avx2(float* pDst, const float* pAcc, OMX_U32 nSamples) {
+  __m256 vMin = _mm256_set1_ps(-1.0f);
+  __m256 vMax = _mm256_set1_ps(1.0f);
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    _mm256_storeu_ps(pDst + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pAcc + i), vMin), vMax));
+  }
+  store_float_scalar(pDst + i, pAcc + i, nSamples - i);
+}
+
+TARGET_AVX2 static float dot_float_avx2(const float* pX, const float* pH, OMX_U32 nSamples) {
+  __m256 vSum0 = _mm256_setzero_ps();
+  __m256 vSum1 = _mm256_setzero_ps();
+  __m128 vSum;
+  OMX_U32 i;
+
+  for (i = 0; i + 16 <= nSamples; i += 16) {
+    vSum0 = _mm256_add_ps(vSum0, _mm256_mul_ps(_mm256_loadu_ps(pX + i), _mm256_loadu_ps(pH + i)));
+    vSum1 = _mm256_add_ps(vSum1, _mm256_mul_ps(_mm256_loadu_ps(pX + i + 8), _mm256_loadu_ps(pH + i + 8)));
+  }
+  if (i + 8 <= nSamples) {
+    vSum0 = _mm256_add_ps(vSum0, _mm256_mul_ps(_mm256_loadu_ps(pX + i), _mm256_loadu_ps(pH + i)));
+    i += 8;
+  }
+  vSum0 = _mm256_add_ps(vSum0, vSum1);
+  vSum = _mm_add_ps(_mm256_castps256_ps128(vSum0), _mm256_extractf128_ps(vSum0, 1));
+  vSum = _mm_add_ps(vSum, _mm_movehl_ps(vSum, vSum));
+  vSum = _mm_add_ss(vSum, _mm_shuffle_ps(vSum, vSum, 1));
+  return _mm_cvtss_f32(vSum) + dot_float_scalar(pX + i, pH + i, nSamples - i);
+}
+
+TARGET_AVX2 static void levels_float_avx2(const float* pSrc, OMX_U32 nChannels, OMX_U32 nFrames, float fClip,
+                                          float* pPeak, float* pSquares, OMX_U32* pClips) {
+  __m256 vAbs = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 vClip = _mm256_set1_ps(fClip);
+  __m256 vPeak = _mm256_setzero_ps();
+  __m256 vSum = _mm256_setzero_ps();
+  __m256i vClips = _mm256_setzero_si256();
+  __m256 x;
+  float peak[8], sum[8];
+  int32_t clips[8];
+  OMX_U32 nSamples = nFrames * nChannels, i, k;
+
+  if (8 % nChannels != 0) {
+    levels_float_scalar(pSrc, nChannels, nFrames, fClip, pPeak, pSquares, pClips);
+    return;
+  }
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    x = _mm256_and_ps(_mm256_loadu_ps(pSrc + i), vAbs);
+    vPeak = _mm256_max_ps(x, vPeak);
+    vSum = _mm256_add_ps(vSum, _mm256_mul_ps(x, x));
+    vClips = _mm256_sub_epi32(vClips, _mm256_castps_si256(_mm256_cmp_ps(x, vClip, _CMP_GE_OQ)));
+  }
+  _mm256_storeu_ps(peak, vPeak);
+  _mm256_storeu_ps(sum, vSum);
+  _mm256_storeu_si256((__m256i*)clips, vClips);
+  for (k = 0; k < 8; k++) {
+    pPeak[k % nChannels] = peak[k] > pPeak[k % nChannels] ? peak[k] : pPeak[k % nChannels];
+    pSquares[k % nChannels] += sum[k];
+    pClips[k % nChannels] += clips[k];
+  }
+  levels_float_scalar(pSrc + i, nChannels, (nSamples - i) / nChannels, fClip, pPeak, pSquares, pClips);
+}
+
+/* the pipeline of biquad4_sse2 over 8 lanes, a cascade of 4 sections
+ * or less goes through the shorter one */
+TARGET_AVX2 static void biquad8_avx2(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                                     OMX_U32 s, AUDIO_BIQUAD_STATE* pState) {
+  __m256 b0 = _mm256_loadu_ps(pCoeffs->b0 + s);
+  __m256 b1 = _mm256_loadu_ps(pCoeffs->b1 + s);
+  __m256 b2 = _mm256_loadu_ps(pCoeffs->b2 + s);
+  __m256 a1 = _mm256_loadu_ps(pCoeffs->a1 + s);
+  __m256 a2 = _mm256_loadu_ps(pCoeffs->a2 + s);
+  __m256 z1 = _mm256_loadu_ps(pState->z1 + s);
+  __m256 z2 = _mm256_loadu_ps(pState->z2 + s);
+  __m256 y = _mm256_setzero_ps();
+  __m256i vShift = _mm256_set_epi32(6, 5, 4, 3, 2, 1, 0, 7);
+  __m256i vLane = _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+  __m256i vFrames = _mm256_set1_epi32((int)nFrames);
+  __m256i vSample;
+  __m256 x, z1n, z2n, vMask;
+  __m128 vLast;
+  OMX_U32 t;
+
+  for (t = 0; t < nFrames + 7; t++) {
+    x = _mm256_set1_ps(t < nFrames ? pSamples[t * nStride] : 0.0f);
+    x = _mm256_blend_ps(_mm256_permutevar8x32_ps(y, vShift), x, 1);
+    y = _mm256_add_ps(_mm256_mul_ps(b0, x), z1);
+    z1n = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), z2);
+    z2n = _mm256_sub_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+    if (t >= 7 && t < nFrames) {
+      z1 = z1n;
+      z2 = z2n;
+    } else {
+      vSample = _mm256_sub_epi32(_mm256_set1_epi32((int)t), vLane);
+      vMask = _mm256_castsi256_ps(_mm256_and_si256(_mm256_cmpgt_epi32(vSample, _mm256_set1_epi32(-1)), _mm256_cmpgt_epi32(vFrames, vSample)));
+      z1 = _mm256_blendv_ps(z1, z1n, vMask);
+      z2 = _mm256_blendv_ps(z2, z2n, vMask);
+    }
+    if (t >= 7) {
+      vLast = _mm256_extractf128_ps(y, 1);
+      pSamples[(t - 7) * nStride] = _mm_cvtss_f32(_mm_shuffle_ps(vLast, vLast, 0xFF));
+    }
+  }
+  _mm256_storeu_ps(pState->z1 + s, z1);
+  _mm256_storeu_ps(pState->z2 + s, z2);
+}
+
+TARGET_AVX2 static void biquad_float_avx2(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                                          OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState) {
+  OMX_U32 s = 0;
+
+  while (s < nSections) {
+    if (nSections - s > 4) {
+      biquad8_avx2(pSamples, nStride, nFrames, pCoeffs, s, pState);
+      s += 8;
+    } else {
+      biquad4_sse2(pSamples, nStride, nFrames, pCoeffs, s, pState);
+      s += 4;
+    }
+  }
+}
+
+TARGET_AVX2 static void to_float_s16_avx2(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const OMX_S16* src = pSrc;
+  __m256 vScale = _mm256_set1_ps(1.0f / 32768.0f);
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 8 <= nSamples; i += 8) {
+      _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i)))), vScale));
+    }
+  }
+  to_float_s16_scalar(pDst + i, src + i * nStride, nStride, nSamples - i);
+}
+
+TARGET_AVX2 static void to_float_s32_avx2(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const int32_t* src = pSrc;
+  __m256 vScale = _mm256_set1_ps(1.0f / 2147483648.0f);
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 8 <= nSamples; i += 8) {
+      _mm256_storeu_ps(pDst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(src + i))), vScale));
+    }
+  }
+  to_float_s32_scalar(pDst + i, src + i * nStride, nStride, nSamples - i);
+}
+
+TARGET_AVX2 static void from_float_s16_avx2(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  OMX_S16* dst = pDst;
+  __m256 vScale = _mm256_set1_ps(32768.0f);
+  __m256 vMin = _mm256_set1_ps(-32768.0f);
+  __m256 vMax = _mm256_set1_ps(32767.0f);
+  __m256i p0, p1;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 16 <= nSamples; i += 16) {
+      p0 = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(pSrc + i), vScale), vMin), vMax));
+      p1 = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(pSrc + i + 8), vScale), vMin), vMax));
+      _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(_mm256_packs_epi32(p0, p1), 0xD8));
+    }
+  }
+  from_float_s16_scalar(dst + i * nStride, nStride, pSrc + i, nSamples - i);
+}
+
+TARGET_AVX2 static void from_float_s32_avx2(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  int32_t* dst = pDst;
+  __m256 vScale = _mm256_set1_ps(2147483648.0f);
+  __m256 x;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 8 <= nSamples; i += 8) {
+      x = _mm256_mul_ps(_mm256_loadu_ps(pSrc + i), vScale);
+      _mm256_storeu_si256((__m256i*)(dst + i), _mm256_xor_si256(_mm256_cvtps_epi32(x), _mm256_castps_si256(_mm256_cmp_ps(x, vScale, _CMP_GE_OQ))));
+    }
+  }
+  from_float_s32_scalar(dst + i * nStride, nStride, pSrc + i, nSamples - i);
+}
+
+TARGET_AVX2 static void from_float_float_avx2(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  if (nStride == 1) {
+    store_float_avx2(pDst, pSrc, nSamples);
+  } else {
+    from_float_float_scalar(pDst, nStride, pSrc, nSamples);
+  }
+}
+
+static const audio_kernels avx2Kernels = {
+  "avx2",
+  { NULL, volume_s16_avx2, volume_s24_scalar, volume_s32_avx2, volume_float_avx2 },
+  mix_s16_avx2, store_s16_avx2, mix_float_avx2, store_float_avx2, dot_float_avx2, levels_float_avx2,
+  biquad_float_avx2,
+  { NULL, to_float_s16_avx2, to_float_s24_scalar, to_float_s32_avx2, to_float_float_scalar },
+  { NULL, from_float_s16_avx2, from_float_s24_scalar, from_float_s32_avx2, from_float_float_avx2 }
+};
+
+#endif
+
+#ifdef AUDIO_KERNELS_NEON
+
+/* vqrdmulh computes (2 * a * b + 2^15) >> 16, that is the rounded Q15 product */
+static void volume_s16_neon(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const OMX_S16* src = pSrc;
+  OMX_S16* dst = pDst;
+  int16x8_t vGain = vdupq_n_s16((int16_t)nGain);
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    vst1q_s16(dst + i, vqrdmulhq_s16(vld1q_s16(src + i), vGain));
+  }
+  volume_s16_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+/* the gain is moved to Q31, so that the 32 bit doubling multiply gives the Q15 product */
+static void volume_s32_neon(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const int32_t* src = pSrc;
+  int32_t* dst = pDst;
+  int32x4_t vGain = vdupq_n_s32(nGain << 16);
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    vst1q_s32(dst + i, vqrdmulhq_s32(vld1q_s32(src + i), vGain));
+  }
+  volume_s32_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+static void volume_float_neon(void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  const float* src = pSrc;
+  float* dst = pDst;
+  float32x4_t vGain = vdupq_n_f32((float)nGain / AUDIO_GAIN_UNITY);
+  float32x4_t vMin = vdupq_n_f32(-1.0f);
+  float32x4_t vMax = vdupq_n_f32(1.0f);
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    vst1q_f32(dst + i, vminq_f32(vmaxq_f32(vmulq_f32(vld1q_f32(src + i), vGain), vMin), vMax));
+  }
+  volume_float_scalar(dst + i, src + i, nSamples - i, nGain);
+}
+
+static void mix_s16_neon(int32_t* pAcc, const OMX_S16* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  int16x8_t x;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    x = vld1q_s16(pSrc + i);
+    vst1q_s32(pAcc + i, vmlaq_n_s32(vld1q_s32(pAcc + i), vmovl_s16(vget_low_s16(x)), (int32_t)nGain));
+    vst1q_s32(pAcc + i + 4, vmlaq_n_s32(vld1q_s32(pAcc + i + 4), vmovl_s16(vget_high_s16(x)), (int32_t)nGain));
+  }
+  mix_s16_scalar(pAcc + i, pSrc + i, nSamples - i, nGain);
+}
+
+/* vqrshrn rounds, shifts and saturates in one instruction */
+static void store_s16_neon(OMX_S16* pDst, const int32_t* pAcc, OMX_U32 nSamples) {
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    vst1q_s16(pDst + i, vcombine_s16(vqrshrn_n_s32(vld1q_s32(pAcc + i), 15), vqrshrn_n_s32(vld1q_s32(pAcc + i + 4), 15)));
+  }
+  store_s16_scalar(pDst + i, pAcc + i, nSamples - i);
+}
+
+static void mix_float_neon(float* pAcc, const float* pSrc, OMX_U32 nSamples, float fGain) {
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    vst1q_f32(pAcc + i, vmlaq_n_f32(vld1q_f32(pAcc + i), vld1q_f32(pSrc + i), fGain));
+  }
+  mix_float_scalar(pAcc + i, pSrc + i, nSamples - i, fGain);
+}
+
+static void store_float_neon(float* pDst, const float* pAcc, OMX_U32 nSamples) {
+  float32x4_t vMin = vdupq_n_f32(-1.0f);
+  float32x4_t vMax = vdupq_n_f32(1.0f);
+  OMX_U32 i;
+
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    vst1q_f32(pDst + i, vminq_f32(vmaxq_f32(vld1q_f32(pAcc + i), vMin), vMax));
+  }
+  store_float_scalar(pDst + i, pAcc + i, nSamples - i);
+}
+
+static float dot_float_neon(const float* pX, const float* pH, OMX_U32 nSamples) {
+  float32x4_t vSum0 = vdupq_n_f32(0.0f);
+  float32x4_t vSum1 = vdupq_n_f32(0.0f);
+  float32x2_t vSum;
+  OMX_U32 i;
+
+  for (i = 0; i + 8 <= nSamples; i += 8) {
+    vSum0 = vmlaq_f32(vSum0, vld1q_f32(pX + i), vld1q_f32(pH + i));
+    vSum1 = vmlaq_f32(vSum1, vld1q_f32(pX + i + 4), vld1q_f32(pH + i + 4));
+  }
+  vSum0 = vaddq_f32(vSum0, vSum1);
+  vSum = vadd_f32(vget_low_f32(vSum0), vget_high_f32(vSum0));
+  vSum = vpadd_f32(vSum, vSum);
+  return vget_lane_f32(vSum, 0) + dot_float_scalar(pX + i, pH + i, nSamples - i);
+}
+
+static void levels_float_neon(const float* pSrc, OMX_U32 nChannels, OMX_U32 nFrames, float fClip,
+                              float* pPeak, float* pSquares, OMX_U32* pClips) {
+  float32x4_t vClip = vdupq_n_f32(fClip);
+  float32x4_t vPeak = vdupq_n_f32(0.0f);
+  float32x4_t vSum = vdupq_n_f32(0.0f);
+  uint32x4_t vClips = vdupq_n_u32(0);
+  float32x4_t x;
+  float peak[4], sum[4];
+  uint32_t clips[4];
+  OMX_U32 nSamples = nFrames * nChannels, i, k;
+
+  if (4 % nChannels != 0) {
+    levels_float_scalar(pSrc, nChannels, nFrames, fClip, pPeak, pSquares, pClips);
+    return;
+  }
+  for (i = 0; i + 4 <= nSamples; i += 4) {
+    x = vabsq_f32(vld1q_f32(pSrc + i));
+    vPeak = vmaxq_f32(x, vPeak);
+    vSum = vmlaq_f32(vSum, x, x);
+    vClips = vsubq_u32(vClips, vcgeq_f32(x, vClip));
+  }
+  vst1q_f32(peak, vPeak);
+  vst1q_f32(sum, vSum);
+  vst1q_u32(clips, vClips);
+  for (k = 0; k < 4; k++) {
+    pPeak[k % nChannels] = peak[k] > pPeak[k % nChannels] ? peak[k] : pPeak[k % nChannels];
+    pSquares[k % nChannels] += sum[k];
+    pClips[k % nChannels] += clips[k];
+  }
+  levels_float_scalar(pSrc + i, nChannels, (nSamples - i) / nChannels, fClip, pPeak, pSquares, pClips);
+}
+
+/* the pipeline of biquad4_sse2 */
+static void biquad4_neon(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                         OMX_U32 s, AUDIO_BIQUAD_STATE* pState) {
+  static const int32_t lanes[4] = { 0, 1, 2, 3 };
+  float32x4_t b0 = vld1q_f32(pCoeffs->b0 + s);
+  float32x4_t b1 = vld1q_f32(pCoeffs->b1 + s);
+  float32x4_t b2 = vld1q_f32(pCoeffs->b2 + s);
+  float32x4_t a1 = vld1q_f32(pCoeffs->a1 + s);
+  float32x4_t a2 = vld1q_f32(pCoeffs->a2 + s);
+  float32x4_t z1 = vld1q_f32(pState->z1 + s);
+  float32x4_t z2 = vld1q_f32(pState->z2 + s);
+  float32x4_t y = vdupq_n_f32(0.0f);
+  int32x4_t vLane = vld1q_s32(lanes);
+  int32x4_t vFrames = vdupq_n_s32((int32_t)nFrames);
+  int32x4_t vSample;
+  uint32x4_t vMask;
+  float32x4_t x, z1n, z2n;
+  OMX_U32 t;
+
+  for (t = 0; t < nFrames + 3; t++) {
+    x = vextq_f32(vdupq_n_f32(t < nFrames ? pSamples[t * nStride] : 0.0f), y, 3);
+    y = vaddq_f32(vmulq_f32(b0, x), z1);
+    z1n = vaddq_f32(vsubq_f32(vmulq_f32(b1, x), vmulq_f32(a1, y)), z2);
+    z2n = vsubq_f32(vmulq_f32(b2, x), vmulq_f32(a2, y));
+    if (t >= 3 && t < nFrames) {
+      z1 = z1n;
+      z2 = z2n;
+    } else {
+      vSample = vsubq_s32(vdupq_n_s32((int32_t)t), vLane);
+      vMask = vandq_u32(vcgeq_s32(vSample, vdupq_n_s32(0)), vcltq_s32(vSample, vFrames));
+      z1 = vbslq_f32(vMask, z1n, z1);
+      z2 = vbslq_f32(vMask, z2n, z2);
+    }
+    if (t >= 3) {
+      pSamples[(t - 3) * nStride] = vgetq_lane_f32(y, 3);
+    }
+  }
+  vst1q_f32(pState->z1 + s, z1);
+  vst1q_f32(pState->z2 + s, z2);
+}
+
+static void biquad_float_neon(float* pSamples, OMX_U32 nStride, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                              OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState) {
+  OMX_U32 s;
+
+  for (s = 0; s < nSections; s += 4) {
+    biquad4_neon(pSamples, nStride, nFrames, pCoeffs, s, pState);
+  }
+}
+
+static void to_float_s16_neon(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const OMX_S16* src = pSrc;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 4 <= nSamples; i += 4) {
+      vst1q_f32(pDst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(src + i))), 1.0f / 32768.0f));
+    }
+  }
+  to_float_s16_scalar(pDst + i, src + i * nStride, nStride, nSamples - i);
+}
+
+static void to_float_s32_neon(float* pDst, const void* pSrc, OMX_U32 nStride, OMX_U32 nSamples) {
+  const int32_t* src = pSrc;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 4 <= nSamples; i += 4) {
+      vst1q_f32(pDst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), 1.0f / 2147483648.0f));
+    }
+  }
+  to_float_s32_scalar(pDst + i, src + i * nStride, nStride, nSamples - i);
+}
+
+#if defined(__aarch64__)
+/* vcvtn rounds to the even integer and saturates, only the 64 bit instruction set has it */
+static void from_float_s16_neon(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  OMX_S16* dst = pDst;
+  float32x4_t vMin = vdupq_n_f32(-32768.0f);
+  float32x4_t vMax = vdupq_n_f32(32767.0f);
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 4 <= nSamples; i += 4) {
+      vst1_s16(dst + i, vmovn_s32(vcvtnq_s32_f32(vminq_f32(vmaxq_f32(vmulq_n_f32(vld1q_f32(pSrc + i), 32768.0f), vMin), vMax))));
+    }
+  }
+  from_float_s16_scalar(dst + i * nStride, nStride, pSrc + i, nSamples - i);
+}
+
+static void from_float_s32_neon(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  int32_t* dst = pDst;
+  OMX_U32 i = 0;
+
+  if (nStride == 1) {
+    for (; i + 4 <= nSamples; i += 4) {
+      vst1q_s32(dst + i, vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(pSrc + i), 2147483648.0f)));
+    }
+  }
+  from_float_s32_scalar(dst + i * nStride, nStride, pSrc + i, nSamples - i);
+}
+#else
+#define from_float_s16_neon from_float_s16_scalar
+#define from_float_s32_neon from_float_s32_scalar
+#endif
+
+static void from_float_float_neon(void* pDst, OMX_U32 nStride, const float* pSrc, OMX_U32 nSamples) {
+  if (nStride == 1) {
+    store_float_neon(pDst, pSrc, nSamples);
+  } else {
+    from_float_float_scalar(pDst, nStride, pSrc, nSamples);
+  }
+}
+
+static const audio_kernels neonKernels = {
+  "neon",
+  { NULL, volume_s16_neon, volume_s24_scalar, volume_s32_neon, volume_float_neon },
+  mix_s16_neon, store_s16_neon, mix_float_neon, store_float_neon, dot_float_neon, levels_float_neon,
+  biquad_float_neon,
+  { NULL, to_float_s16_neon, to_float_s24_scalar, to_float_s32_neon, to_float_float_scalar },
+  { NULL, from_float_s16_neon, from_float_s24_scalar, from_float_s32_neon, from_float_float_neon }
+};
+
+#endif
+
+static const audio_kernels* kernels = &scalarKernels;
+static pthread_once_t kernelsOnce = PTHREAD_ONCE_INIT;
+
+static void select_kernels(void) {
+  const char* env = getenv(OMX_AUDIO_KERNELS_ENV);
+
+  if (env && !strcmp(env, "scalar")) {
+    kernels = &scalarKernels;
+    return;
+  }
+#ifdef AUDIO_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && !(env && !strcmp(env, "sse2"))) {
+    kernels = &avx2Kernels;
+  } else if (__builtin_cpu_supports("sse2")) {
+    kernels = &sse2Kernels;
+  }
+#endif
+#ifdef AUDIO_KERNELS_NEON
+  kernels = &neonKernels;
+#endif
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s using the %s audio kernels\n", __func__, kernels->name);
+}
+
+AUDIO_SAMPLE_FORMAT omx_audio_kernels_GetSampleFormat(OMX_AUDIO_PARAM_PCMMODETYPE* pPcmMode) {
+  if (pPcmMode->ePCMMode == OMX_AUDIO_PCMModeBellagioFloat) {
+    return pPcmMode->nBitPerSample == 32 ? AUDIO_SAMPLE_FLOAT : AUDIO_SAMPLE_UNSUPPORTED;
+  }
+  if (pPcmMode->ePCMMode != OMX_AUDIO_PCMModeLinear || pPcmMode->eNumData != OMX_NumericalDataSigned) {
+    return AUDIO_SAMPLE_UNSUPPORTED;
+  }
+  switch (pPcmMode->nBitPerSample) {
+    case 16:
+      return AUDIO_SAMPLE_S16;
+    case 24:
+      return AUDIO_SAMPLE_S24;
+    case 32:
+      return AUDIO_SAMPLE_S32;
+    default:
+      return AUDIO_SAMPLE_UNSUPPORTED;
+  }
+}
+
+OMX_U32 omx_audio_kernels_GetSampleSize(AUDIO_SAMPLE_FORMAT eFormat) {
+  switch (eFormat) {
+    case AUDIO_SAMPLE_S16:
+      return 2;
+    case AUDIO_SAMPLE_S24:
+      return 3;
+    case AUDIO_SAMPLE_S32:
+    case AUDIO_SAMPLE_FLOAT:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+const char* omx_audio_kernels_GetName(void) {
+  pthread_once(&kernelsOnce, select_kernels);
+  return kernels->name;
+}
+
+OMX_S32 omx_audio_kernels_GainQ15(float fGain) {
+  if (fGain <= 0.0f) {
+    return 0;
+  }
+  if (fGain >= 1.0f) {
+    return AUDIO_GAIN_UNITY;
+  }
+  return (OMX_S32)(fGain * AUDIO_GAIN_UNITY + 0.5f);
+}
+
+void omx_audio_kernels_Volume(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain) {
+  if (eFormat <= AUDIO_SAMPLE_UNSUPPORTED || eFormat >= AUDIO_SAMPLE_FORMATS) {
+    return;
+  }
+  /* the vector kernels keep the gain in a 16 bit lane */
+  if (nGain >= AUDIO_GAIN_UNITY) {
+    if (pDst != pSrc) {
+      memcpy(pDst, pSrc, nSamples * omx_audio_kernels_GetSampleSize(eFormat));
+    }
+    return;
+  }
+  pthread_once(&kernelsOnce, select_kernels);
+  kernels->volume[eFormat](pDst, pSrc, nSamples, nGain);
+}
+
+/* Returns the number of samples of a stream, starting at nSrcStart in the
+ * output, that fall in the block starting at nStart. *pOffset receives
+ * the position of the first of them in the block */
+static OMX_U32 mix_range(const OMX_U32* pSrcStart, OMX_U32 j, OMX_U32 nSrcSamples, OMX_U32 nStart, OMX_U32 nBlock, OMX_U32* pOffset) {
+  OMX_U32 nSrcStart = pSrcStart ? pSrcStart[j] : 0;
+  OMX_U32 nFirst = nSrcStart > nStart ? nSrcStart : nStart;
+  OMX_U32 nEnd = nSrcStart + nSrcSamples < nStart + nBlock ? nSrcStart + nSrcSamples : nStart + nBlock;
+
+  *pOffset = nFirst - nStart;
+  return nEnd > nFirst ? nEnd - nFirst : 0;
+}
+
+/* the wide formats are mixed in 64 bit accumulators, without vector versions */
+static void mix_wide(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* const* ppSrc, const OMX_U32* pSrcSamples,
+                     const OMX_U32* pSrcStart, const OMX_S32* pGains, OMX_U32 nSources, OMX_U32 nFirst, OMX_U32 nSamples) {
+  OMX_S64 acc[MIX_BLOCK];
+  OMX_U32 nStart, nBlock, nCount, nOffset, nSrc, i, j;
+  OMX_S32 nMin = eFormat == AUDIO_SAMPLE_S24 ? -8388608 : INT32_MIN;
+  OMX_S32 nMax = eFormat == AUDIO_SAMPLE_S24 ? 8388607 : INT32_MAX;
+
+  for (nStart = nFirst; nStart < nFirst + nSamples; nStart += nBlock) {
+    nBlock = nFirst + nSamples - nStart < MIX_BLOCK ? nFirst + nSamples - nStart : MIX_BLOCK;
+    memset(acc, 0, nBlock * sizeof(OMX_S64));
+    for (j = 0; j < nSources; j++) {
+      nCount = mix_range(pSrcStart, j, pSrcSamples[j], nStart, nBlock, &nOffset);
+      nSrc = nStart + nOffset - (pSrcStart ? pSrcStart[j] : 0);
+      for (i = 0; i < nCount; i++) {
+        if (eFormat == AUDIO_SAMPLE_S24) {
+          acc[nOffset + i] += (OMX_S64)load_s24((const OMX_U8*)ppSrc[j] + (nSrc + i) * 3) * pGains[j];
+        } else {
+          acc[nOffset + i] += (OMX_S64)((const int32_t*)ppSrc[j])[nSrc + i] * pGains[j];
+        }
+      }
+    }
+    for (i = 0; i < nBlock; i++) {
+      if (eFormat == AUDIO_SAMPLE_S24) {
+        store_s24((OMX_U8*)pDst + (nStart + i) * 3, saturate((acc[i] + Q15_ROUND) >> 15, nMin, nMax));
+      } else {
+        ((int32_t*)pDst)[nStart + i] = (int32_t)saturate((acc[i] + Q15_ROUND) >> 15, nMin, nMax);
+      }
+    }
+  }
+}
+
+void omx_audio_kernels_Mix(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* const* ppSrc, const OMX_U32* pSrcSamples,
+                           const OMX_U32* pSrcStart, const OMX_S32* pGains, OMX_U32 nSources, OMX_U32 nSamples) {
+  omx_audio_kernels_MixSlice(eFormat, pDst, ppSrc, pSrcSamples, pSrcStart, pGains, nSources, 0, nSamples);
+}
+
+void omx_audio_kernels_MixSlice(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* const* ppSrc, const OMX_U32* pSrcSamples,
+                                const OMX_U32* pSrcStart, const OMX_S32* pGains, OMX_U32 nSources, OMX_U32 nFirst, OMX_U32 nSamples) {
+  int32_t acc[MIX_BLOCK];
+  float fAcc[MIX_BLOCK];
+  OMX_U32 nStart, nBlock, nCount, nOffset, nSrc, j;
+
+  pthread_once(&kernelsOnce, select_kernels);
+  switch (eFormat) {
+    case AUDIO_SAMPLE_S16:
+      for (nStart = nFirst; nStart < nFirst + nSamples; nStart += nBlock) {
+        nBlock = nFirst + nSamples - nStart < MIX_BLOCK ? nFirst + nSamples - nStart : MIX_BLOCK;
+        memset(acc, 0, nBlock * sizeof(int32_t));
+        for (j = 0; j < nSources; j++) {
+          nCount = mix_range(pSrcStart, j, pSrcSamples[j], nStart, nBlock, &nOffset);
+          if (nCount) {
+            nSrc = nStart + nOffset - (pSrcStart ? pSrcStart[j] : 0);
+            kernels->mix_s16(acc + nOffset, (const OMX_S16*)ppSrc[j] + nSrc, nCount, pGains[j]);
+          }
+        }
+        kernels->store_s16((OMX_S16*)pDst + nStart, acc, nBlock);
+      }
+      break;
+    case AUDIO_SAMPLE_FLOAT:
+      for (nStart = nFirst; nStart < nFirst + nSamples; nStart += nBlock) {
+        nBlock = nFirst + nSamples - nStart < MIX_BLOCK ? nFirst + nSamples - nStart : MIX_BLOCK;
+        memset(fAcc, 0, nBlock * sizeof(float));
+        for (j = 0; j < nSources; j++) {
+          nCount = mix_range(pSrcStart, j, pSrcSamples[j], nStart, nBlock, &nOffset);
+          if (nCount) {
+            nSrc = nStart + nOffset - (pSrcStart ? pSrcStart[j] : 0);
+            kernels->mix_float(fAcc + nOffset, (const float*)ppSrc[j] + nSrc, nCount, (float)pGains[j] / AUDIO_GAIN_UNITY);
+          }
+        }
+        kernels->store_float((float*)pDst + nStart, fAcc, nBlock);
+      }
+      break;
+    case AUDIO_SAMPLE_S24:
+    case AUDIO_SAMPLE_S32:
+      mix_wide(eFormat, pDst, ppSrc, pSrcSamples, pSrcStart, pGains, nSources, nFirst, nSamples);
+      break;
+    default:
+      break;
+  }
+}
+
+void omx_audio_kernels_ToFloat(AUDIO_SAMPLE_FORMAT eFormat, float* pDst, const void* pSrc, OMX_U32 nSrcStride, OMX_U32 nSamples) {
+  if (eFormat <= AUDIO_SAMPLE_UNSUPPORTED || eFormat >= AUDIO_SAMPLE_FORMATS) {
+    return;
+  }
+  pthread_once(&kernelsOnce, select_kernels);
+  kernels->to_float[eFormat](pDst, pSrc, nSrcStride, nSamples);
+}
+
+void omx_audio_kernels_FromFloat(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, OMX_U32 nDstStride, const float* pSrc, OMX_U32 nSamples) {
+  if (eFormat <= AUDIO_SAMPLE_UNSUPPORTED || eFormat >= AUDIO_SAMPLE_FORMATS) {
+    return;
+  }
+  pthread_once(&kernelsOnce, select_kernels);
+  kernels->from_float[eFormat](pDst, nDstStride, pSrc, nSamples);
+}
+
+void omx_audio_kernels_ChannelMatrix(float* pDst, const float* pSrc, OMX_U32 nPlaneSize, const float* pMatrix,
+                                     OMX_U32 nInChannels, OMX_U32 nOutChannels, OMX_U32 nSamples) {
+  OMX_U32 i, j;
+
+  pthread_once(&kernelsOnce, select_kernels);
+  for (i = 0; i < nOutChannels; i++) {
+    memset(pDst + i * nPlaneSize, 0, nSamples * sizeof(float));
+    for (j = 0; j < nInChannels; j++) {
+      if (pMatrix[i * nInChannels + j] != 0.0f) {
+        kernels->mix_float(pDst + i * nPlaneSize, pSrc + j * nPlaneSize, nSamples, pMatrix[i * nInChannels + j]);
+      }
+    }
+  }
+}
+
+/* The levels are measured on blocks converted to float, which stay in
+ * the cache between the conversion and the measure. The squares of a
+ * block are summed in float, and the blocks in double */
+void omx_audio_kernels_Levels(AUDIO_SAMPLE_FORMAT eFormat, const void* pSrc, OMX_U32 nChannels, OMX_U32 nFrames,
+                              float* pPeak, double* pSquares, OMX_U32* pClips) {
+  float block[LEVELS_BLOCK];
+  float fSquares[OMX_AUDIO_MAXCHANNELS];
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(eFormat);
+  OMX_U32 nBlockFrames, nBlock, nFrame, c;
+  const float* pBlock;
+  float fClip;
+
+  if (nSampleSize == 0 || nChannels == 0 || nChannels > OMX_AUDIO_MAXCHANNELS) {
+    return;
+  }
+  /* the highest value of the format, the float of the 32 bit one is 1.0 */
+  switch (eFormat) {
+    case AUDIO_SAMPLE_S16:
+      fClip = 32767.0f / 32768.0f;
+      break;
+    case AUDIO_SAMPLE_S24:
+      fClip = 8388607.0f / 8388608.0f;
+      break;
+    default:
+      fClip = 1.0f;
+      break;
+  }
+  pthread_once(&kernelsOnce, select_kernels);
+  nBlockFrames = LEVELS_BLOCK / nChannels;
+  for (nFrame = 0; nFrame < nFrames; nFrame += nBlock) {
+    nBlock = nFrames - nFrame < nBlockFrames ? nFrames - nFrame : nBlockFrames;
+    if (eFormat == AUDIO_SAMPLE_FLOAT) {
+      pBlock = (const float*)pSrc + nFrame * nChannels;
+    } else {
+      kernels->to_float[eFormat](block, (const OMX_U8*)pSrc + nFrame * nChannels * nSampleSize, 1, nBlock * nChannels);
+      pBlock = block;
+    }
+    memset(fSquares, 0, nChannels * sizeof(float));
+    kernels->levels_float(pBlock, nChannels, nBlock, fClip, pPeak, fSquares, pClips);
+    for (c = 0; c < nChannels; c++) {
+      pSquares[c] += fSquares[c];
+    }
+  }
+}
+
+/* A channel goes through all the sections before the next one. The
+ * states still ringing under BIQUAD_QUIET are flushed, so that a filter
+ * decaying in silence does not go on through slow denormal arithmetic */
+void omx_audio_kernels_Biquad(float* pSamples, OMX_U32 nChannels, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                              OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState) {
+  OMX_U32 c, s;
+
+  if (nFrames == 0 || nSections == 0 || nSections > AUDIO_BIQUAD_SECTIONS) {
+    return;
+  }
+  pthread_once(&kernelsOnce, select_kernels);
+  for (c = 0; c < nChannels; c++) {
+    kernels->biquad_float(pSamples + c, nChannels, nFrames, pCoeffs, nSections, pState + c);
+    for (s = 0; s < nSections; s++) {
+      if (fabsf(pState[c].z1[s]) < BIQUAD_QUIET) {
+        pState[c].z1[s] = 0.0f;
+      }
+      if (fabsf(pState[c].z2[s]) < BIQUAD_QUIET) {
+        pState[c].z2[s] = 0.0f;
+      }
+    }
+  }
+}
+
+OMX_U32 omx_audio_kernels_Polyphase(float* pDst, const float* pSrc, OMX_U32 nSrcSamples, const float* pCoeffs, OMX_U32 nTaps,
+                                    OMX_U32 nPhases, OMX_U32 nStep, OMX_U32* pPosition, OMX_U32* pPhase, OMX_U32 nMaxOut) {
+  OMX_U32 nPosition = *pPosition;
+  OMX_U32 nPhase = *pPhase;
+  OMX_U32 nStepInt = nStep / nPhases;
+  OMX_U32 nStepFrac = nStep % nPhases;
+  OMX_U32 nOut;
+
+  pthread_once(&kernelsOnce, select_kernels);
+  for (nOut = 0; nOut < nMaxOut && nPosition + nTaps <= nSrcSamples; nOut++) {
+    pDst[nOut] = kernels->dot_float(pSrc + nPosition, pCoeffs + nPhase * nTaps, nTaps);
+    nPosition += nStepInt;
+    nPhase += nStepFrac;
+    if (nPhase >= nPhases) {
+      nPhase -= nPhases;
+      nPosition++;
+    }
+  }
+  *pPosition = nPosition;
+  *pPhase = nPhase;
+  return nOut;
+}
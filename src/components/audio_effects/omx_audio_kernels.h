@@ -0,0 +1,231 @@
+/**
+  src/components/audio_effects/omx_audio_kernels.h
+
+  Sample processing kernels shared by the audio effect components.
+  Each kernel has a scalar version and, where the instruction set helps,
+  SSE2, AVX2 and NEON versions. The best set supported by the processor
+  is selected at run time, the first time a kernel is called.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_AUDIO_KERNELS_H_
+#define _OMX_AUDIO_KERNELS_H_
+
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+/** Name of the environment variable that restricts the kernels to a
+ * smaller instruction set: "scalar", "sse2", "avx2" or "neon".
+ * A set the processor does not support is ignored
+ */
+#define OMX_AUDIO_KERNELS_ENV "OMX_BELLAGIO_SIMD"
+
+/** The unity gain in Q15 */
+#define AUDIO_GAIN_UNITY 32768
+
+/** Number of samples the mix kernel computes at a time. A slice of the
+ * output starting on a multiple of it is mixed exactly as in the whole output
+ */
+#define AUDIO_MIX_BLOCK 256
+
+/** The sample layouts handled by the kernels. The samples are in the
+ * byte order of the processor
+ */
+typedef enum AUDIO_SAMPLE_FORMAT {
+  AUDIO_SAMPLE_UNSUPPORTED = 0,
+  AUDIO_SAMPLE_S16,   /**< signed 16 bit */
+  AUDIO_SAMPLE_S24,   /**< signed 24 bit, packed in 3 bytes */
+  AUDIO_SAMPLE_S32,   /**< signed 32 bit */
+  AUDIO_SAMPLE_FLOAT, /**< 32 bit floating point in the range [-1, 1] */
+  AUDIO_SAMPLE_FORMATS
+} AUDIO_SAMPLE_FORMAT;
+
+/** Returns the sample layout described by a PCM mode structure,
+ * or AUDIO_SAMPLE_UNSUPPORTED
+ */
+AUDIO_SAMPLE_FORMAT omx_audio_kernels_GetSampleFormat(OMX_AUDIO_PARAM_PCMMODETYPE* pPcmMode);
+
+/** Returns the size in bytes of a sample */
+OMX_U32 omx_audio_kernels_GetSampleSize(AUDIO_SAMPLE_FORMAT eFormat);
+
+/** Returns the name of the selected instruction set */
+const char* omx_audio_kernels_GetName(void);
+
+/** Converts a gain in Q15 from a float gain, where 1.0 is the unity */
+OMX_S32 omx_audio_kernels_GainQ15(float fGain);
+
+/** Scales the samples by a gain, rounding to the nearest value and
+ * saturating to the range of the format
+ *
+ * @param eFormat the sample layout
+ * @param pDst the scaled samples. It can be equal to pSrc
+ * @param pSrc the samples to scale
+ * @param nSamples number of samples, of all the channels
+ * @param nGain the gain in Q15, from 0 to AUDIO_GAIN_UNITY
+ */
+void omx_audio_kernels_Volume(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* pSrc, OMX_U32 nSamples, OMX_S32 nGain);
+
+/** Mixes several streams in one pass over the output. The scaled samples
+ * are summed in wide accumulators, and each output sample is rounded and
+ * saturated once. A stream contributes silence outside of its samples,
+ * so that a stream can start after the beginning of the output and end
+ * before its end
+ *
+ * @param eFormat the sample layout of all the streams
+ * @param pDst the mixed samples. It must not overlap the streams
+ * @param ppSrc the streams to mix
+ * @param pSrcSamples the number of samples of each stream
+ * @param pSrcStart the position in the output of the first sample of
+ * each stream. NULL if all the streams start with the output
+ * @param pGains the gain of each stream in Q15. The sum of the gains
+ * should not exceed AUDIO_GAIN_UNITY by much, to keep 16 bit sums in 32 bits
+ * @param nSources number of streams
+ * @param nSamples number of output samples
+ */
+void omx_audio_kernels_Mix(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* const* ppSrc, const OMX_U32* pSrcSamples,
+                           const OMX_U32* pSrcStart, const OMX_S32* pGains, OMX_U32 nSources, OMX_U32 nSamples);
+
+/** Mixes a slice of the output of omx_audio_kernels_Mix, so that several
+ * threads can share the mix of a long output. The slices starting on a
+ * multiple of AUDIO_MIX_BLOCK give the same samples as the whole mix
+ *
+ * @param pDst the whole output. Only the samples of the slice are written
+ * @param nFirst the position of the slice in the output
+ * @param nSamples number of samples of the slice
+ *
+ * The other parameters are the ones of omx_audio_kernels_Mix
+ */
+void omx_audio_kernels_MixSlice(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, const void* const* ppSrc, const OMX_U32* pSrcSamples,
+                                const OMX_U32* pSrcStart, const OMX_S32* pGains, OMX_U32 nSources, OMX_U32 nFirst, OMX_U32 nSamples);
+
+/** Converts samples to floating point, where the full scale of the
+ * format is 1.0
+ *
+ * @param eFormat the layout of the source samples
+ * @param pDst the converted samples, one after the other
+ * @param pSrc the first sample to convert
+ * @param nSrcStride distance in samples between two source samples. It is
+ * the number of channels to take one channel out of interleaved samples
+ * @param nSamples number of samples to convert
+ */
+void omx_audio_kernels_ToFloat(AUDIO_SAMPLE_FORMAT eFormat, float* pDst, const void* pSrc, OMX_U32 nSrcStride, OMX_U32 nSamples);
+
+/** Converts floating point samples to a format, rounding to the nearest
+ * value, the halves to the even one, and saturating to its range.
+ * It is the inverse of omx_audio_kernels_ToFloat
+ *
+ * @param nDstStride distance in samples between two converted samples
+ */
+void omx_audio_kernels_FromFloat(AUDIO_SAMPLE_FORMAT eFormat, void* pDst, OMX_U32 nDstStride, const float* pSrc, OMX_U32 nSamples);
+
+/** Computes each output channel as a weighted sum of the input channels.
+ * The channels are planes of floating point samples
+ *
+ * @param pDst the output planes. They must not overlap the input planes
+ * @param pSrc the input planes
+ * @param nPlaneSize distance in samples between two planes, of the input and of the output
+ * @param pMatrix the weights, nInChannels for each output channel. A zero
+ * weight costs nothing
+ * @param nSamples number of samples of each plane
+ */
+void omx_audio_kernels_ChannelMatrix(float* pDst, const float* pSrc, OMX_U32 nPlaneSize, const float* pMatrix,
+                                     OMX_U32 nInChannels, OMX_U32 nOutChannels, OMX_U32 nSamples);
+
+/** Measures the levels of interleaved samples, adding them to the
+ * levels of the previous samples of the channels
+ *
+ * @param eFormat the layout of the samples
+ * @param pSrc the samples
+ * @param nChannels number of channels, at most OMX_AUDIO_MAXCHANNELS
+ * @param nFrames number of samples of each channel
+ * @param pPeak [in/out] the highest absolute value of each channel, where
+ * the full scale of the format is 1.0
+ * @param pSquares [in/out] the sum of the squares of each channel, on the same scale
+ * @param pClips [in/out] the number of samples of each channel at the
+ * highest or the lowest value of the format, or past 1.0 in floating point
+ */
+void omx_audio_kernels_Levels(AUDIO_SAMPLE_FORMAT eFormat, const void* pSrc, OMX_U32 nChannels, OMX_U32 nFrames,
+                              float* pPeak, double* pSquares, OMX_U32* pClips);
+
+/** Most sections of a cascade of biquad filters. The coefficients and
+ * the states of the sections are rows of this many values, so that the
+ * vector kernels load the same value of consecutive sections at once
+ */
+#define AUDIO_BIQUAD_SECTIONS 16
+
+/** The coefficients of a cascade of biquad filters, divided by a0.
+ * Section s computes y = b0 x + z1, then z1 = b1 x - a1 y + z2 and
+ * z2 = b2 x - a2 y, in the transposed direct form II. The sections past
+ * the cascade must pass the samples through, with b0 1 and the other
+ * coefficients 0
+ */
+typedef struct AUDIO_BIQUAD_COEFFS {
+  float b0[AUDIO_BIQUAD_SECTIONS];
+  float b1[AUDIO_BIQUAD_SECTIONS];
+  float b2[AUDIO_BIQUAD_SECTIONS];
+  float a1[AUDIO_BIQUAD_SECTIONS];
+  float a2[AUDIO_BIQUAD_SECTIONS];
+} AUDIO_BIQUAD_COEFFS;
+
+/** The state of the sections of a cascade for one channel. The states
+ * of the sections past the cascade must be 0
+ */
+typedef struct AUDIO_BIQUAD_STATE {
+  float z1[AUDIO_BIQUAD_SECTIONS];
+  float z2[AUDIO_BIQUAD_SECTIONS];
+} AUDIO_BIQUAD_STATE;
+
+/** Runs a cascade of biquad filters over interleaved floating point
+ * samples, each channel with its own state. All the instruction sets
+ * give the same samples
+ *
+ * @param pSamples the samples, replaced by the filtered ones
+ * @param nChannels number of channels
+ * @param nFrames number of samples of each channel
+ * @param pCoeffs the coefficients, the same for all the channels
+ * @param nSections number of sections of the cascade, at most AUDIO_BIQUAD_SECTIONS
+ * @param pState [in/out] the state of each channel
+ */
+void omx_audio_kernels_Biquad(float* pSamples, OMX_U32 nChannels, OMX_U32 nFrames, const AUDIO_BIQUAD_COEFFS* pCoeffs,
+                              OMX_U32 nSections, AUDIO_BIQUAD_STATE* pState);
+
+/** Runs a polyphase FIR filter over the samples of one channel, to
+ * change the sample rate by nPhases / nStep. The output sample n is the
+ * product of the nTaps samples starting at its position with the
+ * coefficients of its phase. The next sample is nStep phases further,
+ * each nPhases phases moving the position by one input sample
+ *
+ * @param pDst the filtered samples
+ * @param pSrc the input samples
+ * @param nSrcSamples number of input samples. The filter stops when an
+ * output sample would need samples past them
+ * @param pCoeffs the coefficients, nTaps for each phase, in the order of
+ * the input samples they multiply
+ * @param pPosition [in/out] the position in pSrc of the next output sample
+ * @param pPhase [in/out] the phase of the next output sample
+ * @param nMaxOut maximum number of output samples
+ *
+ * @return the number of output samples
+ */
+OMX_U32 omx_audio_kernels_Polyphase(float* pDst, const float* pSrc, OMX_U32 nSrcSamples, const float* pCoeffs, OMX_U32 nTaps,
+                                    OMX_U32 nPhases, OMX_U32 nStep, OMX_U32* pPosition, OMX_U32* pPhase, OMX_U32 nMaxOut);
+
+#endif
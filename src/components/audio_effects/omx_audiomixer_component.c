@@ -24,65 +24,160 @@
 
 */
 
+#include <unistd.h>
+#include <asm/unistd.h>
 #include <omxcore.h>
 #include <omx_base_audio_port.h>
 #include <omx_audiomixer_component.h>
+#include <omx_trace.h>
 #include<OMX_Audio.h>
 
 /* Gain value */
 #define GAIN_VALUE 100.0f
 
-OMX_ERRORTYPE omx_audio_mixer_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
-  OMX_ERRORTYPE err = OMX_ErrorNone;
-  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private;
-  omx_audio_mixer_component_PortType *pPort;//,*inPort1, *outPort;
-  OMX_U32 i;
+/** Operations on the bitmasks with one bit per port */
+#define MIXER_PORT_IS_SET(pMask, i) (((pMask)[(i) / 64] >> ((i) % 64)) & 1)
+#define MIXER_PORT_SET(pMask, i) ((pMask)[(i) / 64] |= (OMX_U64)1 << ((i) % 64))
+#define MIXER_PORT_CLEAR(pMask, i) ((pMask)[(i) / 64] &= ~((OMX_U64)1 << ((i) % 64)))
 
-  RM_RegisterComponent(MIXER_COMP_NAME, MAX_MIXER_COMPONENTS);
-  if (!openmaxStandComp->pComponentPrivate) {
-    DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, allocating component\n",__func__);
-    openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_audio_mixer_component_PrivateType));
-    if(openmaxStandComp->pComponentPrivate == NULL) {
-      return OMX_ErrorInsufficientResources;
+/** Returns the index of the first bit set in a bitmask from nFrom,
+ * or nPorts if there is none
+ */
+static OMX_U32 omx_audio_mixer_NextPort(const OMX_U64* pMask, OMX_U32 nPorts, OMX_U32 nFrom) {
+  OMX_U32 nWord = nFrom / 64;
+  OMX_U64 bits;
+
+  if (nFrom >= nPorts) {
+    return nPorts;
+  }
+  bits = pMask[nWord] & (~(OMX_U64)0 << (nFrom % 64));
+  while (!bits) {
+    if (++nWord >= MIXER_MASK_WORDS(nPorts)) {
+      return nPorts;
     }
-  } else {
-    DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+    bits = pMask[nWord];
   }
+  nFrom = nWord * 64 + __builtin_ctzll(bits);
+  return (nFrom < nPorts) ? nFrom : nPorts;
+}
 
-  omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
-  omx_audio_mixer_component_Private->ports = NULL;
+static void omx_audio_mixer_StopWorkers(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private);
 
-  /** Calling base filter constructor */
-  err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+/** Enabling or disabling an input port changes the share of the other inputs in the mix
+ */
+static OMX_ERRORTYPE omx_audio_mixer_port_EnablePort(omx_base_PortType *openmaxStandPort) {
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE err;
 
-  /*Assuming 4 input and 1 output ports*/
-  omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
-  omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = MAX_PORTS;
+  err = base_port_EnablePort(openmaxStandPort);
+  omx_audio_mixer_component_Private->bPortsChanged = OMX_TRUE;
+  omx_audio_mixer_component_Private->bGainsChanged = OMX_TRUE;
+  return err;
+}
 
-  /** Allocate Ports and call port constructor. */
-  if (omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_audio_mixer_component_Private->ports) {
-    omx_audio_mixer_component_Private->ports = calloc(omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
-    if (!omx_audio_mixer_component_Private->ports) {
-      return OMX_ErrorInsufficientResources;
-    }
+static OMX_ERRORTYPE omx_audio_mixer_port_DisablePort(omx_base_PortType *openmaxStandPort) {
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE err;
+
+  err = base_port_DisablePort(openmaxStandPort);
+  omx_audio_mixer_component_Private->bPortsChanged = OMX_TRUE;
+  omx_audio_mixer_component_Private->bGainsChanged = OMX_TRUE;
+  return err;
+}
+
+/** Frees the ports and the per port state of the buffer management thread
+ */
+static void omx_audio_mixer_FreePorts(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private) {
+  OMX_U32 i;
+
+  if (omx_audio_mixer_component_Private->ports) {
     for (i=0; i < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
-      omx_audio_mixer_component_Private->ports[i] = calloc(1, sizeof(omx_audio_mixer_component_PortType));
-      if (!omx_audio_mixer_component_Private->ports[i]) {
-        return OMX_ErrorInsufficientResources;
+      if(omx_audio_mixer_component_Private->ports[i]) {
+        free(((omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[i])->pJitterBuffers);
+      }
+      if(omx_audio_mixer_component_Private->ports[i] && omx_audio_mixer_component_Private->ports[i]->PortDestructor) {
+        omx_audio_mixer_component_Private->ports[i]->PortDestructor(omx_audio_mixer_component_Private->ports[i]);
+      } else {
+        free(omx_audio_mixer_component_Private->ports[i]);
       }
     }
+    free(omx_audio_mixer_component_Private->ports);
+    omx_audio_mixer_component_Private->ports=NULL;
   }
+  omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 0;
+
+  free((void*)omx_audio_mixer_component_Private->pSignalledPorts);
+  omx_audio_mixer_component_Private->pSignalledPorts = NULL;
+  free(omx_audio_mixer_component_Private->pPendingPorts);
+  omx_audio_mixer_component_Private->pPendingPorts = NULL;
+  free(omx_audio_mixer_component_Private->pHeldPorts);
+  omx_audio_mixer_component_Private->pHeldPorts = NULL;
+  free(omx_audio_mixer_component_Private->pEnabledPorts);
+  omx_audio_mixer_component_Private->pEnabledPorts = NULL;
+  free(omx_audio_mixer_component_Private->pEndedPorts);
+  omx_audio_mixer_component_Private->pEndedPorts = NULL;
+  free(omx_audio_mixer_component_Private->pMixSrc);
+  omx_audio_mixer_component_Private->pMixSrc = NULL;
+  free(omx_audio_mixer_component_Private->pMixSrcSamples);
+  omx_audio_mixer_component_Private->pMixSrcSamples = NULL;
+  free(omx_audio_mixer_component_Private->pMixSrcStart);
+  omx_audio_mixer_component_Private->pMixSrcStart = NULL;
+  free(omx_audio_mixer_component_Private->pMixGains);
+  omx_audio_mixer_component_Private->pMixGains = NULL;
+  omx_audio_mixer_component_Private->nMixStreams = 0;
+}
+
+OMX_ERRORTYPE omx_audio_mixer_component_SetPorts(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 nPorts) {
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
+  omx_audio_mixer_component_PortType *pPort;
+  OMX_U32 i, nWords = MIXER_MASK_WORDS(nPorts);
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s with %i ports\n", __func__, (int)nPorts);
+  omx_audio_mixer_FreePorts(omx_audio_mixer_component_Private);
+
+  /** Allocate Ports and the state of the buffer management thread */
+  omx_audio_mixer_component_Private->ports = calloc(nPorts, sizeof(omx_base_PortType *));
+  if (!omx_audio_mixer_component_Private->ports) {
+    return OMX_ErrorInsufficientResources;
+  }
+  omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+  omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = nPorts;
+  for (i=0; i < nPorts; i++) {
+    omx_audio_mixer_component_Private->ports[i] = calloc(1, sizeof(omx_audio_mixer_component_PortType));
+    if (!omx_audio_mixer_component_Private->ports[i]) {
+      omx_audio_mixer_FreePorts(omx_audio_mixer_component_Private);
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  omx_audio_mixer_component_Private->pSignalledPorts = calloc(nWords, sizeof(OMX_U64));
+  omx_audio_mixer_component_Private->pPendingPorts = calloc(nWords, sizeof(OMX_U64));
+  omx_audio_mixer_component_Private->pHeldPorts = calloc(nWords, sizeof(OMX_U64));
+  omx_audio_mixer_component_Private->pEnabledPorts = calloc(nWords, sizeof(OMX_U64));
+  omx_audio_mixer_component_Private->pEndedPorts = calloc(nWords, sizeof(OMX_U64));
+  omx_audio_mixer_component_Private->pMixSrc = calloc(nPorts, sizeof(const void*));
+  omx_audio_mixer_component_Private->pMixSrcSamples = calloc(nPorts, sizeof(OMX_U32));
+  omx_audio_mixer_component_Private->pMixSrcStart = calloc(nPorts, sizeof(OMX_U32));
+  omx_audio_mixer_component_Private->pMixGains = calloc(nPorts, sizeof(OMX_S32));
+  if (!omx_audio_mixer_component_Private->pSignalledPorts || !omx_audio_mixer_component_Private->pPendingPorts ||
+      !omx_audio_mixer_component_Private->pHeldPorts || !omx_audio_mixer_component_Private->pEnabledPorts ||
+      !omx_audio_mixer_component_Private->pEndedPorts ||
+      !omx_audio_mixer_component_Private->pMixSrc || !omx_audio_mixer_component_Private->pMixSrcSamples ||
+      !omx_audio_mixer_component_Private->pMixSrcStart || !omx_audio_mixer_component_Private->pMixGains) {
+    omx_audio_mixer_FreePorts(omx_audio_mixer_component_Private);
+    return OMX_ErrorInsufficientResources;
+  }
+  omx_audio_mixer_component_Private->nMixStreams = nPorts;
 
   /* construct all input ports */
-  for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts-1;i++) {
+  for(i=0;i<nPorts-1;i++) {
     base_audio_port_Constructor(openmaxStandComp, &omx_audio_mixer_component_Private->ports[i], i, OMX_TRUE);
   }
 
   /* construct one output port */
-  base_audio_port_Constructor(openmaxStandComp, &omx_audio_mixer_component_Private->ports[omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts-1], omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts-1, OMX_FALSE);
+  base_audio_port_Constructor(openmaxStandComp, &omx_audio_mixer_component_Private->ports[nPorts-1], nPorts-1, OMX_FALSE);
 
   /** Domain specific section for the ports. */
-  for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts;i++) {
+  for(i=0;i<nPorts;i++) {
     pPort = (omx_audio_mixer_component_PortType *) omx_audio_mixer_component_Private->ports[i];
 
     pPort->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
@@ -105,12 +200,66 @@ OMX_ERRORTYPE omx_audio_mixer_component_Constructor(OMX_COMPONENTTYPE *openmaxSt
     pPort->sVolume.sVolume.nValue = (OMX_S32)GAIN_VALUE;
     pPort->sVolume.sVolume.nMin = 0;   /**< minimum for value (i.e. nValue >= nMin) */
     pPort->sVolume.sVolume.nMax = (OMX_S32)GAIN_VALUE;
+    pPort->nGainFactor = 0;
+
+    pPort->Port_EnablePort = omx_audio_mixer_port_EnablePort;
+    pPort->Port_DisablePort = omx_audio_mixer_port_DisablePort;
+
+    /* the callbacks of the IL client have been given to the previous ports */
+    if (omx_audio_mixer_component_Private->callbacks) {
+      pPort->BufferProcessedCallback = (i < nPorts - 1) ? omx_audio_mixer_component_Private->callbacks->EmptyBufferDone :
+                                                          omx_audio_mixer_component_Private->callbacks->FillBufferDone;
+    }
+  }
+  /* the new ports start from the default layout */
+  omx_audio_mixer_component_Private->eSampleFormat = AUDIO_SAMPLE_S16;
+  omx_audio_mixer_component_Private->bGainsChanged = OMX_TRUE;
+  omx_audio_mixer_component_Private->bPortsChanged = OMX_TRUE;
+  omx_audio_mixer_component_Private->sPeriod.nPortIndex = nPorts - 1;
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE omx_audio_mixer_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private;
+  OMX_U32 i;
+
+  RM_RegisterComponent(MIXER_COMP_NAME, MAX_MIXER_COMPONENTS);
+  if (!openmaxStandComp->pComponentPrivate) {
+    DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, allocating component\n",__func__);
+    openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_audio_mixer_component_PrivateType));
+    if(openmaxStandComp->pComponentPrivate == NULL) {
+      return OMX_ErrorInsufficientResources;
+    }
+  } else {
+    DEBUG(DEB_LEV_FUNCTION_NAME, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+  }
+
+  omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
+  omx_audio_mixer_component_Private->ports = NULL;
+
+  /* by default the period is the length of the first input buffer, and the inputs are not delayed */
+  setHeader(&omx_audio_mixer_component_Private->sPeriod, sizeof(OMX_CONFIG_BELLAGIOMIXERPERIODTYPE));
+  omx_audio_mixer_component_Private->sPeriod.nPeriodSamples = 0;
+  omx_audio_mixer_component_Private->sPeriod.nMaxLatenessMs = 0;
+  omx_audio_mixer_component_Private->sPeriod.nJitterBuffers = 1;
+  omx_audio_mixer_component_Private->sPeriod.nMixThreads = 1;
+
+  /** Calling base filter constructor */
+  err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+
+  /* The input ports can be changed in Loaded state through OMX_IndexParamAudioInit */
+  err = omx_audio_mixer_component_SetPorts(openmaxStandComp, MIXER_DEFAULT_INPUT_PORTS + 1);
+  if (err != OMX_ErrorNone) {
+    return err;
   }
 
   omx_audio_mixer_component_Private->destructor = omx_audio_mixer_component_Destructor;
   openmaxStandComp->SetParameter = omx_audio_mixer_component_SetParameter;
   openmaxStandComp->GetParameter = omx_audio_mixer_component_GetParameter;
   openmaxStandComp->GetConfig = omx_audio_mixer_component_GetConfig;
+  openmaxStandComp->GetExtensionIndex = omx_audio_mixer_component_GetExtensionIndex;
   openmaxStandComp->SetConfig = omx_audio_mixer_component_SetConfig;
   omx_audio_mixer_component_Private->BufferMgmtCallback = omx_audio_mixer_component_BufferMgmtCallback;
   omx_audio_mixer_component_Private->BufferMgmtFunction = omx_audio_mixer_BufferMgmtFunction;
@@ -134,18 +283,11 @@ OMX_ERRORTYPE omx_audio_mixer_component_Constructor(OMX_COMPONENTTYPE *openmaxSt
 OMX_ERRORTYPE omx_audio_mixer_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
 
   omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
-  OMX_U32 i;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
+  omx_audio_mixer_StopWorkers(omx_audio_mixer_component_Private);
   /* frees port/s */
-  if (omx_audio_mixer_component_Private->ports) {
-    for (i=0; i < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
-      if(omx_audio_mixer_component_Private->ports[i])
-        omx_audio_mixer_component_Private->ports[i]->PortDestructor(omx_audio_mixer_component_Private->ports[i]);
-    }
-    free(omx_audio_mixer_component_Private->ports);
-    omx_audio_mixer_component_Private->ports=NULL;
-  }
+  omx_audio_mixer_FreePorts(omx_audio_mixer_component_Private);
 
   omx_base_filter_Destructor(openmaxStandComp);
 
@@ -154,40 +296,353 @@ OMX_ERRORTYPE omx_audio_mixer_component_Destructor(OMX_COMPONENTTYPE *openmaxSta
   return OMX_ErrorNone;
 }
 
-/** This function is used to process the input buffer and provide one output buffer
-  */
-void omx_audio_mixer_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInBuffer, OMX_BUFFERHEADERTYPE* pOutBuffer) {
-  OMX_S32 denominator=0;
-  OMX_U32 i,sampleCount = pInBuffer->nFilledLen / 2; // signed 16 bit samples assumed
-  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
+/** Computes the share of each input port in the mix, from the volumes of
+ * the enabled input ports. It runs only when a volume changes or a port
+ * is enabled or disabled
+ */
+static void omx_audio_mixer_UpdateGains(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private) {
   omx_audio_mixer_component_PortType* pPort;
+  OMX_U32 i, nInputPorts = omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts - 1;
+  OMX_S64 denominator = 0;
 
-  for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts-1;i++) {
+  if (!omx_audio_mixer_component_Private->bGainsChanged) {
+    return;
+  }
+  omx_audio_mixer_component_Private->bGainsChanged = OMX_FALSE;
+
+  /* the gains stay in [0, AUDIO_GAIN_UNITY] whatever the volumes, the kernels rely on it */
+  for(i=0;i<nInputPorts;i++) {
+    pPort = (omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[i];
+    if (PORT_IS_ENABLED(pPort) && pPort->sVolume.sVolume.nValue > 0) {
+      denominator += pPort->sVolume.sVolume.nValue;
+    }
+  }
+  for(i=0;i<nInputPorts;i++) {
     pPort = (omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[i];
-    if(PORT_IS_ENABLED(pPort)){
-      denominator+=pPort->sVolume.sVolume.nValue;
+    if (PORT_IS_ENABLED(pPort) && pPort->sVolume.sVolume.nValue > 0 && denominator > 0) {
+      pPort->nGainFactor = (OMX_S32)(((OMX_S64)pPort->sVolume.sVolume.nValue * AUDIO_GAIN_UNITY + denominator / 2) / denominator);
+    } else {
+      pPort->nGainFactor = 0;
     }
+    DEBUG(DEB_LEV_FULL_SEQ, "In %s port %i gain factor %i\n", __func__, (int)i, (int)pPort->nGainFactor);
   }
+}
+
+/** The threads sharing the mix of a period with the buffer management thread.
+ * The period is cut in slices aligned on AUDIO_MIX_BLOCK, that the threads
+ * take in turn from a ticket, so that the output is the same whatever the
+ * thread mixing a slice
+ */
+struct omx_audio_mixer_workers {
+  omx_audio_mixer_component_PrivateType* pPrivate;
+  pthread_t* pThreads;
+  OMX_U32 nThreads; /**< number of worker threads, the buffer management thread excluded */
+  tsem_t sWorkSem; /**< raised once for each worker that can take a slice */
+  tsem_t sDoneSem; /**< raised by the worker that completes the last slice */
+  volatile OMX_U64 nTicket; /**< the number of slices in the high half, the next slice to take in the low half */
+  volatile int nSlicesLeft; /**< the slices not completed yet */
+  volatile OMX_BOOL bStop;
+  void* pDst;
+  OMX_U32 nStreams;
+  OMX_U32 nSamples;
+  OMX_U32 nSliceSamples;
+};
+
+/** Mixes slices of the current period until there is none left to take.
+ * Returns the number of slices mixed
+ */
+static int omx_audio_mixer_MixSlices(omx_audio_mixer_workers* pWorkers) {
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = pWorkers->pPrivate;
+  OMX_U64 nTicket;
+  OMX_U32 nFirst;
+  int nDone = 0;
+
+  for (;;) {
+    /* the ticket also carries the number of slices, so that a late worker
+     * never takes a slice of a period already completed */
+    nTicket = __sync_fetch_and_add(&pWorkers->nTicket, 1);
+    if ((nTicket & 0xFFFFFFFF) >= (nTicket >> 32)) {
+      return nDone;
+    }
+    nFirst = (OMX_U32)(nTicket & 0xFFFFFFFF) * pWorkers->nSliceSamples;
+    omx_audio_kernels_MixSlice(omx_audio_mixer_component_Private->eSampleFormat, pWorkers->pDst, omx_audio_mixer_component_Private->pMixSrc,
+                               omx_audio_mixer_component_Private->pMixSrcSamples, omx_audio_mixer_component_Private->pMixSrcStart,
+                               omx_audio_mixer_component_Private->pMixGains, pWorkers->nStreams, nFirst,
+                               pWorkers->nSamples - nFirst < pWorkers->nSliceSamples ? pWorkers->nSamples - nFirst : pWorkers->nSliceSamples);
+    nDone++;
+  }
+}
+
+static void* omx_audio_mixer_WorkerFunction(void* param) {
+  omx_audio_mixer_workers* pWorkers = (omx_audio_mixer_workers*)param;
+  int nDone;
+
+  for (;;) {
+    tsem_down(&pWorkers->sWorkSem);
+    if (pWorkers->bStop) {
+      break;
+    }
+    nDone = omx_audio_mixer_MixSlices(pWorkers);
+    if (nDone > 0 && __sync_sub_and_fetch(&pWorkers->nSlicesLeft, nDone) == 0) {
+      tsem_up(&pWorkers->sDoneSem);
+    }
+  }
+  return NULL;
+}
+
+/** Stops the threads sharing the mix, if any
+ */
+static void omx_audio_mixer_StopWorkers(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private) {
+  omx_audio_mixer_workers* pWorkers = omx_audio_mixer_component_Private->pMixWorkers;
+  OMX_U32 i;
+
+  if (!pWorkers) {
+    return;
+  }
+  pWorkers->bStop = OMX_TRUE;
+  tsem_up_n(&pWorkers->sWorkSem, pWorkers->nThreads);
+  for (i = 0; i < pWorkers->nThreads; i++) {
+    pthread_join(pWorkers->pThreads[i], NULL);
+  }
+  tsem_deinit(&pWorkers->sWorkSem);
+  tsem_deinit(&pWorkers->sDoneSem);
+  free(pWorkers->pThreads);
+  free(pWorkers);
+  omx_audio_mixer_component_Private->pMixWorkers = NULL;
+}
+
+/** Starts the threads sharing the mix, as many as sPeriod.nMixThreads asks
+ * besides the buffer management thread. It runs in the buffer management thread
+ */
+static void omx_audio_mixer_StartWorkers(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private) {
+  omx_audio_mixer_workers* pWorkers = omx_audio_mixer_component_Private->pMixWorkers;
+  OMX_U32 nThreads = omx_audio_mixer_component_Private->sPeriod.nMixThreads > 1 ? omx_audio_mixer_component_Private->sPeriod.nMixThreads - 1 : 0;
+
+  if (pWorkers && pWorkers->nThreads == nThreads) {
+    return;
+  }
+  omx_audio_mixer_StopWorkers(omx_audio_mixer_component_Private);
+  if (nThreads == 0) {
+    return;
+  }
+  pWorkers = calloc(1, sizeof(omx_audio_mixer_workers));
+  if (!pWorkers) {
+    return;
+  }
+  pWorkers->pThreads = calloc(nThreads, sizeof(pthread_t));
+  if (!pWorkers->pThreads || tsem_init(&pWorkers->sWorkSem, 0) != 0 || tsem_init(&pWorkers->sDoneSem, 0) != 0) {
+    free(pWorkers->pThreads);
+    free(pWorkers);
+    return;
+  }
+  pWorkers->pPrivate = omx_audio_mixer_component_Private;
+  for (pWorkers->nThreads = 0; pWorkers->nThreads < nThreads; pWorkers->nThreads++) {
+    if (pthread_create(&pWorkers->pThreads[pWorkers->nThreads], NULL, omx_audio_mixer_WorkerFunction, pWorkers) != 0) {
+      DEBUG(DEB_LEV_ERR, "In %s only %i mix threads started\n", __func__, (int)pWorkers->nThreads);
+      break;
+    }
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s %i mix threads\n", __func__, (int)pWorkers->nThreads);
+  omx_audio_mixer_component_Private->pMixWorkers = pWorkers;
+}
+
+/** Mixes the streams prepared in the private arrays, in slices shared with
+ * the mix threads when the output is long enough
+ */
+static void omx_audio_mixer_MixStreams(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private, void* pDst, OMX_U32 nStreams, OMX_U32 nSamples) {
+  omx_audio_mixer_workers* pWorkers;
+  OMX_U32 nSlices;
+  int nDone;
+
+  omx_audio_mixer_StartWorkers(omx_audio_mixer_component_Private);
+  pWorkers = omx_audio_mixer_component_Private->pMixWorkers;
+  nSlices = pWorkers ? pWorkers->nThreads + 1 : 1;
+  if (nSlices > nSamples / MIXER_MIN_SLICE) {
+    nSlices = nSamples / MIXER_MIN_SLICE;
+  }
+  if (nSlices < 2) {
+    omx_audio_kernels_Mix(omx_audio_mixer_component_Private->eSampleFormat, pDst, omx_audio_mixer_component_Private->pMixSrc,
+                          omx_audio_mixer_component_Private->pMixSrcSamples, omx_audio_mixer_component_Private->pMixSrcStart,
+                          omx_audio_mixer_component_Private->pMixGains, nStreams, nSamples);
+    return;
+  }
+
+  pWorkers->pDst = pDst;
+  pWorkers->nStreams = nStreams;
+  pWorkers->nSamples = nSamples;
+  pWorkers->nSliceSamples = (nSamples + nSlices - 1) / nSlices;
+  pWorkers->nSliceSamples = (pWorkers->nSliceSamples + AUDIO_MIX_BLOCK - 1) / AUDIO_MIX_BLOCK * AUDIO_MIX_BLOCK;
+  nSlices = (nSamples + pWorkers->nSliceSamples - 1) / pWorkers->nSliceSamples;
+  pWorkers->nSlicesLeft = nSlices;
+  /* publishing the ticket hands the period to the workers: the release store
+   * orders the period set up above before it, the full barrier of the
+   * workers' fetch and add pairs with it */
+  __atomic_store_n(&pWorkers->nTicket, (OMX_U64)nSlices << 32, __ATOMIC_RELEASE);
+  tsem_up_n(&pWorkers->sWorkSem, nSlices - 1 < pWorkers->nThreads ? nSlices - 1 : pWorkers->nThreads);
+
+  nDone = omx_audio_mixer_MixSlices(pWorkers);
+  /* the last slice wakes up this thread, unless this thread completed it */
+  if (nDone == 0 || __sync_sub_and_fetch(&pWorkers->nSlicesLeft, nDone) != 0) {
+    tsem_down(&pWorkers->sDoneSem);
+  }
+}
+
+void omx_audio_mixer_component_MixBuffers(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE** ppInBuffers, OMX_U32 nInBuffers, OMX_BUFFERHEADERTYPE* pOutBuffer) {
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
+  omx_audio_mixer_component_PortType* pPort;
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(omx_audio_mixer_component_Private->eSampleFormat);
+  const void** pSrc = omx_audio_mixer_component_Private->pMixSrc;
+  OMX_U32* nSrcSamples = omx_audio_mixer_component_Private->pMixSrcSamples;
+  OMX_S32* nGains = omx_audio_mixer_component_Private->pMixGains;
+  OMX_U32 i, sampleCount = 0;
+
+  omx_audio_mixer_UpdateGains(omx_audio_mixer_component_Private);
+
+  for (i = 0; i < nInBuffers; i++) {
+    pPort = (omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[ppInBuffers[i]->nInputPortIndex];
+    pSrc[i] = ppInBuffers[i]->pBuffer + ppInBuffers[i]->nOffset;
+    nSrcSamples[i] = ppInBuffers[i]->nFilledLen / nSampleSize;
+    nGains[i] = pPort->nGainFactor;
+    if (nSrcSamples[i] > sampleCount) {
+      sampleCount = nSrcSamples[i];
+    }
+  }
+  /* the output never holds more than it can */
+  if (sampleCount > pOutBuffer->nAllocLen / nSampleSize) {
+    sampleCount = pOutBuffer->nAllocLen / nSampleSize;
+  }
+
+  for (i = 0; i < nInBuffers; i++) {
+    omx_audio_mixer_component_Private->pMixSrcStart[i] = 0;
+  }
+  omx_audio_mixer_MixStreams(omx_audio_mixer_component_Private, pOutBuffer->pBuffer, nInBuffers, sampleCount);
+
+  pOutBuffer->nOffset = 0;
+  pOutBuffer->nFilledLen = sampleCount * nSampleSize;
+  for (i = 0; i < nInBuffers; i++) {
+    ppInBuffers[i]->nFilledLen = 0;
+  }
+}
+
+/** Makes room for nStreams streams in the arrays given to the mix kernel
+ */
+static OMX_ERRORTYPE omx_audio_mixer_ReserveStreams(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private, OMX_U32 nStreams) {
+  const void** pMixSrc;
+  OMX_U32 *pMixSrcSamples, *pMixSrcStart;
+  OMX_S32* pMixGains;
+
+  if (nStreams <= omx_audio_mixer_component_Private->nMixStreams) {
+    return OMX_ErrorNone;
+  }
+  pMixSrc = realloc(omx_audio_mixer_component_Private->pMixSrc, nStreams * sizeof(const void*));
+  if (pMixSrc) {
+    omx_audio_mixer_component_Private->pMixSrc = pMixSrc;
+  }
+  pMixSrcSamples = realloc(omx_audio_mixer_component_Private->pMixSrcSamples, nStreams * sizeof(OMX_U32));
+  if (pMixSrcSamples) {
+    omx_audio_mixer_component_Private->pMixSrcSamples = pMixSrcSamples;
+  }
+  pMixSrcStart = realloc(omx_audio_mixer_component_Private->pMixSrcStart, nStreams * sizeof(OMX_U32));
+  if (pMixSrcStart) {
+    omx_audio_mixer_component_Private->pMixSrcStart = pMixSrcStart;
+  }
+  pMixGains = realloc(omx_audio_mixer_component_Private->pMixGains, nStreams * sizeof(OMX_S32));
+  if (pMixGains) {
+    omx_audio_mixer_component_Private->pMixGains = pMixGains;
+  }
+  if (!pMixSrc || !pMixSrcSamples || !pMixSrcStart || !pMixGains) {
+    return OMX_ErrorInsufficientResources;
+  }
+  omx_audio_mixer_component_Private->nMixStreams = nStreams;
+  return OMX_ErrorNone;
+}
 
-  pPort = (omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[pInBuffer->nInputPortIndex];
+void omx_audio_mixer_component_MixPeriod(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pOutBuffer, OMX_U32 nSamples, OMX_BOOL bDrain) {
+  omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
+  omx_audio_mixer_component_PortType* pPort;
+  OMX_BUFFERHEADERTYPE* pBuffer;
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(omx_audio_mixer_component_Private->eSampleFormat);
+  OMX_U32 nOutputPortIndex = omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts - 1;
+  OMX_U32 i, k, nCount, nPos, nStreams = 0, nOutSamples = 0;
+  OMX_BOOL bTimeStamp = OMX_FALSE;
+
+  omx_audio_mixer_UpdateGains(omx_audio_mixer_component_Private);
 
-  /*Copy the first buffer with appropriate gain*/
-  if(pOutBuffer->nFilledLen == 0) {
-    memset(pOutBuffer->pBuffer,0,pInBuffer->nFilledLen);
+  /* the output never holds more than it can */
+  if (nSamples > pOutBuffer->nAllocLen / nSampleSize) {
+    nSamples = pOutBuffer->nAllocLen / nSampleSize;
+  }
+  for (i = omx_audio_mixer_NextPort(omx_audio_mixer_component_Private->pHeldPorts, nOutputPortIndex, 0); i < nOutputPortIndex;
+       i = omx_audio_mixer_NextPort(omx_audio_mixer_component_Private->pHeldPorts, nOutputPortIndex, i + 1)) {
+    nStreams += ((omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[i])->nJitterCount;
+  }
+  if (omx_audio_mixer_ReserveStreams(omx_audio_mixer_component_Private, nStreams) != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "In %s no memory to mix %i streams\n", __func__, (int)nStreams);
+    return;
+  }
 
-    for (i = 0; i < sampleCount; i++) {
-      ((OMX_S16*) pOutBuffer->pBuffer)[i] = (OMX_S16)
-              ((((OMX_S16*) pInBuffer->pBuffer)[i] * pPort->sVolume.sVolume.nValue ) / denominator);
+  nStreams = 0;
+  for (i = omx_audio_mixer_NextPort(omx_audio_mixer_component_Private->pHeldPorts, nOutputPortIndex, 0); i < nOutputPortIndex;
+       i = omx_audio_mixer_NextPort(omx_audio_mixer_component_Private->pHeldPorts, nOutputPortIndex, i + 1)) {
+    pPort = (omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[i];
+    pPort->nJitterConsumed = 0;
+    /* a port still gathering its buffers contributes silence, unless its stream ends */
+    if (!PORT_IS_ENABLED(pPort) || (!pPort->bJitterPrimed && pPort->nJitterEOS == 0)) {
+      continue;
     }
-  } else { // For the second buffer add with the first buffer with gain
-    for (i = 0; i < sampleCount; i++) {
-      ((OMX_S16*) pOutBuffer->pBuffer)[i] += (OMX_S16)
-                ((((OMX_S16*) pInBuffer->pBuffer)[i] * pPort->sVolume.sVolume.nValue ) / denominator);
+    nPos = 0;
+    for (k = 0; k < pPort->nJitterCount; k++) {
+      pBuffer = pPort->pJitterBuffers[(pPort->nJitterHead + k) % pPort->nJitterSize];
+      nCount = pBuffer->nFilledLen / nSampleSize;
+      if (nCount > nSamples - nPos) {
+        nCount = nSamples - nPos;
+      }
+      if (nCount > 0) {
+        if (!bTimeStamp) {
+          pOutBuffer->nTimeStamp = pBuffer->nTimeStamp;
+          bTimeStamp = OMX_TRUE;
+        }
+        omx_audio_mixer_component_Private->pMixSrc[nStreams] = pBuffer->pBuffer + pBuffer->nOffset;
+        omx_audio_mixer_component_Private->pMixSrcSamples[nStreams] = nCount;
+        omx_audio_mixer_component_Private->pMixSrcStart[nStreams] = nPos;
+        omx_audio_mixer_component_Private->pMixGains[nStreams] = pPort->nGainFactor;
+        nStreams++;
+        nPos += nCount;
+        pBuffer->nOffset += nCount * nSampleSize;
+        pBuffer->nFilledLen -= nCount * nSampleSize;
+      }
+      /* the unread samples of a buffer carry over to the next period */
+      if (pBuffer->nFilledLen >= nSampleSize) {
+        break;
+      }
+      pBuffer->nFilledLen = 0;
+      pPort->nJitterConsumed++;
+    }
+    pPort->nJitterSamples -= nPos;
+    if (nPos < nSamples && pPort->nJitterEOS == 0) {
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s underrun of port %i: %i samples of %i\n", __func__, (int)i, (int)nPos, (int)nSamples);
+      pPort->bJitterPrimed = OMX_FALSE;
     }
+    if (nPos > nOutSamples) {
+      nOutSamples = nPos;
+    }
+  }
+  if (!bDrain) {
+    nOutSamples = nSamples;
   }
 
-  pOutBuffer->nFilledLen = pInBuffer->nFilledLen;
-  pInBuffer->nFilledLen=0;
+  omx_audio_mixer_MixStreams(omx_audio_mixer_component_Private, pOutBuffer->pBuffer, nStreams, nOutSamples);
+
+  pOutBuffer->nOffset = 0;
+  pOutBuffer->nFilledLen = nOutSamples * nSampleSize;
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+  * The buffer management function mixes all the inputs at once through
+  * omx_audio_mixer_component_MixBuffers, this is the equivalent for a single input
+  */
+void omx_audio_mixer_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInBuffer, OMX_BUFFERHEADERTYPE* pOutBuffer) {
+  omx_audio_mixer_component_MixBuffers(openmaxStandComp, &pInBuffer, 1, pOutBuffer);
 }
 
 /** setting configurations */
@@ -197,27 +652,60 @@ OMX_ERRORTYPE omx_audio_mixer_component_SetConfig(
   OMX_PTR pComponentConfigStructure) {
 
   OMX_AUDIO_CONFIG_VOLUMETYPE* pVolume;
+  OMX_CONFIG_BELLAGIOMIXERPERIODTYPE* pPeriod;
   OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
   omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
   omx_audio_mixer_component_PortType * pPort;
+  OMX_U32 i;
   OMX_ERRORTYPE err = OMX_ErrorNone;
 
-  switch (nIndex) {
+  switch ((OMX_U32)nIndex) {
     case OMX_IndexConfigAudioVolume :
       pVolume = (OMX_AUDIO_CONFIG_VOLUMETYPE*) pComponentConfigStructure;
-      if(pVolume->sVolume.nValue > 100) {
+      if(pVolume->sVolume.nValue < 0 || pVolume->sVolume.nValue > 100) {
         err =  OMX_ErrorBadParameter;
         break;
       }
 
-      if (pVolume->nPortIndex <= omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+      if (pVolume->nPortIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
         pPort= (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[pVolume->nPortIndex];
         DEBUG(DEB_LEV_SIMPLE_SEQ, "Port %i Gain=%d\n",(int)pVolume->nPortIndex,(int)pVolume->sVolume.nValue);
         memcpy(&pPort->sVolume, pVolume, sizeof(OMX_AUDIO_CONFIG_VOLUMETYPE));
+        omx_audio_mixer_component_Private->bGainsChanged = OMX_TRUE;
       } else {
         err = OMX_ErrorBadPortIndex;
       }
       break;
+    case OMX_IndexConfigBellagioMixerPeriod :
+      pPeriod = (OMX_CONFIG_BELLAGIOMIXERPERIODTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOMIXERPERIODTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pPeriod->nPortIndex != omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts - 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      if (pPeriod->nJitterBuffers == 0 || pPeriod->nMixThreads > MIXER_MAX_MIX_THREADS) {
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* an input never holds more buffers than it has, it would never be primed */
+      for (i = 0; i < pPeriod->nPortIndex; i++) {
+        pPort = (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[i];
+        if (PORT_IS_ENABLED(pPort) && pPeriod->nJitterBuffers > pPort->sPortParam.nBufferCountActual) {
+          DEBUG(DEB_LEV_ERR, "In %s %i jitter buffers while port %i has %i buffers\n", __func__,
+                (int)pPeriod->nJitterBuffers, (int)i, (int)pPort->sPortParam.nBufferCountActual);
+          err = OMX_ErrorBadParameter;
+          break;
+        }
+      }
+      if (err != OMX_ErrorNone) {
+        break;
+      }
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "Period of %i samples, lateness %i ms, %i jitter buffers, %i mix threads\n",
+            (int)pPeriod->nPeriodSamples, (int)pPeriod->nMaxLatenessMs, (int)pPeriod->nJitterBuffers, (int)pPeriod->nMixThreads);
+      memcpy(&omx_audio_mixer_component_Private->sPeriod, pPeriod, sizeof(OMX_CONFIG_BELLAGIOMIXERPERIODTYPE));
+      break;
     default: // delegate to superclass
       err = omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
   }
@@ -229,27 +717,55 @@ OMX_ERRORTYPE omx_audio_mixer_component_GetConfig(
   OMX_INDEXTYPE nIndex,
   OMX_PTR pComponentConfigStructure) {
   OMX_AUDIO_CONFIG_VOLUMETYPE           *pVolume;
+  OMX_CONFIG_BELLAGIOMIXERPERIODTYPE    *pPeriod;
   OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
   omx_audio_mixer_component_PrivateType *omx_audio_mixer_component_Private = openmaxStandComp->pComponentPrivate;
   omx_audio_mixer_component_PortType    *pPort;
   OMX_ERRORTYPE err = OMX_ErrorNone;
 
-  switch (nIndex) {
+  switch ((OMX_U32)nIndex) {
     case OMX_IndexConfigAudioVolume :
       pVolume = (OMX_AUDIO_CONFIG_VOLUMETYPE*) pComponentConfigStructure;
-      if (pVolume->nPortIndex <= omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+      if (pVolume->nPortIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
         pPort= (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[pVolume->nPortIndex];
         memcpy(pVolume,&pPort->sVolume,sizeof(OMX_AUDIO_CONFIG_VOLUMETYPE));
       } else {
         err = OMX_ErrorBadPortIndex;
       }
       break;
+    case OMX_IndexConfigBellagioMixerPeriod :
+      pPeriod = (OMX_CONFIG_BELLAGIOMIXERPERIODTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOMIXERPERIODTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pPeriod->nPortIndex == omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts - 1) {
+        memcpy(pPeriod, &omx_audio_mixer_component_Private->sPeriod, sizeof(OMX_CONFIG_BELLAGIOMIXERPERIODTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
     default :
       err = omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
   }
   return err;
 }
 
+/** Resolves the mixer period extension, then falls back on the names
+  * known to the base component
+  */
+OMX_ERRORTYPE omx_audio_mixer_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if (strcmp(cParameterName, "OMX.st.index.config.BellagioMixerPeriod") == 0) {
+    *pIndexType = OMX_IndexConfigBellagioMixerPeriod;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
+
 OMX_ERRORTYPE omx_audio_mixer_component_SetParameter(
   OMX_HANDLETYPE hComponent,
   OMX_INDEXTYPE nParamIndex,
@@ -257,8 +773,11 @@ OMX_ERRORTYPE omx_audio_mixer_component_SetParameter(
 
   OMX_ERRORTYPE                   err = OMX_ErrorNone;
   OMX_AUDIO_PARAM_PORTFORMATTYPE  *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE     *pAudioPcmMode;
   OMX_PARAM_COMPONENTROLETYPE     *pComponentRole;
+  OMX_PORT_PARAM_TYPE             *pPortParam;
   OMX_U32                         portIndex;
+  AUDIO_SAMPLE_FORMAT             eSampleFormat;
   omx_audio_mixer_component_PortType *port;
 
   /* Check which structure we are being fed and make control its header */
@@ -270,6 +789,34 @@ OMX_ERRORTYPE omx_audio_mixer_component_SetParameter(
 
   DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
   switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      /* nPorts - 1 input ports, followed by the output port */
+      pPortParam = (OMX_PORT_PARAM_TYPE*)ComponentParameterStructure;
+      if ((omx_audio_mixer_component_Private->state != OMX_StateLoaded && omx_audio_mixer_component_Private->state != OMX_StateWaitForResources) ||
+          omx_audio_mixer_component_Private->transientState != OMX_TransStateMax) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_audio_mixer_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pPortParam->nStartPortNumber != 0 || pPortParam->nPorts < 2 || pPortParam->nPorts > MIXER_MAX_INPUT_PORTS + 1) {
+        DEBUG(DEB_LEV_ERR, "In %s %i ports requested, the mixer supports from 1 to %i input ports\n", __func__, (int)pPortParam->nPorts, MIXER_MAX_INPUT_PORTS);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      if (pPortParam->nPorts == omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+        break;
+      }
+      for (portIndex = 0; portIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; portIndex++) {
+        if (PORT_IS_TUNNELED(omx_audio_mixer_component_Private->ports[portIndex]) ||
+            omx_audio_mixer_component_Private->ports[portIndex]->nNumAssignedBuffers > 0) {
+          DEBUG(DEB_LEV_ERR, "In %s port %i is in use, the ports cannot be changed\n", __func__, (int)portIndex);
+          return OMX_ErrorIncorrectStateOperation;
+        }
+      }
+      err = omx_audio_mixer_component_SetPorts(openmaxStandComp, pPortParam->nPorts);
+      break;
     case OMX_IndexParamAudioPortFormat:
       pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
       portIndex = pAudioPortFormat->nPortIndex;
@@ -278,13 +825,45 @@ OMX_ERRORTYPE omx_audio_mixer_component_SetParameter(
         DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
         break;
       }
-      if (portIndex <= omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+      if (portIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
         port= (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[portIndex];
         memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
       } else {
         err = OMX_ErrorBadPortIndex;
       }
       break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex >= omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      eSampleFormat = omx_audio_kernels_GetSampleFormat(pAudioPcmMode);
+      if (eSampleFormat == AUDIO_SAMPLE_UNSUPPORTED) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported PCM layout of %i bits\n",__func__,(int)pAudioPcmMode->nBitPerSample);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* the streams are mixed sample by sample, so the layout applies to all the ports.
+       * The buffer management thread mixes with it, so it changes only while loaded */
+      if (omx_audio_mixer_component_Private->state != OMX_StateLoaded && omx_audio_mixer_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_audio_mixer_component_Private->state,__LINE__);
+        err = OMX_ErrorIncorrectStateOperation;
+        break;
+      }
+      for (portIndex = 0; portIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; portIndex++) {
+        port = (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[portIndex];
+        memcpy(&port->pAudioPcmMode, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+        port->pAudioPcmMode.nPortIndex = portIndex;
+      }
+      omx_audio_mixer_component_Private->eSampleFormat = eSampleFormat;
+      break;
     case OMX_IndexParamStandardComponentRole:
       pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
 
@@ -336,7 +915,7 @@ OMX_ERRORTYPE omx_audio_mixer_component_GetParameter(
       if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
         break;
       }
-      if (pAudioPortFormat->nPortIndex <= omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+      if (pAudioPortFormat->nPortIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
         port= (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[pAudioPortFormat->nPortIndex];
         memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
       } else {
@@ -349,7 +928,7 @@ OMX_ERRORTYPE omx_audio_mixer_component_GetParameter(
         break;
       }
 
-      if (pAudioPcmMode->nPortIndex <= omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
+      if (pAudioPcmMode->nPortIndex < omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts) {
         port= (omx_audio_mixer_component_PortType *)omx_audio_mixer_component_Private->ports[pAudioPcmMode->nPortIndex];
         memcpy(pAudioPcmMode, &port->pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
       } else {
@@ -391,33 +970,147 @@ int checkAnyPortBeingFlushed(omx_audio_mixer_component_PrivateType* omx_audio_mi
   return ret;
 }
 
+/** Adds an input buffer to the jitter buffer of its port
+ */
+static void omx_audio_mixer_JitterPush(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private,
+                                       omx_audio_mixer_component_PortType* pPort, OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(omx_audio_mixer_component_Private->eSampleFormat);
+  OMX_BUFFERHEADERTYPE** pJitterBuffers;
+  OMX_U32 i, nSize;
+
+  if (pPort->nJitterCount == pPort->nJitterSize) {
+    nSize = pPort->nJitterSize ? pPort->nJitterSize * 2 : (pPort->sPortParam.nBufferCountActual > 2 ? pPort->sPortParam.nBufferCountActual : 2);
+    pJitterBuffers = malloc(nSize * sizeof(OMX_BUFFERHEADERTYPE*));
+    if (!pJitterBuffers) {
+      DEBUG(DEB_LEV_ERR, "In %s no memory for the jitter buffer of port %i\n", __func__, (int)pPort->sPortParam.nPortIndex);
+      pPort->ReturnBufferFunction((omx_base_PortType*)pPort, pBuffer);
+      return;
+    }
+    for (i = 0; i < pPort->nJitterCount; i++) {
+      pJitterBuffers[i] = pPort->pJitterBuffers[(pPort->nJitterHead + i) % pPort->nJitterSize];
+    }
+    free(pPort->pJitterBuffers);
+    pPort->pJitterBuffers = pJitterBuffers;
+    pPort->nJitterSize = nSize;
+    pPort->nJitterHead = 0;
+  }
+  pPort->pJitterBuffers[(pPort->nJitterHead + pPort->nJitterCount) % pPort->nJitterSize] = pBuffer;
+  pPort->nJitterCount++;
+  pPort->nJitterSamples += pBuffer->nFilledLen / nSampleSize;
+  if (pBuffer->nFlags & OMX_BUFFERFLAG_EOS) {
+    pPort->nJitterEOS++;
+  }
+  MIXER_PORT_CLEAR(omx_audio_mixer_component_Private->pEndedPorts, pPort->sPortParam.nPortIndex);
+  /* the buffer count may have been lowered after the period was set */
+  if (pPort->nJitterCount >= omx_audio_mixer_component_Private->sPeriod.nJitterBuffers ||
+      pPort->nJitterCount >= pPort->sPortParam.nBufferCountActual) {
+    pPort->bJitterPrimed = OMX_TRUE;
+  }
+  MIXER_PORT_SET(omx_audio_mixer_component_Private->pHeldPorts, pPort->sPortParam.nPortIndex);
+}
+
+/** Removes the oldest buffer from the jitter buffer of a port and returns it
+ */
+static OMX_BUFFERHEADERTYPE* omx_audio_mixer_JitterPop(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private,
+                                                       omx_audio_mixer_component_PortType* pPort) {
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(omx_audio_mixer_component_Private->eSampleFormat);
+  OMX_BUFFERHEADERTYPE* pBuffer = pPort->pJitterBuffers[pPort->nJitterHead];
+
+  pPort->nJitterHead = (pPort->nJitterHead + 1) % pPort->nJitterSize;
+  pPort->nJitterCount--;
+  pPort->nJitterSamples -= pBuffer->nFilledLen / nSampleSize;
+  if (pBuffer->nFlags & OMX_BUFFERFLAG_EOS) {
+    pPort->nJitterEOS--;
+    MIXER_PORT_SET(omx_audio_mixer_component_Private->pEndedPorts, pPort->sPortParam.nPortIndex);
+  }
+  if (pPort->nJitterCount == 0) {
+    MIXER_PORT_CLEAR(omx_audio_mixer_component_Private->pHeldPorts, pPort->sPortParam.nPortIndex);
+  }
+  return pBuffer;
+}
+
+/** Returns the length of the output period in samples of all the channels.
+ * When it is not configured it is the length of the longest buffer at the
+ * head of the inputs, 0 if there is none yet
+ */
+static OMX_U32 omx_audio_mixer_PeriodSamples(omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private, OMX_BUFFERHEADERTYPE* pOutBuffer) {
+  OMX_U32 nOutputPortIndex = omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts - 1;
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(omx_audio_mixer_component_Private->eSampleFormat);
+  OMX_U32 nChannels = ((omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[nOutputPortIndex])->pAudioPcmMode.nChannels;
+  omx_audio_mixer_component_PortType* pPort;
+  OMX_U32 i, nSamples = omx_audio_mixer_component_Private->sPeriod.nPeriodSamples;
+
+  if (nSamples == 0) {
+    for (i = omx_audio_mixer_NextPort(omx_audio_mixer_component_Private->pHeldPorts, nOutputPortIndex, 0); i < nOutputPortIndex;
+         i = omx_audio_mixer_NextPort(omx_audio_mixer_component_Private->pHeldPorts, nOutputPortIndex, i + 1)) {
+      pPort = (omx_audio_mixer_component_PortType*)omx_audio_mixer_component_Private->ports[i];
+      if (PORT_IS_ENABLED(pPort) && pPort->pJitterBuffers[pPort->nJitterHead]->nFilledLen / nSampleSize > nSamples) {
+        nSamples = pPort->pJitterBuffers[pPort->nJitterHead]->nFilledLen / nSampleSize;
+      }
+    }
+  }
+  if (nSamples > pOutBuffer->nAllocLen / nSampleSize) {
+    nSamples = pOutBuffer->nAllocLen / nSampleSize;
+  }
+  /* keep whole frames */
+  if (nChannels > 1) {
+    nSamples -= nSamples % nChannels;
+  }
+  return nSamples;
+}
+
 /** This is the central function for component processing,overridden for audio mixer. It
   * is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
-  * is available on the given port.
+  * is available on the given port. The ports with buffers in the queue,
+  * and the ports holding buffers, are tracked in bitmasks, so that each
+  * loop only visits the ports that have something to do.
+  * The input buffers wait in the jitter buffers of their ports. An output
+  * period is mixed as soon as every enabled input holds a period of samples,
+  * or ends its stream. Once an input is ready the others are waited for at
+  * most sPeriod.nMaxLatenessMs, then the late inputs contribute what they hold
   */
 void* omx_audio_mixer_BufferMgmtFunction (void* param) {
   OMX_COMPONENTTYPE* openmaxStandComp = (OMX_COMPONENTTYPE*)param;
   omx_audio_mixer_component_PrivateType* omx_audio_mixer_component_Private = (omx_audio_mixer_component_PrivateType*)openmaxStandComp->pComponentPrivate;
 
-  omx_base_PortType *pPort[MAX_PORTS];
-  tsem_t* pSem[MAX_PORTS];
-  queue_t* pQueue[MAX_PORTS];
-  OMX_BUFFERHEADERTYPE* pBuffer[MAX_PORTS];
-  OMX_BOOL isBufferNeeded[MAX_PORTS];
+  omx_base_PortType** pPort = omx_audio_mixer_component_Private->ports;
+  omx_audio_mixer_component_PortType* pMixerPort;
+  volatile OMX_U64* pSignalled = omx_audio_mixer_component_Private->pSignalledPorts;
+  OMX_U64* pPending = omx_audio_mixer_component_Private->pPendingPorts;
+  OMX_U64* pHeld = omx_audio_mixer_component_Private->pHeldPorts;
+  OMX_U64* pEnabled = omx_audio_mixer_component_Private->pEnabledPorts;
+  OMX_U64* pEnded = omx_audio_mixer_component_Private->pEndedPorts;
+  OMX_U32 nPorts = omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts;
+  OMX_U32 nWords = MIXER_MASK_WORDS(nPorts);
+  OMX_AUDIO_PARAM_PCMMODETYPE* pOutPcmMode;
+  OMX_BUFFERHEADERTYPE* pOutBuffer = NULL;
+  OMX_BUFFERHEADERTYPE* pBuffer;
+  OMX_U64 nCallbackStart, nCallbackTime;
+  OMX_U64 nNow, nDeadline = 0;
+  OMX_U32 nPeriod = 0, nLateness;
+  OMX_U32 nReady, nEOS;
+  OMX_BOOL bAllReady, bDrain;
   OMX_COMPONENTTYPE* target_component;
-  OMX_U32 nOutputPortIndex,i;
+  OMX_U32 nOutputPortIndex,i,k,w;
 
-  for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts;i++){
-    pPort[i] = omx_audio_mixer_component_Private->ports[i];
-    pSem[i] = pPort[i]->pBufferSem;
-    pQueue[i] = pPort[i]->pBufferQueue;
-    pBuffer[i] = NULL;
-    isBufferNeeded[i] = OMX_TRUE;
-  }
-
-  nOutputPortIndex = omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts - 1;
+  omx_audio_mixer_component_Private->bellagioThreads->nThreadBufferMngtID = (long int)syscall(__NR_gettid);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s the thread ID is %i\n", __func__, (int)omx_audio_mixer_component_Private->bellagioThreads->nThreadBufferMngtID);
 
+  /* the first loop looks at all the ports, the next ones only at the signalled ports */
+  for(i=0;i<nPorts;i++){
+    MIXER_PORT_SET(pPending, i);
+  }
+  memset(pHeld, 0, nWords * sizeof(OMX_U64));
+  memset(pEnded, 0, nWords * sizeof(OMX_U64));
+
+  nOutputPortIndex = nPorts - 1;
+  pOutPcmMode = &((omx_audio_mixer_component_PortType*)pPort[nOutputPortIndex])->pAudioPcmMode;
+  for(i=0;i<nOutputPortIndex;i++){
+    pMixerPort = (omx_audio_mixer_component_PortType*)pPort[i];
+    pMixerPort->nJitterHead = pMixerPort->nJitterCount = pMixerPort->nJitterSamples = pMixerPort->nJitterEOS = 0;
+    pMixerPort->bJitterPrimed = OMX_FALSE;
+  }
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   while(omx_audio_mixer_component_Private->state == OMX_StateIdle || omx_audio_mixer_component_Private->state == OMX_StateExecuting ||  omx_audio_mixer_component_Private->state == OMX_StatePause ||
@@ -427,22 +1120,36 @@ void* omx_audio_mixer_BufferMgmtFunction (void* param) {
     while( checkAnyPortBeingFlushed(omx_audio_mixer_component_Private) ) {
 
       DEBUG(DEB_LEV_FULL_SEQ, "In %s 1 signalling flush all cond iF=%d,oF=%d iSemVal=%d,oSemval=%d\n",
-        __func__,isBufferNeeded[0],isBufferNeeded[nOutputPortIndex],pSem[0]->semval,pSem[nOutputPortIndex]->semval);
-
-      for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts;i++){
-        if(isBufferNeeded[i]==OMX_FALSE && PORT_IS_BEING_FLUSHED(pPort[i])) {
-          pPort[i]->ReturnBufferFunction(pPort[i],pBuffer[i]);
-          pBuffer[i]=NULL;
-          isBufferNeeded[i]=OMX_TRUE;
-          DEBUG(DEB_LEV_FULL_SEQ, "Ports are flushing,so returning buffer %i\n",(int)i);
+        __func__,!MIXER_PORT_IS_SET(pHeld, 0),pOutBuffer==NULL,pPort[0]->pBufferSem->semval,pPort[nOutputPortIndex]->pBufferSem->semval);
+
+      for(i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, 0);i<nOutputPortIndex;i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, i+1)){
+        if(PORT_IS_BEING_FLUSHED(pPort[i])) {
+          pMixerPort = (omx_audio_mixer_component_PortType*)pPort[i];
+          while(pMixerPort->nJitterCount > 0) {
+            pPort[i]->ReturnBufferFunction(pPort[i], omx_audio_mixer_JitterPop(omx_audio_mixer_component_Private, pMixerPort));
+          }
+          pMixerPort->bJitterPrimed = OMX_FALSE;
+          MIXER_PORT_CLEAR(pEnded, i);
+          DEBUG(DEB_LEV_FULL_SEQ, "Ports are flushing,so returning buffers of port %i\n",(int)i);
         }
       }
+      if(pOutBuffer != NULL && PORT_IS_BEING_FLUSHED(pPort[nOutputPortIndex])) {
+        pPort[nOutputPortIndex]->ReturnBufferFunction(pPort[nOutputPortIndex],pOutBuffer);
+        pOutBuffer = NULL;
+        MIXER_PORT_CLEAR(pHeld, nOutputPortIndex);
+      }
+      nDeadline = 0;
 
       DEBUG(DEB_LEV_FULL_SEQ, "In %s 2 signalling flush all cond iF=%d,oF=%d iSemVal=%d,oSemval=%d\n",
-        __func__,isBufferNeeded[0],isBufferNeeded[nOutputPortIndex],pSem[0]->semval,pSem[nOutputPortIndex]->semval);
+        __func__,!MIXER_PORT_IS_SET(pHeld, 0),pOutBuffer==NULL,pPort[0]->pBufferSem->semval,pPort[nOutputPortIndex]->pBufferSem->semval);
 
       tsem_up(omx_audio_mixer_component_Private->flush_all_condition);
       tsem_down(omx_audio_mixer_component_Private->flush_condition);
+
+      /* the queues have changed under the flush: look at all the ports again */
+      for(i=0;i<nPorts;i++){
+        MIXER_PORT_SET(pPending, i);
+      }
     }
 
     if(omx_audio_mixer_component_Private->state == OMX_StateLoaded || omx_audio_mixer_component_Private->state == OMX_StateInvalid) {
@@ -450,104 +1157,130 @@ void* omx_audio_mixer_BufferMgmtFunction (void* param) {
       break;
     }
 
-    /*No buffer to process. So wait here*/
-    for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts;i++){
-      if((isBufferNeeded[i]==OMX_TRUE && pSem[i]->semval==0) &&
-        (omx_audio_mixer_component_Private->state != OMX_StateLoaded && omx_audio_mixer_component_Private->state != OMX_StateInvalid) &&
-        PORT_IS_ENABLED(pPort[i]) && !PORT_IS_BEING_FLUSHED(pPort[i])) {
-        //Signalled from EmptyThisBuffer or FillThisBuffer or some thing else
-        DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next input/output buffer\n");
-        tsem_down(omx_audio_mixer_component_Private->bMgmtSem);
+    /*The enabled inputs are looked at again only when one is enabled or disabled*/
+    if(__sync_lock_test_and_set(&omx_audio_mixer_component_Private->bPortsChanged, OMX_FALSE)) {
+      memset(pEnabled, 0, nWords * sizeof(OMX_U64));
+      for(i=0;i<nOutputPortIndex;i++){
+        if(PORT_IS_ENABLED(pPort[i])) {
+          MIXER_PORT_SET(pEnabled, i);
+        }
+      }
+    }
 
+    /*Take the new buffers: all of them on the inputs, one on the output*/
+    for(w=0;w<nWords;w++) {
+      if(pSignalled[w]) {
+        pPending[w] |= __sync_fetch_and_and(&pSignalled[w], 0);
       }
-      /*Don't wait for buffers, if any port is flushing*/
-      if(checkAnyPortBeingFlushed(omx_audio_mixer_component_Private)) {
-        break;
+    }
+    for(i=omx_audio_mixer_NextPort(pPending, nPorts, 0);i<nPorts;i=omx_audio_mixer_NextPort(pPending, nPorts, i+1)){
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for buffer %i semval=%d \n",(int)i,pPort[i]->pBufferSem->semval);
+      while(pPort[i]->pBufferSem->semval>0 && PORT_IS_ENABLED(pPort[i]) && (i != nOutputPortIndex || pOutBuffer == NULL)) {
+        tsem_down(pPort[i]->pBufferSem);
+        if(pPort[i]->pBufferQueue->nelem == 0) {
+          break;
+        }
+        pBuffer = dequeue(pPort[i]->pBufferQueue);
+        OMX_TRACE(OMX_TraceBufferDequeue, openmaxStandComp, pPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pBuffer);
+        if(pBuffer == NULL){
+          DEBUG(DEB_LEV_ERR, "Had NULL input buffer!!\n");
+          break;
+        }
+        if(i == nOutputPortIndex) {
+          pOutBuffer = pBuffer;
+          MIXER_PORT_SET(pHeld, nOutputPortIndex);
+        } else {
+          omx_audio_mixer_JitterPush(omx_audio_mixer_component_Private, (omx_audio_mixer_component_PortType*)pPort[i], pBuffer);
+        }
       }
-      if(omx_audio_mixer_component_Private->state == OMX_StateLoaded || omx_audio_mixer_component_Private->state == OMX_StateInvalid) {
-        DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
-        break;
+      /* the port stays pending while it has more buffers in the queue */
+      if(pPort[i]->pBufferSem->semval==0) {
+        MIXER_PORT_CLEAR(pPending, i);
       }
     }
 
-    for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts;i++){
-      DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for buffer %i semval=%d \n",(int)i,pSem[i]->semval);
-      if(pSem[i]->semval>0 && isBufferNeeded[i]==OMX_TRUE && PORT_IS_ENABLED(pPort[i])) {
-        tsem_down(pSem[i]);
-        if(pQueue[i]->nelem>0){
-          isBufferNeeded[i]=OMX_FALSE;
-          pBuffer[i] = dequeue(pQueue[i]);
-          if(pBuffer[i] == NULL){
-            DEBUG(DEB_LEV_ERR, "Had NULL input buffer!!\n");
-            break;
-          }
-        }
+    /*Check whether the inputs are ready for a period*/
+    nReady = 0;
+    bAllReady = OMX_TRUE;
+    bDrain = OMX_TRUE;
+    if(pOutBuffer != NULL && (nPeriod == 0 || omx_audio_mixer_component_Private->sPeriod.nPeriodSamples != 0)) {
+      nPeriod = omx_audio_mixer_PeriodSamples(omx_audio_mixer_component_Private, pOutBuffer);
+    }
+    for(i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, 0);i<nOutputPortIndex && nPeriod > 0;i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, i+1)){
+      pMixerPort = (omx_audio_mixer_component_PortType*)pPort[i];
+      if(!PORT_IS_ENABLED(pMixerPort)) {
+        continue;
+      }
+      if(pMixerPort->nJitterEOS > 0 || (pMixerPort->bJitterPrimed && pMixerPort->nJitterSamples >= nPeriod)) {
+        nReady++;
+      } else {
+        bAllReady = OMX_FALSE;
+      }
+      if(pMixerPort->nJitterEOS == 0) {
+        bDrain = OMX_FALSE;
+      }
+    }
+    /*The enabled inputs that hold nothing are waited for, until their stream ends*/
+    for(w=0;w<nWords && nPeriod > 0;w++) {
+      if(pEnabled[w] & ~pHeld[w] & ~pEnded[w]) {
+        bAllReady = OMX_FALSE;
+        bDrain = OMX_FALSE;
+        break;
       }
     }
 
-    if(isBufferNeeded[nOutputPortIndex]==OMX_FALSE) {
+    nNow = base_port_StatTime();
+    if(pOutBuffer != NULL && nReady > 0 && omx_audio_mixer_component_Private->state == OMX_StateExecuting &&
+       (bAllReady || (nDeadline != 0 && nNow >= nDeadline))) {
 
       if(omx_audio_mixer_component_Private->pMark.hMarkTargetComponent != NULL){
-        pBuffer[nOutputPortIndex]->hMarkTargetComponent = omx_audio_mixer_component_Private->pMark.hMarkTargetComponent;
-        pBuffer[nOutputPortIndex]->pMarkData            = omx_audio_mixer_component_Private->pMark.pMarkData;
+        pOutBuffer->hMarkTargetComponent = omx_audio_mixer_component_Private->pMark.hMarkTargetComponent;
+        pOutBuffer->pMarkData            = omx_audio_mixer_component_Private->pMark.pMarkData;
         omx_audio_mixer_component_Private->pMark.hMarkTargetComponent = NULL;
         omx_audio_mixer_component_Private->pMark.pMarkData            = NULL;
       }
-      for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts-1;i++){
-        if(isBufferNeeded[i]==OMX_FALSE && PORT_IS_ENABLED(pPort[i])) {
-
-          if(isBufferNeeded[i]==OMX_FALSE) {
-            target_component=(OMX_COMPONENTTYPE*)pBuffer[i]->hMarkTargetComponent;
-            if(target_component==(OMX_COMPONENTTYPE *)openmaxStandComp) {
-              /*Clear the mark and generate an event*/
-              (*(omx_audio_mixer_component_Private->callbacks->EventHandler))
-                (openmaxStandComp,
-                omx_audio_mixer_component_Private->callbackData,
-                OMX_EventMark, /* The command was completed */
-                1, /* The commands was a OMX_CommandStateSet */
-                0, /* The state has been changed in message->messageParam2 */
-                pBuffer[i]->pMarkData);
-            } else if(pBuffer[i]->hMarkTargetComponent!=NULL){
-              /*If this is not the target component then pass the mark*/
-              pBuffer[nOutputPortIndex]->hMarkTargetComponent  = pBuffer[i]->hMarkTargetComponent;
-              pBuffer[nOutputPortIndex]->pMarkData = pBuffer[i]->pMarkData;
-              pBuffer[i]->pMarkData=NULL;
-            }
-            pBuffer[nOutputPortIndex]->nTimeStamp = pBuffer[i]->nTimeStamp;
-          }
+      if(!bAllReady) {
+        DEBUG(DEB_LEV_FULL_SEQ, "In %s mixing a period with %i ready inputs only\n", __func__, (int)nReady);
+      }
 
-          if((pBuffer[i]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS && pBuffer[i]->nFilledLen==0) {
-            DEBUG(DEB_LEV_FULL_SEQ, "Detected EOS flags in input buffer %p of %i filled len=%d\n", pBuffer[i], (int)i, (int)pBuffer[i]->nFilledLen);
-            pBuffer[nOutputPortIndex]->nFlags = pBuffer[i]->nFlags;
-            pBuffer[i]->nFlags=0;
+      /*Mix all the ready inputs in one pass over the output buffer*/
+      nCallbackStart = base_port_StatTime();
+      OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, nOutputPortIndex, (OMX_U64)(unsigned long)pOutBuffer);
+      omx_audio_mixer_component_MixPeriod(openmaxStandComp, pOutBuffer, nPeriod, bDrain);
+      OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, nOutputPortIndex, (OMX_U64)(unsigned long)pOutBuffer);
+      nCallbackTime = base_port_StatTime() - nCallbackStart;
+      base_port_StatCallbackTime(pPort[nOutputPortIndex], nCallbackTime);
+      nDeadline = 0;
+
+      /*Pass the marks and the EOS of the consumed input buffers to the output*/
+      nEOS = 0;
+      for(i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, 0);i<nOutputPortIndex;i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, i+1)){
+        pMixerPort = (omx_audio_mixer_component_PortType*)pPort[i];
+        if(!PORT_IS_ENABLED(pMixerPort)) {
+          continue;
+        }
+        for(k=0;k<pMixerPort->nJitterConsumed;k++) {
+          pBuffer = pMixerPort->pJitterBuffers[(pMixerPort->nJitterHead + k) % pMixerPort->nJitterSize];
+          target_component=(OMX_COMPONENTTYPE*)pBuffer->hMarkTargetComponent;
+          if(target_component==(OMX_COMPONENTTYPE *)openmaxStandComp) {
+            /*Clear the mark and generate an event*/
             (*(omx_audio_mixer_component_Private->callbacks->EventHandler))
               (openmaxStandComp,
               omx_audio_mixer_component_Private->callbackData,
-              OMX_EventBufferFlag, /* The command was completed */
-              nOutputPortIndex, /* The commands was a OMX_CommandStateSet */
-              pBuffer[nOutputPortIndex]->nFlags, /* The state has been changed in message->messageParam2 */
-              NULL);
+              OMX_EventMark, /* The command was completed */
+              1, /* The commands was a OMX_CommandStateSet */
+              0, /* The state has been changed in message->messageParam2 */
+              pBuffer->pMarkData);
+          } else if(pBuffer->hMarkTargetComponent!=NULL){
+            /*If this is not the target component then pass the mark*/
+            pOutBuffer->hMarkTargetComponent  = pBuffer->hMarkTargetComponent;
+            pOutBuffer->pMarkData = pBuffer->pMarkData;
+            pBuffer->pMarkData=NULL;
           }
-
-          //TBD: To be verified
-          if(omx_audio_mixer_component_Private->state == OMX_StateExecuting)  {
-            if (omx_audio_mixer_component_Private->BufferMgmtCallback && pBuffer[i]->nFilledLen != 0) {
-              (*(omx_audio_mixer_component_Private->BufferMgmtCallback))(openmaxStandComp, pBuffer[i], pBuffer[nOutputPortIndex]);
-            } else {
-              /*It no buffer management call back the explicitly consume input buffer*/
-              pBuffer[i]->nFilledLen = 0;
-            }
-          } else {
-            DEBUG(DEB_LEV_ERR, "In %s Received Buffer in non-Executing State(%x)\n", __func__, (int)omx_audio_mixer_component_Private->state);
-            if(OMX_TransStateExecutingToIdle == omx_audio_mixer_component_Private->transientState ||
-			   OMX_TransStatePauseToIdle == omx_audio_mixer_component_Private->transientState) {
-              pBuffer[i]->nFilledLen = 0;
-            }
-          }
-
-          /*Input Buffer has been completely consumed. So, get new input buffer*/
-          if(pBuffer[i]->nFilledLen==0) {
-            isBufferNeeded[i] = OMX_TRUE;
+          if((pBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+            DEBUG(DEB_LEV_FULL_SEQ, "Detected EOS flags in input buffer %p of %i\n", pBuffer, (int)i);
+            pOutBuffer->nFlags |= pBuffer->nFlags;
+            nEOS++;
           }
         }
       }
@@ -559,11 +1292,69 @@ void* omx_audio_mixer_BufferMgmtFunction (void* param) {
       }
 
       /*If EOS and Input buffer Filled Len Zero then Return output buffer immediately*/
-      if(pBuffer[nOutputPortIndex]->nFilledLen!=0 || (pBuffer[nOutputPortIndex]->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS){
+      if(pOutBuffer->nFilledLen!=0 || (pOutBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS){
         DEBUG(DEB_LEV_SIMPLE_SEQ, "Returning output buffer \n");
-        pPort[nOutputPortIndex]->ReturnBufferFunction(pPort[nOutputPortIndex],pBuffer[nOutputPortIndex]);
-        pBuffer[nOutputPortIndex]=NULL;
-        isBufferNeeded[nOutputPortIndex]=OMX_TRUE;
+        pPort[nOutputPortIndex]->ReturnBufferFunction(pPort[nOutputPortIndex],pOutBuffer);
+        pOutBuffer=NULL;
+        MIXER_PORT_CLEAR(pHeld, nOutputPortIndex);
+      }
+      /* one event for each input that ends, once its last samples have been delivered */
+      for(k=0;k<nEOS;k++) {
+        (*(omx_audio_mixer_component_Private->callbacks->EventHandler))
+          (openmaxStandComp,
+          omx_audio_mixer_component_Private->callbackData,
+          OMX_EventBufferFlag, /* The command was completed */
+          nOutputPortIndex, /* The commands was a OMX_CommandStateSet */
+          OMX_BUFFERFLAG_EOS, /* The state has been changed in message->messageParam2 */
+          NULL);
+      }
+
+      /*Input Buffers completely consumed. So, return them*/
+      for(i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, 0);i<nOutputPortIndex;i=omx_audio_mixer_NextPort(pHeld, nOutputPortIndex, i+1)){
+        pMixerPort = (omx_audio_mixer_component_PortType*)pPort[i];
+        if(!PORT_IS_ENABLED(pMixerPort) || pMixerPort->nJitterConsumed == 0) {
+          continue;
+        }
+        base_port_StatCallbackTime(pPort[i], nCallbackTime);
+        for(k=0;k<pMixerPort->nJitterConsumed;k++) {
+          pBuffer = omx_audio_mixer_JitterPop(omx_audio_mixer_component_Private, pMixerPort);
+          pBuffer->nFlags = 0;
+          /* the periods moved the offset through the buffer, it goes back empty */
+          pBuffer->nOffset = 0;
+          pPort[i]->ReturnBufferFunction(pPort[i],pBuffer);
+        }
+        pMixerPort->nJitterConsumed = 0;
+      }
+      /* more periods may be ready already */
+      continue;
+    }
+
+    if(omx_audio_mixer_component_Private->state == OMX_StateLoaded || omx_audio_mixer_component_Private->state == OMX_StateInvalid) {
+      DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Buffer Management Thread is exiting\n",__func__);
+      break;
+    }
+
+    /*Once an input is ready, the late inputs are waited for a limited time*/
+    if(pOutBuffer != NULL && nReady > 0 && nDeadline == 0 && omx_audio_mixer_component_Private->state == OMX_StateExecuting) {
+      nLateness = omx_audio_mixer_component_Private->sPeriod.nMaxLatenessMs;
+      if(nLateness == 0 && pOutPcmMode->nChannels > 0 && pOutPcmMode->nSamplingRate > 0) {
+        nLateness = (OMX_U32)((OMX_U64)nPeriod * 1000 / (pOutPcmMode->nChannels * pOutPcmMode->nSamplingRate));
+      }
+      nDeadline = nNow + (OMX_U64)(nLateness > 0 ? nLateness : 1) * 1000000;
+    }
+
+    /*No period to mix. So wait here until a buffer arrives or the late inputs have been waited for*/
+    /*Don't wait for buffers, if any port is flushing*/
+    if(!checkAnyPortBeingFlushed(omx_audio_mixer_component_Private) &&
+      (omx_audio_mixer_component_Private->state != OMX_StateLoaded && omx_audio_mixer_component_Private->state != OMX_StateInvalid)) {
+      //Signalled from EmptyThisBuffer or FillThisBuffer or some thing else
+      DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next input/output buffer\n");
+      if(nDeadline != 0) {
+        nNow = base_port_StatTime();
+        omx_base_component_WaitForAnyPort(openmaxStandComp,
+                                          nDeadline > nNow ? (OMX_U32)((nDeadline - nNow + 999999) / 1000000) : 0);
+      } else {
+        omx_base_component_WaitForAnyPort(openmaxStandComp, OMX_BASE_WAIT_FOREVER);
       }
     }
 
@@ -574,16 +1365,8 @@ void* omx_audio_mixer_BufferMgmtFunction (void* param) {
       /*Waiting at paused state*/
       tsem_wait(omx_audio_mixer_component_Private->bStateSem);
     }
-
-    /*Input Buffer has been completely consumed. So, return input buffer*/
-    for(i=0;i<omx_audio_mixer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts-1;i++){
-      if(isBufferNeeded[i] == OMX_TRUE && pBuffer[i]!=NULL && PORT_IS_ENABLED(pPort[i])) {
-        pPort[i]->ReturnBufferFunction(pPort[i],pBuffer[i]);
-        pBuffer[i]=NULL;
-      }
-    }
   }
+  omx_audio_mixer_StopWorkers(omx_audio_mixer_component_Private);
   DEBUG(DEB_LEV_SIMPLE_SEQ,"Exiting Buffer Management Thread\n");
   return NULL;
 }
-
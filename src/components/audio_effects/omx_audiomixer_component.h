@@ -33,6 +33,7 @@
 #include <string.h>
 #include <omx_base_filter.h>
 #include <omx_base_audio_port.h>
+#include "omx_audio_kernels.h"
 
 #define MIXER_COMP_NAME "OMX.st.audio.mixer"
 #define MIXER_COMP_ROLE "audio.mixer"
@@ -41,8 +42,12 @@
 #define MIXER_QUALITY_LEVELS 1
 static int mixerQualityLevels []={50, 60000, 10, 40000};
 
-#define MAX_PORTS   5 // Maximum number of ports supported by the mixer. 4 input and 1 output
+#define MIXER_DEFAULT_INPUT_PORTS 4 // Number of input ports of a new mixer. The output port follows the input ports
+#define MIXER_MAX_INPUT_PORTS 128 // Maximum number of input ports, set through OMX_IndexParamAudioInit
+#define MIXER_MASK_WORDS(nPorts) (((nPorts) + 63) / 64) // Number of OMX_U64 of a bitmask with one bit per port
 #define MAX_CHANNEL 6 // Maximum number of channels supported in a single stream 5.1
+#define MIXER_MAX_MIX_THREADS 64 // Maximum number of threads sharing the mix of a period
+#define MIXER_MIN_SLICE (4 * AUDIO_MIX_BLOCK) // Shortest slice of a period mixed by a thread, in samples of all the channels
 
 /** Audio Mixer port structure.
   */
@@ -55,15 +60,62 @@ DERIVEDCLASS(omx_audio_mixer_component_PortType, omx_base_audio_PortType)
   /** @param sVolume Audio Volume adjustment for a port */ \
   OMX_AUDIO_CONFIG_VOLUMETYPE sVolume; \
   /** @param sChannelVolume Audio Volume adjustment for a channel */ \
-  OMX_AUDIO_CONFIG_CHANNELVOLUMETYPE sChannelVolume[MAX_CHANNEL];
+  OMX_AUDIO_CONFIG_CHANNELVOLUMETYPE sChannelVolume[MAX_CHANNEL]; \
+  /** @param nGainFactor the share of the port in the mix in Q15, derived from the volumes of the enabled ports */ \
+  OMX_S32 nGainFactor; \
+  /** @param pJitterBuffers the input buffers held by the port, oldest first, in a ring of nJitterSize entries */ \
+  OMX_BUFFERHEADERTYPE** pJitterBuffers; \
+  OMX_U32 nJitterSize; \
+  /** @param nJitterHead position in pJitterBuffers of the oldest buffer */ \
+  OMX_U32 nJitterHead; \
+  /** @param nJitterCount number of buffers held */ \
+  OMX_U32 nJitterCount; \
+  /** @param nJitterSamples number of samples left in the held buffers */ \
+  OMX_U32 nJitterSamples; \
+  /** @param nJitterEOS number of held buffers with the EOS flag */ \
+  OMX_U32 nJitterEOS; \
+  /** @param nJitterConsumed number of held buffers, from the oldest, consumed by the last period */ \
+  OMX_U32 nJitterConsumed; \
+  /** @param bJitterPrimed the port has gathered enough buffers to contribute to the mix */ \
+  OMX_BOOL bJitterPrimed;
 ENDCLASS(omx_audio_mixer_component_PortType)
 
+/** The threads sharing the mix of the periods, defined in the source */
+typedef struct omx_audio_mixer_workers omx_audio_mixer_workers;
+
 /** Twoport component private structure.
 * see the define above
 */
 DERIVEDCLASS(omx_audio_mixer_component_PrivateType, omx_base_filter_PrivateType)
 #define omx_audio_mixer_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
-  /** This class is empty for the time being */
+  /** @param eSampleFormat the sample layout of all the ports */ \
+  AUDIO_SAMPLE_FORMAT eSampleFormat; \
+  /** @param bGainsChanged set when a volume changes or a port is enabled or disabled, so that the gain factors are computed again */ \
+  volatile OMX_BOOL bGainsChanged; \
+  /** @param pPendingPorts bitmask of the ports that have buffers in their queue */ \
+  OMX_U64* pPendingPorts; \
+  /** @param pHeldPorts bitmask of the ports holding buffers in the buffer management thread */ \
+  OMX_U64* pHeldPorts; \
+  /** @param pEnabledPorts bitmask of the enabled input ports, built again by the buffer management thread when bPortsChanged is set */ \
+  OMX_U64* pEnabledPorts; \
+  /** @param bPortsChanged set when an input port is enabled or disabled */ \
+  volatile OMX_BOOL bPortsChanged; \
+  /** @param pEndedPorts bitmask of the input ports whose last consumed buffer had the EOS flag */ \
+  OMX_U64* pEndedPorts; \
+  /** @param sPeriod the output period, set through OMX_IndexConfigBellagioMixerPeriod */ \
+  OMX_CONFIG_BELLAGIOMIXERPERIODTYPE sPeriod; \
+  /** @param pMixSrc the streams given to the mix kernel */ \
+  const void** pMixSrc; \
+  /** @param pMixSrcSamples the length of each stream given to the mix kernel */ \
+  OMX_U32* pMixSrcSamples; \
+  /** @param pMixSrcStart the position in the output of each stream given to the mix kernel */ \
+  OMX_U32* pMixSrcStart; \
+  /** @param nMixStreams the size of the arrays given to the mix kernel */ \
+  OMX_U32 nMixStreams; \
+  /** @param pMixWorkers the threads mixing slices of the periods with the buffer management thread, NULL when it mixes alone */ \
+  omx_audio_mixer_workers* pMixWorkers; \
+  /** @param pMixGains the gain of each stream given to the mix kernel */ \
+  OMX_S32* pMixGains;
 ENDCLASS(omx_audio_mixer_component_PrivateType)
 
 /* Component private entry points declaration */
@@ -75,6 +127,46 @@ void omx_audio_mixer_component_BufferMgmtCallback(
   OMX_BUFFERHEADERTYPE* inputbuffer,
   OMX_BUFFERHEADERTYPE* outputbuffer);
 
+/** Destroys the ports of the mixer and constructs nPorts new ones with the
+ * default settings: nPorts - 1 input ports followed by the output port.
+ * It also sizes the per port state of the buffer management thread
+ *
+ * @param nPorts the number of ports, output port included
+ */
+OMX_ERRORTYPE omx_audio_mixer_component_SetPorts(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_U32 nPorts);
+
+/** Mixes the input buffers ready for an output period in a single pass,
+ * and consumes them. The output length is the one of the longest input
+ *
+ * @param ppInBuffers the input buffers, at most one per port
+ * @param nInBuffers number of input buffers
+ * @param pOutBuffer the output buffer, that is overwritten
+ */
+void omx_audio_mixer_component_MixBuffers(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE** ppInBuffers,
+  OMX_U32 nInBuffers,
+  OMX_BUFFERHEADERTYPE* pOutBuffer);
+
+/** Mixes one output period from the buffers held by the input ports.
+ * Each primed input contributes up to nSamples samples, taken from its
+ * oldest buffers, and silence for the rest. The last buffer read by an
+ * input keeps its unread samples for the next period, the buffers read
+ * completely are counted in nJitterConsumed, to be returned by the caller
+ *
+ * @param pOutBuffer the output buffer, that is overwritten
+ * @param nSamples the length of the period, in samples of all the channels
+ * @param bDrain the inputs are ending: the output stops with the longest input
+ * instead of being completed with silence
+ */
+void omx_audio_mixer_component_MixPeriod(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* pOutBuffer,
+  OMX_U32 nSamples,
+  OMX_BOOL bDrain);
+
 OMX_ERRORTYPE omx_audio_mixer_component_GetParameter(
   OMX_HANDLETYPE hComponent,
   OMX_INDEXTYPE nParamIndex,
@@ -95,10 +187,18 @@ OMX_ERRORTYPE omx_audio_mixer_component_SetConfig(
   OMX_INDEXTYPE nIndex,
   OMX_PTR pComponentConfigStructure);
 
+OMX_ERRORTYPE omx_audio_mixer_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
 /** This is the central function for component processing, overridden for audio mixer. It
   * is executed in a separate thread, is synchronized with
   * semaphores at each port, those are released each time a new buffer
-  * is available on the given port.
+  * is available on the given port. The input buffers are gathered in
+  * per port jitter buffers, and an output period is mixed when all the
+  * inputs are ready, or when the late inputs have been waited for
+  * sPeriod.nMaxLatenessMs.
   */
 void* omx_audio_mixer_BufferMgmtFunction (void* param);
 
@@ -0,0 +1,731 @@
+/**
+  src/components/audio_effects/omx_converter_component.c
+
+  OpenMAX audio converter component. This component implements a filter that
+  converts the sample format, the layout and the channels of an audio PCM stream.
+
+  The input port and the output port each take any of the sample formats
+  of the audio kernels, interleaved or planar, and up to
+  OMX_AUDIO_MAXCHANNELS channels. A planar buffer holds the samples of
+  each channel one after the other, in a plane per channel. The frames
+  are converted by blocks: each input channel is converted to a float
+  plane, the planes are mixed by the channel matrix and converted to the
+  output format, while the block is still in the cache.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <sched.h>
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_converter_component.h>
+#include<OMX_Audio.h>
+
+/** The weight of a channel folded into two channels, -3 dB */
+#define CONVERTER_FOLD_WEIGHT 0.70710678f
+
+static OMX_ERRORTYPE omx_converter_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort);
+static void converter_Publish(omx_converter_component_PrivateType* omx_converter_component_Private);
+
+OMX_ERRORTYPE omx_converter_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+	OMX_ERRORTYPE err;
+	omx_converter_component_PrivateType* omx_converter_component_Private;
+	OMX_U32 i;
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+	RM_RegisterComponent(CONVERTER_COMP_NAME, MAX_CONVERTER_COMPONENTS);
+	if (!openmaxStandComp->pComponentPrivate) {
+		openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_converter_component_PrivateType));
+		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s allocated private structure %p for std component %p\n",
+				__func__, openmaxStandComp->pComponentPrivate, openmaxStandComp);
+		if(openmaxStandComp->pComponentPrivate == NULL) {
+			return OMX_ErrorInsufficientResources;
+		}
+	} else {
+		DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+		return OMX_ErrorUndefined;
+	}
+
+	omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+	omx_converter_component_Private->ports = NULL;
+
+	/** Calling base filter constructor */
+	err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+	if (err != OMX_ErrorNone) {
+			DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+			return err;
+	}
+
+	omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+	omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 2;
+
+	/** Allocate Ports and call port constructor. */
+	if (omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_converter_component_Private->ports) {
+		omx_converter_component_Private->ports = calloc(omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
+		if (!omx_converter_component_Private->ports) {
+			return OMX_ErrorInsufficientResources;
+		}
+		for (i=0; i < omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			omx_converter_component_Private->ports[i] = calloc(1, sizeof(omx_base_audio_PortType));
+			if (!omx_converter_component_Private->ports[i]) {
+				return OMX_ErrorInsufficientResources;
+			}
+		}
+	}
+
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_converter_component_Private->ports[0], 0, OMX_TRUE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_converter_component_Private->ports[1], 1, OMX_FALSE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+
+	/** Domain specific section for the ports. */
+	omx_converter_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+	omx_converter_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+
+	omx_converter_component_Private->pPlanes = malloc(2 * OMX_AUDIO_MAXCHANNELS * CONVERTER_BLOCK * sizeof(float));
+	if (!omx_converter_component_Private->pPlanes) {
+		return OMX_ErrorInsufficientResources;
+	}
+
+	/* a flush drops the rest of the input buffer being converted */
+	omx_converter_component_Private->BaseFlushProcessingBuffers = omx_converter_component_Private->ports[0]->FlushProcessingBuffers;
+	for (i = 0; i < 2; i++) {
+		omx_converter_component_Private->ports[i]->FlushProcessingBuffers = omx_converter_component_port_FlushProcessingBuffers;
+
+		setHeader(&omx_converter_component_Private->sPCMModeParam[i], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+		omx_converter_component_Private->sPCMModeParam[i].nPortIndex = i;
+		omx_converter_component_Private->sPCMModeParam[i].nChannels = 2;
+		omx_converter_component_Private->sPCMModeParam[i].eNumData = OMX_NumericalDataSigned;
+		omx_converter_component_Private->sPCMModeParam[i].eEndian = OMX_EndianBig;
+		omx_converter_component_Private->sPCMModeParam[i].bInterleaved = OMX_TRUE;
+		omx_converter_component_Private->sPCMModeParam[i].nBitPerSample = 16;
+		omx_converter_component_Private->sPCMModeParam[i].nSamplingRate = 44100;
+		omx_converter_component_Private->sPCMModeParam[i].ePCMMode = OMX_AUDIO_PCMModeLinear;
+		omx_converter_component_Private->sPCMModeParam[i].eChannelMapping[0] = OMX_AUDIO_ChannelLF;
+		omx_converter_component_Private->sPCMModeParam[i].eChannelMapping[1] = OMX_AUDIO_ChannelRF;
+		omx_converter_component_Private->eSampleFormat[i] = AUDIO_SAMPLE_S16;
+	}
+	setHeader(&omx_converter_component_Private->sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+	omx_converter_component_Private->sMatrix.nPortIndex = OMX_BASE_FILTER_OUTPUTPORT_INDEX;
+	pthread_mutex_init(&omx_converter_component_Private->matrixMutex, NULL);
+	converter_Publish(omx_converter_component_Private);
+
+	omx_converter_component_Private->destructor = omx_converter_component_Destructor;
+	openmaxStandComp->SetParameter = omx_converter_component_SetParameter;
+	openmaxStandComp->GetParameter = omx_converter_component_GetParameter;
+	openmaxStandComp->GetConfig = omx_converter_component_GetConfig;
+	openmaxStandComp->GetExtensionIndex = omx_converter_component_GetExtensionIndex;
+	openmaxStandComp->SetConfig = omx_converter_component_SetConfig;
+	omx_converter_component_Private->BufferMgmtCallback = omx_converter_component_BufferMgmtCallback;
+
+  /* resource management special section */
+  omx_converter_component_Private->nqualitylevels = CONVERTER_QUALITY_LEVELS;
+  omx_converter_component_Private->currentQualityLevel = 1;
+  omx_converter_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * CONVERTER_QUALITY_LEVELS);
+  for (i = 0; i<CONVERTER_QUALITY_LEVELS; i++) {
+	  omx_converter_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  omx_converter_component_Private->multiResourceLevel[i]->CPUResourceRequested = converterQualityLevels[i * 2];
+	  omx_converter_component_Private->multiResourceLevel[i]->MemoryResourceRequested = converterQualityLevels[i * 2 + 1];
+  }
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_converter_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+
+	omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+	OMX_U32 i;
+
+	/* frees port/s */
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+	if (omx_converter_component_Private->ports) {
+		for (i=0; i < omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			if(omx_converter_component_Private->ports[i]) {
+				omx_converter_component_Private->ports[i]->PortDestructor(omx_converter_component_Private->ports[i]);
+			}
+		}
+		free(omx_converter_component_Private->ports);
+		omx_converter_component_Private->ports=NULL;
+	}
+
+	free(omx_converter_component_Private->pPlanes);
+	omx_converter_component_Private->pPlanes = NULL;
+	pthread_mutex_destroy(&omx_converter_component_Private->matrixMutex);
+
+	omx_base_filter_Destructor(openmaxStandComp);
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+/** Flushes the port like the base port, the next input buffer is
+  * converted from its first frame
+  */
+static OMX_ERRORTYPE omx_converter_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort) {
+  omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE err;
+
+  err = omx_converter_component_Private->BaseFlushProcessingBuffers(openmaxStandPort);
+  omx_converter_component_Private->bInputReset = OMX_TRUE;
+  return err;
+}
+
+/** Gives the position of each channel of a port. When the mapping is not
+  * set, the channels follow the usual order of their count
+  */
+static void converter_Mapping(OMX_AUDIO_PARAM_PCMMODETYPE* pPcmMode, OMX_AUDIO_CHANNELTYPE* pMapping) {
+  static const OMX_AUDIO_CHANNELTYPE eDefaultMapping[] = {
+    OMX_AUDIO_ChannelLF, OMX_AUDIO_ChannelRF, OMX_AUDIO_ChannelCF, OMX_AUDIO_ChannelLFE,
+    OMX_AUDIO_ChannelLR, OMX_AUDIO_ChannelRR, OMX_AUDIO_ChannelLS, OMX_AUDIO_ChannelRS
+  };
+  OMX_U32 i;
+
+  for (i = 0; i < pPcmMode->nChannels; i++) {
+    if (pPcmMode->eChannelMapping[i] == OMX_AUDIO_ChannelNone) {
+      break;
+    }
+  }
+  if (i == pPcmMode->nChannels) {
+    memcpy(pMapping, pPcmMode->eChannelMapping, pPcmMode->nChannels * sizeof(OMX_AUDIO_CHANNELTYPE));
+    return;
+  }
+  for (i = 0; i < pPcmMode->nChannels; i++) {
+    if (pPcmMode->nChannels == 1) {
+      pMapping[i] = OMX_AUDIO_ChannelCF;
+    } else if (i < sizeof(eDefaultMapping) / sizeof(eDefaultMapping[0])) {
+      pMapping[i] = eDefaultMapping[i];
+    } else {
+      pMapping[i] = OMX_AUDIO_ChannelNone;
+    }
+  }
+}
+
+/** Returns the first channel of a mapping at a position, or -1 */
+static int converter_Find(const OMX_AUDIO_CHANNELTYPE* pMapping, OMX_U32 nChannels, OMX_AUDIO_CHANNELTYPE eChannel) {
+  OMX_U32 i;
+
+  for (i = 0; i < nChannels; i++) {
+    if (pMapping[i] == eChannel) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/** Derives the matrix from the channel mappings of the ports. A channel
+  * present on both ports is copied, a mono input goes to all the output
+  * channels and a mono output averages the input channels. The other
+  * channels are folded into the nearest output channels at -3 dB, and the
+  * low frequency channel is dropped. The rows are then scaled so that
+  * the sum of the weights of an output channel does not exceed 1
+  */
+static void converter_DefaultMatrix(omx_converter_component_PrivateType* omx_converter_component_Private, float* pMatrix) {
+  OMX_U32 nIn = omx_converter_component_Private->sPCMModeParam[0].nChannels;
+  OMX_U32 nOut = omx_converter_component_Private->sPCMModeParam[1].nChannels;
+  OMX_AUDIO_CHANNELTYPE eIn[OMX_AUDIO_MAXCHANNELS];
+  OMX_AUDIO_CHANNELTYPE eOut[OMX_AUDIO_MAXCHANNELS];
+  OMX_AUDIO_CHANNELTYPE eSide;
+  int nLeft, nRight, nSide;
+  float fSum;
+  OMX_U32 i, o;
+
+  converter_Mapping(&omx_converter_component_Private->sPCMModeParam[0], eIn);
+  converter_Mapping(&omx_converter_component_Private->sPCMModeParam[1], eOut);
+  memset(pMatrix, 0, nIn * nOut * sizeof(float));
+  nLeft = converter_Find(eOut, nOut, OMX_AUDIO_ChannelLF);
+  nRight = converter_Find(eOut, nOut, OMX_AUDIO_ChannelRF);
+
+  for (i = 0; i < nIn; i++) {
+    for (o = 0; o < nOut; o++) {
+      if (nIn == 1 || nOut == 1) {
+        if (eIn[i] != OMX_AUDIO_ChannelLFE && eOut[o] != OMX_AUDIO_ChannelLFE) {
+          pMatrix[o * nIn + i] = 1.0f;
+        }
+      } else if (eIn[i] == eOut[o] && (eIn[i] != OMX_AUDIO_ChannelNone || i == o)) {
+        pMatrix[o * nIn + i] = 1.0f;
+        break;
+      }
+    }
+    if (nIn == 1 || nOut == 1 || o < nOut) {
+      continue;
+    }
+    switch (eIn[i]) {
+      case OMX_AUDIO_ChannelLS:
+      case OMX_AUDIO_ChannelLR:
+        /* a surround channel moves to the other surround position first */
+        eSide = eIn[i] == OMX_AUDIO_ChannelLS ? OMX_AUDIO_ChannelLR : OMX_AUDIO_ChannelLS;
+        if ((nSide = converter_Find(eOut, nOut, eSide)) >= 0) {
+          pMatrix[nSide * nIn + i] = 1.0f;
+        } else if (nLeft >= 0) {
+          pMatrix[nLeft * nIn + i] = CONVERTER_FOLD_WEIGHT;
+        }
+        break;
+      case OMX_AUDIO_ChannelRS:
+      case OMX_AUDIO_ChannelRR:
+        eSide = eIn[i] == OMX_AUDIO_ChannelRS ? OMX_AUDIO_ChannelRR : OMX_AUDIO_ChannelRS;
+        if ((nSide = converter_Find(eOut, nOut, eSide)) >= 0) {
+          pMatrix[nSide * nIn + i] = 1.0f;
+        } else if (nRight >= 0) {
+          pMatrix[nRight * nIn + i] = CONVERTER_FOLD_WEIGHT;
+        }
+        break;
+      case OMX_AUDIO_ChannelCF:
+      case OMX_AUDIO_ChannelCS:
+        if (nLeft >= 0 && nRight >= 0) {
+          pMatrix[nLeft * nIn + i] = CONVERTER_FOLD_WEIGHT;
+          pMatrix[nRight * nIn + i] = CONVERTER_FOLD_WEIGHT;
+        }
+        break;
+      default:
+        break;
+    }
+  }
+
+  for (o = 0; o < nOut; o++) {
+    fSum = 0.0f;
+    for (i = 0; i < nIn; i++) {
+      fSum += pMatrix[o * nIn + i];
+    }
+    if (fSum > 1.0f) {
+      for (i = 0; i < nIn; i++) {
+        pMatrix[o * nIn + i] /= fSum;
+      }
+    }
+  }
+}
+
+/** Publishes sMatrix to the buffer management thread. The caller holds
+  * matrixMutex, so that there is a single writer of sPublished. nSequence
+  * is odd while it is written
+  */
+static void converter_Publish(omx_converter_component_PrivateType* omx_converter_component_Private) {
+  omx_converter_component_Private->nSequence++;
+  __sync_synchronize();
+  memcpy(&omx_converter_component_Private->sPublished, &omx_converter_component_Private->sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+  __sync_synchronize();
+  omx_converter_component_Private->nSequence++;
+}
+
+/** Reads the matrix published since the one in use. Returns OMX_FALSE if
+  * there is none. Unlike the equalizer it waits for a client writing it,
+  * as the matrix in use may be for other channels
+  */
+static OMX_BOOL converter_Take(omx_converter_component_PrivateType* omx_converter_component_Private,
+                               OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix) {
+  OMX_U32 nSequence;
+
+  do {
+    while ((nSequence = omx_converter_component_Private->nSequence) & 1) {
+      sched_yield();
+    }
+    if (nSequence == omx_converter_component_Private->nApplied) {
+      return OMX_FALSE;
+    }
+    __sync_synchronize();
+    memcpy(pMatrix, &omx_converter_component_Private->sPublished, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+    __sync_synchronize();
+  } while (omx_converter_component_Private->nSequence != nSequence);
+  omx_converter_component_Private->nApplied = nSequence;
+  return OMX_TRUE;
+}
+
+/** Builds the matrix of the buffer management thread from the one set by
+  * the client, or from the channel mappings
+  */
+static void converter_SetupMatrix(omx_converter_component_PrivateType* omx_converter_component_Private,
+                                  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix) {
+  OMX_U32 nIn = omx_converter_component_Private->sPCMModeParam[0].nChannels;
+  OMX_U32 nOut = omx_converter_component_Private->sPCMModeParam[1].nChannels;
+  OMX_U32 i, o;
+
+  if (pMatrix->nInChannels == nIn && pMatrix->nOutChannels == nOut) {
+    for (i = 0; i < nIn * nOut; i++) {
+      omx_converter_component_Private->fMatrix[i] = pMatrix->xCoeffs[i] / 65536.0f;
+    }
+  } else {
+    converter_DefaultMatrix(omx_converter_component_Private, omx_converter_component_Private->fMatrix);
+  }
+
+  omx_converter_component_Private->bIdentity = nIn == nOut ? OMX_TRUE : OMX_FALSE;
+  for (o = 0; o < nOut && omx_converter_component_Private->bIdentity; o++) {
+    for (i = 0; i < nIn; i++) {
+      if (omx_converter_component_Private->fMatrix[o * nIn + i] != (i == o ? 1.0f : 0.0f)) {
+        omx_converter_component_Private->bIdentity = OMX_FALSE;
+        break;
+      }
+    }
+  }
+}
+
+/** Returns the address of the sample of a channel in a buffer of nFrames
+  * frames, and in pStride the distance in samples to the next frame
+  */
+static OMX_U8* converter_Sample(OMX_U8* pBuffer, OMX_AUDIO_PARAM_PCMMODETYPE* pPcmMode, OMX_U32 nSampleSize,
+                                OMX_U32 nFrames, OMX_U32 nChannel, OMX_U32 nFrame, OMX_U32* pStride) {
+  if (pPcmMode->bInterleaved == OMX_TRUE) {
+    *pStride = pPcmMode->nChannels;
+    return pBuffer + (nFrame * pPcmMode->nChannels + nChannel) * nSampleSize;
+  }
+  *pStride = 1;
+  return pBuffer + (nChannel * nFrames + nFrame) * nSampleSize;
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+  * The output buffer takes as many frames as it holds, the rest of the
+  * input buffer is kept for the next output buffer. A planar output buffer
+  * holds planes of the frames it takes
+  */
+void omx_converter_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_AUDIO_PARAM_PCMMODETYPE* pInMode = &omx_converter_component_Private->sPCMModeParam[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  OMX_AUDIO_PARAM_PCMMODETYPE* pOutMode = &omx_converter_component_Private->sPCMModeParam[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  AUDIO_SAMPLE_FORMAT eInFormat = omx_converter_component_Private->eSampleFormat[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  AUDIO_SAMPLE_FORMAT eOutFormat = omx_converter_component_Private->eSampleFormat[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  OMX_U32 nInSampleSize = omx_audio_kernels_GetSampleSize(eInFormat);
+  OMX_U32 nOutSampleSize = omx_audio_kernels_GetSampleSize(eOutFormat);
+  OMX_U32 nIn = pInMode->nChannels;
+  OMX_U32 nOut = pOutMode->nChannels;
+  float* pInPlanes = omx_converter_component_Private->pPlanes;
+  float* pOutPlanes = omx_converter_component_Private->pPlanes + OMX_AUDIO_MAXCHANNELS * CONVERTER_BLOCK;
+  OMX_U8* pIn = pInputBuffer->pBuffer + pInputBuffer->nOffset;
+  OMX_U8* pOut = pOutputBuffer->pBuffer + pOutputBuffer->nOffset;
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sMatrix;
+  OMX_U32 nFrames, nFrame, nBlock, nStride, i;
+  OMX_U8* pSample;
+
+  if (converter_Take(omx_converter_component_Private, &sMatrix)) {
+    converter_SetupMatrix(omx_converter_component_Private, &sMatrix);
+  }
+  if (omx_converter_component_Private->bInputReset) {
+    omx_converter_component_Private->bInputReset = OMX_FALSE;
+    omx_converter_component_Private->nFramesDone = 0;
+  }
+  /* the input buffer stays in place until all its frames are converted,
+   * as the planes of a planar buffer depend on its length */
+  if (omx_converter_component_Private->nFramesDone == 0) {
+    omx_converter_component_Private->nInFrames = pInputBuffer->nFilledLen / (nIn * nInSampleSize);
+  }
+  nFrames = omx_converter_component_Private->nInFrames - omx_converter_component_Private->nFramesDone;
+  if (nFrames > (pOutputBuffer->nAllocLen - pOutputBuffer->nOffset) / (nOut * nOutSampleSize)) {
+    nFrames = (pOutputBuffer->nAllocLen - pOutputBuffer->nOffset) / (nOut * nOutSampleSize);
+  }
+
+  for (nFrame = 0; nFrame < nFrames; nFrame += nBlock) {
+    nBlock = nFrames - nFrame < CONVERTER_BLOCK ? nFrames - nFrame : CONVERTER_BLOCK;
+    if (omx_converter_component_Private->bIdentity && pInMode->bInterleaved == OMX_TRUE && pOutMode->bInterleaved == OMX_TRUE) {
+      /* only the format changes: the interleaved frames are converted as one run of samples */
+      omx_audio_kernels_ToFloat(eInFormat, pInPlanes,
+                                pIn + (omx_converter_component_Private->nFramesDone + nFrame) * nIn * nInSampleSize, 1, nBlock * nIn);
+      omx_audio_kernels_FromFloat(eOutFormat, pOut + nFrame * nOut * nOutSampleSize, 1, pInPlanes, nBlock * nOut);
+      continue;
+    }
+    for (i = 0; i < nIn; i++) {
+      pSample = converter_Sample(pIn, pInMode, nInSampleSize, omx_converter_component_Private->nInFrames,
+                                 i, omx_converter_component_Private->nFramesDone + nFrame, &nStride);
+      omx_audio_kernels_ToFloat(eInFormat, pInPlanes + i * CONVERTER_BLOCK, pSample, nStride, nBlock);
+    }
+    if (!omx_converter_component_Private->bIdentity) {
+      omx_audio_kernels_ChannelMatrix(pOutPlanes, pInPlanes, CONVERTER_BLOCK, omx_converter_component_Private->fMatrix, nIn, nOut, nBlock);
+    }
+    for (i = 0; i < nOut; i++) {
+      pSample = converter_Sample(pOut, pOutMode, nOutSampleSize, nFrames, i, nFrame, &nStride);
+      omx_audio_kernels_FromFloat(eOutFormat, pSample, nStride,
+                                  (omx_converter_component_Private->bIdentity ? pInPlanes : pOutPlanes) + i * CONVERTER_BLOCK, nBlock);
+    }
+  }
+  pOutputBuffer->nFilledLen = nFrames * nOut * nOutSampleSize;
+  omx_converter_component_Private->nFramesDone += nFrames;
+
+  /* a trailing partial frame is dropped */
+  if (omx_converter_component_Private->nFramesDone >= omx_converter_component_Private->nInFrames) {
+    omx_converter_component_Private->nFramesDone = 0;
+    pInputBuffer->nFilledLen = 0;
+    pInputBuffer->nOffset = 0;
+  }
+}
+
+OMX_ERRORTYPE omx_converter_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioChannelMatrix :
+      pMatrix = (OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pMatrix->nPortIndex != OMX_BASE_FILTER_OUTPUTPORT_INDEX) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      if (pMatrix->nInChannels != 0 &&
+          (pMatrix->nInChannels != omx_converter_component_Private->sPCMModeParam[0].nChannels ||
+           pMatrix->nOutChannels != omx_converter_component_Private->sPCMModeParam[1].nChannels)) {
+        DEBUG(DEB_LEV_ERR, "In %s the matrix of %ix%i channels does not match the ports\n",__func__,
+              (int)pMatrix->nInChannels, (int)pMatrix->nOutChannels);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      pthread_mutex_lock(&omx_converter_component_Private->matrixMutex);
+      memcpy(&omx_converter_component_Private->sMatrix, pMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+      converter_Publish(omx_converter_component_Private);
+      pthread_mutex_unlock(&omx_converter_component_Private->matrixMutex);
+      break;
+    default: // delegate to superclass
+      err = omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+/** The channel matrix is returned with the weights in use, the ones
+  * derived from the channel mappings when the client did not set them
+  */
+OMX_ERRORTYPE omx_converter_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE* pMatrix;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+  float fMatrix[OMX_AUDIO_MAXCHANNELS * OMX_AUDIO_MAXCHANNELS];
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_U32 i;
+
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioChannelMatrix :
+      pMatrix = (OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pMatrix->nPortIndex != OMX_BASE_FILTER_OUTPUTPORT_INDEX) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      pthread_mutex_lock(&omx_converter_component_Private->matrixMutex);
+      memcpy(pMatrix, &omx_converter_component_Private->sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+      pthread_mutex_unlock(&omx_converter_component_Private->matrixMutex);
+      if (pMatrix->nInChannels == 0) {
+        pMatrix->nInChannels = omx_converter_component_Private->sPCMModeParam[0].nChannels;
+        pMatrix->nOutChannels = omx_converter_component_Private->sPCMModeParam[1].nChannels;
+        converter_DefaultMatrix(omx_converter_component_Private, fMatrix);
+        for (i = 0; i < pMatrix->nInChannels * pMatrix->nOutChannels; i++) {
+          pMatrix->xCoeffs[i] = (OMX_S32)(fMatrix[i] * 65536.0f + 0.5f);
+        }
+      }
+      break;
+    default :
+      err = omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+/** Maps the channel matrix name to its index, the generic names are
+  * left to the base component
+  */
+OMX_ERRORTYPE omx_converter_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if (strcmp(cParameterName, "OMX.st.index.config.BellagioChannelMatrix") == 0) {
+    *pIndexType = OMX_IndexConfigBellagioChannelMatrix;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
+
+OMX_ERRORTYPE omx_converter_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  AUDIO_SAMPLE_FORMAT eSampleFormat;
+  OMX_U32 portIndex;
+  omx_base_audio_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pAudioPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_converter_component_Private->ports[portIndex];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      eSampleFormat = omx_audio_kernels_GetSampleFormat(pAudioPcmMode);
+      if (eSampleFormat == AUDIO_SAMPLE_UNSUPPORTED ||
+          pAudioPcmMode->nChannels == 0 || pAudioPcmMode->nChannels > OMX_AUDIO_MAXCHANNELS) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported PCM layout of %i bits and %i channels\n",__func__,
+              (int)pAudioPcmMode->nBitPerSample, (int)pAudioPcmMode->nChannels);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* the rate is not converted, it is set on both ports. Past Loaded the sanity
+       * check lets only a disabled port change, the other one may be enabled
+       * and its client must not see its rate change */
+      if (omx_converter_component_Private->state != OMX_StateLoaded && omx_converter_component_Private->state != OMX_StateWaitForResources &&
+          PORT_IS_ENABLED(omx_converter_component_Private->ports[1 - portIndex]) &&
+          pAudioPcmMode->nSamplingRate != omx_converter_component_Private->sPCMModeParam[1 - portIndex].nSamplingRate) {
+        DEBUG(DEB_LEV_ERR, "In %s the rate of the enabled port %i cannot change in state %x\n",__func__,
+              (int)(1 - portIndex), omx_converter_component_Private->state);
+        err = OMX_ErrorIncorrectStateOperation;
+        break;
+      }
+      pthread_mutex_lock(&omx_converter_component_Private->matrixMutex);
+      /* a matrix set for other channels no longer applies */
+      if (pAudioPcmMode->nChannels != omx_converter_component_Private->sPCMModeParam[portIndex].nChannels) {
+        omx_converter_component_Private->sMatrix.nInChannels = 0;
+      }
+      memcpy(&omx_converter_component_Private->sPCMModeParam[portIndex], pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      omx_converter_component_Private->eSampleFormat[portIndex] = eSampleFormat;
+      omx_converter_component_Private->sPCMModeParam[1 - portIndex].nSamplingRate = pAudioPcmMode->nSamplingRate;
+      /* the matrix derived from the channel mappings changes with them */
+      converter_Publish(omx_converter_component_Private);
+      pthread_mutex_unlock(&omx_converter_component_Private->matrixMutex);
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_converter_component_Private->state != OMX_StateLoaded && omx_converter_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_converter_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, CONVERTER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_converter_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_converter_component_PrivateType* omx_converter_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_converter_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_converter_component_Private->ports[pAudioPortFormat->nPortIndex];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+    break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (pAudioPcmMode->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      memcpy(pAudioPcmMode, &omx_converter_component_Private->sPCMModeParam[pAudioPcmMode->nPortIndex], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, CONVERTER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
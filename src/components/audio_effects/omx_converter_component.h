@@ -0,0 +1,118 @@
+/**
+  src/components/audio_effects/omx_converter_component.h
+
+  OpenMAX audio converter component. This component implements a filter that
+  converts the sample format, the layout and the channels of an audio PCM stream.
+  The sampling rate is not converted: setting it on either port sets it on both.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_CONVERTER_COMPONENT_H_
+#define _OMX_CONVERTER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <string.h>
+#include <omx_base_filter.h>
+#include "omx_audio_kernels.h"
+#define CONVERTER_COMP_NAME "OMX.st.audio.converter"
+#define CONVERTER_COMP_ROLE "audio.converter"
+#define MAX_CONVERTER_COMPONENTS 10
+/** The conversion has a single quality level */
+#define CONVERTER_QUALITY_LEVELS 1
+static int converterQualityLevels []={10, 65536};
+
+/** Number of frames converted at a time. The planes of a block stay in
+ * the first level cache between the stages of the conversion
+ */
+#define CONVERTER_BLOCK 256
+
+/** Converter component private structure.
+* see the define above
+*/
+DERIVEDCLASS(omx_converter_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_converter_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  /** @param sPCMModeParam the PCM layout of each port. The ports differ by sample format, layout and channels, not by rate */ \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPCMModeParam[2]; \
+  /** @param eSampleFormat the sample layout given by sPCMModeParam of each port */ \
+  AUDIO_SAMPLE_FORMAT eSampleFormat[2]; \
+  /** @param sMatrix the channel matrix set through OMX_IndexConfigBellagioChannelMatrix, none if nInChannels is 0, guarded by matrixMutex */ \
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sMatrix; \
+  /** @param matrixMutex serializes the clients changing sMatrix or the channels, the buffer management thread never takes it */ \
+  pthread_mutex_t matrixMutex; \
+  /** @param sPublished the copy of sMatrix for the buffer management thread, written under nSequence */ \
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sPublished; \
+  /** @param nSequence odd while sPublished is written, incremented again once it is complete */ \
+  volatile OMX_U32 nSequence; \
+  /** @param nApplied the value of nSequence fMatrix was built at */ \
+  OMX_U32 nApplied; \
+  /** @param fMatrix the weights of the input channels, nInChannels for each output channel */ \
+  float fMatrix[OMX_AUDIO_MAXCHANNELS * OMX_AUDIO_MAXCHANNELS]; \
+  /** @param bIdentity set when fMatrix copies each input channel to the same output channel */ \
+  OMX_BOOL bIdentity; \
+  /** @param pPlanes the planes of a block converted to float, CONVERTER_BLOCK samples for the input channels then for the output channels */ \
+  float* pPlanes; \
+  /** @param nInFrames the frames of the input buffer being converted */ \
+  OMX_U32 nInFrames; \
+  /** @param nFramesDone the frames of the input buffer already converted, 0 before a new input buffer */ \
+  OMX_U32 nFramesDone; \
+  /** @param bInputReset set by a flush, the next input buffer starts from its first frame */ \
+  volatile OMX_BOOL bInputReset; \
+  /** @param BaseFlushProcessingBuffers the flush function of the base port */ \
+  OMX_ERRORTYPE (*BaseFlushProcessingBuffers)(omx_base_PortType *openmaxStandPort);
+ENDCLASS(omx_converter_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_converter_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_converter_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_converter_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_converter_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_converter_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_converter_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_converter_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_converter_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
+#endif
@@ -0,0 +1,640 @@
+/**
+  src/components/audio_effects/omx_equalizer_component.c
+
+  OpenMAX audio equalizer component. This component implements a filter
+  that runs each channel of an audio PCM stream through a cascade of
+  biquad filters, one for each band of the equalizer.
+
+  The samples are filtered in blocks converted to float, in the buffer
+  itself when the base filter can pass it in place. The client changes
+  the bands with SetConfig at any time: the coefficients are published
+  to the buffer management thread without a lock, and taken at the start
+  of a block, over which the output of the old bands fades into the
+  output of the new ones.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <math.h>
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_equalizer_component.h>
+#include<OMX_Audio.h>
+
+static OMX_ERRORTYPE omx_equalizer_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort);
+static void equalizer_Publish(omx_equalizer_component_PrivateType* omx_equalizer_component_Private);
+static OMX_BOOL equalizer_Take(omx_equalizer_component_PrivateType* omx_equalizer_component_Private,
+                               AUDIO_BIQUAD_COEFFS* pCoeffs, OMX_U32* pSections);
+
+OMX_ERRORTYPE omx_equalizer_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+	OMX_ERRORTYPE err;
+	omx_equalizer_component_PrivateType* omx_equalizer_component_Private;
+	OMX_U32 i;
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+	RM_RegisterComponent(EQUALIZER_COMP_NAME, MAX_EQUALIZER_COMPONENTS);
+	if (!openmaxStandComp->pComponentPrivate) {
+		openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_equalizer_component_PrivateType));
+		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s allocated private structure %p for std component %p\n",
+				__func__, openmaxStandComp->pComponentPrivate, openmaxStandComp);
+		if(openmaxStandComp->pComponentPrivate == NULL) {
+			return OMX_ErrorInsufficientResources;
+		}
+	} else {
+		DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+		return OMX_ErrorUndefined;
+	}
+
+	omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+	omx_equalizer_component_Private->ports = NULL;
+
+	/** Calling base filter constructor */
+	err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+	if (err != OMX_ErrorNone) {
+			DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+			return err;
+	}
+
+	omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+	omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 2;
+
+	/** Allocate Ports and call port constructor. */
+	if (omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_equalizer_component_Private->ports) {
+		omx_equalizer_component_Private->ports = calloc(omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
+		if (!omx_equalizer_component_Private->ports) {
+			return OMX_ErrorInsufficientResources;
+		}
+		for (i=0; i < omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			omx_equalizer_component_Private->ports[i] = calloc(1, sizeof(omx_base_audio_PortType));
+			if (!omx_equalizer_component_Private->ports[i]) {
+				return OMX_ErrorInsufficientResources;
+			}
+		}
+	}
+
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_equalizer_component_Private->ports[0], 0, OMX_TRUE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_equalizer_component_Private->ports[1], 1, OMX_FALSE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+
+	/** Domain specific section for the ports. */
+	omx_equalizer_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+	omx_equalizer_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+
+	/* a flush clears the states of the filters */
+	omx_equalizer_component_Private->BaseFlushProcessingBuffers = omx_equalizer_component_Private->ports[0]->FlushProcessingBuffers;
+	for (i = 0; i < 2; i++) {
+		omx_equalizer_component_Private->ports[i]->FlushProcessingBuffers = omx_equalizer_component_port_FlushProcessingBuffers;
+	}
+
+	setHeader(&omx_equalizer_component_Private->sPCMModeParam, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+	omx_equalizer_component_Private->sPCMModeParam.nPortIndex = 0;
+	omx_equalizer_component_Private->sPCMModeParam.nChannels = 2;
+	omx_equalizer_component_Private->sPCMModeParam.eNumData = OMX_NumericalDataSigned;
+	omx_equalizer_component_Private->sPCMModeParam.eEndian = OMX_EndianBig;
+	omx_equalizer_component_Private->sPCMModeParam.bInterleaved = OMX_TRUE;
+	omx_equalizer_component_Private->sPCMModeParam.nBitPerSample = 16;
+	omx_equalizer_component_Private->sPCMModeParam.nSamplingRate = EQUALIZER_DEFAULT_RATE;
+	omx_equalizer_component_Private->sPCMModeParam.ePCMMode = OMX_AUDIO_PCMModeLinear;
+	omx_equalizer_component_Private->eSampleFormat = AUDIO_SAMPLE_S16;
+
+	/* no band until the client sets them */
+	setHeader(&omx_equalizer_component_Private->sEqualizer, sizeof(OMX_CONFIG_BELLAGIOEQUALIZERTYPE));
+	pthread_mutex_init(&omx_equalizer_component_Private->eqMutex, NULL);
+	equalizer_Publish(omx_equalizer_component_Private);
+	equalizer_Take(omx_equalizer_component_Private, &omx_equalizer_component_Private->sCoeffs, &omx_equalizer_component_Private->nSections);
+
+	omx_equalizer_component_Private->pBlock = malloc(2 * OMX_AUDIO_MAXCHANNELS * EQUALIZER_BLOCK * sizeof(float));
+	if (!omx_equalizer_component_Private->pBlock) {
+		return OMX_ErrorInsufficientResources;
+	}
+
+	omx_equalizer_component_Private->destructor = omx_equalizer_component_Destructor;
+	openmaxStandComp->SetParameter = omx_equalizer_component_SetParameter;
+	openmaxStandComp->GetParameter = omx_equalizer_component_GetParameter;
+	openmaxStandComp->GetConfig = omx_equalizer_component_GetConfig;
+	openmaxStandComp->GetExtensionIndex = omx_equalizer_component_GetExtensionIndex;
+	openmaxStandComp->SetConfig = omx_equalizer_component_SetConfig;
+	omx_equalizer_component_Private->BufferMgmtCallback = omx_equalizer_component_BufferMgmtCallback;
+	omx_equalizer_component_Private->bInPlace = OMX_TRUE;
+
+  /* resource management special section */
+  omx_equalizer_component_Private->nqualitylevels = EQUALIZER_QUALITY_LEVELS;
+  omx_equalizer_component_Private->currentQualityLevel = 1;
+  omx_equalizer_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * EQUALIZER_QUALITY_LEVELS);
+  for (i = 0; i<EQUALIZER_QUALITY_LEVELS; i++) {
+	  omx_equalizer_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  omx_equalizer_component_Private->multiResourceLevel[i]->CPUResourceRequested = equalizerQualityLevels[i * 2];
+	  omx_equalizer_component_Private->multiResourceLevel[i]->MemoryResourceRequested = equalizerQualityLevels[i * 2 + 1];
+  }
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_equalizer_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+
+	omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+	OMX_U32 i;
+
+	/* frees port/s */
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+	if (omx_equalizer_component_Private->ports) {
+		for (i=0; i < omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			if(omx_equalizer_component_Private->ports[i]) {
+				omx_equalizer_component_Private->ports[i]->PortDestructor(omx_equalizer_component_Private->ports[i]);
+			}
+		}
+		free(omx_equalizer_component_Private->ports);
+		omx_equalizer_component_Private->ports=NULL;
+	}
+
+	omx_base_filter_Destructor(openmaxStandComp);
+	pthread_mutex_destroy(&omx_equalizer_component_Private->eqMutex);
+	free(omx_equalizer_component_Private->pBlock);
+	omx_equalizer_component_Private->pBlock = NULL;
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+/** Flushes the port like the base port, the next buffer starts from silence
+  */
+static OMX_ERRORTYPE omx_equalizer_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort) {
+  omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE err;
+
+  err = omx_equalizer_component_Private->BaseFlushProcessingBuffers(openmaxStandPort);
+  omx_equalizer_component_Private->bEqReset = OMX_TRUE;
+  return err;
+}
+
+/** Designs the biquad filter of a band, from the cookbook formulae of
+  * Robert Bristow-Johnson, and stores it as the section s
+  */
+static void equalizer_Design(const OMX_BELLAGIOEQBANDTYPE* pBand, OMX_U32 nRate, AUDIO_BIQUAD_COEFFS* pCoeffs, OMX_U32 s) {
+  double fA, fW, fCos, fAlpha, fRoot, b0, b1, b2, a0, a1, a2;
+
+  if ((OMX_U64)pBand->nFrequency * 2 >= nRate) {
+    pCoeffs->b0[s] = 1.0f;
+    pCoeffs->b1[s] = pCoeffs->b2[s] = pCoeffs->a1[s] = pCoeffs->a2[s] = 0.0f;
+    return;
+  }
+  fA = pow(10.0, pBand->nGain / 4000.0);
+  fW = 2.0 * M_PI * pBand->nFrequency / nRate;
+  fCos = cos(fW);
+  fAlpha = sin(fW) / (2.0 * pBand->xQ / 65536.0);
+  fRoot = 2.0 * sqrt(fA) * fAlpha;
+  switch (pBand->eFilter) {
+    case OMX_BellagioEqLowShelf:
+      b0 = fA * ((fA + 1.0) - (fA - 1.0) * fCos + fRoot);
+      b1 = 2.0 * fA * ((fA - 1.0) - (fA + 1.0) * fCos);
+      b2 = fA * ((fA + 1.0) - (fA - 1.0) * fCos - fRoot);
+      a0 = (fA + 1.0) + (fA - 1.0) * fCos + fRoot;
+      a1 = -2.0 * ((fA - 1.0) + (fA + 1.0) * fCos);
+      a2 = (fA + 1.0) + (fA - 1.0) * fCos - fRoot;
+      break;
+    case OMX_BellagioEqHighShelf:
+      b0 = fA * ((fA + 1.0) + (fA - 1.0) * fCos + fRoot);
+      b1 = -2.0 * fA * ((fA - 1.0) + (fA + 1.0) * fCos);
+      b2 = fA * ((fA + 1.0) + (fA - 1.0) * fCos - fRoot);
+      a0 = (fA + 1.0) - (fA - 1.0) * fCos + fRoot;
+      a1 = 2.0 * ((fA - 1.0) - (fA + 1.0) * fCos);
+      a2 = (fA + 1.0) - (fA - 1.0) * fCos - fRoot;
+      break;
+    case OMX_BellagioEqLowPass:
+      b0 = (1.0 - fCos) / 2.0;
+      b1 = 1.0 - fCos;
+      b2 = (1.0 - fCos) / 2.0;
+      a0 = 1.0 + fAlpha;
+      a1 = -2.0 * fCos;
+      a2 = 1.0 - fAlpha;
+      break;
+    case OMX_BellagioEqHighPass:
+      b0 = (1.0 + fCos) / 2.0;
+      b1 = -(1.0 + fCos);
+      b2 = (1.0 + fCos) / 2.0;
+      a0 = 1.0 + fAlpha;
+      a1 = -2.0 * fCos;
+      a2 = 1.0 - fAlpha;
+      break;
+    default:
+      b0 = 1.0 + fAlpha * fA;
+      b1 = -2.0 * fCos;
+      b2 = 1.0 - fAlpha * fA;
+      a0 = 1.0 + fAlpha / fA;
+      a1 = -2.0 * fCos;
+      a2 = 1.0 - fAlpha / fA;
+      break;
+  }
+  pCoeffs->b0[s] = (float)(b0 / a0);
+  pCoeffs->b1[s] = (float)(b1 / a0);
+  pCoeffs->b2[s] = (float)(b2 / a0);
+  pCoeffs->a1[s] = (float)(a1 / a0);
+  pCoeffs->a2[s] = (float)(a2 / a0);
+}
+
+/** Designs the bands of sEqualizer and publishes their coefficients to
+  * the buffer management thread. The caller holds eqMutex, so that there
+  * is a single writer of sPublished. nSequence is odd while it is written
+  */
+static void equalizer_Publish(omx_equalizer_component_PrivateType* omx_equalizer_component_Private) {
+  AUDIO_BIQUAD_COEFFS sCoeffs;
+  OMX_U32 nRate = omx_equalizer_component_Private->sPCMModeParam.nSamplingRate;
+  OMX_U32 s;
+
+  for (s = 0; s < AUDIO_BIQUAD_SECTIONS; s++) {
+    if (s < omx_equalizer_component_Private->sEqualizer.nBands) {
+      equalizer_Design(&omx_equalizer_component_Private->sEqualizer.sBands[s], nRate ? nRate : EQUALIZER_DEFAULT_RATE, &sCoeffs, s);
+    } else {
+      sCoeffs.b0[s] = 1.0f;
+      sCoeffs.b1[s] = sCoeffs.b2[s] = sCoeffs.a1[s] = sCoeffs.a2[s] = 0.0f;
+    }
+  }
+  omx_equalizer_component_Private->nSequence++;
+  __sync_synchronize();
+  memcpy(&omx_equalizer_component_Private->sPublished, &sCoeffs, sizeof(AUDIO_BIQUAD_COEFFS));
+  omx_equalizer_component_Private->nPublishedSections = omx_equalizer_component_Private->sEqualizer.nBands;
+  __sync_synchronize();
+  omx_equalizer_component_Private->nSequence++;
+}
+
+/** Reads the coefficients published since the ones in use, without
+  * waiting for a client writing them. Returns OMX_FALSE if there are none,
+  * or if they are being written, in which case the next block tries again
+  */
+static OMX_BOOL equalizer_Take(omx_equalizer_component_PrivateType* omx_equalizer_component_Private,
+                               AUDIO_BIQUAD_COEFFS* pCoeffs, OMX_U32* pSections) {
+  OMX_U32 nSequence = omx_equalizer_component_Private->nSequence;
+
+  if (nSequence == omx_equalizer_component_Private->nApplied || (nSequence & 1)) {
+    return OMX_FALSE;
+  }
+  __sync_synchronize();
+  memcpy(pCoeffs, &omx_equalizer_component_Private->sPublished, sizeof(AUDIO_BIQUAD_COEFFS));
+  *pSections = omx_equalizer_component_Private->nPublishedSections;
+  __sync_synchronize();
+  if (omx_equalizer_component_Private->nSequence != nSequence) {
+    return OMX_FALSE;
+  }
+  omx_equalizer_component_Private->nApplied = nSequence;
+  return OMX_TRUE;
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+  * The frames are converted to float a block at a time, filtered and
+  * converted back, in the input buffer itself when the base filter
+  * passes it in place. When new coefficients are taken at the start of a
+  * block, the block also goes through the old ones with a copy of the
+  * states, and the two outputs are cross-faded
+  */
+void omx_equalizer_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+  AUDIO_SAMPLE_FORMAT eFormat = omx_equalizer_component_Private->eSampleFormat;
+  OMX_U32 nChannels = omx_equalizer_component_Private->sPCMModeParam.nChannels;
+  OMX_U32 nFrameSize = omx_audio_kernels_GetSampleSize(eFormat) * nChannels;
+  OMX_U32 nFrames = pInputBuffer->nFilledLen / nFrameSize;
+  OMX_U8* pIn = pInputBuffer->pBuffer + pInputBuffer->nOffset;
+  float* pBlock = omx_equalizer_component_Private->pBlock;
+  float* pOld = omx_equalizer_component_Private->pBlock + OMX_AUDIO_MAXCHANNELS * EQUALIZER_BLOCK;
+  AUDIO_BIQUAD_STATE sOldState[OMX_AUDIO_MAXCHANNELS];
+  AUDIO_BIQUAD_COEFFS sCoeffs;
+  OMX_U32 nFrame, nBlock, nSections = 0, nOldSections, i, c, s;
+  OMX_BOOL bFade;
+  OMX_U8* pOut;
+  float fFade;
+
+  if (omx_equalizer_component_Private->bEqReset) {
+    omx_equalizer_component_Private->bEqReset = OMX_FALSE;
+    memset(omx_equalizer_component_Private->sState, 0, sizeof(omx_equalizer_component_Private->sState));
+  }
+  if (pOutputBuffer->pBuffer != pInputBuffer->pBuffer) {
+    pOutputBuffer->nOffset = 0;
+  }
+  pOut = pOutputBuffer->pBuffer + pOutputBuffer->nOffset;
+
+  for (nFrame = 0; nFrame < nFrames; nFrame += nBlock) {
+    nBlock = nFrames - nFrame < EQUALIZER_BLOCK ? nFrames - nFrame : EQUALIZER_BLOCK;
+    nOldSections = omx_equalizer_component_Private->nSections;
+    bFade = equalizer_Take(omx_equalizer_component_Private, &sCoeffs, &nSections) && (nOldSections > 0 || nSections > 0);
+    if (!bFade && nOldSections == 0) {
+      /* no band, the samples pass unchanged */
+      if (pOut != pIn) {
+        memcpy(pOut + nFrame * nFrameSize, pIn + nFrame * nFrameSize, nBlock * nFrameSize);
+      }
+      continue;
+    }
+    omx_audio_kernels_ToFloat(eFormat, pBlock, pIn + nFrame * nFrameSize, 1, nBlock * nChannels);
+    if (bFade) {
+      DEBUG(DEB_LEV_FULL_SEQ, "In %s %i bands replace %i\n", __func__, (int)nSections, (int)nOldSections);
+      memcpy(pOld, pBlock, nBlock * nChannels * sizeof(float));
+      memcpy(sOldState, omx_equalizer_component_Private->sState, nChannels * sizeof(AUDIO_BIQUAD_STATE));
+      omx_audio_kernels_Biquad(pOld, nChannels, nBlock, &omx_equalizer_component_Private->sCoeffs, nOldSections, sOldState);
+      /* the new bands go on from the states of the old ones, the sections left out are cleared */
+      memcpy(&omx_equalizer_component_Private->sCoeffs, &sCoeffs, sizeof(AUDIO_BIQUAD_COEFFS));
+      omx_equalizer_component_Private->nSections = nSections;
+      for (c = 0; c < nChannels; c++) {
+        for (s = nSections; s < AUDIO_BIQUAD_SECTIONS; s++) {
+          omx_equalizer_component_Private->sState[c].z1[s] = 0.0f;
+          omx_equalizer_component_Private->sState[c].z2[s] = 0.0f;
+        }
+      }
+    }
+    omx_audio_kernels_Biquad(pBlock, nChannels, nBlock, &omx_equalizer_component_Private->sCoeffs,
+                             omx_equalizer_component_Private->nSections, omx_equalizer_component_Private->sState);
+    if (bFade) {
+      for (i = 0; i < nBlock; i++) {
+        fFade = (float)(i + 1) / nBlock;
+        for (c = 0; c < nChannels; c++) {
+          pBlock[i * nChannels + c] = pOld[i * nChannels + c] + (pBlock[i * nChannels + c] - pOld[i * nChannels + c]) * fFade;
+        }
+      }
+    }
+    omx_audio_kernels_FromFloat(eFormat, pOut + nFrame * nFrameSize, 1, pBlock, nBlock * nChannels);
+  }
+  pOutputBuffer->nFilledLen = nFrames * nFrameSize;
+  pInputBuffer->nFilledLen = 0;
+}
+
+/** Sets all the bands at once. They are designed and published here, in
+  * the thread of the client, and take effect at the next block
+  */
+OMX_ERRORTYPE omx_equalizer_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOEQUALIZERTYPE* pEqualizer;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_U32 i;
+
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioEqualizer :
+      pEqualizer = (OMX_CONFIG_BELLAGIOEQUALIZERTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOEQUALIZERTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pEqualizer->nPortIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      if (pEqualizer->nBands > OMX_BELLAGIO_EQ_MAXBANDS) {
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      for (i = 0; i < pEqualizer->nBands && err == OMX_ErrorNone; i++) {
+        if ((OMX_U32)pEqualizer->sBands[i].eFilter >= OMX_BellagioEqFilterMax ||
+            pEqualizer->sBands[i].nFrequency == 0 || pEqualizer->sBands[i].xQ == 0) {
+          DEBUG(DEB_LEV_ERR, "In %s band %i of filter %i at %i Hz is not valid\n", __func__, (int)i,
+                (int)pEqualizer->sBands[i].eFilter, (int)pEqualizer->sBands[i].nFrequency);
+          err = OMX_ErrorBadParameter;
+        }
+      }
+      if (err != OMX_ErrorNone) {
+        break;
+      }
+      pthread_mutex_lock(&omx_equalizer_component_Private->eqMutex);
+      memcpy(&omx_equalizer_component_Private->sEqualizer, pEqualizer, sizeof(OMX_CONFIG_BELLAGIOEQUALIZERTYPE));
+      equalizer_Publish(omx_equalizer_component_Private);
+      pthread_mutex_unlock(&omx_equalizer_component_Private->eqMutex);
+      break;
+    default: // delegate to superclass
+      err = omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_equalizer_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOEQUALIZERTYPE* pEqualizer;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_U32 portIndex;
+
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioEqualizer :
+      pEqualizer = (OMX_CONFIG_BELLAGIOEQUALIZERTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOEQUALIZERTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pEqualizer->nPortIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      portIndex = pEqualizer->nPortIndex;
+      pthread_mutex_lock(&omx_equalizer_component_Private->eqMutex);
+      memcpy(pEqualizer, &omx_equalizer_component_Private->sEqualizer, sizeof(OMX_CONFIG_BELLAGIOEQUALIZERTYPE));
+      pthread_mutex_unlock(&omx_equalizer_component_Private->eqMutex);
+      pEqualizer->nPortIndex = portIndex;
+      break;
+    default :
+      err = omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+/** Looks up the equalizer config name before the generic ones of the
+  * base component
+  */
+OMX_ERRORTYPE omx_equalizer_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if (strcmp(cParameterName, "OMX.st.index.config.BellagioEqualizer") == 0) {
+    *pIndexType = OMX_IndexConfigBellagioEqualizer;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
+
+OMX_ERRORTYPE omx_equalizer_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  AUDIO_SAMPLE_FORMAT eSampleFormat;
+  OMX_U32 portIndex;
+  omx_base_audio_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pAudioPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_equalizer_component_Private->ports[portIndex];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      eSampleFormat = omx_audio_kernels_GetSampleFormat(pAudioPcmMode);
+      if (eSampleFormat == AUDIO_SAMPLE_UNSUPPORTED || pAudioPcmMode->bInterleaved == OMX_FALSE ||
+          pAudioPcmMode->nChannels == 0 || pAudioPcmMode->nChannels > OMX_AUDIO_MAXCHANNELS) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported PCM layout of %i bits and %i channels\n",__func__,
+              (int)pAudioPcmMode->nBitPerSample, (int)pAudioPcmMode->nChannels);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* the layout applies to both ports, and the filters the buffer management
+       * thread runs are designed for it: it cannot change while either port runs */
+      if (omx_equalizer_component_Private->state != OMX_StateLoaded && omx_equalizer_component_Private->state != OMX_StateWaitForResources &&
+          PORT_IS_ENABLED(omx_equalizer_component_Private->ports[1 - portIndex])) {
+        DEBUG(DEB_LEV_ERR, "In %s the layout of the enabled port %i cannot change in state %x\n",__func__,
+              (int)(1 - portIndex), omx_equalizer_component_Private->state);
+        err = OMX_ErrorIncorrectStateOperation;
+        break;
+      }
+      memcpy(&omx_equalizer_component_Private->sPCMModeParam, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      omx_equalizer_component_Private->eSampleFormat = eSampleFormat;
+      omx_equalizer_component_Private->bEqReset = OMX_TRUE;
+      /* the bands are designed again for the rate */
+      pthread_mutex_lock(&omx_equalizer_component_Private->eqMutex);
+      equalizer_Publish(omx_equalizer_component_Private);
+      pthread_mutex_unlock(&omx_equalizer_component_Private->eqMutex);
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_equalizer_component_Private->state != OMX_StateLoaded && omx_equalizer_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_equalizer_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, EQUALIZER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_equalizer_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_U32 portIndex;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_equalizer_component_PrivateType* omx_equalizer_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_equalizer_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_equalizer_component_Private->ports[pAudioPortFormat->nPortIndex];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+    break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (pAudioPcmMode->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      portIndex = pAudioPcmMode->nPortIndex;
+      memcpy(pAudioPcmMode, &omx_equalizer_component_Private->sPCMModeParam, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      pAudioPcmMode->nPortIndex = portIndex;
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, EQUALIZER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
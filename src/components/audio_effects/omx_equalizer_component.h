@@ -0,0 +1,125 @@
+/**
+  src/components/audio_effects/omx_equalizer_component.h
+
+  OpenMAX audio equalizer component. This component implements a filter
+  that runs each channel of an audio PCM stream through a cascade of
+  biquad filters, one for each band of the equalizer. It filters in place
+  when it allocated the buffers of both ports, and the payload of a header
+  returned to the client may then be another one than it was allocated.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_EQUALIZER_COMPONENT_H_
+#define _OMX_EQUALIZER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <string.h>
+#include <pthread.h>
+#include <omx_base_filter.h>
+#include "omx_audio_kernels.h"
+#define EQUALIZER_COMP_NAME "OMX.st.audio.equalizer"
+#define EQUALIZER_COMP_ROLE "audio.equalizer"
+#define MAX_EQUALIZER_COMPONENTS 10
+/** The equalizer has a single quality level */
+#define EQUALIZER_QUALITY_LEVELS 1
+static int equalizerQualityLevels []={10, 65536};
+
+/** The sample rate the bands are designed for when the client sets none */
+#define EQUALIZER_DEFAULT_RATE 44100
+
+/** Number of frames filtered at a time. The coefficients change between
+ * two blocks, and the output of the old ones fades into the output of the
+ * new ones over the block
+ */
+#define EQUALIZER_BLOCK 256
+
+/** Equalizer component private structure.
+* see the define above
+*/
+DERIVEDCLASS(omx_equalizer_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_equalizer_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  /** @param sPCMModeParam the PCM layout of both ports, the component does not convert it */ \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPCMModeParam; \
+  /** @param eSampleFormat the sample layout given by sPCMModeParam */ \
+  AUDIO_SAMPLE_FORMAT eSampleFormat; \
+  /** @param sEqualizer the bands set by the client, guarded by eqMutex */ \
+  OMX_CONFIG_BELLAGIOEQUALIZERTYPE sEqualizer; \
+  /** @param eqMutex serializes the clients changing the bands, the buffer management thread never takes it */ \
+  pthread_mutex_t eqMutex; \
+  /** @param sPublished the coefficients of the bands for the buffer management thread, written under nSequence */ \
+  AUDIO_BIQUAD_COEFFS sPublished; \
+  /** @param nPublishedSections the sections of sPublished */ \
+  OMX_U32 nPublishedSections; \
+  /** @param nSequence odd while sPublished is written, incremented again once it is complete */ \
+  volatile OMX_U32 nSequence; \
+  /** @param nApplied the value of nSequence the coefficients in use were read at */ \
+  OMX_U32 nApplied; \
+  /** @param sCoeffs the coefficients in use by the buffer management thread */ \
+  AUDIO_BIQUAD_COEFFS sCoeffs; \
+  /** @param nSections the sections of sCoeffs */ \
+  OMX_U32 nSections; \
+  /** @param sState the state of the sections for each channel */ \
+  AUDIO_BIQUAD_STATE sState[OMX_AUDIO_MAXCHANNELS]; \
+  /** @param pBlock a block of frames converted to float, then the same block through the old coefficients while they change */ \
+  float* pBlock; \
+  /** @param bEqReset set by a flush or a new layout, the states are cleared before the next buffer */ \
+  volatile OMX_BOOL bEqReset; \
+  /** @param BaseFlushProcessingBuffers the flush function of the base port */ \
+  OMX_ERRORTYPE (*BaseFlushProcessingBuffers)(omx_base_PortType *openmaxStandPort);
+ENDCLASS(omx_equalizer_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_equalizer_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_equalizer_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_equalizer_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_equalizer_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_equalizer_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_equalizer_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_equalizer_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_equalizer_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
+#endif
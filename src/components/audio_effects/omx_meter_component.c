@@ -0,0 +1,542 @@
+/**
+  src/components/audio_effects/omx_meter_component.c
+
+  OpenMAX audio meter component. This component implements a filter that
+  passes an audio PCM stream through unchanged and measures the peak, the
+  RMS level and the clipped samples of each of its channels.
+
+  The stream is measured over windows of a fixed duration. The levels of
+  the last complete window are returned by GetConfig, and sent to the
+  client in vendor events no more often than it asks. The buffers go
+  downstream without copy when the base filter can pass them in place,
+  so that the measure costs one more read of samples still in the cache.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <math.h>
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_meter_component.h>
+#include<OMX_Audio.h>
+
+static OMX_ERRORTYPE omx_meter_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort);
+
+OMX_ERRORTYPE omx_meter_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+	OMX_ERRORTYPE err;
+	omx_meter_component_PrivateType* omx_meter_component_Private;
+	OMX_U32 i;
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+	RM_RegisterComponent(METER_COMP_NAME, MAX_METER_COMPONENTS);
+	if (!openmaxStandComp->pComponentPrivate) {
+		openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_meter_component_PrivateType));
+		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s allocated private structure %p for std component %p\n",
+				__func__, openmaxStandComp->pComponentPrivate, openmaxStandComp);
+		if(openmaxStandComp->pComponentPrivate == NULL) {
+			return OMX_ErrorInsufficientResources;
+		}
+	} else {
+		DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+		return OMX_ErrorUndefined;
+	}
+
+	omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+	omx_meter_component_Private->ports = NULL;
+
+	/** Calling base filter constructor */
+	err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+	if (err != OMX_ErrorNone) {
+			DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+			return err;
+	}
+
+	omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+	omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 2;
+
+	/** Allocate Ports and call port constructor. */
+	if (omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_meter_component_Private->ports) {
+		omx_meter_component_Private->ports = calloc(omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
+		if (!omx_meter_component_Private->ports) {
+			return OMX_ErrorInsufficientResources;
+		}
+		for (i=0; i < omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			omx_meter_component_Private->ports[i] = calloc(1, sizeof(omx_base_audio_PortType));
+			if (!omx_meter_component_Private->ports[i]) {
+				return OMX_ErrorInsufficientResources;
+			}
+		}
+	}
+
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_meter_component_Private->ports[0], 0, OMX_TRUE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_meter_component_Private->ports[1], 1, OMX_FALSE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+
+	/** Domain specific section for the ports. */
+	omx_meter_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+	omx_meter_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+
+	/* a flush drops the window being measured */
+	omx_meter_component_Private->BaseFlushProcessingBuffers = omx_meter_component_Private->ports[0]->FlushProcessingBuffers;
+	for (i = 0; i < 2; i++) {
+		omx_meter_component_Private->ports[i]->FlushProcessingBuffers = omx_meter_component_port_FlushProcessingBuffers;
+	}
+
+	setHeader(&omx_meter_component_Private->sPCMModeParam, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+	omx_meter_component_Private->sPCMModeParam.nPortIndex = 0;
+	omx_meter_component_Private->sPCMModeParam.nChannels = 2;
+	omx_meter_component_Private->sPCMModeParam.eNumData = OMX_NumericalDataSigned;
+	omx_meter_component_Private->sPCMModeParam.eEndian = OMX_EndianBig;
+	omx_meter_component_Private->sPCMModeParam.bInterleaved = OMX_TRUE;
+	omx_meter_component_Private->sPCMModeParam.nBitPerSample = 16;
+	omx_meter_component_Private->sPCMModeParam.nSamplingRate = METER_DEFAULT_RATE;
+	omx_meter_component_Private->sPCMModeParam.ePCMMode = OMX_AUDIO_PCMModeLinear;
+	omx_meter_component_Private->eSampleFormat = AUDIO_SAMPLE_S16;
+
+	setHeader(&omx_meter_component_Private->sLevels, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE));
+	omx_meter_component_Private->sLevels.nWindowMs = METER_DEFAULT_WINDOW_MS;
+	pthread_mutex_init(&omx_meter_component_Private->levelsMutex, NULL);
+
+	omx_meter_component_Private->destructor = omx_meter_component_Destructor;
+	openmaxStandComp->SetParameter = omx_meter_component_SetParameter;
+	openmaxStandComp->GetParameter = omx_meter_component_GetParameter;
+	openmaxStandComp->GetConfig = omx_meter_component_GetConfig;
+	openmaxStandComp->GetExtensionIndex = omx_meter_component_GetExtensionIndex;
+	openmaxStandComp->SetConfig = omx_meter_component_SetConfig;
+	omx_meter_component_Private->BufferMgmtCallback = omx_meter_component_BufferMgmtCallback;
+	omx_meter_component_Private->bInPlace = OMX_TRUE;
+	/* an empty buffer ending the stream still publishes the last window */
+	omx_meter_component_Private->bCallbackOnEOS = OMX_TRUE;
+
+  /* resource management special section */
+  omx_meter_component_Private->nqualitylevels = METER_QUALITY_LEVELS;
+  omx_meter_component_Private->currentQualityLevel = 1;
+  omx_meter_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * METER_QUALITY_LEVELS);
+  for (i = 0; i<METER_QUALITY_LEVELS; i++) {
+	  omx_meter_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  omx_meter_component_Private->multiResourceLevel[i]->CPUResourceRequested = meterQualityLevels[i * 2];
+	  omx_meter_component_Private->multiResourceLevel[i]->MemoryResourceRequested = meterQualityLevels[i * 2 + 1];
+  }
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_meter_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+
+	omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+	OMX_U32 i;
+
+	/* frees port/s */
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+	if (omx_meter_component_Private->ports) {
+		for (i=0; i < omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			if(omx_meter_component_Private->ports[i]) {
+				omx_meter_component_Private->ports[i]->PortDestructor(omx_meter_component_Private->ports[i]);
+			}
+		}
+		free(omx_meter_component_Private->ports);
+		omx_meter_component_Private->ports=NULL;
+	}
+
+	omx_base_filter_Destructor(openmaxStandComp);
+	pthread_mutex_destroy(&omx_meter_component_Private->levelsMutex);
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+/** Flushes the port like the base port, the next buffer starts a new window
+  */
+static OMX_ERRORTYPE omx_meter_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort) {
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE err;
+
+  err = omx_meter_component_Private->BaseFlushProcessingBuffers(openmaxStandPort);
+  omx_meter_component_Private->bMeterReset = OMX_TRUE;
+  return err;
+}
+
+/** Converts a level in Q16 of the full scale. The floating point samples
+  * can go past the full scale, up to the largest value
+  */
+static OMX_U32 meter_Q16(double fLevel) {
+  if (fLevel >= 65535.0) {
+    return 0xFFFFFFFF;
+  }
+  return (OMX_U32)(fLevel * 65536.0 + 0.5);
+}
+
+/** Starts a new window */
+static void meter_Clear(omx_meter_component_PrivateType* omx_meter_component_Private) {
+  memset(omx_meter_component_Private->fPeak, 0, sizeof(omx_meter_component_Private->fPeak));
+  memset(omx_meter_component_Private->fSquares, 0, sizeof(omx_meter_component_Private->fSquares));
+  memset(omx_meter_component_Private->nClips, 0, sizeof(omx_meter_component_Private->nClips));
+  omx_meter_component_Private->nFrames = 0;
+}
+
+/** Publishes the levels of the window measured, then sends them to the
+  * client if it asked for events and the interval has passed since the
+  * previous one. The last window of a stream is always sent
+  */
+static void meter_Publish(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BOOL bEnd) {
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE sLevels;
+  OMX_U32 nChannels = omx_meter_component_Private->sPCMModeParam.nChannels;
+  OMX_U32 nFrames = omx_meter_component_Private->nFrames;
+  OMX_U64 nNow;
+  OMX_U32 c;
+
+  pthread_mutex_lock(&omx_meter_component_Private->levelsMutex);
+  omx_meter_component_Private->sLevels.nWindows++;
+  omx_meter_component_Private->sLevels.nChannels = nChannels;
+  omx_meter_component_Private->sLevels.nFrames = nFrames;
+  for (c = 0; c < OMX_AUDIO_MAXCHANNELS; c++) {
+    if (c < nChannels && nFrames > 0) {
+      omx_meter_component_Private->sLevels.nPeak[c] = meter_Q16(omx_meter_component_Private->fPeak[c]);
+      omx_meter_component_Private->sLevels.nRms[c] = meter_Q16(sqrt(omx_meter_component_Private->fSquares[c] / nFrames));
+      omx_meter_component_Private->sLevels.nClips[c] = omx_meter_component_Private->nClips[c];
+    } else {
+      omx_meter_component_Private->sLevels.nPeak[c] = 0;
+      omx_meter_component_Private->sLevels.nRms[c] = 0;
+      omx_meter_component_Private->sLevels.nClips[c] = 0;
+    }
+  }
+  memcpy(&sLevels, &omx_meter_component_Private->sLevels, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE));
+  pthread_mutex_unlock(&omx_meter_component_Private->levelsMutex);
+  meter_Clear(omx_meter_component_Private);
+
+  if (sLevels.nEventIntervalMs == 0) {
+    return;
+  }
+  nNow = base_port_StatTime();
+  if (!bEnd && omx_meter_component_Private->nLastEvent != 0 &&
+      nNow - omx_meter_component_Private->nLastEvent < (OMX_U64)sLevels.nEventIntervalMs * 1000000) {
+    return;
+  }
+  omx_meter_component_Private->nLastEvent = nNow;
+  DEBUG(DEB_LEV_FULL_SEQ, "In %s window %i of %i frames\n", __func__, (int)sLevels.nWindows, (int)nFrames);
+  (*(omx_meter_component_Private->callbacks->EventHandler))
+    (openmaxStandComp,
+    omx_meter_component_Private->callbackData,
+    OMX_EventBellagioAudioLevels,
+    OMX_BASE_FILTER_INPUTPORT_INDEX,
+    sLevels.nWindows,
+    &sLevels);
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+  * The samples are measured in the input buffer, which goes downstream as
+  * the output buffer when the base filter passes it in place
+  */
+void omx_meter_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 nChannels = omx_meter_component_Private->sPCMModeParam.nChannels;
+  OMX_U32 nFrameSize = omx_audio_kernels_GetSampleSize(omx_meter_component_Private->eSampleFormat) * nChannels;
+  OMX_U32 nFrames = pInputBuffer->nFilledLen / nFrameSize;
+  OMX_U32 nRate = omx_meter_component_Private->sPCMModeParam.nSamplingRate;
+  OMX_U32 nWindowFrames, nFrame, nCount;
+  OMX_U8* pIn = pInputBuffer->pBuffer + pInputBuffer->nOffset;
+
+  if (omx_meter_component_Private->bMeterReset) {
+    omx_meter_component_Private->bMeterReset = OMX_FALSE;
+    meter_Clear(omx_meter_component_Private);
+  }
+  nWindowFrames = (OMX_U32)((OMX_U64)(nRate ? nRate : METER_DEFAULT_RATE) * omx_meter_component_Private->sLevels.nWindowMs / 1000);
+  if (nWindowFrames == 0) {
+    nWindowFrames = 1;
+  }
+
+  /* a buffer can complete several windows, or none */
+  for (nFrame = 0; nFrame < nFrames; nFrame += nCount) {
+    nCount = nFrames - nFrame;
+    if (omx_meter_component_Private->nFrames + nCount > nWindowFrames) {
+      nCount = omx_meter_component_Private->nFrames < nWindowFrames ? nWindowFrames - omx_meter_component_Private->nFrames : 0;
+    }
+    omx_audio_kernels_Levels(omx_meter_component_Private->eSampleFormat, pIn + nFrame * nFrameSize, nChannels, nCount,
+                             omx_meter_component_Private->fPeak, omx_meter_component_Private->fSquares, omx_meter_component_Private->nClips);
+    omx_meter_component_Private->nFrames += nCount;
+    if (omx_meter_component_Private->nFrames >= nWindowFrames) {
+      meter_Publish(openmaxStandComp, OMX_FALSE);
+    }
+  }
+  if ((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) && omx_meter_component_Private->nFrames > 0) {
+    meter_Publish(openmaxStandComp, OMX_TRUE);
+  }
+
+  /* the samples are passed unchanged, copied only when the buffer could not be passed */
+  if (pOutputBuffer->pBuffer != pInputBuffer->pBuffer) {
+    pOutputBuffer->nOffset = 0;
+    memcpy(pOutputBuffer->pBuffer, pIn, pInputBuffer->nFilledLen);
+  }
+  pOutputBuffer->nFilledLen = pInputBuffer->nFilledLen;
+  pInputBuffer->nFilledLen = 0;
+}
+
+/** Sets the window and the event interval, the window being measured
+  * ends with the new duration
+  */
+OMX_ERRORTYPE omx_meter_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE* pLevels;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioAudioLevels :
+      pLevels = (OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pLevels->nPortIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      if (pLevels->nWindowMs == 0) {
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      pthread_mutex_lock(&omx_meter_component_Private->levelsMutex);
+      omx_meter_component_Private->sLevels.nWindowMs = pLevels->nWindowMs;
+      omx_meter_component_Private->sLevels.nEventIntervalMs = pLevels->nEventIntervalMs;
+      pthread_mutex_unlock(&omx_meter_component_Private->levelsMutex);
+      break;
+    default: // delegate to superclass
+      err = omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_meter_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE* pLevels;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_U32 portIndex;
+
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioAudioLevels :
+      pLevels = (OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pLevels->nPortIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      portIndex = pLevels->nPortIndex;
+      pthread_mutex_lock(&omx_meter_component_Private->levelsMutex);
+      memcpy(pLevels, &omx_meter_component_Private->sLevels, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE));
+      pthread_mutex_unlock(&omx_meter_component_Private->levelsMutex);
+      pLevels->nPortIndex = portIndex;
+      break;
+    default :
+      err = omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+/** Gives the index of the audio levels config, or the one of a generic
+  * name from the base component
+  */
+OMX_ERRORTYPE omx_meter_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if (strcmp(cParameterName, "OMX.st.index.config.BellagioAudioLevels") == 0) {
+    *pIndexType = OMX_IndexConfigBellagioAudioLevels;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
+
+OMX_ERRORTYPE omx_meter_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  AUDIO_SAMPLE_FORMAT eSampleFormat;
+  OMX_U32 portIndex;
+  omx_base_audio_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pAudioPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_meter_component_Private->ports[portIndex];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      eSampleFormat = omx_audio_kernels_GetSampleFormat(pAudioPcmMode);
+      if (eSampleFormat == AUDIO_SAMPLE_UNSUPPORTED || pAudioPcmMode->bInterleaved == OMX_FALSE ||
+          pAudioPcmMode->nChannels == 0 || pAudioPcmMode->nChannels > OMX_AUDIO_MAXCHANNELS) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported PCM layout of %i bits and %i channels\n",__func__,
+              (int)pAudioPcmMode->nBitPerSample, (int)pAudioPcmMode->nChannels);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* the layout applies to both ports, and it restarts the window the buffer
+       * management thread measures: it cannot change while either port runs */
+      if (omx_meter_component_Private->state != OMX_StateLoaded && omx_meter_component_Private->state != OMX_StateWaitForResources &&
+          PORT_IS_ENABLED(omx_meter_component_Private->ports[1 - portIndex])) {
+        DEBUG(DEB_LEV_ERR, "In %s the layout of the enabled port %i cannot change in state %x\n",__func__,
+              (int)(1 - portIndex), omx_meter_component_Private->state);
+        err = OMX_ErrorIncorrectStateOperation;
+        break;
+      }
+      memcpy(&omx_meter_component_Private->sPCMModeParam, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      omx_meter_component_Private->eSampleFormat = eSampleFormat;
+      omx_meter_component_Private->bMeterReset = OMX_TRUE;
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_meter_component_Private->state != OMX_StateLoaded && omx_meter_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_meter_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, METER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_meter_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_U32 portIndex;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_meter_component_PrivateType* omx_meter_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_meter_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_meter_component_Private->ports[pAudioPortFormat->nPortIndex];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+    break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (pAudioPcmMode->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      portIndex = pAudioPcmMode->nPortIndex;
+      memcpy(pAudioPcmMode, &omx_meter_component_Private->sPCMModeParam, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      pAudioPcmMode->nPortIndex = portIndex;
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, METER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
@@ -0,0 +1,115 @@
+/**
+  src/components/audio_effects/omx_meter_component.h
+
+  OpenMAX audio meter component. This component implements a filter that
+  passes an audio PCM stream through unchanged and measures the peak, the
+  RMS level and the clipped samples of each of its channels. The samples
+  pass in place when the component allocated the buffers, the payloads of
+  the input and output headers are then exchanged.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_METER_COMPONENT_H_
+#define _OMX_METER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <string.h>
+#include <pthread.h>
+#include <omx_base_filter.h>
+#include "omx_audio_kernels.h"
+#define METER_COMP_NAME "OMX.st.audio.meter"
+#define METER_COMP_ROLE "audio.meter"
+#define MAX_METER_COMPONENTS 10
+/** The measure has a single quality level */
+#define METER_QUALITY_LEVELS 1
+static int meterQualityLevels []={1, 32768};
+
+/** The default duration of a measurement window, in milliseconds */
+#define METER_DEFAULT_WINDOW_MS 100
+/** The sample rate the windows are counted in when the client sets none */
+#define METER_DEFAULT_RATE 44100
+
+/** Meter component private structure.
+* see the define above
+*/
+DERIVEDCLASS(omx_meter_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_meter_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  /** @param sPCMModeParam the PCM layout of both ports, the component does not convert it */ \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPCMModeParam; \
+  /** @param eSampleFormat the sample layout given by sPCMModeParam */ \
+  AUDIO_SAMPLE_FORMAT eSampleFormat; \
+  /** @param sLevels the levels of the last window and the settings, guarded by levelsMutex */ \
+  OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE sLevels; \
+  /** @param levelsMutex guards sLevels between the buffer management thread and the client */ \
+  pthread_mutex_t levelsMutex; \
+  /** @param fPeak the highest absolute sample of each channel in the window being measured */ \
+  float fPeak[OMX_AUDIO_MAXCHANNELS]; \
+  /** @param fSquares the sum of the squares of each channel in the window being measured */ \
+  double fSquares[OMX_AUDIO_MAXCHANNELS]; \
+  /** @param nClips the samples of each channel at the limits of the format in the window being measured */ \
+  OMX_U32 nClips[OMX_AUDIO_MAXCHANNELS]; \
+  /** @param nFrames the samples of each channel in the window being measured */ \
+  OMX_U32 nFrames; \
+  /** @param nLastEvent the time of the last levels event on the monotonic clock, in nanoseconds */ \
+  OMX_U64 nLastEvent; \
+  /** @param bMeterReset set when the window being measured must be dropped before the next buffer */ \
+  volatile OMX_BOOL bMeterReset; \
+  /** @param BaseFlushProcessingBuffers the flush function of the base port, called before dropping the window */ \
+  OMX_ERRORTYPE (*BaseFlushProcessingBuffers)(omx_base_PortType *openmaxStandPort);
+ENDCLASS(omx_meter_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_meter_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_meter_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_meter_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_meter_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_meter_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_meter_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_meter_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_meter_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
+#endif
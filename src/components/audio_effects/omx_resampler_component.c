@@ -0,0 +1,635 @@
+/**
+  src/components/audio_effects/omx_resampler_component.c
+
+  OpenMAX audio resampler component. This component implements a filter that
+  converts the sample rate of an audio PCM stream with a polyphase FIR filter.
+
+  The ratio of the rates is reduced to nPhases / nStep. The filter is a
+  Kaiser windowed sinc designed at nPhases times the input rate and split
+  into nPhases phases, so that each output sample is a single dot product
+  of nTaps input samples, computed by the vector kernels.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <math.h>
+#include <omxcore.h>
+#include <omx_base_audio_port.h>
+#include <omx_resampler_component.h>
+#include<OMX_Audio.h>
+
+/** The filter of each quality level: taps per phase when the rate is not
+  * divided, beta of the Kaiser window and cutoff relative to the lower of
+  * the two Nyquist frequencies
+  */
+static const struct {
+  OMX_U32 nTaps;
+  double fBeta;
+  double fCutoff;
+} resamplerFilters[RESAMPLER_QUALITY_LEVELS] = {
+  { 64, 9.0, 0.95 },
+  { 32, 7.0, 0.92 },
+  { 16, 5.0, 0.85 }
+};
+
+static OMX_ERRORTYPE omx_resampler_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort);
+
+OMX_ERRORTYPE omx_resampler_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp, OMX_STRING cComponentName) {
+	OMX_ERRORTYPE err;
+	omx_resampler_component_PrivateType* omx_resampler_component_Private;
+	OMX_U32 i;
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n",__func__);
+
+	RM_RegisterComponent(RESAMPLER_COMP_NAME, MAX_RESAMPLER_COMPONENTS);
+	if (!openmaxStandComp->pComponentPrivate) {
+		openmaxStandComp->pComponentPrivate = calloc(1, sizeof(omx_resampler_component_PrivateType));
+		DEBUG(DEB_LEV_FUNCTION_NAME, "In %s allocated private structure %p for std component %p\n",
+				__func__, openmaxStandComp->pComponentPrivate, openmaxStandComp);
+		if(openmaxStandComp->pComponentPrivate == NULL) {
+			return OMX_ErrorInsufficientResources;
+		}
+	} else {
+		DEBUG(DEB_LEV_ERR, "In %s, Error Component %p Already Allocated\n", __func__, openmaxStandComp->pComponentPrivate);
+		return OMX_ErrorUndefined;
+	}
+
+	omx_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+	omx_resampler_component_Private->ports = NULL;
+
+	/** Calling base filter constructor */
+	err = omx_base_filter_Constructor(openmaxStandComp, cComponentName);
+	if (err != OMX_ErrorNone) {
+			DEBUG(DEB_LEV_ERR, "In %s failed base class constructor\n", __func__);
+			return err;
+	}
+
+	omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nStartPortNumber = 0;
+	omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts = 2;
+
+	/** Allocate Ports and call port constructor. */
+	if (omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts && !omx_resampler_component_Private->ports) {
+		omx_resampler_component_Private->ports = calloc(omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts, sizeof(omx_base_PortType *));
+		if (!omx_resampler_component_Private->ports) {
+			return OMX_ErrorInsufficientResources;
+		}
+		for (i=0; i < omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			omx_resampler_component_Private->ports[i] = calloc(1, sizeof(omx_base_audio_PortType));
+			if (!omx_resampler_component_Private->ports[i]) {
+				return OMX_ErrorInsufficientResources;
+			}
+		}
+	}
+
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_resampler_component_Private->ports[0], 0, OMX_TRUE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+	err = base_audio_port_Constructor(openmaxStandComp, &omx_resampler_component_Private->ports[1], 1, OMX_FALSE);
+	if (err != OMX_ErrorNone) {
+		return OMX_ErrorInsufficientResources;
+	}
+
+	/** Domain specific section for the ports. */
+	omx_resampler_component_Private->ports[OMX_BASE_FILTER_INPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+	omx_resampler_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
+
+	/* a flush drops the samples kept in the filter */
+	omx_resampler_component_Private->BaseFlushProcessingBuffers = omx_resampler_component_Private->ports[0]->FlushProcessingBuffers;
+	for (i = 0; i < 2; i++) {
+		omx_resampler_component_Private->ports[i]->FlushProcessingBuffers = omx_resampler_component_port_FlushProcessingBuffers;
+
+		setHeader(&omx_resampler_component_Private->sPCMModeParam[i], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+		omx_resampler_component_Private->sPCMModeParam[i].nPortIndex = i;
+		omx_resampler_component_Private->sPCMModeParam[i].nChannels = 2;
+		omx_resampler_component_Private->sPCMModeParam[i].eNumData = OMX_NumericalDataSigned;
+		omx_resampler_component_Private->sPCMModeParam[i].eEndian = OMX_EndianBig;
+		omx_resampler_component_Private->sPCMModeParam[i].bInterleaved = OMX_TRUE;
+		omx_resampler_component_Private->sPCMModeParam[i].nBitPerSample = 16;
+		omx_resampler_component_Private->sPCMModeParam[i].nSamplingRate = RESAMPLER_DEFAULT_RATE;
+		omx_resampler_component_Private->sPCMModeParam[i].ePCMMode = OMX_AUDIO_PCMModeLinear;
+		omx_resampler_component_Private->sPCMModeParam[i].eChannelMapping[0] = OMX_AUDIO_ChannelLF;
+		omx_resampler_component_Private->sPCMModeParam[i].eChannelMapping[1] = OMX_AUDIO_ChannelRF;
+		omx_resampler_component_Private->eSampleFormat[i] = AUDIO_SAMPLE_S16;
+	}
+	omx_resampler_component_Private->bFilterReset = OMX_TRUE;
+
+	omx_resampler_component_Private->destructor = omx_resampler_component_Destructor;
+	openmaxStandComp->SetParameter = omx_resampler_component_SetParameter;
+	openmaxStandComp->GetParameter = omx_resampler_component_GetParameter;
+	omx_resampler_component_Private->BufferMgmtCallback = omx_resampler_component_BufferMgmtCallback;
+	/* an empty buffer ending the stream still drains the filter */
+	omx_resampler_component_Private->bCallbackOnEOS = OMX_TRUE;
+
+  /* resource management special section */
+  omx_resampler_component_Private->nqualitylevels = RESAMPLER_QUALITY_LEVELS;
+  omx_resampler_component_Private->currentQualityLevel = 1;
+  omx_resampler_component_Private->multiResourceLevel = malloc(sizeof(multiResourceDescriptor *) * RESAMPLER_QUALITY_LEVELS);
+  for (i = 0; i<RESAMPLER_QUALITY_LEVELS; i++) {
+	  omx_resampler_component_Private->multiResourceLevel[i] = malloc(sizeof(multiResourceDescriptor));
+	  omx_resampler_component_Private->multiResourceLevel[i]->CPUResourceRequested = resamplerQualityLevels[i * 2];
+	  omx_resampler_component_Private->multiResourceLevel[i]->MemoryResourceRequested = resamplerQualityLevels[i * 2 + 1];
+  }
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+
+/** The destructor
+  */
+OMX_ERRORTYPE omx_resampler_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp) {
+
+	omx_resampler_component_PrivateType* omx_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+	OMX_U32 i;
+
+	/* frees port/s */
+	DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, openmaxStandComp);
+	if (omx_resampler_component_Private->ports) {
+		for (i=0; i < omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio].nPorts; i++) {
+			if(omx_resampler_component_Private->ports[i]) {
+				omx_resampler_component_Private->ports[i]->PortDestructor(omx_resampler_component_Private->ports[i]);
+			}
+		}
+		free(omx_resampler_component_Private->ports);
+		omx_resampler_component_Private->ports=NULL;
+	}
+
+	free(omx_resampler_component_Private->pCoeffs);
+	omx_resampler_component_Private->pCoeffs = NULL;
+	free(omx_resampler_component_Private->pHistory);
+	omx_resampler_component_Private->pHistory = NULL;
+	free(omx_resampler_component_Private->pFiltered);
+	omx_resampler_component_Private->pFiltered = NULL;
+
+	omx_base_filter_Destructor(openmaxStandComp);
+
+	DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s for component %p\n", __func__, openmaxStandComp);
+	return OMX_ErrorNone;
+}
+
+/** Flushes the port like the base port, and clears the history of the
+  * filter before the next buffer
+  */
+static OMX_ERRORTYPE omx_resampler_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort) {
+  omx_resampler_component_PrivateType* omx_resampler_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE err;
+
+  err = omx_resampler_component_Private->BaseFlushProcessingBuffers(openmaxStandPort);
+  omx_resampler_component_Private->bFilterReset = OMX_TRUE;
+  return err;
+}
+
+/** Reduces the ratio of the rates to nPhases / nStep. An unknown rate,
+  * equal to 0, leaves the rate unchanged
+  *
+  * @return OMX_FALSE if the filter would need more than RESAMPLER_MAX_PHASES phases
+  */
+static OMX_BOOL resampler_Ratio(OMX_U32 nInRate, OMX_U32 nOutRate, OMX_U32* pPhases, OMX_U32* pStep) {
+  OMX_U32 a = nInRate, b = nOutRate, t;
+
+  if (nInRate == 0 || nOutRate == 0 || nInRate == nOutRate) {
+    *pPhases = *pStep = 1;
+    return OMX_TRUE;
+  }
+  while (b) {
+    t = a % b;
+    a = b;
+    b = t;
+  }
+  *pPhases = nOutRate / a;
+  *pStep = nInRate / a;
+  return *pPhases <= RESAMPLER_MAX_PHASES ? OMX_TRUE : OMX_FALSE;
+}
+
+/* the modified Bessel function of the first kind and order 0, for the Kaiser window */
+static double resampler_BesselI0(double x) {
+  double fSum = 1.0, fTerm = 1.0;
+  int k;
+
+  for (k = 1; k < 64 && fTerm > fSum * 1e-12; k++) {
+    fTerm *= (x / (2.0 * k)) * (x / (2.0 * k));
+    fSum += fTerm;
+  }
+  return fSum;
+}
+
+/** Designs the low pass filter of a quality level, and stores the phases
+  * with their coefficients in the order of the input samples. Each phase
+  * is normalized to a unity gain, so that a constant input gives a constant output
+  */
+static void resampler_Design(float* pCoeffs, OMX_U32 nTaps, OMX_U32 nPhases, OMX_U32 nStep, int nLevel) {
+  OMX_U32 nLength = nTaps * nPhases;
+  double fCutoff = resamplerFilters[nLevel - 1].fCutoff / (2.0 * (nStep > nPhases ? nStep : nPhases));
+  double fBeta = resamplerFilters[nLevel - 1].fBeta;
+  /* the center falls on the input sample that follows the (nTaps - 1) / 2
+   * zeros starting the history, so that the output is not delayed */
+  double fCenter = (double)nPhases * (nTaps - 1 - (nTaps - 1) / 2);
+  double fNorm = resampler_BesselI0(fBeta);
+  double x, r, fSum;
+  OMX_U32 p, t, k;
+
+  for (p = 0; p < nPhases; p++) {
+    fSum = 0.0;
+    for (t = 0; t < nTaps; t++) {
+      k = p + t * nPhases;
+      x = k - fCenter;
+      r = x / (nLength / 2.0);
+      x = (x == 0.0 ? 2.0 * fCutoff : sin(2.0 * M_PI * fCutoff * x) / (M_PI * x)) *
+          resampler_BesselI0(fBeta * sqrt(1.0 - r * r)) / fNorm;
+      /* the tap t multiplies the input sample t before the newest one */
+      pCoeffs[p * nTaps + nTaps - 1 - t] = (float)x;
+      fSum += x;
+    }
+    for (t = 0; t < nTaps; t++) {
+      pCoeffs[p * nTaps + t] = (float)(pCoeffs[p * nTaps + t] / fSum);
+    }
+  }
+}
+
+/** Builds the filter for the current rates and quality level, if they
+  * changed, and clears the history. The history starts with the zeros that
+  * center the first output sample on the first input sample
+  */
+static OMX_ERRORTYPE resampler_SetupFilter(omx_resampler_component_PrivateType* omx_resampler_component_Private) {
+  OMX_U32 nChannels = omx_resampler_component_Private->sPCMModeParam[0].nChannels;
+  int nLevel = omx_resampler_component_Private->currentQualityLevel;
+  OMX_U32 nTaps, nPhases, nStep;
+  float* pCoeffs;
+  float* pHistory;
+
+  if (nLevel < 1 || nLevel > RESAMPLER_QUALITY_LEVELS) {
+    nLevel = 1;
+  }
+  resampler_Ratio(omx_resampler_component_Private->sPCMModeParam[0].nSamplingRate,
+                  omx_resampler_component_Private->sPCMModeParam[1].nSamplingRate, &nPhases, &nStep);
+  if (nPhases == nStep) {
+    nTaps = 1;
+  } else {
+    /* a lower output rate narrows the pass band, the filter gets longer to keep its transition band */
+    nTaps = resamplerFilters[nLevel - 1].nTaps;
+    if (nStep > nPhases) {
+      nTaps = (nTaps * nStep + nPhases - 1) / nPhases;
+    }
+    nTaps = (nTaps + 7) & ~7;
+    if (nTaps > RESAMPLER_MAX_TAPS) {
+      nTaps = RESAMPLER_MAX_TAPS;
+    }
+  }
+
+  if (!omx_resampler_component_Private->pCoeffs || nTaps != omx_resampler_component_Private->nTaps ||
+      nPhases != omx_resampler_component_Private->nPhases || nStep != omx_resampler_component_Private->nStep ||
+      nLevel != omx_resampler_component_Private->nFilterLevel) {
+    pCoeffs = realloc(omx_resampler_component_Private->pCoeffs, nTaps * nPhases * sizeof(float));
+    if (!pCoeffs) {
+      return OMX_ErrorInsufficientResources;
+    }
+    omx_resampler_component_Private->pCoeffs = pCoeffs;
+    if (nTaps == 1) {
+      pCoeffs[0] = 1.0f;
+    } else {
+      resampler_Design(pCoeffs, nTaps, nPhases, nStep, nLevel);
+    }
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s resampling by %i/%i with %i taps per phase\n", __func__, (int)nPhases, (int)nStep, (int)nTaps);
+  }
+  omx_resampler_component_Private->nTaps = nTaps;
+  omx_resampler_component_Private->nPhases = nPhases;
+  omx_resampler_component_Private->nStep = nStep;
+  omx_resampler_component_Private->nFilterLevel = nLevel;
+
+  omx_resampler_component_Private->nHistorySize = nTaps + RESAMPLER_CHUNK;
+  pHistory = realloc(omx_resampler_component_Private->pHistory, nChannels * omx_resampler_component_Private->nHistorySize * sizeof(float));
+  if (!pHistory) {
+    return OMX_ErrorInsufficientResources;
+  }
+  omx_resampler_component_Private->pHistory = pHistory;
+  if (!omx_resampler_component_Private->pFiltered) {
+    omx_resampler_component_Private->pFiltered = malloc(RESAMPLER_CHUNK * sizeof(float));
+    if (!omx_resampler_component_Private->pFiltered) {
+      return OMX_ErrorInsufficientResources;
+    }
+  }
+  memset(pHistory, 0, nChannels * omx_resampler_component_Private->nHistorySize * sizeof(float));
+  omx_resampler_component_Private->nHistoryLen = (nTaps - 1) / 2;
+  omx_resampler_component_Private->nPosition = 0;
+  omx_resampler_component_Private->nPhase = 0;
+  omx_resampler_component_Private->bFilterReset = OMX_FALSE;
+  return OMX_ErrorNone;
+}
+
+/** Drops the samples of the history no longer needed by the next output sample */
+static void resampler_Compact(omx_resampler_component_PrivateType* omx_resampler_component_Private) {
+  OMX_U32 nChannels = omx_resampler_component_Private->sPCMModeParam[0].nChannels;
+  OMX_U32 nDrop = omx_resampler_component_Private->nPosition;
+  float* pHistory;
+  OMX_U32 i;
+
+  /* when the rate is divided, the next output sample can be past the history */
+  if (nDrop > omx_resampler_component_Private->nHistoryLen) {
+    nDrop = omx_resampler_component_Private->nHistoryLen;
+  }
+  if (nDrop == 0) {
+    return;
+  }
+  for (i = 0; i < nChannels; i++) {
+    pHistory = omx_resampler_component_Private->pHistory + i * omx_resampler_component_Private->nHistorySize;
+    memmove(pHistory, pHistory + nDrop, (omx_resampler_component_Private->nHistoryLen - nDrop) * sizeof(float));
+  }
+  omx_resampler_component_Private->nHistoryLen -= nDrop;
+  omx_resampler_component_Private->nPosition -= nDrop;
+}
+
+/** Filters the history into at most nMaxOut interleaved output frames
+  *
+  * @return the number of output frames
+  */
+static OMX_U32 resampler_Filter(omx_resampler_component_PrivateType* omx_resampler_component_Private, OMX_U8* pDst, OMX_U32 nMaxOut) {
+  OMX_U32 nChannels = omx_resampler_component_Private->sPCMModeParam[0].nChannels;
+  AUDIO_SAMPLE_FORMAT eFormat = omx_resampler_component_Private->eSampleFormat[OMX_BASE_FILTER_OUTPUTPORT_INDEX];
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(eFormat);
+  OMX_U32 nDone = 0, nOut = 0, nChunk, nPosition = 0, nPhase = 0, i;
+
+  while (nDone < nMaxOut) {
+    nChunk = nMaxOut - nDone < RESAMPLER_CHUNK ? nMaxOut - nDone : RESAMPLER_CHUNK;
+    /* all the channels move by the same positions and phases */
+    for (i = 0; i < nChannels; i++) {
+      nPosition = omx_resampler_component_Private->nPosition;
+      nPhase = omx_resampler_component_Private->nPhase;
+      nOut = omx_audio_kernels_Polyphase(omx_resampler_component_Private->pFiltered,
+                                         omx_resampler_component_Private->pHistory + i * omx_resampler_component_Private->nHistorySize,
+                                         omx_resampler_component_Private->nHistoryLen,
+                                         omx_resampler_component_Private->pCoeffs, omx_resampler_component_Private->nTaps,
+                                         omx_resampler_component_Private->nPhases, omx_resampler_component_Private->nStep,
+                                         &nPosition, &nPhase, nChunk);
+      omx_audio_kernels_FromFloat(eFormat, pDst + (nDone * nChannels + i) * nSampleSize, nChannels,
+                                  omx_resampler_component_Private->pFiltered, nOut);
+    }
+    omx_resampler_component_Private->nPosition = nPosition;
+    omx_resampler_component_Private->nPhase = nPhase;
+    nDone += nOut;
+    if (nOut < nChunk) {
+      break;
+    }
+  }
+  return nDone;
+}
+
+/** This function is used to process the input buffer and provide one output buffer.
+  * The input is consumed while the output buffer has room, the rest of it
+  * is kept for the next output buffer
+  */
+void omx_resampler_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
+  omx_resampler_component_PrivateType* omx_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 nChannels = omx_resampler_component_Private->sPCMModeParam[0].nChannels;
+  AUDIO_SAMPLE_FORMAT eInFormat = omx_resampler_component_Private->eSampleFormat[OMX_BASE_FILTER_INPUTPORT_INDEX];
+  OMX_U32 nInSampleSize = omx_audio_kernels_GetSampleSize(eInFormat);
+  OMX_U32 nInFrameSize = nInSampleSize * nChannels;
+  OMX_U32 nOutFrameSize = omx_audio_kernels_GetSampleSize(omx_resampler_component_Private->eSampleFormat[OMX_BASE_FILTER_OUTPUTPORT_INDEX]) * nChannels;
+  OMX_U32 nFree, nFrames, nTail, i;
+
+  /* nothing entered the filter since it was reset, there is no tail to drain */
+  if (omx_resampler_component_Private->bFilterReset && pInputBuffer->nFilledLen == 0) {
+    pInputBuffer->nOffset = 0;
+    return;
+  }
+  if (omx_resampler_component_Private->bFilterReset ||
+      omx_resampler_component_Private->nFilterLevel != omx_resampler_component_Private->currentQualityLevel) {
+    if (resampler_SetupFilter(omx_resampler_component_Private) != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "In %s no memory for the filter, the input is dropped\n", __func__);
+      pInputBuffer->nFilledLen = 0;
+      pInputBuffer->nOffset = 0;
+      return;
+    }
+  }
+
+  nFree = (pOutputBuffer->nAllocLen - pOutputBuffer->nOffset - pOutputBuffer->nFilledLen) / nOutFrameSize;
+  for (;;) {
+    nFrames = resampler_Filter(omx_resampler_component_Private, pOutputBuffer->pBuffer + pOutputBuffer->nOffset + pOutputBuffer->nFilledLen, nFree);
+    pOutputBuffer->nFilledLen += nFrames * nOutFrameSize;
+    nFree -= nFrames;
+    nFrames = pInputBuffer->nFilledLen / nInFrameSize;
+    if (nFree == 0 || nFrames == 0) {
+      break;
+    }
+    resampler_Compact(omx_resampler_component_Private);
+    if (nFrames > omx_resampler_component_Private->nHistorySize - omx_resampler_component_Private->nHistoryLen) {
+      nFrames = omx_resampler_component_Private->nHistorySize - omx_resampler_component_Private->nHistoryLen;
+    }
+    for (i = 0; i < nChannels; i++) {
+      omx_audio_kernels_ToFloat(eInFormat,
+                                omx_resampler_component_Private->pHistory + i * omx_resampler_component_Private->nHistorySize + omx_resampler_component_Private->nHistoryLen,
+                                pInputBuffer->pBuffer + pInputBuffer->nOffset + i * nInSampleSize, nChannels, nFrames);
+    }
+    omx_resampler_component_Private->nHistoryLen += nFrames;
+    pInputBuffer->nOffset += nFrames * nInFrameSize;
+    pInputBuffer->nFilledLen -= nFrames * nInFrameSize;
+  }
+
+  /* a trailing partial frame is dropped */
+  if (pInputBuffer->nFilledLen < nInFrameSize) {
+    if ((pInputBuffer->nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS) {
+      /* the zeros after the last sample bring out the delay of the filter.
+       * They are lost if the output buffer is full, the stream being over anyway */
+      resampler_Compact(omx_resampler_component_Private);
+      nTail = omx_resampler_component_Private->nTaps - 1 - (omx_resampler_component_Private->nTaps - 1) / 2;
+      if (nTail > omx_resampler_component_Private->nHistorySize - omx_resampler_component_Private->nHistoryLen) {
+        nTail = omx_resampler_component_Private->nHistorySize - omx_resampler_component_Private->nHistoryLen;
+      }
+      for (i = 0; i < nChannels; i++) {
+        memset(omx_resampler_component_Private->pHistory + i * omx_resampler_component_Private->nHistorySize + omx_resampler_component_Private->nHistoryLen,
+               0, nTail * sizeof(float));
+      }
+      omx_resampler_component_Private->nHistoryLen += nTail;
+      nFrames = resampler_Filter(omx_resampler_component_Private, pOutputBuffer->pBuffer + pOutputBuffer->nOffset + pOutputBuffer->nFilledLen, nFree);
+      pOutputBuffer->nFilledLen += nFrames * nOutFrameSize;
+      /* the next stream starts on a clean history */
+      omx_resampler_component_Private->bFilterReset = OMX_TRUE;
+    }
+    pInputBuffer->nFilledLen = 0;
+    pInputBuffer->nOffset = 0;
+  }
+}
+
+OMX_ERRORTYPE omx_resampler_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  AUDIO_SAMPLE_FORMAT eSampleFormat;
+  OMX_U32 portIndex, nPhases, nStep;
+  omx_base_audio_PortType *port;
+
+  /* Check which structure we are being fed and make control its header */
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_resampler_component_PrivateType* omx_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      portIndex = pAudioPortFormat->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_resampler_component_Private->ports[portIndex];
+        memcpy(&port->sAudioParam, pAudioPortFormat, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+      break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      eSampleFormat = omx_audio_kernels_GetSampleFormat(pAudioPcmMode);
+      if (eSampleFormat == AUDIO_SAMPLE_UNSUPPORTED || pAudioPcmMode->bInterleaved != OMX_TRUE ||
+          pAudioPcmMode->nChannels == 0 || pAudioPcmMode->nChannels > OMX_AUDIO_MAXCHANNELS) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported PCM layout of %i bits and %i channels\n",__func__,
+              (int)pAudioPcmMode->nBitPerSample, (int)pAudioPcmMode->nChannels);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      if (!resampler_Ratio(portIndex == 0 ? pAudioPcmMode->nSamplingRate : omx_resampler_component_Private->sPCMModeParam[0].nSamplingRate,
+                           portIndex == 1 ? pAudioPcmMode->nSamplingRate : omx_resampler_component_Private->sPCMModeParam[1].nSamplingRate,
+                           &nPhases, &nStep)) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported rate %i, more than %i phases\n",__func__,(int)pAudioPcmMode->nSamplingRate,RESAMPLER_MAX_PHASES);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* past Loaded the sanity check lets only a disabled port change, and the buffer
+       * management thread converts nothing while a port is disabled. The channels
+       * also apply to the other port, whose client must not see them change while enabled */
+      if (omx_resampler_component_Private->state != OMX_StateLoaded && omx_resampler_component_Private->state != OMX_StateWaitForResources &&
+          PORT_IS_ENABLED(omx_resampler_component_Private->ports[1 - portIndex]) &&
+          (pAudioPcmMode->nChannels != omx_resampler_component_Private->sPCMModeParam[1 - portIndex].nChannels ||
+           memcmp(pAudioPcmMode->eChannelMapping, omx_resampler_component_Private->sPCMModeParam[1 - portIndex].eChannelMapping,
+                  pAudioPcmMode->nChannels * sizeof(OMX_AUDIO_CHANNELTYPE)))) {
+        DEBUG(DEB_LEV_ERR, "In %s the channels of the enabled port %i cannot change in state %x\n",__func__,
+              (int)(1 - portIndex), omx_resampler_component_Private->state);
+        err = OMX_ErrorIncorrectStateOperation;
+        break;
+      }
+      memcpy(&omx_resampler_component_Private->sPCMModeParam[portIndex], pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      omx_resampler_component_Private->eSampleFormat[portIndex] = eSampleFormat;
+      /* the channels are not converted, they apply to both ports */
+      omx_resampler_component_Private->sPCMModeParam[1 - portIndex].nChannels = pAudioPcmMode->nChannels;
+      memcpy(omx_resampler_component_Private->sPCMModeParam[1 - portIndex].eChannelMapping, pAudioPcmMode->eChannelMapping,
+             sizeof(pAudioPcmMode->eChannelMapping));
+      omx_resampler_component_Private->bFilterReset = OMX_TRUE;
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+
+      if (omx_resampler_component_Private->state != OMX_StateLoaded && omx_resampler_component_Private->state != OMX_StateWaitForResources) {
+        DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__,omx_resampler_component_Private->state,__LINE__);
+        return OMX_ErrorIncorrectStateOperation;
+      }
+
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (strcmp( (char*) pComponentRole->cRole, RESAMPLER_COMP_ROLE)) {
+        return OMX_ErrorBadParameter;
+      }
+      break;
+    default:
+      err = omx_base_component_SetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_resampler_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure) {
+
+  OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
+  OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  OMX_ERRORTYPE err = OMX_ErrorNone;
+  omx_base_audio_PortType *port;
+  OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_resampler_component_PrivateType* omx_resampler_component_Private = openmaxStandComp->pComponentPrivate;
+  if (ComponentParameterStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "   Getting parameter %i\n", nParamIndex);
+  /* Check which structure we are being fed and fill its header */
+  switch(nParamIndex) {
+    case OMX_IndexParamAudioInit:
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      memcpy(ComponentParameterStructure, &omx_resampler_component_Private->sPortTypesParam[OMX_PortDomainAudio], sizeof(OMX_PORT_PARAM_TYPE));
+      break;
+    case OMX_IndexParamAudioPortFormat:
+      pAudioPortFormat = (OMX_AUDIO_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pAudioPortFormat->nPortIndex <= 1) {
+        port= (omx_base_audio_PortType *)omx_resampler_component_Private->ports[pAudioPortFormat->nPortIndex];
+        memcpy(pAudioPortFormat, &port->sAudioParam, sizeof(OMX_AUDIO_PARAM_PORTFORMATTYPE));
+      } else {
+        err = OMX_ErrorBadPortIndex;
+      }
+    break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+
+      if (pAudioPcmMode->nPortIndex > 1) {
+        return OMX_ErrorBadPortIndex;
+      }
+      memcpy(pAudioPcmMode, &omx_resampler_component_Private->sPCMModeParam[pAudioPcmMode->nPortIndex], sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      break;
+    case OMX_IndexParamStandardComponentRole:
+      pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
+      if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PARAM_COMPONENTROLETYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      strcpy( (char*) pComponentRole->cRole, RESAMPLER_COMP_ROLE);
+      break;
+    default:
+      err = omx_base_component_GetParameter(hComponent, nParamIndex, ComponentParameterStructure);
+  }
+  return err;
+}
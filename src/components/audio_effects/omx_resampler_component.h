@@ -0,0 +1,111 @@
+/**
+  src/components/audio_effects/omx_resampler_component.h
+
+  OpenMAX audio resampler component. This component implements a filter that
+  converts the sample rate of an audio PCM stream with a polyphase FIR filter.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef _OMX_RESAMPLER_COMPONENT_H_
+#define _OMX_RESAMPLER_COMPONENT_H_
+
+#include <OMX_Types.h>
+#include <OMX_Component.h>
+#include <OMX_Core.h>
+#include <string.h>
+#include <omx_base_filter.h>
+#include "omx_audio_kernels.h"
+#define RESAMPLER_COMP_NAME "OMX.st.audio.resampler"
+#define RESAMPLER_COMP_ROLE "audio.resampler"
+#define MAX_RESAMPLER_COMPONENTS 10
+/** The quality levels select the length of the filter: 64, 32 or 16 taps per phase */
+#define RESAMPLER_QUALITY_LEVELS 3
+static int resamplerQualityLevels []={40, 786432, 20, 393216, 10, 196608};
+
+/** The default sample rate of both ports */
+#define RESAMPLER_DEFAULT_RATE 44100
+/** Maximum number of phases of the filter, the output rate divided by the
+ * greatest common divisor of the two rates. It covers any pair of the usual
+ * rates from 8 to 192 kHz
+ */
+#define RESAMPLER_MAX_PHASES 4096
+/** Maximum number of taps per phase, reached when the rate is divided by more than 8 */
+#define RESAMPLER_MAX_TAPS 512
+/** Number of samples per channel converted or filtered at a time */
+#define RESAMPLER_CHUNK 1024
+
+/** Resampler component private structure.
+* see the define above
+*/
+DERIVEDCLASS(omx_resampler_component_PrivateType, omx_base_filter_PrivateType)
+#define omx_resampler_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
+  /** @param sPCMModeParam the PCM layout of each port. The ports differ by rate and sample format, not by channels */ \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPCMModeParam[2]; \
+  /** @param eSampleFormat the sample layout given by sPCMModeParam of each port */ \
+  AUDIO_SAMPLE_FORMAT eSampleFormat[2]; \
+  /** @param bFilterReset set when the filter must be built again, or its history cleared, before the next buffer */ \
+  volatile OMX_BOOL bFilterReset; \
+  /** @param nFilterLevel the quality level the filter was built for, 0 before the first buffer */ \
+  int nFilterLevel; \
+  /** @param pCoeffs the coefficients of the filter, nTaps for each of the nPhases phases */ \
+  float* pCoeffs; \
+  /** @param nTaps number of taps per phase */ \
+  OMX_U32 nTaps; \
+  /** @param nPhases the output rate divided by the greatest common divisor of the rates */ \
+  OMX_U32 nPhases; \
+  /** @param nStep the input rate divided by the greatest common divisor of the rates */ \
+  OMX_U32 nStep; \
+  /** @param pHistory the input samples converted to float, nHistorySize for each channel */ \
+  float* pHistory; \
+  /** @param nHistorySize the room of each channel in pHistory */ \
+  OMX_U32 nHistorySize; \
+  /** @param nHistoryLen number of samples of each channel in pHistory */ \
+  OMX_U32 nHistoryLen; \
+  /** @param nPosition the position in pHistory of the next output sample */ \
+  OMX_U32 nPosition; \
+  /** @param nPhase the phase of the next output sample */ \
+  OMX_U32 nPhase; \
+  /** @param pFiltered the filtered samples of one channel, RESAMPLER_CHUNK of them */ \
+  float* pFiltered; \
+  /** @param BaseFlushProcessingBuffers the flush function of the base port, called before clearing the history */ \
+  OMX_ERRORTYPE (*BaseFlushProcessingBuffers)(omx_base_PortType *openmaxStandPort);
+ENDCLASS(omx_resampler_component_PrivateType)
+
+/* Component private entry points declaration */
+OMX_ERRORTYPE omx_resampler_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName);
+OMX_ERRORTYPE omx_resampler_component_Destructor(OMX_COMPONENTTYPE *openmaxStandComp);
+
+void omx_resampler_component_BufferMgmtCallback(
+  OMX_COMPONENTTYPE *openmaxStandComp,
+  OMX_BUFFERHEADERTYPE* inputbuffer,
+  OMX_BUFFERHEADERTYPE* outputbuffer);
+
+OMX_ERRORTYPE omx_resampler_component_GetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+OMX_ERRORTYPE omx_resampler_component_SetParameter(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nParamIndex,
+  OMX_PTR ComponentParameterStructure);
+
+#endif
@@ -93,12 +93,24 @@ OMX_ERRORTYPE omx_volume_component_Constructor(OMX_COMPONENTTYPE *openmaxStandCo
 	omx_volume_component_Private->ports[OMX_BASE_FILTER_OUTPUTPORT_INDEX]->sPortParam.nBufferSize = DEFAULT_OUT_BUFFER_SIZE;
 
 	omx_volume_component_Private->gain = GAIN_VALUE; //100.0f; // default gain
+
+	setHeader(&omx_volume_component_Private->sPCMModeParam, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+	omx_volume_component_Private->sPCMModeParam.nPortIndex = 0;
+	omx_volume_component_Private->sPCMModeParam.nChannels = 2;
+	omx_volume_component_Private->sPCMModeParam.eNumData = OMX_NumericalDataSigned;
+	omx_volume_component_Private->sPCMModeParam.eEndian = OMX_EndianBig;
+	omx_volume_component_Private->sPCMModeParam.bInterleaved = OMX_TRUE;
+	omx_volume_component_Private->sPCMModeParam.nBitPerSample = 16;
+	omx_volume_component_Private->sPCMModeParam.nSamplingRate = 0;
+	omx_volume_component_Private->sPCMModeParam.ePCMMode = OMX_AUDIO_PCMModeLinear;
+	omx_volume_component_Private->eSampleFormat = AUDIO_SAMPLE_S16;
 	omx_volume_component_Private->destructor = omx_volume_component_Destructor;
 	openmaxStandComp->SetParameter = omx_volume_component_SetParameter;
 	openmaxStandComp->GetParameter = omx_volume_component_GetParameter;
 	openmaxStandComp->GetConfig = omx_volume_component_GetConfig;
 	openmaxStandComp->SetConfig = omx_volume_component_SetConfig;
 	omx_volume_component_Private->BufferMgmtCallback = omx_volume_component_BufferMgmtCallback;
+	omx_volume_component_Private->bInPlace = OMX_TRUE;
 
   /* resource management special section */
   omx_volume_component_Private->nqualitylevels = VOLUME_QUALITY_LEVELS;
@@ -143,17 +155,29 @@ OMX_ERRORTYPE omx_volume_component_Destructor(OMX_COMPONENTTYPE *openmaxStandCom
 /** This function is used to process the input buffer and provide one output buffer
   */
 void omx_volume_component_BufferMgmtCallback(OMX_COMPONENTTYPE *openmaxStandComp, OMX_BUFFERHEADERTYPE* pInputBuffer, OMX_BUFFERHEADERTYPE* pOutputBuffer) {
-  int i;
-  int sampleCount = pInputBuffer->nFilledLen / 2; // signed 16 bit samples assumed
   omx_volume_component_PrivateType* omx_volume_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_U32 nSampleSize = omx_audio_kernels_GetSampleSize(omx_volume_component_Private->eSampleFormat);
+  OMX_U32 sampleCount = pInputBuffer->nFilledLen / nSampleSize;
+  OMX_U8* pIn = pInputBuffer->pBuffer + pInputBuffer->nOffset;
+  OMX_U8* pOut;
+
+  /* in place the samples stay where they are, otherwise they go to the start of the output */
+  if (pOutputBuffer->pBuffer != pInputBuffer->pBuffer) {
+    pOutputBuffer->nOffset = 0;
+  }
+  pOut = pOutputBuffer->pBuffer + pOutputBuffer->nOffset;
 
   if(omx_volume_component_Private->gain != GAIN_VALUE) {
-    for (i = 0; i < sampleCount; i++) {
-      ((OMX_S16*) pOutputBuffer->pBuffer)[i] = (OMX_S16)
-              (((OMX_S16*) pInputBuffer->pBuffer)[i] * (omx_volume_component_Private->gain / 100.0f));
+    omx_audio_kernels_Volume(omx_volume_component_Private->eSampleFormat,
+                             pOut, pIn, sampleCount,
+                             omx_audio_kernels_GainQ15(omx_volume_component_Private->gain / 100.0f));
+    /* a trailing partial sample is passed through */
+    if (pOut != pIn) {
+      memcpy(pOut + sampleCount * nSampleSize, pIn + sampleCount * nSampleSize,
+             pInputBuffer->nFilledLen - sampleCount * nSampleSize);
     }
-  } else {
-    memcpy(pOutputBuffer->pBuffer,pInputBuffer->pBuffer,pInputBuffer->nFilledLen);
+  } else if (pOut != pIn) {
+    memcpy(pOut,pIn,pInputBuffer->nFilledLen);
   }
   pOutputBuffer->nFilledLen = pInputBuffer->nFilledLen;
   pInputBuffer->nFilledLen=0;
@@ -219,7 +243,9 @@ OMX_ERRORTYPE omx_volume_component_SetParameter(
 
   OMX_ERRORTYPE err = OMX_ErrorNone;
   OMX_AUDIO_PARAM_PORTFORMATTYPE *pAudioPortFormat;
+  OMX_AUDIO_PARAM_PCMMODETYPE *pAudioPcmMode;
   OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
+  AUDIO_SAMPLE_FORMAT eSampleFormat;
   OMX_U32 portIndex;
   omx_base_audio_PortType *port;
 
@@ -247,6 +273,36 @@ OMX_ERRORTYPE omx_volume_component_SetParameter(
         err = OMX_ErrorBadPortIndex;
       }
       break;
+    case OMX_IndexParamAudioPcm:
+      pAudioPcmMode = (OMX_AUDIO_PARAM_PCMMODETYPE*)ComponentParameterStructure;
+      portIndex = pAudioPcmMode->nPortIndex;
+      err = omx_base_component_ParameterSanityCheck(hComponent, portIndex, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      if(err!=OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "In %s Parameter Check Error=%x\n",__func__,err);
+        break;
+      }
+      if (portIndex > 1) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      eSampleFormat = omx_audio_kernels_GetSampleFormat(pAudioPcmMode);
+      if (eSampleFormat == AUDIO_SAMPLE_UNSUPPORTED) {
+        DEBUG(DEB_LEV_ERR, "In %s unsupported PCM layout of %i bits\n",__func__,(int)pAudioPcmMode->nBitPerSample);
+        err = OMX_ErrorBadParameter;
+        break;
+      }
+      /* the layout applies to both ports, the sanity check only let the named one be
+       * disabled and the buffer management thread reads the layout while the other runs */
+      if (omx_volume_component_Private->state != OMX_StateLoaded && omx_volume_component_Private->state != OMX_StateWaitForResources &&
+          PORT_IS_ENABLED(omx_volume_component_Private->ports[1 - portIndex])) {
+        DEBUG(DEB_LEV_ERR, "In %s the layout of the enabled port %i cannot change in state %x\n",__func__,
+              (int)(1 - portIndex), omx_volume_component_Private->state);
+        err = OMX_ErrorIncorrectStateOperation;
+        break;
+      }
+      memcpy(&omx_volume_component_Private->sPCMModeParam, pAudioPcmMode, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      omx_volume_component_Private->eSampleFormat = eSampleFormat;
+      break;
     case OMX_IndexParamStandardComponentRole:
       pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
 
@@ -279,6 +335,7 @@ OMX_ERRORTYPE omx_volume_component_GetParameter(
   OMX_PARAM_COMPONENTROLETYPE *pComponentRole;
   OMX_ERRORTYPE err = OMX_ErrorNone;
   omx_base_audio_PortType *port;
+  OMX_U32 portIndex;
   OMX_COMPONENTTYPE *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
   omx_volume_component_PrivateType* omx_volume_component_Private = openmaxStandComp->pComponentPrivate;
   if (ComponentParameterStructure == NULL) {
@@ -314,13 +371,9 @@ OMX_ERRORTYPE omx_volume_component_GetParameter(
       if (pAudioPcmMode->nPortIndex > 1) {
         return OMX_ErrorBadPortIndex;
       }
-      pAudioPcmMode->nChannels = 2;
-      pAudioPcmMode->eNumData = OMX_NumericalDataSigned;
-      pAudioPcmMode->eEndian = OMX_EndianBig;
-      pAudioPcmMode->bInterleaved = OMX_TRUE;
-      pAudioPcmMode->nBitPerSample = 16;
-      pAudioPcmMode->nSamplingRate = 0;
-      pAudioPcmMode->ePCMMode = OMX_AUDIO_PCMModeLinear;
+      portIndex = pAudioPcmMode->nPortIndex;
+      memcpy(pAudioPcmMode, &omx_volume_component_Private->sPCMModeParam, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+      pAudioPcmMode->nPortIndex = portIndex;
       break;
     case OMX_IndexParamStandardComponentRole:
       pComponentRole = (OMX_PARAM_COMPONENTROLETYPE*)ComponentParameterStructure;
@@ -2,7 +2,9 @@
   src/components/audio_effects/omx_volume_component.h
 
   OpenMAX volume control component. This component implements a filter that
-  controls the volume level of the audio PCM stream.
+  controls the volume level of the audio PCM stream. With buffers it allocated
+  itself it scales the samples in place and hands the input memory on to the
+  output header, so a client must take pBuffer from the header it gets back.
 
   Copyright (C) 2007-2009 STMicroelectronics
   Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
@@ -32,6 +34,7 @@
 #include <OMX_Core.h>
 #include <string.h>
 #include <omx_base_filter.h>
+#include "omx_audio_kernels.h"
 #define VOLUME_COMP_NAME "OMX.st.volume.component"
 #define VOLUME_COMP_ROLE "volume.component"
 #define MAX_VOLUME_COMPONENTS 10
@@ -44,7 +47,11 @@ static int volumeQualityLevels []={1, 65536, 1, 32768};
 DERIVEDCLASS(omx_volume_component_PrivateType, omx_base_filter_PrivateType)
 #define omx_volume_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
   /** @param gain the volume gain value */ \
-  float gain;
+  float gain; \
+  /** @param sPCMModeParam the PCM layout of both ports, the component does not convert it */ \
+  OMX_AUDIO_PARAM_PCMMODETYPE sPCMModeParam; \
+  /** @param eSampleFormat the sample layout given by sPCMModeParam */ \
+  AUDIO_SAMPLE_FORMAT eSampleFormat;
 ENDCLASS(omx_volume_component_PrivateType)
 
 /* Component private entry points declaration */
@@ -27,15 +27,461 @@
 #include <omxcore.h>
 #include <omx_base_clock_port.h>
 #include <omx_clocksrc_component.h>
+#include <omx_trace.h>
 #include <config.h>
 #include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+/** The deadline of a request that cannot come, while the clock is paused */
+#define CLOCKSRC_NEVER (~0ULL)
+
+/** The time of the monotonic clock in nanoseconds. All the wall times of the
+ * clock are read from it, so that they never jump with the time of day.
+ */
+static OMX_U64 clocksrc_WallTime(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (OMX_U64)now.tv_sec * 1000000000ULL + (OMX_U64)now.tv_nsec;
+}
+
+/** The media time of a timebase at the monotonic time nWallTime, in microseconds.
+ * The elapsed wall time is scaled in two parts so that the product with a
+ * Q16 scale does not overflow after a long run.
+ */
+static OMX_TICKS clocksrc_MediaTimeAt(CLOCKSRC_TIMEBASE* pTimebase, OMX_U64 nWallTime) {
+  OMX_S64 nElapsed = (OMX_S64)(nWallTime - pTimebase->nWallTime);
+  OMX_S64 nScaled;
+
+  nScaled = (nElapsed / 65536) * pTimebase->xScale + ((nElapsed % 65536) * pTimebase->xScale) / 65536;
+  return pTimebase->nMediaTime + nScaled / 1000;
+}
+
+/** The time of the monotonic clock a timebase reaches the media time
+ * nMediaTime at, in nanoseconds. A timebase with a null scale never reaches
+ * another media time, and a media time already passed gives a time in the past.
+ */
+static OMX_U64 clocksrc_WallTimeAt(CLOCKSRC_TIMEBASE* pTimebase, OMX_TICKS nMediaTime) {
+  OMX_S64 nMedia = (OMX_S64)(nMediaTime - pTimebase->nMediaTime) * 65536;
+  OMX_S64 nWall;
+
+  if (pTimebase->xScale == 0) {
+    return nMediaTime == pTimebase->nMediaTime ? pTimebase->nWallTime : CLOCKSRC_NEVER;
+  }
+  nWall = (nMedia / pTimebase->xScale) * 1000 + ((nMedia % pTimebase->xScale) * 1000) / pTimebase->xScale;
+  if (nWall < 0 && (OMX_U64)(-nWall) > pTimebase->nWallTime) {
+    return 0;
+  }
+  return pTimebase->nWallTime + nWall;
+}
+
+/** Takes a consistent copy of the timebase */
+static void clocksrc_GetTimebase(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, CLOCKSRC_TIMEBASE* pTimebase) {
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timebaseMutex);
+  *pTimebase = omx_clocksrc_component_Private->sTimebase;
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timebaseMutex);
+}
+
+/** Rewrites the snapshot read by the clients from the timebase and the
+ * state of the clock. The timebase is moved to a whole microsecond of wall
+ * time, the unit the clients see the wall time in.
+ */
+static void clocksrc_PublishSnapshot(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private) {
+  OMX_BELLAGIOCLOCKSNAPSHOTTYPE* pSnapshot = &omx_clocksrc_component_Private->sSnapshot;
+  OMX_U64                        nWallTime;
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timebaseMutex);
+  nWallTime = omx_clocksrc_component_Private->sTimebase.nWallTime / 1000 * 1000;
+  pSnapshot->nSequence++;
+  __sync_synchronize();
+  pSnapshot->eState     = omx_clocksrc_component_Private->sClockState.eState;
+  pSnapshot->xScale     = omx_clocksrc_component_Private->sTimebase.xScale;
+  pSnapshot->nMediaTime = clocksrc_MediaTimeAt(&omx_clocksrc_component_Private->sTimebase, nWallTime);
+  pSnapshot->nWallTime  = (OMX_TICKS)(nWallTime / 1000);
+  __sync_synchronize();
+  pSnapshot->nSequence++;
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timebaseMutex);
+}
+
+/** The bit of the port nPortIndex in nWaitMask, none for the ports it has no room for */
+static OMX_U32 clocksrc_WaitMaskBit(OMX_U32 nPortIndex) {
+  return nPortIndex < CLOCK_WAITMASK_PORTS ? (OMX_U32)1 << nPortIndex : 0;
+}
+
+/** The bits of all the ports of the component in nWaitMask */
+static OMX_U32 clocksrc_WaitMaskAll(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private) {
+  OMX_U32 nPorts = omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;
+
+  return nPorts < CLOCK_WAITMASK_PORTS ? ((OMX_U32)1 << nPorts) - 1 : ~(OMX_U32)0;
+}
+
+/** The time a request is due at: the wall time its media time is reached at,
+ * brought forward by the wall time offset the client asked for
+ */
+static OMX_U64 clocksrc_RequestDeadline(CLOCKSRC_TIMEBASE* pTimebase, OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE* pRequest) {
+  return clocksrc_WallTimeAt(pTimebase, pRequest->nMediaTimestamp - (pRequest->nOffset * pTimebase->xScale) / 65536);
+}
+
+/** Moves the request at nIndex up the heap to its place. Called with timerMutex held */
+static void clocksrc_HeapUp(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_U32 nIndex) {
+  CLOCKSRC_REQUEST* pHeap = omx_clocksrc_component_Private->sRequests;
+  CLOCKSRC_REQUEST  sRequest = pHeap[nIndex];
+
+  while (nIndex > 0 && pHeap[(nIndex - 1) / 2].nDeadline > sRequest.nDeadline) {
+    pHeap[nIndex] = pHeap[(nIndex - 1) / 2];
+    nIndex = (nIndex - 1) / 2;
+  }
+  pHeap[nIndex] = sRequest;
+}
+
+/** Moves the request at nIndex down the heap to its place. Called with timerMutex held */
+static void clocksrc_HeapDown(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_U32 nIndex) {
+  CLOCKSRC_REQUEST* pHeap = omx_clocksrc_component_Private->sRequests;
+  OMX_U32           nRequests = omx_clocksrc_component_Private->nRequests;
+  CLOCKSRC_REQUEST  sRequest = pHeap[nIndex];
+  OMX_U32           nChild;
+
+  while ((nChild = 2 * nIndex + 1) < nRequests) {
+    if (nChild + 1 < nRequests && pHeap[nChild + 1].nDeadline < pHeap[nChild].nDeadline) {
+      nChild++;
+    }
+    if (pHeap[nChild].nDeadline >= sRequest.nDeadline) {
+      break;
+    }
+    pHeap[nIndex] = pHeap[nChild];
+    nIndex = nChild;
+  }
+  pHeap[nIndex] = sRequest;
+}
+
+/** Recomputes the deadlines of the pending requests after the timebase
+ * changed and wakes the timer thread to wait for the new earliest one
+ */
+static void clocksrc_RescheduleRequests(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private) {
+  CLOCKSRC_TIMEBASE sTimebase;
+  OMX_U32           i;
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timerMutex);
+  if (omx_clocksrc_component_Private->nRequests > 0) {
+    clocksrc_GetTimebase(omx_clocksrc_component_Private, &sTimebase);
+    for (i = 0; i < omx_clocksrc_component_Private->nRequests; i++) {
+      omx_clocksrc_component_Private->sRequests[i].nDeadline =
+        clocksrc_RequestDeadline(&sTimebase, &omx_clocksrc_component_Private->sRequests[i].sRequest);
+    }
+    for (i = omx_clocksrc_component_Private->nRequests / 2; i > 0; i--) {
+      clocksrc_HeapDown(omx_clocksrc_component_Private, i - 1);
+    }
+    pthread_cond_signal(&omx_clocksrc_component_Private->timerCond);
+  }
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
+}
+
+/** Drops the updates queued on the port nPortIndex. Called with clockEventMutex held */
+static void clocksrc_DropUpdates(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_U32 nPortIndex) {
+  OMX_U32 i;
+
+  for (i = 0; i < omx_clocksrc_component_Private->nUpdates[nPortIndex]; i++) {
+    if (omx_clocksrc_component_Private->sUpdates[nPortIndex][i].eUpdateType == OMX_TIME_UpdateRequestFulfillment) {
+      __sync_fetch_and_sub(&omx_clocksrc_component_Private->nPortRequests[nPortIndex], 1);
+    }
+  }
+  omx_clocksrc_component_Private->nUpdates[nPortIndex] = 0;
+}
+
+/** Drops the pending requests of the port nPortIndex, or of all ports with
+ * OMX_ALL, and the updates queued on them and not delivered yet
+ */
+static void clocksrc_CancelRequests(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_U32 nPortIndex) {
+  OMX_U32 i, nKept = 0;
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timerMutex);
+  for (i = 0; i < omx_clocksrc_component_Private->nRequests; i++) {
+    if (nPortIndex != OMX_ALL && omx_clocksrc_component_Private->sRequests[i].sRequest.nPortIndex != nPortIndex) {
+      omx_clocksrc_component_Private->sRequests[nKept++] = omx_clocksrc_component_Private->sRequests[i];
+    } else {
+      __sync_fetch_and_sub(&omx_clocksrc_component_Private->nPortRequests[omx_clocksrc_component_Private->sRequests[i].sRequest.nPortIndex], 1);
+    }
+  }
+  omx_clocksrc_component_Private->nRequests = nKept;
+  for (i = nKept / 2; i > 0; i--) {
+    clocksrc_HeapDown(omx_clocksrc_component_Private, i - 1);
+  }
+  pthread_cond_signal(&omx_clocksrc_component_Private->timerCond);
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->clockEventMutex);
+  for (i = 0; i < omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts; i++) {
+    if (nPortIndex == OMX_ALL || nPortIndex == i) {
+      clocksrc_DropUpdates(omx_clocksrc_component_Private, i);
+    }
+  }
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->clockEventMutex);
+}
+
+/** Queues an update on the port nPortIndex. A state or scale change replaces
+ * the one still queued, which it supersedes. Called with clockEventMutex held
+ */
+static void clocksrc_QueueUpdate(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_U32 nPortIndex, OMX_TIME_MEDIATIMETYPE* pUpdate) {
+  OMX_TIME_MEDIATIMETYPE* pUpdates = omx_clocksrc_component_Private->sUpdates[nPortIndex];
+  OMX_U32                 i, nKept = 0;
+
+  if (pUpdate->eUpdateType != OMX_TIME_UpdateRequestFulfillment) {
+    for (i = 0; i < omx_clocksrc_component_Private->nUpdates[nPortIndex]; i++) {
+      if (pUpdates[i].eUpdateType == OMX_TIME_UpdateRequestFulfillment) {
+        pUpdates[nKept++] = pUpdates[i];
+      }
+    }
+    omx_clocksrc_component_Private->nUpdates[nPortIndex] = nKept;
+  }
+  if (omx_clocksrc_component_Private->nUpdates[nPortIndex] == CLOCK_PORT_UPDATES) {
+    /* not reached while nPortRequests bounds the fulfilments */
+    DEBUG(DEB_LEV_ERR, "In %s update queue of port %d full, update %d dropped\n", __func__, (int)nPortIndex, (int)pUpdate->eUpdateType);
+    if (pUpdate->eUpdateType == OMX_TIME_UpdateRequestFulfillment) {
+      __sync_fetch_and_sub(&omx_clocksrc_component_Private->nPortRequests[nPortIndex], 1);
+    }
+    return;
+  }
+  pUpdates[omx_clocksrc_component_Private->nUpdates[nPortIndex]++] = *pUpdate;
+}
+
+/** Takes the oldest update queued on the port nPortIndex, the delivery of a
+ * fulfilment leaves room for a new request of the port
+ */
+static OMX_BOOL clocksrc_TakeUpdate(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_U32 nPortIndex, OMX_TIME_MEDIATIMETYPE* pUpdate) {
+  OMX_TIME_MEDIATIMETYPE* pUpdates = omx_clocksrc_component_Private->sUpdates[nPortIndex];
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->clockEventMutex);
+  if (omx_clocksrc_component_Private->nUpdates[nPortIndex] == 0) {
+    pthread_mutex_unlock(&omx_clocksrc_component_Private->clockEventMutex);
+    return OMX_FALSE;
+  }
+  *pUpdate = pUpdates[0];
+  memmove(&pUpdates[0], &pUpdates[1], --omx_clocksrc_component_Private->nUpdates[nPortIndex] * sizeof(OMX_TIME_MEDIATIMETYPE));
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->clockEventMutex);
+  if (pUpdate->eUpdateType == OMX_TIME_UpdateRequestFulfillment) {
+    __sync_fetch_and_sub(&omx_clocksrc_component_Private->nPortRequests[nPortIndex], 1);
+  }
+  return OMX_TRUE;
+}
+
+/** The scale the timebase runs at: the scale set by the client while the
+ * clock is running, 0 otherwise so that the media time stays where it is
+ */
+static OMX_S32 clocksrc_TimebaseScale(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private) {
+  if (omx_clocksrc_component_Private->sClockState.eState != OMX_TIME_ClockStateRunning) {
+    return 0;
+  }
+  return omx_clocksrc_component_Private->sConfigScale.xScale;
+}
+
+/** Restarts the timebase now from the media time nMediaTime at the scale xScale */
+static void clocksrc_SetTimebase(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_TICKS nMediaTime, OMX_S32 xScale) {
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timebaseMutex);
+  omx_clocksrc_component_Private->sTimebase.nWallTime  = clocksrc_WallTime();
+  omx_clocksrc_component_Private->sTimebase.nMediaTime = nMediaTime;
+  omx_clocksrc_component_Private->sTimebase.xScale     = xScale;
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timebaseMutex);
+  clocksrc_PublishSnapshot(omx_clocksrc_component_Private);
+  clocksrc_RescheduleRequests(omx_clocksrc_component_Private);
+}
+
+/** Changes the scale of the timebase keeping the media time continuous, the
+ * media time elapsed so far is accounted at the previous scale
+ */
+static void clocksrc_ScaleTimebase(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_S32 xScale) {
+  OMX_U64 nNow;
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timebaseMutex);
+  nNow = clocksrc_WallTime();
+  omx_clocksrc_component_Private->sTimebase.nMediaTime = clocksrc_MediaTimeAt(&omx_clocksrc_component_Private->sTimebase, nNow);
+  omx_clocksrc_component_Private->sTimebase.nWallTime  = nNow;
+  omx_clocksrc_component_Private->sTimebase.xScale     = xScale;
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timebaseMutex);
+  clocksrc_PublishSnapshot(omx_clocksrc_component_Private);
+  clocksrc_RescheduleRequests(omx_clocksrc_component_Private);
+}
+
+/** Publishes a state or scale change of the clock to its clients. The
+ * snapshot is rewritten for all of them and the change is queued on the
+ * ports which did not opt out of the buffers, the buffer management thread
+ * is not woken at all when every client reads the snapshot. The caller does
+ * not wait for the delivery.
+ */
+static void clocksrc_BroadcastUpdate(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, OMX_TIME_UPDATETYPE eUpdateType, OMX_TIME_CLOCKSTATE eState) {
+  OMX_TIME_MEDIATIMETYPE sUpdate;
+  CLOCKSRC_TIMEBASE      sTimebase;
+  OMX_U32                i, nNotified = 0;
+
+  setHeader(&sUpdate, sizeof(OMX_TIME_MEDIATIMETYPE));
+  pthread_mutex_lock(&omx_clocksrc_component_Private->clockEventMutex);
+  clocksrc_PublishSnapshot(omx_clocksrc_component_Private);
+  clocksrc_GetTimebase(omx_clocksrc_component_Private, &sTimebase);
+  omx_clocksrc_component_Private->eUpdateType = eUpdateType;
+  sUpdate.nClientPrivate       = 0;
+  sUpdate.eUpdateType          = eUpdateType;
+  sUpdate.eState               = eState;
+  sUpdate.xScale               = omx_clocksrc_component_Private->sConfigScale.xScale;
+  sUpdate.nMediaTimestamp      = sTimebase.nMediaTime;
+  sUpdate.nOffset              = 0;
+  sUpdate.nWallTimeAtMediaTime = (OMX_TICKS)(sTimebase.nWallTime / 1000);
+  for (i = 0; i < omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts; i++) {
+    if (omx_clocksrc_component_Private->bSnapshotOnly[i]) {
+      continue;
+    }
+    clocksrc_QueueUpdate(omx_clocksrc_component_Private, i, &sUpdate);
+    nNotified++;
+  }
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->clockEventMutex);
+  if (nNotified > 0) {
+    /*Signal Buffer Management Thread*/
+    DEBUG(DEB_LEV_SIMPLE_SEQ, "Clock update %d queued on %d ports\n", (int)eUpdateType, (int)nNotified);
+    tsem_up(omx_clocksrc_component_Private->clockEventSem);
+  }
+}
+
+/** Queues the fulfilment of the due requests on their ports and wakes the
+ * buffer management thread, which delivers each port as soon as it holds a
+ * buffer; the timer thread does not wait for it. A request whose media
+ * time has already passed is reported late with an offset of 0xFFFFFFFF.
+ */
+static void clocksrc_FulfilRequests(omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private, CLOCKSRC_REQUEST* pDue, OMX_U32 nDue) {
+  OMX_TIME_MEDIATIMETYPE sUpdate;
+  CLOCKSRC_TIMEBASE      sTimebase;
+  OMX_U64                nNow, nAt;
+  OMX_U32                i;
+
+  setHeader(&sUpdate, sizeof(OMX_TIME_MEDIATIMETYPE));
+  pthread_mutex_lock(&omx_clocksrc_component_Private->clockEventMutex);
+  clocksrc_GetTimebase(omx_clocksrc_component_Private, &sTimebase);
+  nNow = clocksrc_WallTime();
+  for (i = 0; i < nDue; i++) {
+    nAt = clocksrc_WallTimeAt(&sTimebase, pDue[i].sRequest.nMediaTimestamp);
+    sUpdate.nClientPrivate       = (OMX_U32)(unsigned long)pDue[i].sRequest.pClientPrivate;
+    sUpdate.eUpdateType          = OMX_TIME_UpdateRequestFulfillment;
+    sUpdate.eState               = omx_clocksrc_component_Private->sClockState.eState;
+    sUpdate.xScale               = sTimebase.xScale;
+    sUpdate.nMediaTimestamp      = pDue[i].sRequest.nMediaTimestamp;
+    sUpdate.nOffset              = nAt < nNow ? 0xFFFFFFFF : (OMX_TICKS)((nAt - nNow) / 1000);
+    sUpdate.nWallTimeAtMediaTime = (OMX_TICKS)(nAt / 1000);
+    clocksrc_QueueUpdate(omx_clocksrc_component_Private, pDue[i].sRequest.nPortIndex, &sUpdate);
+    DEBUG(DEB_LEV_SIMPLE_SEQ,"pI=%d MB=%lld WB=%lld RT=%lld offset=%lld late=%lld\n",(int)pDue[i].sRequest.nPortIndex,
+      sTimebase.nMediaTime,sTimebase.nWallTime,pDue[i].sRequest.nMediaTimestamp,sUpdate.nOffset,(OMX_TICKS)(nNow - pDue[i].nDeadline));
+  }
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->clockEventMutex);
+  /*Signal Buffer Management Thread*/
+  tsem_up(omx_clocksrc_component_Private->clockEventSem);
+}
+
+/** The timer thread. It sleeps on the monotonic clock until the earliest
+ * deadline of the request heap, then queues the fulfilment of the due
+ * requests on their ports.
+ */
+static void* clocksrc_TimerFunction(void* param) {
+  omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private = (omx_clocksrc_component_PrivateType*)param;
+  CLOCKSRC_REQUEST                    sDue[MAX_CLOCK_PORTS];
+  OMX_U32                             nDue;
+  OMX_U64                             nNow, nDeadline;
+  struct timespec                     sWakeup;
+
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timerMutex);
+  while (!omx_clocksrc_component_Private->bTimerStop) {
+    if (omx_clocksrc_component_Private->nRequests == 0 || omx_clocksrc_component_Private->sRequests[0].nDeadline == CLOCKSRC_NEVER) {
+      pthread_cond_wait(&omx_clocksrc_component_Private->timerCond, &omx_clocksrc_component_Private->timerMutex);
+      continue;
+    }
+    nNow      = clocksrc_WallTime();
+    nDeadline = omx_clocksrc_component_Private->sRequests[0].nDeadline;
+    if (nDeadline > nNow) {
+      sWakeup.tv_sec  = nDeadline / 1000000000ULL;
+      sWakeup.tv_nsec = nDeadline % 1000000000ULL;
+      pthread_cond_timedwait(&omx_clocksrc_component_Private->timerCond, &omx_clocksrc_component_Private->timerMutex, &sWakeup);
+      continue;
+    }
+
+    /* take the due requests, the ones beyond sDue are taken on the next pass */
+    nDue = 0;
+    while (nDue < MAX_CLOCK_PORTS && omx_clocksrc_component_Private->nRequests > 0 && omx_clocksrc_component_Private->sRequests[0].nDeadline <= nNow) {
+      sDue[nDue++] = omx_clocksrc_component_Private->sRequests[0];
+      omx_clocksrc_component_Private->sRequests[0] = omx_clocksrc_component_Private->sRequests[--omx_clocksrc_component_Private->nRequests];
+      clocksrc_HeapDown(omx_clocksrc_component_Private, 0);
+    }
+    pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
+    clocksrc_FulfilRequests(omx_clocksrc_component_Private, sDue, nDue);
+    pthread_mutex_lock(&omx_clocksrc_component_Private->timerMutex);
+  }
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
+  return NULL;
+}
+
+/** Queues a buffer on a clock port, and wakes the buffer management thread
+ * if updates wait on the port for a buffer
+ */
+static OMX_ERRORTYPE clocksrc_port_SendBufferFunction(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer) {
+  omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_ERRORTYPE                       err;
+
+  err = base_clock_port_SendBufferFunction(openmaxStandPort, pBuffer);
+  if (err == OMX_ErrorNone && omx_clocksrc_component_Private->nUpdates[openmaxStandPort->sPortParam.nPortIndex] > 0) {
+    tsem_up(omx_clocksrc_component_Private->clockEventSem);
+  }
+  return err;
+}
+
+/** Constructs or destructs clock ports so that the component has nPorts of
+ * them. The ports removed must not be tunneled, and the clock waits again
+ * for the start time of all the ports.
+ */
+static OMX_ERRORTYPE clocksrc_SetPortCount(OMX_COMPONENTTYPE *openmaxStandComp, OMX_U32 nPorts) {
+  omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private = openmaxStandComp->pComponentPrivate;
+  omx_base_PortType**                 ports;
+  OMX_U32                             i, nOldPorts = omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;
+
+  if (nPorts == 0 || nPorts > MAX_CLOCK_PORTS) {
+    return OMX_ErrorBadParameter;
+  }
+  for (i = nPorts; i < nOldPorts; i++) {
+    if (PORT_IS_TUNNELED(omx_clocksrc_component_Private->ports[i])) {
+      DEBUG(DEB_LEV_ERR, "In %s port %d is tunneled\n", __func__, (int)i);
+      return OMX_ErrorIncorrectStateOperation;
+    }
+  }
+  for (i = nPorts; i < nOldPorts; i++) {
+    omx_clocksrc_component_Private->ports[i]->PortDestructor(omx_clocksrc_component_Private->ports[i]);
+    omx_clocksrc_component_Private->ports[i] = NULL;
+  }
+  omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts = nPorts < nOldPorts ? nPorts : nOldPorts;
+
+  if (nPorts > nOldPorts) {
+    ports = realloc(omx_clocksrc_component_Private->ports, nPorts * sizeof(omx_base_PortType *));
+    if (!ports) {
+      return OMX_ErrorInsufficientResources;
+    }
+    omx_clocksrc_component_Private->ports = ports;
+    for (i = nOldPorts; i < nPorts; i++) {
+      ports[i] = calloc(1, sizeof(omx_base_clock_PortType));
+      if (!ports[i]) {
+        return OMX_ErrorInsufficientResources;
+      }
+      base_clock_port_Constructor(openmaxStandComp, &ports[i], i, OMX_FALSE);
+      ports[i]->FlushProcessingBuffers = clocksrc_port_FlushProcessingBuffers;
+      ports[i]->Port_SendBufferFunction = clocksrc_port_SendBufferFunction;
+      omx_clocksrc_component_Private->bSnapshotOnly[i] = OMX_FALSE;
+      omx_clocksrc_component_Private->nUpdates[i]      = 0;
+      omx_clocksrc_component_Private->nPortRequests[i] = 0;
+      omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts = i + 1;
+    }
+  }
+  omx_clocksrc_component_Private->sClockState.nWaitMask = clocksrc_WaitMaskAll(omx_clocksrc_component_Private);
+  return OMX_ErrorNone;
+}
 
 /** The Constructor
  */
 OMX_ERRORTYPE omx_clocksrc_component_Constructor(OMX_COMPONENTTYPE *openmaxStandComp,OMX_STRING cComponentName) {
   int                                 omxErr;
   omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private;
-  OMX_U32 i;
+  pthread_condattr_t                  timerCondAttr;
 
 	RM_RegisterComponent(CLOCK_COMP_NAME, MAX_CLOCK_COMPONENTS);
 
@@ -54,32 +500,19 @@ OMX_ERRORTYPE omx_clocksrc_component_Constructor(OMX_COMPONENTTYPE *openmaxStand
     return OMX_ErrorInsufficientResources;
   }
 
-  omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nStartPortNumber = 0;
-  omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts = 3;
-
-  /** Allocate Ports and call port constructor. */
-  if (omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts && !omx_clocksrc_component_Private->ports) {
-    omx_clocksrc_component_Private->ports = calloc(omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts, sizeof(omx_base_PortType *));
-    if (!omx_clocksrc_component_Private->ports) {
-      return OMX_ErrorInsufficientResources;
-    }
-    for (i=0; i < omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts; i++) {
-      omx_clocksrc_component_Private->ports[i] = calloc(1, sizeof(omx_base_clock_PortType));
-      if (!omx_clocksrc_component_Private->ports[i]) {
-        return OMX_ErrorInsufficientResources;
-      }
-      base_clock_port_Constructor(openmaxStandComp, &omx_clocksrc_component_Private->ports[i], i, OMX_FALSE);
-      omx_clocksrc_component_Private->ports[i]->FlushProcessingBuffers = clocksrc_port_FlushProcessingBuffers;
-    }
-  }
-
-
   /* initializing the OMX_TIME_CONFIG_CLOCKSTATETYPE */
   setHeader(&omx_clocksrc_component_Private->sClockState, sizeof(OMX_TIME_CONFIG_CLOCKSTATETYPE));
   omx_clocksrc_component_Private->sClockState.eState     = OMX_TIME_ClockStateStopped;
   omx_clocksrc_component_Private->sClockState.nStartTime = 0;
   omx_clocksrc_component_Private->sClockState.nOffset    = 0;
-  omx_clocksrc_component_Private->sClockState.nWaitMask  = 0xFF;
+
+  /** Allocate Ports and call port constructor, the client can change their number while loaded */
+  omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nStartPortNumber = 0;
+  omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts = 0;
+  omxErr = clocksrc_SetPortCount(openmaxStandComp, CLOCK_DEFAULT_PORTS);
+  if (omxErr != OMX_ErrorNone) {
+    return omxErr;
+  }
 
   setHeader(&omx_clocksrc_component_Private->sMinStartTime, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE));
   omx_clocksrc_component_Private->sMinStartTime.nTimestamp = 0;
@@ -92,16 +525,31 @@ OMX_ERRORTYPE omx_clocksrc_component_Constructor(OMX_COMPONENTTYPE *openmaxStand
   omx_clocksrc_component_Private->sRefClock.eClock = OMX_TIME_RefClockNone;
   omx_clocksrc_component_Private->eUpdateType = OMX_TIME_UpdateMax;
 
+  pthread_mutex_init(&omx_clocksrc_component_Private->timebaseMutex, NULL);
+  omx_clocksrc_component_Private->sTimebase.nWallTime  = clocksrc_WallTime();
+  omx_clocksrc_component_Private->sTimebase.nMediaTime = 0;
+  omx_clocksrc_component_Private->sTimebase.xScale     = clocksrc_TimebaseScale(omx_clocksrc_component_Private);
+  clocksrc_PublishSnapshot(omx_clocksrc_component_Private);
+  pthread_mutex_init(&omx_clocksrc_component_Private->clockEventMutex, NULL);
+
+  /* the timer thread waits for absolute deadlines of the monotonic clock */
+  omx_clocksrc_component_Private->nRequests  = 0;
+  omx_clocksrc_component_Private->bTimerStop = OMX_FALSE;
+  pthread_mutex_init(&omx_clocksrc_component_Private->timerMutex, NULL);
+  pthread_condattr_init(&timerCondAttr);
+  pthread_condattr_setclock(&timerCondAttr, CLOCK_MONOTONIC);
+  pthread_cond_init(&omx_clocksrc_component_Private->timerCond, &timerCondAttr);
+  pthread_condattr_destroy(&timerCondAttr);
+  if (pthread_create(&omx_clocksrc_component_Private->timerThread, NULL, clocksrc_TimerFunction, omx_clocksrc_component_Private) != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s failed to start the timer thread\n", __func__);
+    return OMX_ErrorInsufficientResources;
+  }
+
   if(!omx_clocksrc_component_Private->clockEventSem) {
     omx_clocksrc_component_Private->clockEventSem = calloc(1,sizeof(tsem_t));
     tsem_init(omx_clocksrc_component_Private->clockEventSem, 0);
   }
 
-  if(!omx_clocksrc_component_Private->clockEventCompleteSem) {
-    omx_clocksrc_component_Private->clockEventCompleteSem = calloc(1,sizeof(tsem_t));
-    tsem_init(omx_clocksrc_component_Private->clockEventCompleteSem, 0);
-  }
-
   omx_clocksrc_component_Private->BufferMgmtCallback = omx_clocksrc_component_BufferMgmtCallback;
   omx_clocksrc_component_Private->destructor = omx_clocksrc_component_Destructor;
   omx_clocksrc_component_Private->BufferMgmtFunction = omx_clocksrc_BufferMgmtFunction;
@@ -111,6 +559,7 @@ OMX_ERRORTYPE omx_clocksrc_component_Constructor(OMX_COMPONENTTYPE *openmaxStand
 
   openmaxStandComp->SetConfig  = omx_clocksrc_component_SetConfig;
   openmaxStandComp->GetConfig  = omx_clocksrc_component_GetConfig;
+  openmaxStandComp->GetExtensionIndex = omx_clocksrc_component_GetExtensionIndex;
   openmaxStandComp->SendCommand = omx_clocksrc_component_SendCommand;
 
   return OMX_ErrorNone;
@@ -124,17 +573,23 @@ OMX_ERRORTYPE omx_clocksrc_component_Destructor(OMX_COMPONENTTYPE *openmaxStandC
 
   omx_clocksrc_component_Private->sClockState.eState = OMX_TIME_ClockStateMax;
 
+  /* stop the timer thread before the semaphores it signals go away */
+  pthread_mutex_lock(&omx_clocksrc_component_Private->timerMutex);
+  omx_clocksrc_component_Private->bTimerStop = OMX_TRUE;
+  pthread_cond_signal(&omx_clocksrc_component_Private->timerCond);
+  pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
+  pthread_join(omx_clocksrc_component_Private->timerThread, NULL);
+  pthread_cond_destroy(&omx_clocksrc_component_Private->timerCond);
+  pthread_mutex_destroy(&omx_clocksrc_component_Private->timerMutex);
+
   /*Deinitialize and free message semaphore*/
   if(omx_clocksrc_component_Private->clockEventSem) {
     tsem_deinit(omx_clocksrc_component_Private->clockEventSem);
     free(omx_clocksrc_component_Private->clockEventSem);
     omx_clocksrc_component_Private->clockEventSem=NULL;
   }
-  if(omx_clocksrc_component_Private->clockEventCompleteSem) {
-    tsem_deinit(omx_clocksrc_component_Private->clockEventCompleteSem);
-    free(omx_clocksrc_component_Private->clockEventCompleteSem);
-    omx_clocksrc_component_Private->clockEventCompleteSem=NULL;
-  }
+  pthread_mutex_destroy(&omx_clocksrc_component_Private->timebaseMutex);
+  pthread_mutex_destroy(&omx_clocksrc_component_Private->clockEventMutex);
 
   /* frees port/s */
   if (omx_clocksrc_component_Private->ports) {
@@ -209,6 +664,7 @@ OMX_ERRORTYPE omx_clocksrc_component_SetParameter(
   omx_clocksrc_component_PrivateType*   omx_clocksrc_component_Private = openmaxStandComp->pComponentPrivate;
   omx_base_clock_PortType*              pPort;
   OMX_PARAM_COMPONENTROLETYPE     *pComponentRole;
+  OMX_PORT_PARAM_TYPE                   *pPortParam;
 
   if (ComponentParameterStructure == NULL) {
     return OMX_ErrorBadParameter;
@@ -217,6 +673,21 @@ OMX_ERRORTYPE omx_clocksrc_component_SetParameter(
   DEBUG(DEB_LEV_SIMPLE_SEQ, "   Setting parameter %i\n", nParamIndex);
   /* Check which structure we are being fed and fill its header */
   switch(nParamIndex) {
+  case OMX_IndexParamOtherInit:
+    pPortParam = (OMX_PORT_PARAM_TYPE*)ComponentParameterStructure;
+    if (omx_clocksrc_component_Private->state != OMX_StateLoaded ||
+        omx_clocksrc_component_Private->transientState == OMX_TransStateLoadedToIdle) {
+      DEBUG(DEB_LEV_ERR, "In %s Incorrect State=%x lineno=%d\n",__func__, omx_clocksrc_component_Private->state, __LINE__);
+      return OMX_ErrorIncorrectStateOperation;
+    }
+    if ((err = checkHeader(ComponentParameterStructure, sizeof(OMX_PORT_PARAM_TYPE))) != OMX_ErrorNone) {
+      break;
+    }
+    if (pPortParam->nStartPortNumber != 0) {
+      return OMX_ErrorBadParameter;
+    }
+    err = clocksrc_SetPortCount(openmaxStandComp, pPortParam->nPorts);
+    break;
   case OMX_IndexParamOtherPortFormat:
     pOtherPortFormat = (OMX_OTHER_PARAM_PORTFORMATTYPE*)ComponentParameterStructure;
     /*Check Structure Header and verify component state*/
@@ -269,9 +740,9 @@ OMX_ERRORTYPE omx_clocksrc_component_SendCommand(
       return OMX_ErrorBadPortIndex;
     }
     if(nParam == OMX_ALL) {
-      nMask = 0xFF;
+      nMask = clocksrc_WaitMaskAll(omx_clocksrc_component_Private);
     } else {
-      nMask = 0x1 << nParam;
+      nMask = clocksrc_WaitMaskBit(nParam);
     }
     omx_clocksrc_component_Private->sClockState.nWaitMask &= (~nMask);
     DEBUG(DEB_LEV_SIMPLE_SEQ,"In %s nWaitMask =%08x Musk=%x\n",__func__,
@@ -283,17 +754,19 @@ OMX_ERRORTYPE omx_clocksrc_component_SendCommand(
       return OMX_ErrorBadPortIndex;
     }
     if(nParam == OMX_ALL) {
-      nMask = 0xFF;
+      nMask = clocksrc_WaitMaskAll(omx_clocksrc_component_Private);
     } else {
-      nMask = 0x1 << nParam;
+      nMask = clocksrc_WaitMaskBit(nParam);
     }
-    omx_clocksrc_component_Private->sClockState.nWaitMask &= nMask;
+    omx_clocksrc_component_Private->sClockState.nWaitMask |= nMask;
     DEBUG(DEB_LEV_SIMPLE_SEQ,"In %s nWaitMask =%08x Musk=%x\n",__func__,
       (int)omx_clocksrc_component_Private->sClockState.nWaitMask,(int)nMask);
     break;
   case OMX_CommandStateSet:
     if ((nParam == OMX_StateLoaded) && (omx_clocksrc_component_Private->state == OMX_StateIdle)) {
       omx_clocksrc_component_Private->transientState = OMX_TransStateIdleToLoaded;
+      /*No request can be fulfilled without the buffer management thread*/
+      clocksrc_CancelRequests(omx_clocksrc_component_Private, OMX_ALL);
       /*Signal buffer management thread to exit*/
       tsem_up(omx_clocksrc_component_Private->clockEventSem);
     } else if ((nParam == OMX_StateExecuting) && (omx_clocksrc_component_Private->state == OMX_StatePause)) {
@@ -326,8 +799,8 @@ OMX_ERRORTYPE omx_clocksrc_component_GetConfig(
   OMX_TIME_CONFIG_TIMESTAMPTYPE*      timestamp;
   OMX_TIME_CONFIG_SCALETYPE           *pConfigScale;
   OMX_TIME_CONFIG_ACTIVEREFCLOCKTYPE  *pRefClock;
-  struct timeval                      tv;
-  struct timezone                     zv;
+  OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE *pSnapshotConfig;
+  CLOCKSRC_TIMEBASE                   sTimebase;
 
   switch (nIndex) {
   case OMX_IndexConfigTimeClockState :
@@ -336,12 +809,15 @@ OMX_ERRORTYPE omx_clocksrc_component_GetConfig(
     break;
   case OMX_IndexConfigTimeCurrentWallTime :
     timestamp = (OMX_TIME_CONFIG_TIMESTAMPTYPE*) pComponentConfigStructure;
-    gettimeofday(&tv,&zv);
-    timestamp->nTimestamp =  (tv.tv_sec)*1000+tv.tv_usec;  // converting the time read from gettimeofday into microseconds
-    DEBUG(DEB_LEV_SIMPLE_SEQ,"wall time obtained in %s =%x\n",__func__,(int)timestamp->nTimestamp);
+    timestamp->nTimestamp = (OMX_TICKS)(clocksrc_WallTime() / 1000);  // the monotonic time in microseconds
+    DEBUG(DEB_LEV_SIMPLE_SEQ,"wall time obtained in %s =%lld\n",__func__,timestamp->nTimestamp);
     break;
   case OMX_IndexConfigTimeCurrentMediaTime :
-    DEBUG(DEB_LEV_SIMPLE_SEQ," TBD  portindex to be returned is OMX_ALL, OMX_IndexConfigTimeCurrentMediaTime in %s \n",__func__);
+    timestamp = (OMX_TIME_CONFIG_TIMESTAMPTYPE*) pComponentConfigStructure;
+    /* the timebase has a null scale while the clock is not running */
+    clocksrc_GetTimebase(omx_clocksrc_component_Private, &sTimebase);
+    timestamp->nTimestamp = clocksrc_MediaTimeAt(&sTimebase, clocksrc_WallTime());
+    DEBUG(DEB_LEV_SIMPLE_SEQ,"media time obtained in %s =%lld\n",__func__,timestamp->nTimestamp);
     break;
   case OMX_IndexConfigTimeScale:
     pConfigScale = (OMX_TIME_CONFIG_SCALETYPE*) pComponentConfigStructure;
@@ -352,6 +828,17 @@ OMX_ERRORTYPE omx_clocksrc_component_GetConfig(
      memcpy(pRefClock,&omx_clocksrc_component_Private->sRefClock, sizeof(OMX_TIME_CONFIG_ACTIVEREFCLOCKTYPE));
      break;
   default:
+    if ((OMX_U32)nIndex == OMX_IndexConfigBellagioPortStats) {
+      return omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
+    } else if ((OMX_U32)nIndex == OMX_IndexConfigBellagioClockSnapshot) {
+      pSnapshotConfig = (OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE*) pComponentConfigStructure;
+      if (pSnapshotConfig->nPortIndex >= omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
+        return OMX_ErrorBadPortIndex;
+      }
+      pSnapshotConfig->bBufferUpdates = omx_clocksrc_component_Private->bSnapshotOnly[pSnapshotConfig->nPortIndex] ? OMX_FALSE : OMX_TRUE;
+      pSnapshotConfig->pSnapshot      = &omx_clocksrc_component_Private->sSnapshot;
+      break;
+    }
     return OMX_ErrorBadParameter;
     break;
   }
@@ -373,12 +860,10 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
   OMX_TIME_CONFIG_SCALETYPE           *pConfigScale;
   OMX_U32                             nMask;
   OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE* sMediaTimeRequest;
-  int                                 i;
-  struct timeval                      tv;
-  struct timezone                     zv;
-  OMX_TICKS                           walltime, mediatime, mediaTimediff, wallTimediff;
-  OMX_S32                             Scale;
-  unsigned int                        sleeptime;
+  OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE* pSnapshotConfig;
+  CLOCKSRC_TIMEBASE                   sTimebase;
+  CLOCKSRC_REQUEST*                   pRequest;
+  OMX_U64                             nDeadline;
 
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
 
@@ -389,21 +874,14 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
       case OMX_TIME_ClockStateRunning:
         if(omx_clocksrc_component_Private->sClockState.eState == OMX_TIME_ClockStateRunning) {
           DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Received OMX_TIME_ClockStateRunning again\n",__func__);
+        } else {
+          /* the media time starts from the start time given by the client */
+          clocksrc_SetTimebase(omx_clocksrc_component_Private, clockstate->nStartTime, omx_clocksrc_component_Private->sConfigScale.xScale);
         }
         DEBUG(DEB_LEV_SIMPLE_SEQ,"in  %s ...set to OMX_TIME_ClockStateRunning\n",__func__);
         memcpy(&omx_clocksrc_component_Private->sClockState, clockstate, sizeof(OMX_TIME_CONFIG_CLOCKSTATETYPE));
-        omx_clocksrc_component_Private->eUpdateType = OMX_TIME_UpdateClockStateChanged;
         /* update the state change in all port */
-        for(i=0;i<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;i++) {
-          pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[i];
-          pPort->sMediaTime.eUpdateType                      = OMX_TIME_UpdateClockStateChanged;
-          pPort->sMediaTime.eState                           = OMX_TIME_ClockStateRunning;
-          pPort->sMediaTime.xScale                           = omx_clocksrc_component_Private->sConfigScale.xScale;
-        }
-        /*Signal Buffer Management Thread*/
-        tsem_up(omx_clocksrc_component_Private->clockEventSem);
-        DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for Clock Running Event for all ports\n");
-        tsem_down(omx_clocksrc_component_Private->clockEventCompleteSem);
+        clocksrc_BroadcastUpdate(omx_clocksrc_component_Private, OMX_TIME_UpdateClockStateChanged, OMX_TIME_ClockStateRunning);
       break;
       case OMX_TIME_ClockStateWaitingForStartTime:
         if(omx_clocksrc_component_Private->sClockState.eState == OMX_TIME_ClockStateRunning) {
@@ -413,22 +891,19 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
         }
         DEBUG(DEB_LEV_SIMPLE_SEQ," in  %s ...set to OMX_TIME_ClockStateWaitingForStartTime  mask sent=%d\n",__func__,(int)clockstate->nWaitMask);
         memcpy(&omx_clocksrc_component_Private->sClockState, clockstate, sizeof(OMX_TIME_CONFIG_CLOCKSTATETYPE));
+        clocksrc_PublishSnapshot(omx_clocksrc_component_Private);
       break;
       case OMX_TIME_ClockStateStopped:
         DEBUG(DEB_LEV_SIMPLE_SEQ," in  %s ...set to OMX_TIME_ClockStateStopped\n",__func__);
+        if(omx_clocksrc_component_Private->sClockState.eState == OMX_TIME_ClockStateRunning) {
+          /* freeze the media time where the clock stopped */
+          clocksrc_ScaleTimebase(omx_clocksrc_component_Private, 0);
+        }
+        /* the requests pending are not fulfilled once the clock stopped */
+        clocksrc_CancelRequests(omx_clocksrc_component_Private, OMX_ALL);
         memcpy(&omx_clocksrc_component_Private->sClockState, clockstate, sizeof(OMX_TIME_CONFIG_CLOCKSTATETYPE));
-        omx_clocksrc_component_Private->eUpdateType = OMX_TIME_UpdateClockStateChanged;
         /* update the state change in all port */
-        for(i=0;i<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;i++) {
-          pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[i];
-          pPort->sMediaTime.eUpdateType                      = OMX_TIME_UpdateClockStateChanged;
-          pPort->sMediaTime.eState                           = OMX_TIME_ClockStateStopped;
-          pPort->sMediaTime.xScale                           = omx_clocksrc_component_Private->sConfigScale.xScale;
-        }
-        /*Signal Buffer Management Thread*/
-        tsem_up(omx_clocksrc_component_Private->clockEventSem);
-        DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for Clock Stop Event for all ports\n");
-        tsem_down(omx_clocksrc_component_Private->clockEventCompleteSem);
+        clocksrc_BroadcastUpdate(omx_clocksrc_component_Private, OMX_TIME_UpdateClockStateChanged, OMX_TIME_ClockStateStopped);
       break;
       default:
       break;
@@ -438,7 +913,7 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
   case OMX_IndexConfigTimeClientStartTime:
     sRefTimeStamp = (OMX_TIME_CONFIG_TIMESTAMPTYPE*) pComponentConfigStructure;
     portIndex = sRefTimeStamp->nPortIndex;
-    if(portIndex > omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
+    if(portIndex >= omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
      return OMX_ErrorBadPortIndex;
     }
 
@@ -452,7 +927,7 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
     /* update the nWaitMask to clear the flag for the client which has sent its start time */
     if(omx_clocksrc_component_Private->sClockState.nWaitMask) {
       DEBUG(DEB_LEV_SIMPLE_SEQ,"refTime set is =%x \n",(int)pPort->sTimeStamp.nTimestamp);
-      nMask = ~(0x1 << portIndex);
+      nMask = ~clocksrc_WaitMaskBit(portIndex);
       omx_clocksrc_component_Private->sClockState.nWaitMask = omx_clocksrc_component_Private->sClockState.nWaitMask & nMask;
       if(omx_clocksrc_component_Private->sMinStartTime.nTimestamp >= pPort->sTimeStamp.nTimestamp){
          omx_clocksrc_component_Private->sMinStartTime.nTimestamp = pPort->sTimeStamp.nTimestamp;
@@ -463,24 +938,12 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
        omx_clocksrc_component_Private->sClockState.eState == OMX_TIME_ClockStateWaitingForStartTime) {
        omx_clocksrc_component_Private->sClockState.eState = OMX_TIME_ClockStateRunning;
       omx_clocksrc_component_Private->sClockState.nStartTime = omx_clocksrc_component_Private->sMinStartTime.nTimestamp;
-      omx_clocksrc_component_Private->MediaTimeBase          = omx_clocksrc_component_Private->sMinStartTime.nTimestamp;
-      gettimeofday(&tv,&zv);
-      walltime = ((OMX_TICKS)tv.tv_sec)*1000000 + ((OMX_TICKS)tv.tv_usec);
-      omx_clocksrc_component_Private->WallTimeBase          = walltime;
-      DEBUG(DEB_LEV_SIMPLE_SEQ,"Mediatimebase=%llx walltimebase=%llx \n",omx_clocksrc_component_Private->MediaTimeBase,omx_clocksrc_component_Private->WallTimeBase);
-      omx_clocksrc_component_Private->eUpdateType        = OMX_TIME_UpdateClockStateChanged;
-      /* update the state change in all port */
-      for(i=0;i<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;i++) {
-        pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[i];
-        pPort->sMediaTime.eUpdateType                      = OMX_TIME_UpdateClockStateChanged;
-        pPort->sMediaTime.eState                           = OMX_TIME_ClockStateRunning;
-        pPort->sMediaTime.xScale                           = omx_clocksrc_component_Private->sConfigScale.xScale;
-      }
-      /*Signal Buffer Management Thread*/
-      tsem_up(omx_clocksrc_component_Private->clockEventSem);
+      clocksrc_SetTimebase(omx_clocksrc_component_Private, omx_clocksrc_component_Private->sMinStartTime.nTimestamp, omx_clocksrc_component_Private->sConfigScale.xScale);
+      DEBUG(DEB_LEV_SIMPLE_SEQ,"Mediatimebase=%llx walltimebase=%llx \n",
+        omx_clocksrc_component_Private->sTimebase.nMediaTime,omx_clocksrc_component_Private->sTimebase.nWallTime);
       DEBUG(DEB_LEV_SIMPLE_SEQ,"setting the state to running from %s \n",__func__);
-      DEBUG(DEB_LEV_SIMPLE_SEQ,"Waiting for Clock Running Event for all ports in case OMX_IndexConfigTimeClientStartTime\n");
-      tsem_down(omx_clocksrc_component_Private->clockEventCompleteSem);
+      /* update the state change in all port */
+      clocksrc_BroadcastUpdate(omx_clocksrc_component_Private, OMX_TIME_UpdateClockStateChanged, OMX_TIME_ClockStateRunning);
     }
     break;
 
@@ -492,121 +955,116 @@ OMX_ERRORTYPE omx_clocksrc_component_SetConfig(
   case OMX_IndexConfigTimeCurrentAudioReference:
     sRefTimeStamp = (OMX_TIME_CONFIG_TIMESTAMPTYPE*) pComponentConfigStructure;
     portIndex = sRefTimeStamp->nPortIndex;
-    if(portIndex > omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
+    if(portIndex >= omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
      return OMX_ErrorBadPortIndex;
     }
     pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[portIndex];
     memcpy(&pPort->sTimeStamp, sRefTimeStamp, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE));
-    gettimeofday(&tv,&zv);
-    walltime = ((OMX_TICKS)tv.tv_sec)*1000000 + ((OMX_TICKS)tv.tv_usec);
-    omx_clocksrc_component_Private->WallTimeBase   = walltime;
-    omx_clocksrc_component_Private->MediaTimeBase  = sRefTimeStamp->nTimestamp; /* set the mediatime base of the received time stamp*/
+    /* set the mediatime base of the received time stamp*/
+    clocksrc_SetTimebase(omx_clocksrc_component_Private, sRefTimeStamp->nTimestamp, clocksrc_TimebaseScale(omx_clocksrc_component_Private));
   break;
 
   case OMX_IndexConfigTimeCurrentVideoReference:
     sRefTimeStamp = (OMX_TIME_CONFIG_TIMESTAMPTYPE*) pComponentConfigStructure;
     portIndex = sRefTimeStamp->nPortIndex;
-    if(portIndex > omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
+    if(portIndex >= omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
       return OMX_ErrorBadPortIndex;
     }
     pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[portIndex];
     memcpy(&pPort->sTimeStamp, sRefTimeStamp, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE));
-    gettimeofday(&tv,&zv);
-    walltime = ((OMX_TICKS)tv.tv_sec)*1000000 + ((OMX_TICKS)tv.tv_usec);
-    omx_clocksrc_component_Private->WallTimeBase   = walltime;
-    omx_clocksrc_component_Private->MediaTimeBase  = sRefTimeStamp->nTimestamp; /* set the mediatime base of the received time stamp*/
+    /* set the mediatime base of the received time stamp*/
+    clocksrc_SetTimebase(omx_clocksrc_component_Private, sRefTimeStamp->nTimestamp, clocksrc_TimebaseScale(omx_clocksrc_component_Private));
   break;
 
   case OMX_IndexConfigTimeScale:
-    /* update the mediatime base and walltime base using the current scale value*/
-    Scale = omx_clocksrc_component_Private->sConfigScale.xScale >> 16;  //* the scale currently in use, right shifted as Q16 format is used for the scale
-    gettimeofday(&tv,&zv);
-    walltime = ((OMX_TICKS)tv.tv_sec)*1000000 + ((OMX_TICKS)tv.tv_usec);
-    mediatime = omx_clocksrc_component_Private->MediaTimeBase + Scale*(walltime - omx_clocksrc_component_Private->WallTimeBase);
-    omx_clocksrc_component_Private->WallTimeBase   = walltime; // suitable start time to be used here
-    omx_clocksrc_component_Private->MediaTimeBase  = mediatime;  // TODO - needs to be checked
-
-    /* update the new scale value */
+    /* update the new scale value, it is kept while the clock is not running and applied when it starts */
     pConfigScale = (OMX_TIME_CONFIG_SCALETYPE*) pComponentConfigStructure;
     memcpy( &omx_clocksrc_component_Private->sConfigScale,pConfigScale, sizeof(OMX_TIME_CONFIG_SCALETYPE));
-    omx_clocksrc_component_Private->eUpdateType = OMX_TIME_UpdateScaleChanged;
+    /* rebase the media time at the scale currently in use, then run it at the new scale */
+    clocksrc_ScaleTimebase(omx_clocksrc_component_Private, clocksrc_TimebaseScale(omx_clocksrc_component_Private));
     /* update the scale change in all ports */
-    for(i=0;i<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;i++) {
-      pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[i];
-      pPort->sMediaTime.eUpdateType                      = OMX_TIME_UpdateScaleChanged;
-      pPort->sMediaTime.eState                           = OMX_TIME_ClockStateRunning;
-      pPort->sMediaTime.xScale                           = omx_clocksrc_component_Private->sConfigScale.xScale;
-      pPort->sMediaTime.nMediaTimestamp                  = omx_clocksrc_component_Private->MediaTimeBase;
-      pPort->sMediaTime.nWallTimeAtMediaTime             = omx_clocksrc_component_Private->WallTimeBase;
-      }
-    /*Signal Buffer Management Thread*/
-    tsem_up(omx_clocksrc_component_Private->clockEventSem);
-    DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for Scale Change Event for all ports\n");
-    tsem_down(omx_clocksrc_component_Private->clockEventCompleteSem);
+    clocksrc_BroadcastUpdate(omx_clocksrc_component_Private, OMX_TIME_UpdateScaleChanged, omx_clocksrc_component_Private->sClockState.eState);
   break;
 
   case OMX_IndexConfigTimeMediaTimeRequest:
-    Scale = omx_clocksrc_component_Private->sConfigScale.xScale >> 16;
+    sMediaTimeRequest = (OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE*) pComponentConfigStructure;
+    portIndex = sMediaTimeRequest->nPortIndex;
+    if(portIndex >= omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
+      return OMX_ErrorBadPortIndex;
+    }
 
-    if(omx_clocksrc_component_Private->sClockState.eState != OMX_TIME_ClockStateStopped && Scale != 0) {//TODO-  what happens if request comes in pause mode
+    if(omx_clocksrc_component_Private->state != OMX_StateIdle && omx_clocksrc_component_Private->state != OMX_StateExecuting &&
+       omx_clocksrc_component_Private->state != OMX_StatePause) {
+      return OMX_ErrorIncorrectStateOperation;
+    }
 
-      sMediaTimeRequest = (OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE*) pComponentConfigStructure;
-      portIndex = sMediaTimeRequest->nPortIndex;
+    if(omx_clocksrc_component_Private->sClockState.eState != OMX_TIME_ClockStateStopped) {
       pPort = (omx_base_clock_PortType*)omx_clocksrc_component_Private->ports[portIndex];
       memcpy(&pPort->sMediaTimeRequest, sMediaTimeRequest, sizeof(OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE));
 
-      gettimeofday(&tv,&zv);
-      walltime = ((OMX_TICKS)tv.tv_sec)*1000000 + ((OMX_TICKS)tv.tv_usec);
-      mediatime = omx_clocksrc_component_Private->MediaTimeBase + Scale*(walltime - omx_clocksrc_component_Private->WallTimeBase);
-      int thresh=2000;  // TODO - what is a good threshold to use
-      mediaTimediff = (sMediaTimeRequest->nMediaTimestamp - (sMediaTimeRequest->nOffset*Scale)) - mediatime;
-      DEBUG(DEB_LEV_SIMPLE_SEQ," pI=%d MTD=%lld MT=%lld RT=%lld offset=%lld, Scale=%d\n",
-               (int)portIndex,mediaTimediff,mediatime,sMediaTimeRequest->nMediaTimestamp,sMediaTimeRequest->nOffset,(int)Scale);
-      if((mediaTimediff<0 && Scale>0) || (mediaTimediff>0 && Scale<0)) { /* if mediatime has already elapsed then request can not be fullfilled */
-        DEBUG(DEB_LEV_SIMPLE_SEQ," pI=%d RNF MTD<0 MB=%lld WB=%lld MT=%lld RT=%lld WT=%lld offset=%lld, Scale=%d\n",
-                 (int)portIndex,omx_clocksrc_component_Private->MediaTimeBase,omx_clocksrc_component_Private->WallTimeBase,
-                  mediatime,sMediaTimeRequest->nMediaTimestamp,walltime,sMediaTimeRequest->nOffset,(int)Scale);
-        pPort->sMediaTime.eUpdateType          =  OMX_TIME_UpdateRequestFulfillment; // TODO : to be checked
-        pPort->sMediaTime.nMediaTimestamp      = sMediaTimeRequest->nMediaTimestamp;
-        pPort->sMediaTime.nOffset              = 0xFFFFFFFF;
-       }else{
-         wallTimediff  = mediaTimediff/Scale;
-         if(mediaTimediff){
-            if(wallTimediff>thresh) {
-                sleeptime = (unsigned int) (wallTimediff-thresh);
-                usleep(sleeptime);
-                wallTimediff = thresh;  // ask : can I use this as the new walltimediff
-                gettimeofday(&tv,&zv);
-                walltime = ((OMX_TICKS)tv.tv_sec)*1000000 + ((OMX_TICKS)tv.tv_usec);
-                mediatime = omx_clocksrc_component_Private->MediaTimeBase + Scale*(walltime - omx_clocksrc_component_Private->WallTimeBase);
-            }
-            //pPort->sMediaTime.nMediaTimestamp      = mediatime;
-            pPort->sMediaTime.nMediaTimestamp      = sMediaTimeRequest->nMediaTimestamp;  ///????
-            pPort->sMediaTime.nWallTimeAtMediaTime = walltime + wallTimediff;        //??????
-            pPort->sMediaTime.nOffset              = wallTimediff;                   //????
-            pPort->sMediaTime.xScale               = Scale;
-            pPort->sMediaTime.eUpdateType          = OMX_TIME_UpdateRequestFulfillment;
-            DEBUG(DEB_LEV_SIMPLE_SEQ,"pI=%d MB=%lld WB=%lld MT=%lld RT=%lld WT=%lld \n",(int)portIndex,
-                omx_clocksrc_component_Private->MediaTimeBase,omx_clocksrc_component_Private->WallTimeBase, mediatime,sMediaTimeRequest->nMediaTimestamp,walltime);
-         }
+      /* queue the request by deadline, the timer thread fulfils it so the client does not wait here */
+      pthread_mutex_lock(&omx_clocksrc_component_Private->timerMutex);
+      if(omx_clocksrc_component_Private->nRequests == CLOCK_MAX_REQUESTS ||
+         omx_clocksrc_component_Private->nPortRequests[portIndex] >= CLOCK_PORT_REQUESTS) {
+        pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
+        DEBUG(DEB_LEV_ERR,"In %s too many pending requests, port %d\n",__func__,(int)portIndex);
+        return OMX_ErrorInsufficientResources;
       }
-      /*Signal Buffer Management Thread*/
-      tsem_up(omx_clocksrc_component_Private->clockEventSem);
-      DEBUG(DEB_LEV_SIMPLE_SEQ, "Waiting for Scale Change Event for all ports\n");
-      tsem_down(omx_clocksrc_component_Private->clockEventCompleteSem);
+      clocksrc_GetTimebase(omx_clocksrc_component_Private, &sTimebase);
+      pRequest = &omx_clocksrc_component_Private->sRequests[omx_clocksrc_component_Private->nRequests];
+      memcpy(&pRequest->sRequest, sMediaTimeRequest, sizeof(OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE));
+      pRequest->nDeadline = nDeadline = clocksrc_RequestDeadline(&sTimebase, sMediaTimeRequest);
+      DEBUG(DEB_LEV_SIMPLE_SEQ," pI=%d RT=%lld offset=%lld Scale=%x due in %lld us\n",(int)portIndex,sMediaTimeRequest->nMediaTimestamp,
+        sMediaTimeRequest->nOffset,(int)sTimebase.xScale,(OMX_TICKS)(nDeadline - clocksrc_WallTime()) / 1000);
+      clocksrc_HeapUp(omx_clocksrc_component_Private, omx_clocksrc_component_Private->nRequests++);
+      __sync_fetch_and_add(&omx_clocksrc_component_Private->nPortRequests[portIndex], 1);
+      /* a new earliest deadline must shorten the wait of the timer thread */
+      if(omx_clocksrc_component_Private->sRequests[0].nDeadline == nDeadline) {
+        pthread_cond_signal(&omx_clocksrc_component_Private->timerCond);
+      }
+      pthread_mutex_unlock(&omx_clocksrc_component_Private->timerMutex);
     } else {
-       DEBUG(DEB_LEV_ERR,"In %s Clock State=%x Scale=%x Line=%d \n",
-          __func__,(int)omx_clocksrc_component_Private->sClockState.eState,(int)Scale,__LINE__);
+       DEBUG(DEB_LEV_ERR,"In %s Clock State=%x Line=%d \n",
+          __func__,(int)omx_clocksrc_component_Private->sClockState.eState,__LINE__);
     }
   break;
 
   default:
+    if ((OMX_U32)nIndex == OMX_IndexConfigBellagioBufferBatch) {
+      return omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+    } else if ((OMX_U32)nIndex == OMX_IndexConfigBellagioClockSnapshot) {
+      pSnapshotConfig = (OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE*) pComponentConfigStructure;
+      if (pSnapshotConfig->nPortIndex >= omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts) {
+        return OMX_ErrorBadPortIndex;
+      }
+      /* the pending updates of the port stay, the next broadcast skips it */
+      pthread_mutex_lock(&omx_clocksrc_component_Private->clockEventMutex);
+      omx_clocksrc_component_Private->bSnapshotOnly[pSnapshotConfig->nPortIndex] = pSnapshotConfig->bBufferUpdates ? OMX_FALSE : OMX_TRUE;
+      pthread_mutex_unlock(&omx_clocksrc_component_Private->clockEventMutex);
+      break;
+    }
     return OMX_ErrorBadParameter;
     break;
   }
   return OMX_ErrorNone;
 }
 
+/** Resolves the clock snapshot extension, the base component resolves
+  * the generic ones
+  */
+OMX_ERRORTYPE omx_clocksrc_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if (strcmp(cParameterName, "OMX.st.index.config.BellagioClockSnapshot") == 0) {
+    *pIndexType = OMX_IndexConfigBellagioClockSnapshot;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
+
 /**
  * This function plays the input buffer. When fully consumed it returns.
  */
@@ -630,11 +1088,12 @@ void* omx_clocksrc_BufferMgmtFunction (void* param) {
   omx_base_component_PrivateType*     omx_base_component_Private=(omx_base_component_PrivateType*)openmaxStandComp->pComponentPrivate;
   omx_clocksrc_component_PrivateType* omx_clocksrc_component_Private  = (omx_clocksrc_component_PrivateType*)omx_base_component_Private;
   omx_base_clock_PortType             *pOutPort[MAX_CLOCK_PORTS];
+  OMX_U64                             nCallbackStart;
   tsem_t*                             pOutputSem[MAX_CLOCK_PORTS];
   queue_t*                            pOutputQueue[MAX_CLOCK_PORTS];
   OMX_BUFFERHEADERTYPE*               pOutputBuffer[MAX_CLOCK_PORTS];
   OMX_BOOL                            isOutputBufferNeeded[MAX_CLOCK_PORTS],bPortsBeingFlushed = OMX_FALSE;
-  int                                 i,j,outBufExchanged[MAX_CLOCK_PORTS];
+  int                                 i,outBufExchanged[MAX_CLOCK_PORTS];
 
   for(i=0;i<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;i++) {
     pOutPort[i]             = (omx_base_clock_PortType *)omx_clocksrc_component_Private->ports[i];
@@ -727,74 +1186,52 @@ void* omx_clocksrc_BufferMgmtFunction (void* param) {
       break;
     }
 
+    /* deliver the updates of each port that holds a buffer, a port without one
+     * keeps them until a buffer arrives and does not hold up the others */
     for(i=0;i<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;i++) {
-      if(pOutPort[i]->sMediaTime.eUpdateType == OMX_TIME_UpdateClockStateChanged ||
-         pOutPort[i]->sMediaTime.eUpdateType == OMX_TIME_UpdateScaleChanged      ||
-         pOutPort[i]->sMediaTime.eUpdateType == OMX_TIME_UpdateRequestFulfillment) {
-
-        if((isOutputBufferNeeded[i]==OMX_TRUE && pOutputSem[i]->semval==0) &&
-          (omx_clocksrc_component_Private->state != OMX_StateLoaded && omx_clocksrc_component_Private->state != OMX_StateInvalid)
-          && PORT_IS_ENABLED(pOutPort[i])) {
-          //Signalled from EmptyThisBuffer or FillThisBuffer or some where else
-          DEBUG(DEB_LEV_FULL_SEQ, "Waiting for next output buffer %i\n",i);
-          tsem_down(omx_clocksrc_component_Private->bMgmtSem);
-        }
-        if(omx_clocksrc_component_Private->state == OMX_StateLoaded  ||
-           omx_clocksrc_component_Private->state == OMX_StateInvalid ||
-           omx_clocksrc_component_Private->transientState == OMX_TransStateIdleToLoaded ||
-           omx_clocksrc_component_Private->transientState == OMX_TransStateInvalid) {
-          DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Buffer Management Thread is exiting (line %d)\n",__func__,__LINE__);
-          break;
-        }
-
-        if(pOutputSem[i]->semval>0 && isOutputBufferNeeded[i]==OMX_TRUE ) {
-          tsem_down(pOutputSem[i]);
-          if(pOutputQueue[i]->nelem>0){
-            outBufExchanged[i]++;
-            isOutputBufferNeeded[i]=OMX_FALSE;
-            pOutputBuffer[i] = dequeue(pOutputQueue[i]);
-            if(pOutputBuffer[i] == NULL){
-              DEBUG(DEB_LEV_ERR, "Had NULL output buffer!!\n");
-              break;
-            }
+      while(omx_clocksrc_component_Private->nUpdates[i] > 0 && PORT_IS_ENABLED(pOutPort[i]) && !PORT_IS_BEING_FLUSHED(pOutPort[i])) {
+        if(isOutputBufferNeeded[i]==OMX_TRUE) {
+          if(pOutputSem[i]->semval==0) {
+            DEBUG(DEB_LEV_FULL_SEQ, "In %s Output buffer not available Port %d, its updates wait\n",__func__,(int)i);
+            break;
           }
-        } else {
-          DEBUG(DEB_LEV_SIMPLE_SEQ, "In %s Output buffer not available Port %d (line=%d)\n",__func__,(int)i,__LINE__);
-
-          /*Check if any dummy bMgmtSem signal and ports are flushing*/
-          pthread_mutex_lock(&omx_clocksrc_component_Private->flush_mutex);
-          bPortsBeingFlushed = OMX_FALSE;
-          for(j=0;j<omx_clocksrc_component_Private->sPortTypesParam[OMX_PortDomainOther].nPorts;j++) {
-            bPortsBeingFlushed |= PORT_IS_BEING_FLUSHED(pOutPort[j]);
+          tsem_down(pOutputSem[i]);
+          if(pOutputQueue[i]->nelem==0) {
+            break;
           }
-          pthread_mutex_unlock(&omx_clocksrc_component_Private->flush_mutex);
-          if(bPortsBeingFlushed) {
-            DEBUG(DEB_LEV_ERR, "In %s Ports are being flushed - breaking (line %d)\n",__func__,__LINE__);
+          pOutputBuffer[i] = dequeue(pOutputQueue[i]);
+          if(pOutputBuffer[i] == NULL){
+            DEBUG(DEB_LEV_ERR, "Had NULL output buffer!!\n");
             break;
           }
+          outBufExchanged[i]++;
+          isOutputBufferNeeded[i]=OMX_FALSE;
+        }
+        if(!clocksrc_TakeUpdate(omx_clocksrc_component_Private, i, &pOutPort[i]->sMediaTime)) {
+          break;
         }
+
         /*Process Output buffer of Port i */
-        if(isOutputBufferNeeded[i]==OMX_FALSE) {
-          if (omx_clocksrc_component_Private->BufferMgmtCallback) {
-            (*(omx_clocksrc_component_Private->BufferMgmtCallback))(openmaxStandComp, pOutputBuffer[i]);
-          } else {
-            /*If no buffer management call back then don't produce any output buffer*/
-            pOutputBuffer[i]->nFilledLen = 0;
-          }
+        if (omx_clocksrc_component_Private->BufferMgmtCallback) {
+          nCallbackStart = base_port_StatTime();
+          OMX_TRACE(OMX_TraceCallbackEnter, openmaxStandComp, pOutPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer[i]);
+          (*(omx_clocksrc_component_Private->BufferMgmtCallback))(openmaxStandComp, pOutputBuffer[i]);
+          OMX_TRACE(OMX_TraceCallbackExit, openmaxStandComp, pOutPort[i]->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pOutputBuffer[i]);
+          base_port_StatCallbackTime((omx_base_PortType*)pOutPort[i], base_port_StatTime() - nCallbackStart);
+        } else {
+          /*If no buffer management call back then don't produce any output buffer*/
+          pOutputBuffer[i]->nFilledLen = 0;
+        }
 
-           /*Output Buffer has been produced or EOS. So, return output buffer and get new buffer*/
-          if(pOutputBuffer[i]->nFilledLen!=0) {
-            pOutPort[i]->ReturnBufferFunction((omx_base_PortType*)pOutPort[i],pOutputBuffer[i]);
-            outBufExchanged[i]--;
-            pOutputBuffer[i]=NULL;
-            isOutputBufferNeeded[i]=OMX_TRUE;
-          }
+        /*Output Buffer has been produced or EOS. So, return output buffer and get new buffer*/
+        if(pOutputBuffer[i]->nFilledLen!=0) {
+          pOutPort[i]->ReturnBufferFunction((omx_base_PortType*)pOutPort[i],pOutputBuffer[i]);
+          outBufExchanged[i]--;
+          pOutputBuffer[i]=NULL;
+          isOutputBufferNeeded[i]=OMX_TRUE;
         }
       }
     }
-
-    DEBUG(DEB_LEV_SIMPLE_SEQ, "Sent Clock Event for all ports\n");
-    tsem_up(omx_clocksrc_component_Private->clockEventCompleteSem);
   }
   DEBUG(DEB_LEV_SIMPLE_SEQ,"Exiting Buffer Management Thread\n");
   return NULL;
@@ -812,6 +1249,9 @@ OMX_ERRORTYPE clocksrc_port_FlushProcessingBuffers(omx_base_PortType *openmaxSta
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   omx_clocksrc_component_Private = (omx_clocksrc_component_PrivateType*)openmaxStandPort->standCompContainer->pComponentPrivate;
 
+  /* a flushed port gives up the media time requests it has pending */
+  clocksrc_CancelRequests(omx_clocksrc_component_Private, openmaxStandPort->sPortParam.nPortIndex);
+
   pthread_mutex_lock(&omx_clocksrc_component_Private->flush_mutex);
   openmaxStandPort->bIsPortFlushed=OMX_TRUE;
   /*Signal the buffer management thread of port flush,if it is waiting for buffers*/
@@ -819,7 +1259,6 @@ OMX_ERRORTYPE clocksrc_port_FlushProcessingBuffers(omx_base_PortType *openmaxSta
     tsem_up(omx_clocksrc_component_Private->bMgmtSem);
   }
   tsem_up(omx_clocksrc_component_Private->clockEventSem);
-  tsem_up(omx_clocksrc_component_Private->clockEventCompleteSem);
 
   if(omx_clocksrc_component_Private->state==OMX_StatePause ) {
     /*Waiting at paused state*/
@@ -878,6 +1317,8 @@ OMX_ERRORTYPE clocksrc_port_FlushProcessingBuffers(omx_base_PortType *openmaxSta
   openmaxStandPort->bIsPortFlushed=OMX_FALSE;
   pthread_mutex_unlock(&omx_clocksrc_component_Private->flush_mutex);
 
+  /* the updates queued on the other ports are still to be delivered */
+  tsem_up(omx_clocksrc_component_Private->clockEventSem);
   tsem_up(omx_clocksrc_component_Private->flush_condition);
 
   DEBUG(DEB_LEV_FULL_SEQ, "Out %s Port Index=%d bIsPortFlushed=%d Component %s\n", __func__,
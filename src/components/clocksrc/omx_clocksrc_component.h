@@ -33,27 +33,81 @@
 #include <OMX_Audio.h>
 #include <omx_base_source.h>
 #include <string.h>
-#include <sys/time.h>
+#include <pthread.h>
 
 #define CLOCK_COMP_NAME "OMX.st.clocksrc"
 #define CLOCK_COMP_ROLE "clocksrc"
 #define MAX_CLOCK_COMPONENTS 20
 
-/** Maximum number of clock ports */
-#define MAX_CLOCK_PORTS                          8
+/** Maximum number of clock ports, the client sets how many with OMX_IndexParamOtherInit */
+#define MAX_CLOCK_PORTS                          64
 
+/** Number of clock ports the component is created with */
+#define CLOCK_DEFAULT_PORTS                      3
+
+/** Number of ports nWaitMask can wait for the start time of, the ports
+ * above are never waited for
+ */
+#define CLOCK_WAITMASK_PORTS                     (sizeof(OMX_U32) * 8)
+
+/** Maximum number of media time requests of a port, pending or fulfilled and
+ * not yet delivered to its client
+ */
+#define CLOCK_PORT_REQUESTS                      4
+
+/** Maximum number of media time requests pending on all the ports together */
+#define CLOCK_MAX_REQUESTS                       (CLOCK_PORT_REQUESTS * MAX_CLOCK_PORTS)
+
+/** Depth of the update queue of a port: the fulfilments of its requests and
+ * the latest state or scale change
+ */
+#define CLOCK_PORT_UPDATES                       (CLOCK_PORT_REQUESTS + 1)
+
+
+/** The timebase the media time is computed from. The media time is nMediaTime
+ * at the wall time nWallTime and from there it advances xScale times as fast
+ * as the wall clock.
+ * @param nWallTime the time of the monotonic clock the timebase was taken at, in nanoseconds
+ * @param nMediaTime the media time at nWallTime, in microseconds
+ * @param xScale the rate of the media time in Q16 format, 0x10000 being normal play
+ */
+typedef struct CLOCKSRC_TIMEBASE {
+  OMX_U64   nWallTime;
+  OMX_TICKS nMediaTime;
+  OMX_S32   xScale;
+} CLOCKSRC_TIMEBASE;
+
+/** A media time request waiting for its deadline in the timer heap.
+ * @param nDeadline the time of the monotonic clock the request is due at, in nanoseconds
+ * @param sRequest the request as received from the client
+ */
+typedef struct CLOCKSRC_REQUEST {
+  OMX_U64                              nDeadline;
+  OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE sRequest;
+} CLOCKSRC_REQUEST;
 
 /** Clock component private structure.
  * see the define above
  * @param sClockState This structure holds the state of the clock
  * @param startTimeSem the semaphore that coordinates the arrival of start times from all clients
- * @param clockEventSem the semaphore that coordinates clock event received from the client
- * @param clockEventCompleteSem the semaphore that coordinates clock event sent to the client
- * @param WallTimeBase the wall time at which the clock was started
- * @param MediaTimeBase the Media time at which the clock was started
+ * @param clockEventSem wakes the buffer management thread to deliver the updates queued on the ports
+ * @param sTimebase the timebase of the media time, guarded by timebaseMutex. Its scale is null while the clock is not running
+ * @param timebaseMutex guards sTimebase so that it is always read and rebased as a whole
+ * @param clockEventMutex guards the update queues of the ports
+ * @param sRequests the pending media time requests, a heap ordered by deadline guarded by timerMutex
+ * @param nRequests the number of requests in sRequests
+ * @param timerMutex guards the request heap and bTimerStop
+ * @param timerCond wakes the timer thread on a new request, a timebase change or the exit
+ * @param timerThread the thread fulfilling the requests at their deadlines
+ * @param bTimerStop asks the timer thread to exit
  * @param eUpdateType indicates the type of update received from the clock src component
  * @param sMinStartTime keeps the minimum starttime of the clients
- * @param sConfigScale Representing the current media time scale factor
+ * @param sConfigScale the media time scale factor set by the client, the timebase runs at it while the clock is running
+ * @param sSnapshot the media time published to the clients, rewritten under timebaseMutex at each rebase and state change
+ * @param bSnapshotOnly the ports whose client reads sSnapshot and gets no buffer for the state and scale changes
+ * @param sUpdates the updates queued on each port, oldest first, delivered as soon as the port holds a buffer
+ * @param nUpdates the number of updates in sUpdates for each port
+ * @param nPortRequests the requests of each port pending or fulfilled and not yet delivered, at most CLOCK_PORT_REQUESTS
  */
 DERIVEDCLASS(omx_clocksrc_component_PrivateType, omx_base_source_PrivateType)
 #define omx_clocksrc_component_PrivateType_FIELDS omx_base_source_PrivateType_FIELDS \
@@ -61,12 +115,23 @@ DERIVEDCLASS(omx_clocksrc_component_PrivateType, omx_base_source_PrivateType)
   OMX_TIME_CONFIG_ACTIVEREFCLOCKTYPE  sRefClock; \
   tsem_t*                             startTimeSem; \
   tsem_t*                             clockEventSem; \
-  tsem_t*                             clockEventCompleteSem; \
-  OMX_TICKS                           WallTimeBase; \
-  OMX_TICKS                           MediaTimeBase; \
+  CLOCKSRC_TIMEBASE                   sTimebase; \
+  pthread_mutex_t                     timebaseMutex; \
+  pthread_mutex_t                     clockEventMutex; \
+  CLOCKSRC_REQUEST                    sRequests[CLOCK_MAX_REQUESTS]; \
+  OMX_U32                             nRequests; \
+  pthread_mutex_t                     timerMutex; \
+  pthread_cond_t                      timerCond; \
+  pthread_t                           timerThread; \
+  OMX_BOOL                            bTimerStop; \
   OMX_TIME_UPDATETYPE                 eUpdateType; \
   OMX_TIME_CONFIG_TIMESTAMPTYPE       sMinStartTime; \
-  OMX_TIME_CONFIG_SCALETYPE           sConfigScale;
+  OMX_TIME_CONFIG_SCALETYPE           sConfigScale; \
+  OMX_BELLAGIOCLOCKSNAPSHOTTYPE       sSnapshot; \
+  OMX_BOOL                            bSnapshotOnly[MAX_CLOCK_PORTS]; \
+  OMX_TIME_MEDIATIMETYPE              sUpdates[MAX_CLOCK_PORTS][CLOCK_PORT_UPDATES]; \
+  OMX_U32                             nUpdates[MAX_CLOCK_PORTS]; \
+  OMX_U32                             nPortRequests[MAX_CLOCK_PORTS];
 ENDCLASS(omx_clocksrc_component_PrivateType)
 
 /* Component private entry points declaration */
@@ -97,6 +162,11 @@ OMX_ERRORTYPE omx_clocksrc_component_GetConfig(
   OMX_INDEXTYPE nIndex,
   OMX_PTR pComponentConfigStructure);
 
+OMX_ERRORTYPE omx_clocksrc_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
 void* omx_clocksrc_BufferMgmtFunction (void* param);
 
 OMX_ERRORTYPE omx_clocksrc_component_SendCommand(
@@ -25,6 +25,7 @@
 
 #include <omxcore.h>
 #include <omx_video_scheduler_component.h>
+#include <omx_trace.h>
 
 #define DEFAULT_WIDTH   352
 #define DEFAULT_HEIGHT  288
@@ -116,10 +117,26 @@ OMX_ERRORTYPE omx_video_scheduler_component_Constructor(OMX_COMPONENTTYPE *openm
 
   omx_video_scheduler_component_Private->destructor         = omx_video_scheduler_component_Destructor;
   omx_video_scheduler_component_Private->BufferMgmtCallback = omx_video_scheduler_component_BufferMgmtCallback;
+  omx_video_scheduler_component_Private->bInPlace = OMX_TRUE;
+
+  omx_video_scheduler_component_Private->nFrames = 0;
+  pthread_mutex_init(&omx_video_scheduler_component_Private->framesMutex, NULL);
+  pthread_cond_init(&omx_video_scheduler_component_Private->framesCond, NULL);
+
+  setHeader(&omx_video_scheduler_component_Private->sQoS, sizeof(OMX_CONFIG_BELLAGIOVIDEOQOSTYPE));
+  omx_video_scheduler_component_Private->sQoS.nMaxLatenessUs  = VIDEOSCHED_DEFAULT_MAX_LATENESS;
+  omx_video_scheduler_component_Private->sQoS.bDropToKeyFrame = OMX_FALSE;
+  omx_video_scheduler_component_Private->bKeyFrameWait        = OMX_FALSE;
+  pthread_mutex_init(&omx_video_scheduler_component_Private->qosMutex, NULL);
 
   inPort->FlushProcessingBuffers  = omx_video_scheduler_component_port_FlushProcessingBuffers;
+  inPort->Port_SendBufferFunction = omx_video_scheduler_component_port_SendBufferFunction;
+  omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX]->Port_SendBufferFunction = omx_video_scheduler_component_clock_port_SendBufferFunction;
   openmaxStandComp->SetParameter  = omx_video_scheduler_component_SetParameter;
   openmaxStandComp->GetParameter  = omx_video_scheduler_component_GetParameter;
+  openmaxStandComp->SetConfig     = omx_video_scheduler_component_SetConfig;
+  openmaxStandComp->GetConfig     = omx_video_scheduler_component_GetConfig;
+  openmaxStandComp->GetExtensionIndex = omx_video_scheduler_component_GetExtensionIndex;
 
   /* resource management special section */
   omx_video_scheduler_component_Private->nqualitylevels = VIDEOSCHED_QUALITY_LEVELS;
@@ -153,17 +170,86 @@ OMX_ERRORTYPE omx_video_scheduler_component_Destructor(OMX_COMPONENTTYPE *openma
     omx_video_scheduler_component_Private->ports=NULL;
   }
 
+  pthread_cond_destroy(&omx_video_scheduler_component_Private->framesCond);
+  pthread_mutex_destroy(&omx_video_scheduler_component_Private->framesMutex);
+  pthread_mutex_destroy(&omx_video_scheduler_component_Private->qosMutex);
+
   omx_base_filter_Destructor(openmaxStandComp);
   DEBUG(DEB_LEV_FUNCTION_NAME, "Out of %s\n", __func__);
 
   return OMX_ErrorNone;
 }
 
+/** Returns the index of the queued frame held in pBuffer, or -1 if the
+ * buffer has no frame waiting. Called with framesMutex held.
+ */
+static int videosched_FindFrame(omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private, OMX_BUFFERHEADERTYPE* pBuffer) {
+  OMX_U32 i;
+
+  for (i = 0; i < omx_video_scheduler_component_Private->nFrames; i++) {
+    if (omx_video_scheduler_component_Private->sFrames[i].pBuffer == pBuffer) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/** Removes the queued frame at index i keeping the arrival order of the
+ * others. Called with framesMutex held.
+ */
+static void videosched_RemoveFrame(omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private, int i) {
+  omx_video_scheduler_component_Private->nFrames--;
+  memmove(&omx_video_scheduler_component_Private->sFrames[i], &omx_video_scheduler_component_Private->sFrames[i + 1],
+          (omx_video_scheduler_component_Private->nFrames - i) * sizeof(VIDEOSCHED_FRAME));
+}
+
+/** Forgets the frame held in pBuffer, if any. Its request may still be
+ * fulfilled by the clock, the fulfilment then matches no frame and is ignored.
+ */
+static void videosched_DropFrame(omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private, OMX_BUFFERHEADERTYPE* pBuffer) {
+  int i;
+
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+  i = videosched_FindFrame(omx_video_scheduler_component_Private, pBuffer);
+  if (i >= 0) {
+    videosched_RemoveFrame(omx_video_scheduler_component_Private, i);
+  }
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+}
+
+/** Marks the frame a request fulfilment is for and wakes the buffer
+ * management thread. The frame is recognized by the buffer given to the
+ * clock as client private data and by its time stamp, so that the late
+ * fulfilment of a dropped or flushed frame is ignored.
+ */
+static void videosched_FulfilFrame(omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private, OMX_TIME_MEDIATIMETYPE* pMediaTime) {
+  VIDEOSCHED_FRAME* pFrame;
+  OMX_U32           i;
+
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+  for (i = 0; i < omx_video_scheduler_component_Private->nFrames; i++) {
+    pFrame = &omx_video_scheduler_component_Private->sFrames[i];
+    if (!pFrame->bFulfilled && pFrame->nTimeStamp == pMediaTime->nMediaTimestamp &&
+        (OMX_U32)(unsigned long)pFrame->pBuffer == pMediaTime->nClientPrivate) {
+      pFrame->bFulfilled = OMX_TRUE;
+      pFrame->nWallTime  = pMediaTime->nWallTimeAtMediaTime;
+      pthread_cond_broadcast(&omx_video_scheduler_component_Private->framesCond);
+      break;
+    }
+  }
+  if (i == omx_video_scheduler_component_Private->nFrames) {
+    DEBUG(DEB_LEV_FULL_SEQ, "In %s stale fulfilment for time stamp %lld ignored\n", __func__, pMediaTime->nMediaTimestamp);
+  }
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+}
 
 /** @brief the entry point for sending buffers to the video scheduler ports
  *
  * This function can be called by the EmptyThisBuffer or FillThisBuffer. It depends on
- * the nature of the port, that can be an input or output port.
+ * the nature of the port, that can be an input or output port. A frame received on
+ * the input port is queued with a request for its presentation time and the call
+ * returns at once, the buffer management thread releases it when the clock fulfils
+ * the request.
  */
 OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer) {
 
@@ -172,7 +258,6 @@ OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(omx_base_Por
   OMX_U32                         portIndex;
   OMX_COMPONENTTYPE*              omxComponent = openmaxStandPort->standCompContainer;
   omx_base_component_PrivateType* omx_base_component_Private = (omx_base_component_PrivateType*)omxComponent->pComponentPrivate;
-  OMX_BOOL                        SendFrame;
   omx_base_clock_PortType*        pClockPort;
 #if NO_GST_OMX_PATCH
   unsigned int i;
@@ -232,24 +317,25 @@ OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(omx_base_Por
   if(PORT_IS_TUNNELED(pClockPort) && !PORT_IS_BEING_FLUSHED(openmaxStandPort) &&
       (omx_base_component_Private->transientState != OMX_TransStateExecutingToIdle) &&
       ((pBuffer->nFlags & OMX_BUFFERFLAG_EOS) != OMX_BUFFERFLAG_EOS)){
-    SendFrame = omx_video_scheduler_component_ClockPortHandleFunction((omx_video_scheduler_component_PrivateType*)omx_base_component_Private, pBuffer);
-    if(!SendFrame) pBuffer->nFilledLen=0;
+    omx_video_scheduler_component_QueueFrame((omx_video_scheduler_component_PrivateType*)omx_base_component_Private, pBuffer);
   }
 
   /* And notify the buffer management thread we have a fresh new buffer to manage */
-  if(!PORT_IS_BEING_FLUSHED(openmaxStandPort) && !(PORT_IS_BEING_DISABLED(openmaxStandPort) && PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort))
-      && omx_base_component_Private->transientState != OMX_TransStateExecutingToIdle){
+  if(!PORT_IS_BEING_FLUSHED(openmaxStandPort) && !(PORT_IS_BEING_DISABLED(openmaxStandPort) && PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort))){
       errQue = queue(openmaxStandPort->pBufferQueue, pBuffer);
       if (errQue) {
     	  /* /TODO the queue is full. This can be handled in a fine way with
     	   * some retrials, or other checking. For the moment this is a critical error
     	   * and simply causes the failure of this call
     	   */
+    	  videosched_DropFrame((omx_video_scheduler_component_PrivateType*)omx_base_component_Private, pBuffer);
     	  return OMX_ErrorInsufficientResources;
       }
+   	  base_port_StatBufferReceived(openmaxStandPort);
+   	  OMX_TRACE(OMX_TraceBufferEnqueue, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pBuffer);
    	  tsem_up(openmaxStandPort->pBufferSem);
    	  DEBUG(DEB_LEV_FULL_SEQ, "In %s Signalling bMgmtSem Port Index=%d\n",__func__, (int)portIndex);
-   	  tsem_up(omx_base_component_Private->bMgmtSem);
+   	  omx_base_component_SignalPortBuffer(openmaxStandPort);
   }else if(PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)){
       DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s received io:%d buffer\n", __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
       errQue = queue(openmaxStandPort->pBufferQueue, pBuffer);
@@ -269,30 +355,70 @@ OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(omx_base_Por
 }
 
 
-OMX_BOOL omx_video_scheduler_component_ClockPortHandleFunction(
+/** @brief the entry point for the media time buffers sent by the clock
+ *
+ * A request fulfilment or a clock state change is recorded at once and the
+ * buffer goes straight back to the clock, so that the clock never waits for
+ * the buffer management thread. The other updates are queued to the clock port
+ * and handled by the buffer management thread with the next frame.
+ */
+OMX_ERRORTYPE omx_video_scheduler_component_clock_port_SendBufferFunction(omx_base_PortType *openmaxStandPort, OMX_BUFFERHEADERTYPE* pBuffer) {
+  omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private = openmaxStandPort->standCompContainer->pComponentPrivate;
+  OMX_TIME_MEDIATIMETYPE*                    pMediaTime;
+  OMX_ERRORTYPE                              err;
+
+  if(pBuffer != NULL && pBuffer->pBuffer != NULL && PORT_IS_TUNNELED(openmaxStandPort) && PORT_IS_ENABLED(openmaxStandPort) &&
+      !PORT_IS_BEING_FLUSHED(openmaxStandPort) && !PORT_IS_BEING_DISABLED(openmaxStandPort) &&
+      (omx_video_scheduler_component_Private->state == OMX_StateExecuting || omx_video_scheduler_component_Private->state == OMX_StatePause) &&
+      omx_video_scheduler_component_Private->transientState != OMX_TransStateExecutingToIdle &&
+      omx_video_scheduler_component_Private->transientState != OMX_TransStatePauseToIdle) {
+    pMediaTime = (OMX_TIME_MEDIATIMETYPE*)pBuffer->pBuffer;
+    if(pMediaTime->eUpdateType == OMX_TIME_UpdateRequestFulfillment) {
+      videosched_FulfilFrame(omx_video_scheduler_component_Private, pMediaTime);
+      base_port_StatBufferReceived(openmaxStandPort);
+      return openmaxStandPort->ReturnBufferFunction(openmaxStandPort, pBuffer);
+    }
+    if(pMediaTime->eUpdateType == OMX_TIME_UpdateClockStateChanged) {
+      pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+      omx_video_scheduler_component_Private->eState = pMediaTime->eState;
+      omx_video_scheduler_component_Private->xScale = pMediaTime->xScale;
+      pthread_cond_broadcast(&omx_video_scheduler_component_Private->framesCond);
+      pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+      base_port_StatBufferReceived(openmaxStandPort);
+      return openmaxStandPort->ReturnBufferFunction(openmaxStandPort, pBuffer);
+    }
+  }
+
+  err = base_clock_port_SendBufferFunction(openmaxStandPort, pBuffer);
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+  pthread_cond_broadcast(&omx_video_scheduler_component_Private->framesCond);
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+  return err;
+}
+
+/** Queues the frame held in pInputBuffer and requests its presentation time
+ * from the clock. The request does not wait for the clock, the fulfilment is
+ * received by the clock port later on.
+ * @return OMX_TRUE if the frame waits for its presentation time, OMX_FALSE if
+ * it is empty, the clock is not running or too many frames are waiting
+ */
+OMX_BOOL omx_video_scheduler_component_QueueFrame(
   omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private,
   OMX_BUFFERHEADERTYPE* pInputBuffer){
   omx_base_clock_PortType               *pClockPort;
   OMX_HANDLETYPE                        hclkComponent;
-  OMX_BUFFERHEADERTYPE*                 clockBuffer;
-  OMX_TIME_MEDIATIMETYPE*               pMediaTime;
   OMX_TIME_CONFIG_TIMESTAMPTYPE         sClientTimeStamp;
+  OMX_TIME_CONFIG_CLOCKSTATETYPE        sClockState;
+  OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE  sMediaTimeRequest;
+  VIDEOSCHED_FRAME                      *pFrame;
   OMX_ERRORTYPE                         err;
-  OMX_BOOL                              SendFrame;
-  omx_base_video_PortType               *pInputPort;
 
   pClockPort    = (omx_base_clock_PortType*) omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX];
-  pInputPort    = (omx_base_video_PortType *) omx_video_scheduler_component_Private->ports[0];
   hclkComponent = pClockPort->hTunneledComponent;
 
-  SendFrame = OMX_TRUE;
-
-  DEBUG(DEB_LEV_FULL_SEQ, "In %s Clock Port is Tunneled. Sending Request\n", __func__);
   /* if first time stamp is received then notify the clock component */
   if((pInputBuffer->nFlags & OMX_BUFFERFLAG_STARTTIME) == OMX_BUFFERFLAG_STARTTIME) {
     DEBUG(DEB_LEV_FULL_SEQ," In %s  first time stamp = %llx \n", __func__,pInputBuffer->nTimeStamp);
-    pInputBuffer->nFlags = 0;
-    hclkComponent = pClockPort->hTunneledComponent;
     setHeader(&sClientTimeStamp, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE));
     sClientTimeStamp.nPortIndex = pClockPort->nTunneledPort;
     sClientTimeStamp.nTimestamp = pInputBuffer->nTimeStamp;
@@ -300,113 +426,210 @@ OMX_BOOL omx_video_scheduler_component_ClockPortHandleFunction(
     if(err!=OMX_ErrorNone) {
      DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig in func=%s \n",err,__func__);
     }
-    tsem_down(pClockPort->pBufferSem); /* wait for state change notification */
+  }
 
-    /* update the clock state and clock scale info into the fbdev private data */
-    if(pClockPort->pBufferQueue->nelem > 0) {
-      clockBuffer=dequeue(pClockPort->pBufferQueue);
-      pMediaTime  = (OMX_TIME_MEDIATIMETYPE*)clockBuffer->pBuffer;
-      omx_video_scheduler_component_Private->eState      = pMediaTime->eState;
-      omx_video_scheduler_component_Private->xScale      = pMediaTime->xScale;
-      pClockPort->ReturnBufferFunction((omx_base_PortType*)pClockPort,clockBuffer);
-    }
+  if(pInputBuffer->nFilledLen == 0) {
+    return OMX_FALSE;
   }
 
-  /* do not send the data to sink and return back, if the clock is not running*/
-  if(!omx_video_scheduler_component_Private->eState==OMX_TIME_ClockStateRunning){
-    pInputBuffer->nFilledLen=0;
-    SendFrame = OMX_FALSE;
+  /* frames are not scheduled while the clock is not running */
+  setHeader(&sClockState, sizeof(OMX_TIME_CONFIG_CLOCKSTATETYPE));
+  err = OMX_GetConfig(hclkComponent, OMX_IndexConfigTimeClockState, &sClockState);
+  if(err != OMX_ErrorNone || sClockState.eState != OMX_TIME_ClockStateRunning) {
+    return OMX_FALSE;
+  }
+
+  /* the frame is queued before the request, the clock may fulfil it at once */
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+  if(omx_video_scheduler_component_Private->nFrames == VIDEOSCHED_MAX_FRAMES) {
+    pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+    DEBUG(DEB_LEV_ERR, "In %s too many frames waiting for their presentation time\n", __func__);
+    return OMX_FALSE;
+  }
+  pFrame = &omx_video_scheduler_component_Private->sFrames[omx_video_scheduler_component_Private->nFrames++];
+  pFrame->pBuffer    = pInputBuffer;
+  pFrame->nTimeStamp = pInputBuffer->nTimeStamp;
+  pFrame->bFulfilled = OMX_FALSE;
+  pFrame->nWallTime  = 0;
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+
+  setHeader(&sMediaTimeRequest, sizeof(OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE));
+  sMediaTimeRequest.nMediaTimestamp = pInputBuffer->nTimeStamp;
+  sMediaTimeRequest.nOffset         = 100; /*set the requested offset */
+  sMediaTimeRequest.nPortIndex      = pClockPort->nTunneledPort;
+  sMediaTimeRequest.pClientPrivate  = pInputBuffer; /* identifies the frame in the fulfilment */
+  err = OMX_SetConfig(hclkComponent, OMX_IndexConfigTimeMediaTimeRequest, &sMediaTimeRequest);
+  if(err!=OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig in func=%s \n",err,__func__);
+    videosched_DropFrame(omx_video_scheduler_component_Private, pInputBuffer);
+    return OMX_FALSE;
+  }
+  return OMX_TRUE;
+}
+
+/** Handles a media time update queued to the clock port */
+static void videosched_HandleClockBuffer(
+  omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private,
+  OMX_BUFFERHEADERTYPE* clockBuffer) {
+  OMX_TIME_MEDIATIMETYPE*               pMediaTime;
+
+  pMediaTime = (OMX_TIME_MEDIATIMETYPE*)clockBuffer->pBuffer;
+  switch(pMediaTime->eUpdateType) {
+  case OMX_TIME_UpdateScaleChanged:
+    /* the clock keeps the media time continuous across the change and
+       reschedules the pending requests, the frames made late are dropped
+       by the lateness policy */
+    pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+    omx_video_scheduler_component_Private->xScale = pMediaTime->xScale;
+    pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+    break;
+  case OMX_TIME_UpdateClockStateChanged:
+    pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+    omx_video_scheduler_component_Private->eState = pMediaTime->eState;
+    omx_video_scheduler_component_Private->xScale = pMediaTime->xScale;
+    pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+    break;
+  case OMX_TIME_UpdateRequestFulfillment:
+    videosched_FulfilFrame(omx_video_scheduler_component_Private, pMediaTime);
+    break;
+  default:
+    break;
+  }
+}
+
+/** Applies the drop policy to a frame which reached its time nLateness
+ * microseconds late, negative when early, and updates the QoS counters.
+ * Sends the QoS event when a late frame is dropped and the event interval
+ * has passed.
+ * @return OMX_TRUE if the frame is to be sent, OMX_FALSE if it is to be dropped
+ */
+static OMX_BOOL videosched_ApplyLateness(omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private, OMX_TICKS nLateness) {
+  OMX_CONFIG_BELLAGIOVIDEOQOSTYPE sQoS;
+  OMX_BOOL                        SendFrame;
+  OMX_U64                         nNow;
+
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->qosMutex);
+  if(nLateness > 0) {
+    omx_video_scheduler_component_Private->sQoS.nLate++;
+  }
+  omx_video_scheduler_component_Private->sQoS.nAverageLateness +=
+    (nLateness - omx_video_scheduler_component_Private->sQoS.nAverageLateness) / 8;
+  SendFrame = (nLateness > (OMX_TICKS)omx_video_scheduler_component_Private->sQoS.nMaxLatenessUs) ? OMX_FALSE : OMX_TRUE;
+  if(SendFrame) {
+    omx_video_scheduler_component_Private->sQoS.nRendered++;
+  } else {
+    omx_video_scheduler_component_Private->sQoS.nDropped++;
+    omx_video_scheduler_component_Private->bKeyFrameWait = omx_video_scheduler_component_Private->sQoS.bDropToKeyFrame;
+  }
+  memcpy(&sQoS, &omx_video_scheduler_component_Private->sQoS, sizeof(OMX_CONFIG_BELLAGIOVIDEOQOSTYPE));
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->qosMutex);
+
+  if(SendFrame || sQoS.nEventIntervalMs == 0) {
+    return SendFrame;
+  }
+  nNow = base_port_StatTime();
+  if(omx_video_scheduler_component_Private->nLastQoSEvent != 0 &&
+     nNow - omx_video_scheduler_component_Private->nLastQoSEvent < (OMX_U64)sQoS.nEventIntervalMs * 1000000) {
     return SendFrame;
   }
+  omx_video_scheduler_component_Private->nLastQoSEvent = nNow;
+  DEBUG(DEB_LEV_FULL_SEQ, "In %s frame dropped %lld us late\n", __func__, nLateness);
+  (*(omx_video_scheduler_component_Private->callbacks->EventHandler))
+    (omx_video_scheduler_component_Private->openmaxStandComp,
+    omx_video_scheduler_component_Private->callbackData,
+    OMX_EventBellagioVideoQoS,
+    OMX_BASE_FILTER_INPUTPORT_INDEX,
+    sQoS.nDropped,
+    &sQoS);
+  return SendFrame;
+}
 
-  /* check for any scale change information from the clock component */
-  if(pClockPort->pBufferSem->semval>0) {
-    tsem_down(pClockPort->pBufferSem);
+/** Waits, in the buffer management thread, until the presentation time of the
+ * frame held in pInputBuffer. Frames which arrived while the clock was not
+ * running are queued here, the others were queued by the send buffer function.
+ * A frame reaching its time later than the QoS threshold is dropped, and so are
+ * the frames up to the next key frame when the policy asks for it.
+ * @return OMX_TRUE if the frame is to be sent, OMX_FALSE if it is to be dropped
+ */
+OMX_BOOL omx_video_scheduler_component_ClockPortHandleFunction(
+  omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private,
+  OMX_BUFFERHEADERTYPE* pInputBuffer){
+  omx_base_clock_PortType               *pClockPort;
+  OMX_BUFFERHEADERTYPE*                 clockBuffer;
+  OMX_TIME_CONFIG_TIMESTAMPTYPE         sWallTime;
+  OMX_BOOL                              bFulfilled;
+  OMX_TICKS                             nWallTime;
+  omx_base_video_PortType               *pInputPort;
+  int                                   i;
+
+  pClockPort    = (omx_base_clock_PortType*) omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX];
+  pInputPort    = (omx_base_video_PortType *) omx_video_scheduler_component_Private->ports[0];
+
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+  i = videosched_FindFrame(omx_video_scheduler_component_Private, pInputBuffer);
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+
+  /* do not send the data to sink and return back, if the clock is not running*/
+  if(i < 0 && !omx_video_scheduler_component_QueueFrame(omx_video_scheduler_component_Private, pInputBuffer)) {
+    return OMX_FALSE;
+  }
+
+  /* after a late frame the frames up to the next key frame are dropped without waiting */
+  if(omx_video_scheduler_component_Private->bKeyFrameWait) {
+    if((pInputBuffer->nFlags & OMX_BUFFERFLAG_SYNCFRAME) != OMX_BUFFERFLAG_SYNCFRAME) {
+      videosched_DropFrame(omx_video_scheduler_component_Private, pInputBuffer);
+      pthread_mutex_lock(&omx_video_scheduler_component_Private->qosMutex);
+      omx_video_scheduler_component_Private->sQoS.nDropped++;
+      pthread_mutex_unlock(&omx_video_scheduler_component_Private->qosMutex);
+      return OMX_FALSE;
+    }
+    omx_video_scheduler_component_Private->bKeyFrameWait = OMX_FALSE;
+  }
+
+  /* wait for the request fulfilment, handling the clock updates meanwhile */
+  bFulfilled = OMX_FALSE;
+  nWallTime  = 0;
+  pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+  while((i = videosched_FindFrame(omx_video_scheduler_component_Private, pInputBuffer)) >= 0) {
+    if(omx_video_scheduler_component_Private->sFrames[i].bFulfilled) {
+      bFulfilled = OMX_TRUE;
+      nWallTime  = omx_video_scheduler_component_Private->sFrames[i].nWallTime;
+      break;
+    }
+    if(PORT_IS_BEING_FLUSHED(pInputPort) || PORT_IS_BEING_FLUSHED(pClockPort) ||
+       omx_video_scheduler_component_Private->transientState == OMX_TransStateExecutingToIdle ||
+       omx_video_scheduler_component_Private->eState != OMX_TIME_ClockStateRunning) {
+      break;
+    }
     if(pClockPort->pBufferQueue->nelem > 0) {
-      clockBuffer = dequeue(pClockPort->pBufferQueue);
-      pMediaTime  = (OMX_TIME_MEDIATIMETYPE*)clockBuffer->pBuffer;
-      if(pMediaTime->eUpdateType==OMX_TIME_UpdateScaleChanged) {
-        /* On scale change update the media time base */
-        sClientTimeStamp.nPortIndex = pClockPort->nTunneledPort;
-        sClientTimeStamp.nTimestamp = pInputBuffer->nTimeStamp;
-        err = OMX_SetConfig(hclkComponent, OMX_IndexConfigTimeCurrentVideoReference, &sClientTimeStamp);
-        if(err!=OMX_ErrorNone) {
-          DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig in func=%s \n",err,__func__);
-        }
-        omx_video_scheduler_component_Private->frameDropFlag = OMX_TRUE;
-        omx_video_scheduler_component_Private->dropFrameCount = 0;
-        omx_video_scheduler_component_Private->xScale = pMediaTime->xScale;
+      pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+      tsem_down(pClockPort->pBufferSem);
+      if(pClockPort->pBufferQueue->nelem > 0) {
+        clockBuffer = dequeue(pClockPort->pBufferQueue);
+        videosched_HandleClockBuffer(omx_video_scheduler_component_Private, clockBuffer);
+        pClockPort->ReturnBufferFunction((omx_base_PortType *)pClockPort,clockBuffer);
       }
-      pClockPort->ReturnBufferFunction((omx_base_PortType*)pClockPort,clockBuffer);
+      pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+      continue;
     }
+    pthread_cond_wait(&omx_video_scheduler_component_Private->framesCond, &omx_video_scheduler_component_Private->framesMutex);
+  }
+  if(i >= 0) {
+    videosched_RemoveFrame(omx_video_scheduler_component_Private, i);
   }
+  pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
 
-  /* drop next seven frames on scale change
-     and rebase the clock time base */
-  if(omx_video_scheduler_component_Private->frameDropFlag && omx_video_scheduler_component_Private->dropFrameCount<7) { //TODO - second check cond can be removed verify
-     omx_video_scheduler_component_Private->dropFrameCount ++;
-     if(omx_video_scheduler_component_Private->dropFrameCount==7) {
-        /* rebase the clock time base */
-        setHeader(&sClientTimeStamp, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE));
-        sClientTimeStamp.nPortIndex = pClockPort->nTunneledPort;
-        sClientTimeStamp.nTimestamp = pInputBuffer->nTimeStamp;
-        err = OMX_SetConfig(hclkComponent, OMX_IndexConfigTimeCurrentVideoReference, &sClientTimeStamp);
-        if(err!=OMX_ErrorNone) {
-          DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig in func=%s \n",err,__func__);
-        }
+  if(!bFulfilled) {
+    return OMX_FALSE;
+  }
 
-        omx_video_scheduler_component_Private->frameDropFlag  = OMX_FALSE;
-        omx_video_scheduler_component_Private->dropFrameCount = 0;
-        SendFrame = OMX_TRUE;
-     }
-     SendFrame = OMX_FALSE;
-  }
-
-  /* frame is not to be dropped so send the request for the timestamp for the data delivery */
-  if(SendFrame){
-    if(!PORT_IS_BEING_FLUSHED(pInputPort) && !PORT_IS_BEING_FLUSHED(pClockPort) &&
-        omx_video_scheduler_component_Private->transientState != OMX_TransStateExecutingToIdle) {
-      setHeader(&pClockPort->sMediaTimeRequest, sizeof(OMX_TIME_CONFIG_MEDIATIMEREQUESTTYPE));
-      pClockPort->sMediaTimeRequest.nMediaTimestamp = pInputBuffer->nTimeStamp;
-      pClockPort->sMediaTimeRequest.nOffset         = 100; /*set the requested offset */
-      pClockPort->sMediaTimeRequest.nPortIndex      = pClockPort->nTunneledPort;
-      pClockPort->sMediaTimeRequest.pClientPrivate  = NULL; /* fill the appropriate value */
-      err = OMX_SetConfig(hclkComponent, OMX_IndexConfigTimeMediaTimeRequest, &pClockPort->sMediaTimeRequest);
-      if(err!=OMX_ErrorNone) {
-        DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig in func=%s \n",err,__func__);
-      }
-      if(!PORT_IS_BEING_FLUSHED(pInputPort) && !PORT_IS_BEING_FLUSHED(pClockPort) &&
-          omx_video_scheduler_component_Private->transientState != OMX_TransStateExecutingToIdle) {
-        tsem_down(pClockPort->pBufferSem); /* wait for the request fullfillment */
-        if(pClockPort->pBufferQueue->nelem > 0) {
-          clockBuffer = dequeue(pClockPort->pBufferQueue);
-          pMediaTime  = (OMX_TIME_MEDIATIMETYPE*)clockBuffer->pBuffer;
-          if(pMediaTime->eUpdateType==OMX_TIME_UpdateScaleChanged) {
-           /* update the media time base */
-            setHeader(&sClientTimeStamp, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE)); // do not need to setHeader again do once at the top
-            sClientTimeStamp.nPortIndex = pClockPort->nTunneledPort;
-            sClientTimeStamp.nTimestamp = pInputBuffer->nTimeStamp;
-            err = OMX_SetConfig(hclkComponent, OMX_IndexConfigTimeCurrentVideoReference, &sClientTimeStamp);
-            if(err!=OMX_ErrorNone) {
-              DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig in func=%s \n",err,__func__);
-            }
-            omx_video_scheduler_component_Private->frameDropFlag  = OMX_TRUE;
-            omx_video_scheduler_component_Private->dropFrameCount = 0;
-            omx_video_scheduler_component_Private->xScale = pMediaTime->xScale;
-          }
-          if(pMediaTime->eUpdateType==OMX_TIME_UpdateRequestFulfillment){
-            if((pMediaTime->nOffset)>0) {
-              SendFrame=OMX_TRUE;
-            }else {
-              SendFrame = OMX_FALSE;
-            }
-          }
-          pClockPort->ReturnBufferFunction((omx_base_PortType *)pClockPort,clockBuffer);
-        }
-      }
-    }
+  /* the lateness is measured on the wall clock of the clock component */
+  setHeader(&sWallTime, sizeof(OMX_TIME_CONFIG_TIMESTAMPTYPE));
+  sWallTime.nPortIndex = pClockPort->nTunneledPort;
+  if(OMX_GetConfig(pClockPort->hTunneledComponent, OMX_IndexConfigTimeCurrentWallTime, &sWallTime) != OMX_ErrorNone) {
+    sWallTime.nTimestamp = nWallTime;
   }
-  return(SendFrame);
+  return videosched_ApplyLateness(omx_video_scheduler_component_Private, sWallTime.nTimestamp - nWallTime);
 }
 
 
@@ -426,6 +649,7 @@ OMX_ERRORTYPE  omx_video_scheduler_component_port_FlushProcessingBuffers(omx_bas
   omx_video_scheduler_component_Private  = ( omx_video_scheduler_component_PrivateType*) omx_base_component_Private;
 
   pClockPort    = (omx_base_clock_PortType*) omx_video_scheduler_component_Private->ports[CLOCKPORT_INDEX];
+  OMX_TRACE(OMX_TraceFlushBegin, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, 0);
 
   if(openmaxStandPort->sPortParam.eDomain!=OMX_PortDomainOther) { /* clock buffers not used in the clients buffer managment function */
     pthread_mutex_lock(&omx_base_component_Private->flush_mutex);
@@ -448,7 +672,17 @@ OMX_ERRORTYPE  omx_video_scheduler_component_port_FlushProcessingBuffers(omx_bas
       tsem_up(pClockPort->pBufferSem);
       tsem_reset(pClockPort->pBufferSem);
     }
+    /* wake the buffer management thread if it waits for a presentation time */
+    pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+    pthread_cond_broadcast(&omx_video_scheduler_component_Private->framesCond);
+    pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
     tsem_down(omx_base_component_Private->flush_all_condition);
+
+    /* the flushed frames no longer wait for their presentation time */
+    pthread_mutex_lock(&omx_video_scheduler_component_Private->framesMutex);
+    omx_video_scheduler_component_Private->nFrames = 0;
+    pthread_mutex_unlock(&omx_video_scheduler_component_Private->framesMutex);
+    omx_video_scheduler_component_Private->bKeyFrameWait = OMX_FALSE;
   }
 
   tsem_reset(omx_base_component_Private->bMgmtSem);
@@ -461,6 +695,10 @@ OMX_ERRORTYPE  omx_video_scheduler_component_port_FlushProcessingBuffers(omx_bas
 
     tsem_down(openmaxStandPort->pBufferSem);
     pBuffer = dequeue(openmaxStandPort->pBufferQueue);
+    if (!PORT_IS_TUNNELED_N_BUFFER_SUPPLIER(openmaxStandPort)) {
+      base_port_StatBufferReturned(openmaxStandPort);
+      OMX_TRACE(OMX_TraceBufferReturn, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, (OMX_U64)(unsigned long)pBuffer);
+    }
     if (PORT_IS_TUNNELED(openmaxStandPort) && !PORT_IS_BUFFER_SUPPLIER(openmaxStandPort)) {
       DEBUG(DEB_LEV_FULL_SEQ, "In %s: Comp %s is returning io:%d buffer\n",
         __func__,omx_base_component_Private->name,(int)openmaxStandPort->sPortParam.nPortIndex);
@@ -498,6 +736,7 @@ OMX_ERRORTYPE  omx_video_scheduler_component_port_FlushProcessingBuffers(omx_bas
   openmaxStandPort->bIsPortFlushed=OMX_FALSE;
   pthread_mutex_unlock(&omx_base_component_Private->flush_mutex);
 
+  OMX_TRACE(OMX_TraceFlushEnd, openmaxStandPort->standCompContainer, openmaxStandPort->sPortParam.nPortIndex, 0);
   tsem_up(omx_base_component_Private->flush_condition);
 
   DEBUG(DEB_LEV_FULL_SEQ, "Out %s Port Index=%d bIsPortFlushed=%d Component %s\n", __func__,
@@ -738,3 +977,92 @@ OMX_ERRORTYPE omx_video_scheduler_component_GetParameter(
   return err;
 }
 
+/** Sets the drop policy and the event interval of the QoS, the counters
+  * are kept
+  */
+OMX_ERRORTYPE omx_video_scheduler_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOVIDEOQOSTYPE*           pQoS;
+  OMX_COMPONENTTYPE                          *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE                              err = OMX_ErrorNone;
+
+  if (pComponentConfigStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioVideoQoS :
+      pQoS = (OMX_CONFIG_BELLAGIOVIDEOQOSTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOVIDEOQOSTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pQoS->nPortIndex >= CLOCKPORT_INDEX) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      pthread_mutex_lock(&omx_video_scheduler_component_Private->qosMutex);
+      omx_video_scheduler_component_Private->sQoS.nMaxLatenessUs   = pQoS->nMaxLatenessUs;
+      omx_video_scheduler_component_Private->sQoS.bDropToKeyFrame  = pQoS->bDropToKeyFrame;
+      omx_video_scheduler_component_Private->sQoS.nEventIntervalMs = pQoS->nEventIntervalMs;
+      pthread_mutex_unlock(&omx_video_scheduler_component_Private->qosMutex);
+      break;
+    default: // delegate to superclass
+      err = omx_base_component_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+OMX_ERRORTYPE omx_video_scheduler_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure) {
+
+  OMX_CONFIG_BELLAGIOVIDEOQOSTYPE*           pQoS;
+  OMX_COMPONENTTYPE                          *openmaxStandComp = (OMX_COMPONENTTYPE *)hComponent;
+  omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private = openmaxStandComp->pComponentPrivate;
+  OMX_ERRORTYPE                              err = OMX_ErrorNone;
+  OMX_U32                                    portIndex;
+
+  if (pComponentConfigStructure == NULL) {
+    return OMX_ErrorBadParameter;
+  }
+  switch ((OMX_U32)nIndex) {
+    case OMX_IndexConfigBellagioVideoQoS :
+      pQoS = (OMX_CONFIG_BELLAGIOVIDEOQOSTYPE*) pComponentConfigStructure;
+      if ((err = checkHeader(pComponentConfigStructure, sizeof(OMX_CONFIG_BELLAGIOVIDEOQOSTYPE))) != OMX_ErrorNone) {
+        break;
+      }
+      if (pQoS->nPortIndex >= CLOCKPORT_INDEX) {
+        err = OMX_ErrorBadPortIndex;
+        break;
+      }
+      portIndex = pQoS->nPortIndex;
+      pthread_mutex_lock(&omx_video_scheduler_component_Private->qosMutex);
+      memcpy(pQoS, &omx_video_scheduler_component_Private->sQoS, sizeof(OMX_CONFIG_BELLAGIOVIDEOQOSTYPE));
+      pthread_mutex_unlock(&omx_video_scheduler_component_Private->qosMutex);
+      pQoS->nPortIndex = portIndex;
+      break;
+    default :
+      err = omx_base_component_GetConfig(hComponent, nIndex, pComponentConfigStructure);
+  }
+  return err;
+}
+
+/** Returns the index of the QoS config, the generic names being
+  * resolved by the base component
+  */
+OMX_ERRORTYPE omx_video_scheduler_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType) {
+
+  DEBUG(DEB_LEV_FUNCTION_NAME, "In %s for component %p\n", __func__, hComponent);
+  if (strcmp(cParameterName, "OMX.st.index.config.BellagioVideoQoS") == 0) {
+    *pIndexType = OMX_IndexConfigBellagioVideoQoS;
+    return OMX_ErrorNone;
+  }
+  return omx_base_component_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+}
@@ -1,7 +1,9 @@
 /**
   src/components/videoscheduler/omx_video_scheduler_component.h
 
-  This component implements a video scheduler
+  This component implements a video scheduler. The frames it allocated the
+  buffers of pass through in place, the input and output headers exchanging
+  their payloads, so a client reads pBuffer from each header it gets back.
 
   Copyright (C) 2008-2009 STMicroelectronics
   Copyright (C) 2008-2009 Nokia Corporation and/or its subsidiary(-ies).
@@ -32,6 +34,7 @@
 #include <omx_base_filter.h>
 #include <omx_base_video_port.h>
 #include <omx_base_clock_port.h>
+#include <pthread.h>
 
 #define VIDEO_SCHEDULER_COMP_NAME "OMX.st.video.scheduler"
 #define VIDEO_SCHEDULER_COMP_ROLE "video.scheduler"
@@ -40,18 +43,49 @@
 #define VIDEOSCHED_QUALITY_LEVELS 2
 static int videoSchedQualityLevels []={1, 456192, 1, 304128};
 
+/** Maximum number of frames waiting for their presentation time */
+#define VIDEOSCHED_MAX_FRAMES 32
+
+/** The default lateness past which a frame is dropped, in microseconds */
+#define VIDEOSCHED_DEFAULT_MAX_LATENESS 20000
+
+/** A frame queued at the input port whose presentation time was requested from the clock.
+  * @param pBuffer the input buffer holding the frame
+  * @param nTimeStamp the media time the presentation was requested for
+  * @param bFulfilled set when the clock fulfilled the request
+  * @param nWallTime the wall time of the clock nTimeStamp is due at, given by the fulfilment
+  */
+typedef struct VIDEOSCHED_FRAME {
+  OMX_BUFFERHEADERTYPE*  pBuffer;
+  OMX_TICKS              nTimeStamp;
+  OMX_BOOL               bFulfilled;
+  OMX_TICKS              nWallTime;
+} VIDEOSCHED_FRAME;
+
 /** video scheduler component private structure.
   * @param xScale the scale of the media clock
   * @param eState the state of the media clock
-  * @param frameDropFlag the flag active on scale change indicates that frames are to be dropped
-  * @param dropFrameCount counts the number of frames dropped
+  * @param sQoS the drop policy and the counters of the frames, guarded by qosMutex
+  * @param qosMutex guards sQoS between the buffer management thread and the client
+  * @param bKeyFrameWait set after a late frame is dropped, until the next key frame
+  * @param nLastQoSEvent the time of the last QoS event on the monotonic clock, in nanoseconds
+  * @param sFrames the frames waiting for their presentation time, in arrival order, guarded by framesMutex
+  * @param nFrames the number of frames in sFrames
+  * @param framesMutex guards sFrames between the client, the clock and the buffer management thread
+  * @param framesCond wakes the buffer management thread on a fulfilment, a clock event or a flush
   */
 DERIVEDCLASS(omx_video_scheduler_component_PrivateType, omx_base_filter_PrivateType)
 #define omx_video_scheduler_component_PrivateType_FIELDS omx_base_filter_PrivateType_FIELDS \
   OMX_S32                      xScale; \
   OMX_TIME_CLOCKSTATE          eState; \
-  OMX_BOOL                     frameDropFlag;\
-  int                          dropFrameCount;
+  OMX_CONFIG_BELLAGIOVIDEOQOSTYPE sQoS; \
+  pthread_mutex_t              qosMutex; \
+  OMX_BOOL                     bKeyFrameWait; \
+  OMX_U64                      nLastQoSEvent; \
+  VIDEOSCHED_FRAME             sFrames[VIDEOSCHED_MAX_FRAMES]; \
+  OMX_U32                      nFrames; \
+  pthread_mutex_t              framesMutex; \
+  pthread_cond_t               framesCond;
 ENDCLASS(omx_video_scheduler_component_PrivateType)
 
 /* Component private entry points declaration */
@@ -76,14 +110,38 @@ OMX_ERRORTYPE omx_video_scheduler_component_SetParameter(
   OMX_INDEXTYPE nParamIndex,
   OMX_PTR ComponentParameterStructure);
 
+OMX_ERRORTYPE omx_video_scheduler_component_GetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_video_scheduler_component_SetConfig(
+  OMX_HANDLETYPE hComponent,
+  OMX_INDEXTYPE nIndex,
+  OMX_PTR pComponentConfigStructure);
+
+OMX_ERRORTYPE omx_video_scheduler_component_GetExtensionIndex(
+  OMX_HANDLETYPE hComponent,
+  OMX_STRING cParameterName,
+  OMX_INDEXTYPE* pIndexType);
+
 /* to handle the communication at the clock port */
 OMX_BOOL omx_video_scheduler_component_ClockPortHandleFunction(
   omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private,
   OMX_BUFFERHEADERTYPE* inputbuffer);
 
+/* to queue a frame and request its presentation time without waiting for it */
+OMX_BOOL omx_video_scheduler_component_QueueFrame(
+  omx_video_scheduler_component_PrivateType* omx_video_scheduler_component_Private,
+  OMX_BUFFERHEADERTYPE* inputbuffer);
+
 OMX_ERRORTYPE omx_video_scheduler_component_port_SendBufferFunction(
   omx_base_PortType *openmaxStandPort,
   OMX_BUFFERHEADERTYPE* pBuffer);
 
+OMX_ERRORTYPE omx_video_scheduler_component_clock_port_SendBufferFunction(
+  omx_base_PortType *openmaxStandPort,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
 OMX_ERRORTYPE omx_video_scheduler_component_port_FlushProcessingBuffers(omx_base_PortType *openmaxStandPort);
 #endif
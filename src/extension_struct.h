@@ -28,6 +28,9 @@
 #ifndef EXTENSION_STRUCT_H_
 #define EXTENSION_STRUCT_H_
 
+#include <OMX_Audio.h>
+#include <OMX_Other.h>
+
 /** This structure is threaded like a parameter with the
  * extension index OMX_IndexParameterThreadsID
  */
@@ -38,6 +41,206 @@ typedef struct OMX_PARAM_BELLAGIOTHREADS_ID {
 	long int nThreadMessageID; /**< @param nThreadMessageID the linux thread ID of the message handler thread*/\
 } OMX_PARAM_BELLAGIOTHREADS_ID;
 
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioPortStats, obtained from
+ * the extension name "OMX.st.index.config.BellagioPortStats".
+ * The counters are never reset, the client computes rates from
+ * the difference between two reads
+ */
+typedef struct OMX_CONFIG_BELLAGIOPORTSTATSTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Port that this structure applies to */
+    OMX_U32 nBuffersReceived;      /**< Buffers received by the port */
+    OMX_U32 nBuffersReturned;      /**< Buffers returned by the port */
+    OMX_U32 nQueueDepth;           /**< Buffers currently waiting in the port queue */
+    OMX_U32 nMaxQueueDepth;        /**< Highest number of buffers waiting in the port queue */
+    OMX_U64 nCallbackTime;         /**< Total time spent in the buffer processing callback on the buffers of the port, in nanoseconds */
+    OMX_U64 nCallbackTimeMax;      /**< Longest buffer processing callback on a buffer of the port, in nanoseconds */
+} OMX_CONFIG_BELLAGIOPORTSTATSTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioBufferBatch, obtained from
+ * the extension name "OMX.st.index.config.BellagioBufferBatch".
+ * Setting it sends all the buffers to the port in one call, as
+ * EmptyThisBuffer on an input port or FillThisBuffer on an output port.
+ * The buffers are queued in array order
+ */
+typedef struct OMX_CONFIG_BELLAGIOBUFFERBATCHTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Port that receives the buffers */
+    OMX_U32 nBufferCount;          /**< Number of buffers in ppBuffers */
+    OMX_BUFFERHEADERTYPE** ppBuffers; /**< The buffers, each one with the port index set as for a single call */
+    OMX_U32 nBuffersSent;          /**< Returns the number of buffers accepted. On error the other buffers still belong to the client */
+} OMX_CONFIG_BELLAGIOBUFFERBATCHTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioMixerPeriod, obtained from
+ * the extension name "OMX.st.index.config.BellagioMixerPeriod".
+ * It sets how the audio mixer schedules its output: an output buffer
+ * is produced every period, as soon as all the enabled inputs hold a
+ * period of samples or when the late inputs have been waited for long
+ * enough. A late input contributes what it holds, and silence for the rest
+ */
+typedef struct OMX_CONFIG_BELLAGIOMIXERPERIODTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< The output port of the mixer */
+    OMX_U32 nPeriodSamples;        /**< Samples of all the channels in an output buffer. 0 follows the longest buffer at the head of the inputs. Never more than an output buffer holds */
+    OMX_U32 nMaxLatenessMs;        /**< Time an output period waits for the late inputs, in milliseconds. 0 waits for the duration of a period */
+    OMX_U32 nJitterBuffers;        /**< Buffers an input port gathers before it contributes to the mix, again after an underrun. At most the nBufferCountActual of the enabled inputs */
+    OMX_U32 nMixThreads;           /**< Threads sharing the mix of each period in slices, the buffer management thread included. 0 or 1 mixes in the buffer management thread alone */
+} OMX_CONFIG_BELLAGIOMIXERPERIODTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioChannelMatrix, obtained from
+ * the extension name "OMX.st.index.config.BellagioChannelMatrix".
+ * It sets the weights of the input channels in each output channel of
+ * the audio converter, in place of the downmix or upmix it derives from
+ * the channel mappings of its ports
+ */
+typedef struct OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< The output port of the converter */
+    OMX_U32 nInChannels;           /**< Channels of the input port. 0 restores the matrix derived from the channel mappings */
+    OMX_U32 nOutChannels;          /**< Channels of the output port */
+    OMX_S32 xCoeffs[OMX_AUDIO_MAXCHANNELS * OMX_AUDIO_MAXCHANNELS]; /**< The weights in Q16, nInChannels for each output channel */
+} OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioAudioLevels, obtained from
+ * the extension name "OMX.st.index.config.BellagioAudioLevels".
+ * The audio meter measures its stream over windows of nWindowMs, and
+ * returns the levels of the last complete window. Setting it changes
+ * the window and the event interval, the levels are read only
+ */
+typedef struct OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Either port of the meter */
+    OMX_U32 nWindowMs;             /**< Duration of a window in milliseconds of the stream, at least 1 */
+    OMX_U32 nEventIntervalMs;      /**< Shortest time between two OMX_EventBellagioAudioLevels events, in milliseconds. 0 sends no event */
+    OMX_U32 nWindows;              /**< Windows measured since the component was created */
+    OMX_U32 nChannels;             /**< Channels of the last window */
+    OMX_U32 nFrames;               /**< Samples of each channel in the last window, fewer than a window at the end of a stream */
+    OMX_U32 nPeak[OMX_AUDIO_MAXCHANNELS];  /**< Highest absolute sample of each channel, in Q16 of the full scale */
+    OMX_U32 nRms[OMX_AUDIO_MAXCHANNELS];   /**< Root mean square of each channel, in Q16 of the full scale */
+    OMX_U32 nClips[OMX_AUDIO_MAXCHANNELS]; /**< Samples of each channel at the limits of the format */
+} OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE;
+
+/** Vendor event of the audio meter, sent when a window is measured and
+ * nEventIntervalMs has passed since the previous one, and at the end of
+ * a stream. Data1 is the input port, Data2 the number of windows and
+ * pEventData the OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE of the window, valid
+ * during the callback
+ */
+#define OMX_EventBellagioAudioLevels ((OMX_EVENTTYPE)(OMX_EventVendorStartUnused + 1))
+
+/** Most bands of OMX_CONFIG_BELLAGIOEQUALIZERTYPE */
+#define OMX_BELLAGIO_EQ_MAXBANDS 16
+
+/** The filter of a band of the equalizer */
+typedef enum OMX_BELLAGIOEQFILTERTYPE {
+    OMX_BellagioEqPeaking = 0,     /**< Boosts or cuts around the frequency, over a width set by xQ */
+    OMX_BellagioEqLowShelf,        /**< Boosts or cuts below the frequency */
+    OMX_BellagioEqHighShelf,       /**< Boosts or cuts above the frequency */
+    OMX_BellagioEqLowPass,         /**< Cuts above the frequency, the gain is ignored */
+    OMX_BellagioEqHighPass,        /**< Cuts below the frequency, the gain is ignored */
+    OMX_BellagioEqFilterMax
+} OMX_BELLAGIOEQFILTERTYPE;
+
+/** A band of the equalizer, run as one biquad filter */
+typedef struct OMX_BELLAGIOEQBANDTYPE {
+    OMX_BELLAGIOEQFILTERTYPE eFilter; /**< The filter of the band */
+    OMX_U32 nFrequency;            /**< Center or corner frequency in Hz. A band at or past half the sample rate passes the samples through */
+    OMX_U32 xQ;                    /**< Quality factor in Q16, higher for a narrower band or a steeper shelf */
+    OMX_S32 nGain;                 /**< Gain at the frequency for a peak, or of the shelf, in millibels */
+} OMX_BELLAGIOEQBANDTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioEqualizer, obtained from
+ * the extension name "OMX.st.index.config.BellagioEqualizer".
+ * It sets all the bands of the audio equalizer at once. The change
+ * takes effect at the next block of samples, cross-faded over it
+ */
+typedef struct OMX_CONFIG_BELLAGIOEQUALIZERTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Either port of the equalizer */
+    OMX_U32 nBands;                /**< Bands run one after the other, 0 passes the samples through */
+    OMX_BELLAGIOEQBANDTYPE sBands[OMX_BELLAGIO_EQ_MAXBANDS]; /**< The bands, nBands of them */
+} OMX_CONFIG_BELLAGIOEQUALIZERTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioVideoQoS, obtained from
+ * the extension name "OMX.st.index.config.BellagioVideoQoS".
+ * The video scheduler measures how late each frame reaches the clock
+ * time it is due at, and drops the frames later than nMaxLatenessUs.
+ * Setting it changes the drop policy and the event interval, the
+ * counters are read only and never reset
+ */
+typedef struct OMX_CONFIG_BELLAGIOVIDEOQOSTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< Either video port of the scheduler */
+    OMX_U32 nMaxLatenessUs;        /**< Lateness past which a frame is dropped, in microseconds of wall time */
+    OMX_BOOL bDropToKeyFrame;      /**< After a late frame is dropped, drop the frames up to the next one flagged OMX_BUFFERFLAG_SYNCFRAME */
+    OMX_U32 nEventIntervalMs;      /**< Shortest time between two OMX_EventBellagioVideoQoS events, in milliseconds. 0 sends no event */
+    OMX_U32 nRendered;             /**< Frames sent to the output port at their time */
+    OMX_U32 nLate;                 /**< Frames which reached their time late, rendered or dropped */
+    OMX_U32 nDropped;              /**< Frames dropped for being late or while waiting for a key frame */
+    OMX_TICKS nAverageLateness;    /**< Lateness of the recent frames in microseconds, each frame weighing 1/8 in the average. Negative when early */
+} OMX_CONFIG_BELLAGIOVIDEOQOSTYPE;
+
+/** Vendor event of the video scheduler, sent when a late frame is
+ * dropped and nEventIntervalMs has passed since the previous one.
+ * Data1 is the input port, Data2 the number of dropped frames and
+ * pEventData the OMX_CONFIG_BELLAGIOVIDEOQOSTYPE of the scheduler,
+ * valid during the callback
+ */
+#define OMX_EventBellagioVideoQoS ((OMX_EVENTTYPE)(OMX_EventVendorStartUnused + 2))
+
+/** The media time of the clock as last rebased, published by the clock
+ * component for its clients to read without sending a buffer. While
+ * eState is OMX_TIME_ClockStateRunning the media time at the wall time
+ * T is nMediaTime + (T - nWallTime) * xScale / 0x10000, otherwise it
+ * stays nMediaTime. The clock makes nSequence odd while it writes the
+ * other fields, a reader copies them while nSequence is even and
+ * unchanged, as base_clock_port_ReadSnapshot does
+ */
+typedef struct OMX_BELLAGIOCLOCKSNAPSHOTTYPE {
+    volatile OMX_U32 nSequence;    /**< Odd while the snapshot is being written, incremented twice at each update */
+    OMX_TIME_CLOCKSTATE eState;    /**< State of the clock */
+    OMX_S32 xScale;                /**< Rate of the media time in Q16 format, 0x10000 being normal play */
+    OMX_TICKS nMediaTime;          /**< Media time at nWallTime, in microseconds */
+    OMX_TICKS nWallTime;           /**< Wall time of the rebase, in microseconds as OMX_IndexConfigTimeCurrentWallTime */
+} OMX_BELLAGIOCLOCKSNAPSHOTTYPE;
+
+/** This structure is threaded like a config with the
+ * extension index OMX_IndexConfigBellagioClockSnapshot, obtained from
+ * the extension name "OMX.st.index.config.BellagioClockSnapshot".
+ * Getting it returns the snapshot of the clock, valid until the clock
+ * component is freed. A client reading the snapshot can set
+ * bBufferUpdates to OMX_FALSE on its port, the clock then stops sending
+ * it buffers for the state and scale changes and only fulfils its
+ * media time requests
+ */
+typedef struct OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE {
+    OMX_U32 nSize;                 /**< Size of the structure in bytes */
+    OMX_VERSIONTYPE nVersion;      /**< OMX specification version information */
+    OMX_U32 nPortIndex;            /**< The clock port of the client */
+    OMX_BOOL bBufferUpdates;       /**< The port receives a buffer at each state and scale change, the default */
+    const OMX_BELLAGIOCLOCKSNAPSHOTTYPE* pSnapshot; /**< The snapshot shared by all the ports, read only */
+} OMX_CONFIG_BELLAGIOCLOCKSNAPSHOTTYPE;
+
+/** Vendor PCM mode of the audio ports that carry 32 bit floating point
+ * samples in the range [-1, 1]. It is set in the ePCMMode field of
+ * OMX_AUDIO_PARAM_PCMMODETYPE, with nBitPerSample equal to 32
+ */
+#define OMX_AUDIO_PCMModeBellagioFloat ((OMX_AUDIO_PCMMODETYPE)(OMX_AUDIO_PCMModeVendorStartUnused + 1))
+
 typedef struct multiResourceDescriptor {
 	int CPUResourceRequested;
 	int MemoryResourceRequested;
@@ -0,0 +1,208 @@
+/**
+  src/omx_trace.c
+
+  Binary event tracer. Each thread owns a ring buffer, so that recording an
+  event needs no lock: the owner writes the event and then publishes it by
+  increasing the ring head. The rings are linked in a global list that is
+  only ever extended, and they are visited when the trace is dumped.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <asm/unistd.h>
+
+#include "omx_comp_debug_levels.h"
+#include "omx_trace.h"
+
+typedef struct omx_trace_ring omx_trace_ring;
+struct omx_trace_ring {
+  omx_trace_ring* next;
+  volatile int bInUse; /**< owned by a running thread, released when the thread exits */
+  OMX_U32 nThread;
+  volatile OMX_U32 nHead; /**< number of events written since the last dump */
+  omx_trace_event events[OMX_TRACE_RING_SIZE];
+};
+
+volatile int omx_trace_enabled = 0;
+
+static omx_trace_ring* volatile rings = NULL;
+static volatile int nRings = 0;
+/** the ring of the current thread. It is NULL until the first event, and
+ * it is set to a dummy value if no ring is available */
+static __thread omx_trace_ring* currentRing = NULL;
+static omx_trace_ring noRing;
+/** holds the ring of each thread so that it is released when the thread exits */
+static pthread_key_t ringKey;
+static pthread_once_t ringKeyOnce = PTHREAD_ONCE_INIT;
+
+static pthread_mutex_t namesMutex = PTHREAD_MUTEX_INITIALIZER;
+static omx_trace_name names[OMX_TRACE_MAX_NAMES];
+static int nNames = 0;
+
+/** Gives the ring of an exiting thread back for another thread. The events
+ * stay in it, tagged with the thread that recorded them, until overwritten
+ */
+static void trace_release_ring(void* param) {
+  omx_trace_ring* ring = (omx_trace_ring*)param;
+
+  __sync_lock_release(&ring->bInUse);
+}
+
+static void trace_create_key(void) {
+  pthread_key_create(&ringKey, trace_release_ring);
+}
+
+static omx_trace_ring* trace_get_ring(void) {
+  omx_trace_ring* ring;
+
+  pthread_once(&ringKeyOnce, trace_create_key);
+  /* a ring released by an exited thread is taken before allocating a new one */
+  for (ring = rings; ring; ring = ring->next) {
+    if (!ring->bInUse && __sync_bool_compare_and_swap(&ring->bInUse, 0, 1)) {
+      ring->nThread = (OMX_U32)syscall(__NR_gettid);
+      pthread_setspecific(ringKey, ring);
+      return ring;
+    }
+  }
+  if (__sync_fetch_and_add(&nRings, 1) >= OMX_TRACE_MAX_RINGS) {
+    __sync_fetch_and_sub(&nRings, 1);
+    DEBUG(DEB_LEV_ERR, "In %s too many threads, events of thread %i are not traced\n", __func__, (int)syscall(__NR_gettid));
+    return &noRing;
+  }
+  ring = calloc(1, sizeof(omx_trace_ring));
+  if (!ring) {
+    __sync_fetch_and_sub(&nRings, 1);
+    return &noRing;
+  }
+  ring->nThread = (OMX_U32)syscall(__NR_gettid);
+  ring->bInUse = 1;
+  pthread_setspecific(ringKey, ring);
+  do {
+    ring->next = rings;
+  } while (!__sync_bool_compare_and_swap(&rings, ring->next, ring));
+  return ring;
+}
+
+OSCL_EXPORT_REF void omx_trace_record(OMX_U32 nType, const void* pComponent, OMX_U32 nPort, OMX_U64 nArg) {
+  omx_trace_ring* ring = currentRing;
+  omx_trace_event* event;
+  struct timespec now;
+
+  if (!ring) {
+    ring = currentRing = trace_get_ring();
+  }
+  if (ring == &noRing) {
+    return;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  event = &ring->events[ring->nHead & (OMX_TRACE_RING_SIZE - 1)];
+  event->nTimestamp = (OMX_U64)now.tv_sec * 1000000000 + now.tv_nsec;
+  event->nComponent = (OMX_U64)(unsigned long)pComponent;
+  event->nArg = nArg;
+  event->nThread = ring->nThread;
+  event->nType = (OMX_U16)nType;
+  event->nPort = (OMX_U16)nPort;
+  /* the event must be complete before it is published */
+  __sync_synchronize();
+  ring->nHead++;
+}
+
+OSCL_EXPORT_REF void omx_trace_start(void) {
+  omx_trace_enabled = 1;
+}
+
+OSCL_EXPORT_REF void omx_trace_stop(void) {
+  omx_trace_enabled = 0;
+}
+
+OSCL_EXPORT_REF void omx_trace_name_component(const void* pComponent, const char* cName) {
+  omx_trace_name* name;
+
+  pthread_mutex_lock(&namesMutex);
+  /* the oldest names are replaced when the table is full */
+  name = &names[nNames % OMX_TRACE_MAX_NAMES];
+  name->nComponent = (OMX_U64)(unsigned long)pComponent;
+  strncpy(name->cName, cName, OMX_TRACE_NAME_SIZE - 1);
+  name->cName[OMX_TRACE_NAME_SIZE - 1] = 0;
+  nNames++;
+  pthread_mutex_unlock(&namesMutex);
+}
+
+OSCL_EXPORT_REF int omx_trace_dump(const char* cFileName) {
+  omx_trace_file_header header;
+  omx_trace_ring* ring;
+  OMX_U32 nHead, nFirst;
+  FILE* file;
+  int err = 0;
+
+  file = fopen(cFileName, "wb");
+  if (!file) {
+    DEBUG(DEB_LEV_ERR, "In %s unable to open %s\n", __func__, cFileName);
+    return -1;
+  }
+  memset(&header, 0, sizeof(header));
+  memcpy(header.cMagic, OMX_TRACE_MAGIC, sizeof(header.cMagic));
+  header.nVersion = OMX_TRACE_VERSION;
+
+  pthread_mutex_lock(&namesMutex);
+  header.nNames = nNames < OMX_TRACE_MAX_NAMES ? nNames : OMX_TRACE_MAX_NAMES;
+  /* the header is written again at the end, with the number of events */
+  if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+      fwrite(names, sizeof(omx_trace_name), header.nNames, file) != header.nNames) {
+    err = -1;
+  }
+  pthread_mutex_unlock(&namesMutex);
+
+  /* the events of each ring are written from the oldest one */
+  for (ring = rings; ring && !err; ring = ring->next) {
+    nHead = ring->nHead;
+    if (nHead > OMX_TRACE_RING_SIZE) {
+      header.nLost += nHead - OMX_TRACE_RING_SIZE;
+      nFirst = nHead & (OMX_TRACE_RING_SIZE - 1);
+      if (fwrite(&ring->events[nFirst], sizeof(omx_trace_event), OMX_TRACE_RING_SIZE - nFirst, file) != OMX_TRACE_RING_SIZE - nFirst ||
+          fwrite(ring->events, sizeof(omx_trace_event), nFirst, file) != nFirst) {
+        err = -1;
+      }
+      header.nEvents += OMX_TRACE_RING_SIZE;
+    } else {
+      if (fwrite(ring->events, sizeof(omx_trace_event), nHead, file) != nHead) {
+        err = -1;
+      }
+      header.nEvents += nHead;
+    }
+    ring->nHead = 0;
+  }
+  if (!err && (fseek(file, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file) != 1)) {
+    err = -1;
+  }
+  if (fclose(file) != 0) {
+    err = -1;
+  }
+  if (err) {
+    DEBUG(DEB_LEV_ERR, "In %s error writing %s\n", __func__, cFileName);
+  }
+  return err;
+}
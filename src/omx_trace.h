@@ -0,0 +1,151 @@
+/**
+  src/omx_trace.h
+
+  Binary event tracer. Events are fixed size records written in per thread
+  ring buffers without locks. Tracing is switched on and off at run time,
+  and costs a test of a global flag when it is off.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMX_TRACE_H__
+#define __OMX_TRACE_H__
+
+#ifdef ANDROID_COMPILATION
+#include <oscl_base_macros.h>
+#else
+#define OSCL_IMPORT_REF
+#define OSCL_EXPORT_REF
+#endif
+
+#include <OMX_Types.h>
+
+/** Name of the environment variable that enables tracing from OMX_Init.
+ * Its value is the name of the file where the trace is dumped by OMX_Deinit,
+ * or at exit if OMX_Deinit is not called
+ */
+#define OMX_TRACE_ENV "OMX_BELLAGIO_TRACE"
+
+/** Number of events kept by each thread. It must be a power of two */
+#define OMX_TRACE_RING_SIZE 4096
+
+/** Maximum number of threads that can record events at the same time.
+ * The ring of a thread is given to another one when it exits
+ */
+#define OMX_TRACE_MAX_RINGS 256
+
+/** Maximum number of component names kept for the decoder */
+#define OMX_TRACE_MAX_NAMES 256
+
+/** Length of a component name in the dump, including the terminator */
+#define OMX_TRACE_NAME_SIZE 128
+
+/** The magic string at the beginning of a dump file */
+#define OMX_TRACE_MAGIC "OMXTRACE"
+
+/** The version of the dump file format */
+#define OMX_TRACE_VERSION 1
+
+/** Port number of the events that are not related to a single port */
+#define OMX_TRACE_NO_PORT 0xFFFF
+
+/** The types of the traced events. The meaning of nArg depends on the type */
+typedef enum OMX_TRACE_EVENTTYPE {
+  OMX_TraceBufferEnqueue = 1, /**< a buffer has been queued on a port. nArg is the buffer header */
+  OMX_TraceBufferDequeue,     /**< the buffer management took a buffer from a port. nArg is the buffer header */
+  OMX_TraceBufferReturn,      /**< a port returned a buffer. nArg is the buffer header */
+  OMX_TraceCallbackEnter,     /**< BufferMgmtCallback is called. nArg is the buffer header */
+  OMX_TraceCallbackExit,      /**< BufferMgmtCallback has returned. nArg is the buffer header */
+  OMX_TraceStateChange,       /**< a state transition starts. nArg is the current state in the upper 32 bits and the requested one in the lower */
+  OMX_TraceFlushBegin,        /**< a port starts being flushed */
+  OMX_TraceFlushEnd,          /**< a port has been flushed */
+  OMX_TraceSemWaitBegin,      /**< a thread sleeps on a semaphore. nComponent is the semaphore */
+  OMX_TraceSemWaitEnd,        /**< a thread wakes up from a semaphore. nComponent is the semaphore */
+  OMX_TraceEventMax
+} OMX_TRACE_EVENTTYPE;
+
+/** A traced event, as recorded in the ring buffers and in the dump file
+ */
+typedef struct omx_trace_event {
+  OMX_U64 nTimestamp; /**< monotonic time of the event, in nanoseconds */
+  OMX_U64 nComponent; /**< the component handle */
+  OMX_U64 nArg;       /**< event specific argument */
+  OMX_U32 nThread;    /**< the linux thread ID of the thread that recorded the event */
+  OMX_U16 nType;      /**< one of OMX_TRACE_EVENTTYPE */
+  OMX_U16 nPort;      /**< the port index or OMX_TRACE_NO_PORT */
+} omx_trace_event;
+
+/** The header of a dump file. It is followed by nNames omx_trace_name
+ * records and by nEvents omx_trace_event records, in native byte order
+ */
+typedef struct omx_trace_file_header {
+  char cMagic[8];     /**< OMX_TRACE_MAGIC, not terminated */
+  OMX_U32 nVersion;   /**< OMX_TRACE_VERSION */
+  OMX_U32 nNames;     /**< number of component names */
+  OMX_U32 nEvents;    /**< number of events */
+  OMX_U32 nLost;      /**< number of events overwritten before the dump */
+} omx_trace_file_header;
+
+/** The name of a component, so that the decoder can show it in place of the handle */
+typedef struct omx_trace_name {
+  OMX_U64 nComponent;
+  char cName[OMX_TRACE_NAME_SIZE];
+} omx_trace_name;
+
+/** Set when tracing is enabled. It must be read only through OMX_TRACE */
+extern volatile int omx_trace_enabled;
+
+/** Records an event if tracing is enabled.
+ *
+ * @param type one of OMX_TRACE_EVENTTYPE
+ * @param comp the component handle, or any other pointer identifying the object
+ * @param port the port index or OMX_TRACE_NO_PORT
+ * @param arg the event specific argument
+ */
+#define OMX_TRACE(type, comp, port, arg) do { if (omx_trace_enabled) { omx_trace_record((type), (comp), (port), (arg)); } } while (0)
+
+/** Records an event. Use OMX_TRACE instead, that skips the call when tracing is off
+ */
+OSCL_IMPORT_REF void omx_trace_record(OMX_U32 nType, const void* pComponent, OMX_U32 nPort, OMX_U64 nArg);
+
+/** Starts recording events, from all the threads */
+OSCL_IMPORT_REF void omx_trace_start(void);
+
+/** Stops recording events. The recorded events are kept until they are dumped */
+OSCL_IMPORT_REF void omx_trace_stop(void);
+
+/** Associates a name to a component handle in the dump
+ *
+ * @param pComponent the component handle
+ * @param cName the component name
+ */
+OSCL_IMPORT_REF void omx_trace_name_component(const void* pComponent, const char* cName);
+
+/** Writes all the recorded events to a file, and clears them.
+ * Tracing should be stopped, otherwise the events recorded during the dump
+ * may be partially written
+ *
+ * @param cFileName the name of the file
+ *
+ * @return 0 on success, -1 if the file cannot be written
+ */
+OSCL_IMPORT_REF int omx_trace_dump(const char* cFileName);
+
+#endif
@@ -39,6 +39,7 @@
 
 #include "omxcore.h"
 #include "omx_create_loaders.h"
+#include "omx_trace.h"
 
 extern CPresult file_pipe_Constructor(CP_PIPETYPE* pPipe, CPstring szURI);
 extern CPresult inet_pipe_Constructor(CP_PIPETYPE* pPipe, CPstring szURI);
@@ -83,11 +84,25 @@ OMX_ERRORTYPE BOSA_AddComponentLoader(BOSA_COMPONENTLOADER *pLoader)
   return OMX_ErrorNone;
 }
 
+/** Set when trace_dump_at_exit has been registered with atexit
+ */
+static int traceAtExit;
+
+/** Dumps the trace if the client exits without calling OMX_Deinit
+ */
+static void trace_dump_at_exit(void) {
+  if (omx_trace_enabled) {
+    omx_trace_stop();
+    omx_trace_dump(getenv(OMX_TRACE_ENV));
+  }
+}
+
 /** @brief The OMX_Init standard function
  *
  * This function calls the init function of each component loader added. If there
  * is no component loaders present, the ST default component loader (static libraries)
  * is loaded as default component loader.
+ * If the OMX_TRACE_ENV environment variable is set, event tracing is started.
  *
  * @return OMX_ErrorNone
  */
@@ -99,6 +114,14 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Init() {
   if(initialized == 0) {
     initialized = 1;
 
+    if (getenv(OMX_TRACE_ENV)) {
+      omx_trace_start();
+      if (!traceAtExit) {
+        traceAtExit = 1;
+        atexit(trace_dump_at_exit);
+      }
+    }
+
     if (createComponentLoaders()) {
     	return OMX_ErrorInsufficientResources;
     }
@@ -118,12 +141,19 @@ OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Init() {
 
 /** @brief The OMX_Deinit standard function
  *
- * In this function the Deinit function for each component loader is performed
+ * In this function the Deinit function for each component loader is performed.
+ * If tracing has been enabled by OMX_Init, the trace is dumped first
  */
 OSCL_EXPORT_REF OMX_ERRORTYPE OMX_Deinit() {
   int i = 0;
+  char* traceFile;
   DEBUG(DEB_LEV_FUNCTION_NAME, "In %s\n", __func__);
   if(initialized == 1) {
+    traceFile = getenv(OMX_TRACE_ENV);
+    if (traceFile) {
+      omx_trace_stop();
+      omx_trace_dump(traceFile);
+    }
     for (i = 0; i < bosa_loaders; i++) {
       loadersList[i]->BOSA_DeInitComponentLoader(loadersList[i]);
       free(loadersList[i]);
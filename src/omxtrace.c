@@ -0,0 +1,184 @@
+/**
+	src/omxtrace.c
+
+	Decode an event trace. When the environment variable OMX_BELLAGIO_TRACE
+	is set, OMX_Init starts recording events and OMX_Deinit, or the exit of
+	the application, dumps them in the binary file named by the variable.
+	This application prints the content of that file as a timeline:
+
+	omxtrace-bellagio trace_file
+
+	Each line holds the time since the first event in microseconds, the thread,
+	the component, the port, the event and its argument.
+
+	Copyright (C) 2007-2009 STMicroelectronics
+	Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+	This library is free software; you can redistribute it and/or modify it under
+	the terms of the GNU Lesser General Public License as published by the Free
+	Software Foundation; either version 2.1 of the License, or (at your option)
+	any later version.
+
+	This library is distributed in the hope that it will be useful, but WITHOUT
+	ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+	FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+	details.
+
+	You should have received a copy of the GNU Lesser General Public License
+	along with this library; if not, write to the Free Software Foundation, Inc.,
+	51 Franklin St, Fifth Floor, Boston, MA
+	02110-1301  USA
+
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "omx_trace.h"
+
+static const char* eventNames[OMX_TraceEventMax] = {
+	"?",
+	"enqueue",
+	"dequeue",
+	"return",
+	"callback-enter",
+	"callback-exit",
+	"state",
+	"flush-begin",
+	"flush-end",
+	"sem-wait-begin",
+	"sem-wait-end"
+};
+
+static const char* stateNames[] = {
+	"Invalid", "Loaded", "Idle", "Executing", "Pause", "WaitForResources"
+};
+
+static omx_trace_name* names;
+static OMX_U32 nNames;
+
+static const char* componentName(OMX_U64 nComponent) {
+	OMX_U32 i;
+
+	/* the latest name wins when a handle has been reused */
+	for (i = nNames; i > 0; i--) {
+		if (names[i - 1].nComponent == nComponent) {
+			return names[i - 1].cName;
+		}
+	}
+	return NULL;
+}
+
+static const char* stateName(OMX_U32 nState) {
+	return nState < sizeof(stateNames) / sizeof(stateNames[0]) ? stateNames[nState] : "?";
+}
+
+static int compareEvents(const void* a, const void* b) {
+	const omx_trace_event* ea = a;
+	const omx_trace_event* eb = b;
+
+	if (ea->nTimestamp != eb->nTimestamp) {
+		return ea->nTimestamp < eb->nTimestamp ? -1 : 1;
+	}
+	return 0;
+}
+
+static void printEvent(const omx_trace_event* event, OMX_U64 nStart) {
+	const char* name;
+	char port[16];
+
+	if (event->nType == OMX_TraceSemWaitBegin || event->nType == OMX_TraceSemWaitEnd) {
+		name = "semaphore";
+	} else {
+		name = componentName(event->nComponent);
+	}
+	if (event->nPort == OMX_TRACE_NO_PORT) {
+		strcpy(port, "-");
+	} else {
+		snprintf(port, sizeof(port), "%u", (unsigned)event->nPort);
+	}
+	printf("%12.3f %6u ", (double)(event->nTimestamp - nStart) / 1000.0, (unsigned)event->nThread);
+	if (name) {
+		printf("%-32s ", name);
+	} else {
+		printf("0x%-30llx ", (unsigned long long)event->nComponent);
+	}
+	printf("%4s %-15s ", port, event->nType < OMX_TraceEventMax ? eventNames[event->nType] : "?");
+	switch (event->nType) {
+	case OMX_TraceStateChange:
+		printf("%s -> %s\n", stateName((OMX_U32)(event->nArg >> 32)), stateName((OMX_U32)(event->nArg & 0xFFFFFFFF)));
+		break;
+	case OMX_TraceSemWaitBegin:
+	case OMX_TraceSemWaitEnd:
+		printf("0x%llx\n", (unsigned long long)event->nComponent);
+		break;
+	case OMX_TraceFlushBegin:
+	case OMX_TraceFlushEnd:
+		printf("\n");
+		break;
+	default:
+		printf("0x%llx\n", (unsigned long long)event->nArg);
+		break;
+	}
+}
+
+int main(int argc, char *argv[]) {
+	omx_trace_file_header header;
+	omx_trace_event* events;
+	OMX_U32 i;
+	FILE* file;
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s trace_file\n", argv[0]);
+		return 1;
+	}
+	file = fopen(argv[1], "rb");
+	if (!file) {
+		fprintf(stderr, "Cannot open %s\n", argv[1]);
+		return 1;
+	}
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+			memcmp(header.cMagic, OMX_TRACE_MAGIC, sizeof(header.cMagic)) != 0) {
+		fprintf(stderr, "%s is not a trace file\n", argv[1]);
+		fclose(file);
+		return 1;
+	}
+	if (header.nVersion != OMX_TRACE_VERSION) {
+		fprintf(stderr, "Unsupported trace version %u\n", (unsigned)header.nVersion);
+		fclose(file);
+		return 1;
+	}
+	nNames = header.nNames;
+	names = calloc(nNames + 1, sizeof(omx_trace_name));
+	events = calloc(header.nEvents + 1, sizeof(omx_trace_event));
+	if (!names || !events) {
+		fprintf(stderr, "Out of memory\n");
+		fclose(file);
+		return 1;
+	}
+	if (fread(names, sizeof(omx_trace_name), nNames, file) != nNames ||
+			fread(events, sizeof(omx_trace_event), header.nEvents, file) != header.nEvents) {
+		fprintf(stderr, "%s is truncated\n", argv[1]);
+		fclose(file);
+		return 1;
+	}
+	fclose(file);
+	for (i = 0; i < nNames; i++) {
+		names[i].cName[OMX_TRACE_NAME_SIZE - 1] = 0;
+	}
+
+	/* the events are stored per thread, so they are merged by time */
+	qsort(events, header.nEvents, sizeof(omx_trace_event), compareEvents);
+	printf("%u events", (unsigned)header.nEvents);
+	if (header.nLost) {
+		printf(", %u older events lost", (unsigned)header.nLost);
+	}
+	printf("\n%12s %6s %-32s %4s %-15s %s\n", "time(us)", "thread", "component", "port", "event", "argument");
+	for (i = 0; i < header.nEvents; i++) {
+		printEvent(&events[i], events[0].nTimestamp);
+	}
+	free(events);
+	free(names);
+	return 0;
+}
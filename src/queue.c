@@ -2,6 +2,7 @@
   src/queue.c
 
   Implements a simple FIFO structure used for queueing OMX buffers.
+  The FIFO is a contiguous power-of-two ring that can be used without locks.
 
   Copyright (C) 2007-2009 STMicroelectronics
   Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
@@ -30,42 +31,47 @@
 #include "queue.h"
 #include "omx_comp_debug_levels.h"
 
+/* Each slot carries a sequence number: a slot at position pos is free for the
+ * producer when seq == pos and holds data for the consumer when seq == pos + 1.
+ * With a single producer and a single consumer every operation is one load of
+ * the slot plus an uncontended compare and swap on its own index, but the
+ * ring stays correct when a flush or a tunneled peer adds a second producer
+ * or consumer.
+ */
+
+/** Allocates a cache line aligned ring of nslots elements, nslots being a power of two
+ */
+static qslot_t* queue_alloc_ring(unsigned int nslots) {
+  qslot_t* ring;
+  unsigned int i;
+  if (posix_memalign((void**)&ring, QUEUE_CACHE_LINE, nslots * sizeof(qslot_t)) != 0) {
+    return NULL;
+  }
+  for (i = 0; i < nslots; i++) {
+    ring[i].seq = i;
+    ring[i].data = NULL;
+  }
+  return ring;
+}
+
 /** Initialize a queue descriptor
  *
  * @param queue The queue descriptor to initialize.
  * The user needs to allocate the queue
  */
 int queue_init(queue_t* queue) {
-  int i;
-  qelem_t* newelem;
-  qelem_t* current;
-  i = pthread_mutex_init(&queue->mutex, NULL);
-  if (i!=0) {
-	  return -1;
-  }
-  queue->first = malloc(sizeof(qelem_t));
-  if (!(queue->first)) {
-	  return -1;
-  }
-  memset(queue->first, 0, sizeof(qelem_t));
-  current = queue->last = queue->first;
-  queue->nelem = 0;
-  for (i = 0; i<MAX_QUEUE_ELEMENTS - 2; i++) {
-    newelem = malloc(sizeof(qelem_t));
-    if (!newelem) {
-    	// the memory is not enough. Free all
-    	while(queue->first!=NULL) {
-        	current = queue->first->q_forw;
-        	free(queue->first);
-        	queue->first = current;
-    	}
-    	return -1;
-    }
-    memset(newelem, 0, sizeof(qelem_t));
-    current->q_forw = newelem;
-    current = newelem;
+  unsigned int nslots = 1;
+  while (nslots < MAX_QUEUE_ELEMENTS) {
+    nslots <<= 1;
+  }
+  queue->ring = queue_alloc_ring(nslots);
+  if (!(queue->ring)) {
+    return -1;
   }
-  current->q_forw = queue->first;
+  queue->mask = nslots - 1;
+  queue->head = 0;
+  queue->tail = 0;
+  queue->nelem = 0;
   return 0;
 }
 
@@ -75,21 +81,46 @@ int queue_init(queue_t* queue) {
  * @param queue the queue descriptor to dump
  */
 void queue_deinit(queue_t* queue) {
-  int i;
-  qelem_t* current;
-  current = queue->first;
-  for (i = 0; i<MAX_QUEUE_ELEMENTS - 2; i++) {
-    if (current != NULL) {
-      current = current->q_forw;
-      free(queue->first);
-      queue->first = current;
-    }
+  if(queue->ring) {
+    free(queue->ring);
+    queue->ring = NULL;
   }
-  if(queue->first) {
-    free(queue->first);
-    queue->first = NULL;
+  queue->mask = 0;
+  queue->nelem = 0;
+}
+
+/** Grows the queue so that it can hold at least nelem elements
+ *
+ * @param queue the queue descriptor to resize
+ *
+ * @param nelem the number of elements the queue must be able to hold
+ *
+ * @return -1 if the queue is not empty or the allocation fails
+ */
+int queue_resize(queue_t* queue, int nelem) {
+  qslot_t* ring;
+  unsigned int nslots = queue->mask + 1;
+  if (nelem <= (int)nslots) {
+    return 0;
+  }
+  if (queue->nelem != 0) {
+    DEBUG(DEB_LEV_ERR, "In %s cannot resize a queue holding %d elements\n", __func__, queue->nelem);
+    return -1;
+  }
+  while (nslots < (unsigned int)nelem) {
+    nslots <<= 1;
+  }
+  ring = queue_alloc_ring(nslots);
+  if (!ring) {
+    return -1;
   }
-  pthread_mutex_destroy(&queue->mutex);
+  free(queue->ring);
+  queue->ring = ring;
+  queue->mask = nslots - 1;
+  queue->head = 0;
+  queue->tail = 0;
+  __sync_synchronize();
+  return 0;
 }
 
 /** Enqueue an element to the given queue descriptor
@@ -101,14 +132,81 @@ void queue_deinit(queue_t* queue) {
  * @return -1 if the queue is full
  */
 int queue(queue_t* queue, void* data) {
-  if (queue->last->data != NULL) {
+  qslot_t* slot;
+  unsigned int pos;
+  int dif;
+
+  pos = queue->tail;
+  for (;;) {
+    slot = &queue->ring[pos & queue->mask];
+    dif = (int)(slot->seq - pos);
+    if (dif == 0) {
+      if (__sync_bool_compare_and_swap(&queue->tail, pos, pos + 1)) {
+        break;
+      }
+      pos = queue->tail;
+    } else if (dif < 0) {
+      return -1;
+    } else {
+      pos = queue->tail;
+    }
+  }
+  slot->data = data;
+  __sync_synchronize();
+  slot->seq = pos + 1;
+  __sync_fetch_and_add(&queue->nelem, 1);
+  return 0;
+}
+
+/** Enqueue several elements to the given queue descriptor at once
+ *
+ * @param queue the queue descritpor where to queue data
+ *
+ * @param data the array of the elements to be enqueued
+ *
+ * @param n the number of elements in data
+ *
+ * @return -1 if the queue has not room for n elements
+ */
+int queue_n(queue_t* queue, void** data, int n) {
+  qslot_t* slot;
+  unsigned int pos;
+  int i, dif;
+
+  if (n <= 0) {
+    return 0;
+  }
+  if ((unsigned int)n > queue->mask + 1) {
     return -1;
   }
-  pthread_mutex_lock(&queue->mutex);
-  queue->last->data = data;
-  queue->last = queue->last->q_forw;
-  queue->nelem++;
-  pthread_mutex_unlock(&queue->mutex);
+  pos = queue->tail;
+  for (;;) {
+    /* every slot of the range must be free. A consumer may release the
+     * slots out of order, so checking the last one is not enough */
+    for (i = 0; i < n; i++) {
+      slot = &queue->ring[(pos + i) & queue->mask];
+      dif = (int)(slot->seq - (pos + i));
+      if (dif != 0) {
+        break;
+      }
+    }
+    if (i == n) {
+      if (__sync_bool_compare_and_swap(&queue->tail, pos, pos + n)) {
+        break;
+      }
+    } else if (dif < 0) {
+      return -1;
+    }
+    pos = queue->tail;
+  }
+  for (i = 0; i < n; i++) {
+    queue->ring[(pos + i) & queue->mask].data = data[i];
+  }
+  __sync_synchronize();
+  for (i = 0; i < n; i++) {
+    queue->ring[(pos + i) & queue->mask].seq = pos + i + 1;
+  }
+  __sync_fetch_and_add(&queue->nelem, n);
   return 0;
 }
 
@@ -120,16 +218,32 @@ int queue(queue_t* queue, void* data) {
  *  a NULL value is returned
  */
 void* dequeue(queue_t* queue) {
+  qslot_t* slot;
   void* data;
-  if (queue->first->data == NULL) {
-    return NULL;
+  unsigned int pos;
+  int dif;
+
+  pos = queue->head;
+  for (;;) {
+    slot = &queue->ring[pos & queue->mask];
+    dif = (int)(slot->seq - (pos + 1));
+    if (dif == 0) {
+      if (__sync_bool_compare_and_swap(&queue->head, pos, pos + 1)) {
+        break;
+      }
+      pos = queue->head;
+    } else if (dif < 0) {
+      return NULL;
+    } else {
+      pos = queue->head;
+    }
   }
-  pthread_mutex_lock(&queue->mutex);
-  data = queue->first->data;
-  queue->first->data = NULL;
-  queue->first = queue->first->q_forw;
-  queue->nelem--;
-  pthread_mutex_unlock(&queue->mutex);
+  __sync_synchronize();
+  data = slot->data;
+  slot->data = NULL;
+  __sync_synchronize();
+  slot->seq = pos + queue->mask + 1;
+  __sync_fetch_and_sub(&queue->nelem, 1);
 
   return data;
 }
@@ -141,9 +255,54 @@ void* dequeue(queue_t* queue) {
  * @return the number of elements in the queue
  */
 int getquenelem(queue_t* queue) {
-  int qelem;
-  pthread_mutex_lock(&queue->mutex);
-  qelem = queue->nelem;
-  pthread_mutex_unlock(&queue->mutex);
-  return qelem;
+  return queue->nelem;
+}
+
+/** Initialize a multiple producer queue descriptor
+ *
+ * @param queue the queue descriptor to initialize
+ */
+void mpsc_queue_init(mpsc_queue_t* queue) {
+  queue->top = NULL;
+}
+
+/** Push an element to the given multiple producer queue
+ *
+ * @param queue the queue descriptor where to push the element
+ *
+ * @param link the link embedded in the element to be pushed
+ *
+ * @return 1 if the queue was empty before the push, 0 otherwise
+ */
+int mpsc_queue_push(mpsc_queue_t* queue, qlink_t* link) {
+  qlink_t* top;
+  do {
+    top = queue->top;
+    link->next = top;
+  } while (!__sync_bool_compare_and_swap(&queue->top, top, link));
+  return (top == NULL);
+}
+
+/** Remove all the pending elements from the given multiple producer queue
+ *
+ * The elements are pushed on a stack, so the detached list is reversed
+ * to give them back in push order.
+ *
+ * @param queue the queue descriptor to drain
+ *
+ * @return the list of the removed elements in push order
+ */
+qlink_t* mpsc_queue_drain(mpsc_queue_t* queue) {
+  qlink_t* list;
+  qlink_t* fifo = NULL;
+  qlink_t* next;
+  list = __sync_lock_test_and_set(&queue->top, NULL);
+  __sync_synchronize();
+  while (list != NULL) {
+    next = list->next;
+    list->next = fifo;
+    fifo = list;
+    list = next;
+  }
+  return fifo;
 }
@@ -2,6 +2,7 @@
   src/queue.h
 
   Implements a simple FIFO structure used for queueing OMX buffers.
+  The FIFO is a contiguous power-of-two ring that can be used without locks.
 
   Copyright (C) 2007-2009 STMicroelectronics
   Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
@@ -26,25 +27,36 @@
 #ifndef __TQUEUE_H__
 #define __TQUEUE_H__
 
-#include <pthread.h>
-/** Maximum number of elements in a queue
+/** Default number of elements in a queue.
+ * The actual capacity is rounded up to the next power of two and can be
+ * grown with queue_resize
  */
 #define MAX_QUEUE_ELEMENTS 10
-/** Output port queue element. Contains an OMX buffer header type
+
+/** Size of a cache line, used to keep the producer and consumer
+ * indexes and the ring storage from sharing cache lines
+ */
+#define QUEUE_CACHE_LINE 64
+
+/** Ring slot. The sequence number tells producer and consumer
+ * whether the slot is free or holds published data
  */
-typedef struct qelem_t qelem_t;
-struct qelem_t{
-  qelem_t* q_forw;
+typedef struct qslot_t{
+  volatile unsigned int seq;
   void* data;
-};
+} qslot_t;
 
 /** This structure contains the queue
  */
 typedef struct queue_t{
-  qelem_t* first; /**< Output buffer queue head */
-  qelem_t* last; /**< Output buffer queue tail */
-  int nelem; /**< Number of elements in the queue */
-  pthread_mutex_t mutex;
+  qslot_t* ring; /**< Cache line aligned slot storage */
+  unsigned int mask; /**< Number of slots minus one. The number of slots is a power of two */
+  char pad0[QUEUE_CACHE_LINE];
+  volatile unsigned int tail; /**< Producer index */
+  char pad1[QUEUE_CACHE_LINE];
+  volatile unsigned int head; /**< Consumer index */
+  char pad2[QUEUE_CACHE_LINE];
+  volatile int nelem; /**< Number of elements in the queue */
 } queue_t;
 
 /** Initialize a queue descriptor
@@ -63,6 +75,19 @@ int queue_init(queue_t* queue);
  */
 void queue_deinit(queue_t* queue);
 
+/** Grows the queue so that it can hold at least nelem elements
+ *
+ * The queue must be empty and no other thread may access it during
+ * the call. A queue is never shrunk.
+ *
+ * @param queue the queue descriptor to resize
+ *
+ * @param nelem the number of elements the queue must be able to hold
+ *
+ * @return -1 if the queue is not empty or the allocation fails
+ */
+int queue_resize(queue_t* queue, int nelem);
+
 /** Enqueue an element to the given queue descriptor
  *
  * @param queue the queue descritpor where to queue data
@@ -73,6 +98,22 @@ void queue_deinit(queue_t* queue);
  */
 int queue(queue_t* queue, void* data);
 
+/** Enqueue several elements to the given queue descriptor at once
+ *
+ * The slots are reserved with a single update of the producer index, and
+ * the elements are published in order. Either all the elements are
+ * enqueued or none is
+ *
+ * @param queue the queue descritpor where to queue data
+ *
+ * @param data the array of the elements to be enqueued
+ *
+ * @param n the number of elements in data
+ *
+ * @return -1 if the queue has not room for n elements
+ */
+int queue_n(queue_t* queue, void** data, int n);
+
 /** Dequeue an element from the given queue descriptor
  *
  * @param queue the queue descriptor from which to dequeue the element
@@ -90,4 +131,48 @@ void* dequeue(queue_t* queue);
  */
 int getquenelem(queue_t* queue);
 
+/** Link embedded as the first field of the elements of a mpsc_queue_t
+ */
+typedef struct qlink_t qlink_t;
+struct qlink_t{
+  qlink_t* next;
+};
+
+/** Unbounded multiple producer, single consumer queue.
+ * The elements are linked through their embedded qlink_t, so pushing
+ * never allocates and never fails. The consumer takes all the pending
+ * elements at once with mpsc_queue_drain
+ */
+typedef struct mpsc_queue_t{
+  qlink_t* volatile top; /**< Most recently pushed element */
+} mpsc_queue_t;
+
+/** Initialize a multiple producer queue descriptor
+ *
+ * @param queue the queue descriptor to initialize
+ */
+void mpsc_queue_init(mpsc_queue_t* queue);
+
+/** Push an element to the given multiple producer queue
+ *
+ * It can be called concurrently by any number of threads
+ *
+ * @param queue the queue descriptor where to push the element
+ *
+ * @param link the link embedded in the element to be pushed
+ *
+ * @return 1 if the queue was empty before the push, 0 otherwise.
+ *  The consumer needs to be woken up only in the first case
+ */
+int mpsc_queue_push(mpsc_queue_t* queue, qlink_t* link);
+
+/** Remove all the pending elements from the given multiple producer queue
+ *
+ * @param queue the queue descriptor to drain
+ *
+ * @return the list of the removed elements in push order, chained
+ *  through their next field. NULL if the queue is empty
+ */
+qlink_t* mpsc_queue_drain(mpsc_queue_t* queue);
+
 #endif
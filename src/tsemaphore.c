@@ -25,11 +25,45 @@
 */
 
 #include <pthread.h>
-#include <sys/time.h>
+#include <time.h>
 #include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include "tsemaphore.h"
+#include "omx_trace.h"
 #include "omx_comp_debug_levels.h"
 
+/** Sleeps on the futex word if it still holds val, until woken up or until
+ * the absolute monotonic deadline is reached (NULL means no deadline)
+ */
+static int futex_wait(volatile unsigned int* word, unsigned int val, const struct timespec* deadline) {
+  if (deadline) {
+    return syscall(SYS_futex, word, FUTEX_WAIT_BITSET_PRIVATE, val, deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+  }
+  return syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+/** Wakes up to nwake threads sleeping on the futex word
+ */
+static void futex_wake(volatile unsigned int* word, int nwake) {
+  syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, nwake, NULL, NULL, 0);
+}
+
+/** Tries to decrease the semaphore value without blocking
+ *
+ * @return 1 if the value has been decreased, 0 if it is zero
+ */
+OSCL_EXPORT_REF int tsem_try_down(tsem_t* tsem) {
+  unsigned int val;
+  while ((val = tsem->semval) > 0) {
+    if (__sync_bool_compare_and_swap(&tsem->semval, val, val - 1)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
 /** Initializes the semaphore at a given value
  *
  * @param tsem the semaphore to initialize
@@ -37,16 +71,10 @@
  *
  */
 OSCL_EXPORT_REF int tsem_init(tsem_t* tsem, unsigned int val) {
-	int i;
-	i = pthread_cond_init(&tsem->condition, NULL);
-	if (i!=0) {
-		return -1;
-	}
-	i = pthread_mutex_init(&tsem->mutex, NULL);
-	if (i!=0) {
-		return -1;
-	}
 	tsem->semval = val;
+	tsem->nwaiters = 0;
+	tsem->signal = 0;
+	__sync_synchronize();
 	return 0;
 }
 
@@ -55,38 +83,44 @@ OSCL_EXPORT_REF int tsem_init(tsem_t* tsem, unsigned int val) {
  * @param tsem the semaphore to destroy
  */
 OSCL_EXPORT_REF void tsem_deinit(tsem_t* tsem) {
-  pthread_cond_destroy(&tsem->condition);
-  pthread_mutex_destroy(&tsem->mutex);
+  tsem->semval = 0;
+  tsem->nwaiters = 0;
 }
 
 /** Decreases the value of the semaphore. Blocks if the semaphore
  * value is zero. If the timeout is reached the function exits with
- * error ETIMEDOUT
+ * error ETIMEDOUT, leaving the semaphore value unchanged
  *
  * @param tsem the semaphore to decrease
- * @param timevalue the value of delay for the timeout
+ * @param milliSecondsDelay the value of delay for the timeout
  */
 OSCL_EXPORT_REF int tsem_timed_down(tsem_t* tsem, unsigned int milliSecondsDelay) {
-	int err = 0;
-    struct timespec final_time;
-    struct timeval currentTime;
-    long int microdelay;
-
-    gettimeofday(&currentTime, NULL);
-    /** convert timeval to timespec and add delay in milliseconds for the timeout */
-    microdelay = ((milliSecondsDelay * 1000 + currentTime.tv_usec));
-	final_time.tv_sec = currentTime.tv_sec + (microdelay / 1000000);
-	final_time.tv_nsec = (microdelay % 1000000) * 1000;
-	pthread_mutex_lock(&tsem->mutex);
-	while (tsem->semval == 0) {
-		err = pthread_cond_timedwait(&tsem->condition, &tsem->mutex, &final_time);
-		if (err != 0) {
-			tsem->semval--;
+	struct timespec final_time;
+
+	if (tsem_try_down(tsem)) {
+		return 0;
+	}
+	/** the deadline is absolute on the monotonic clock, so it is not affected by wall clock changes */
+	clock_gettime(CLOCK_MONOTONIC, &final_time);
+	final_time.tv_sec += milliSecondsDelay / 1000;
+	final_time.tv_nsec += (long)(milliSecondsDelay % 1000) * 1000000;
+	if (final_time.tv_nsec >= 1000000000) {
+		final_time.tv_sec++;
+		final_time.tv_nsec -= 1000000000;
+	}
+	OMX_TRACE(OMX_TraceSemWaitBegin, tsem, OMX_TRACE_NO_PORT, 0);
+	while (!tsem_try_down(tsem)) {
+		__sync_fetch_and_add(&tsem->nwaiters, 1);
+		if (futex_wait(&tsem->semval, 0, &final_time) != 0 && errno == ETIMEDOUT) {
+			__sync_fetch_and_sub(&tsem->nwaiters, 1);
+			OMX_TRACE(OMX_TraceSemWaitEnd, tsem, OMX_TRACE_NO_PORT, 0);
+			/* a tsem_up may have raced with the timeout */
+			return tsem_try_down(tsem) ? 0 : ETIMEDOUT;
 		}
+		__sync_fetch_and_sub(&tsem->nwaiters, 1);
 	}
-	tsem->semval--;
-	pthread_mutex_unlock(&tsem->mutex);
-	return err;
+	OMX_TRACE(OMX_TraceSemWaitEnd, tsem, OMX_TRACE_NO_PORT, 0);
+	return 0;
 }
 
 /** Decreases the value of the semaphore. Blocks if the semaphore
@@ -95,12 +129,16 @@ OSCL_EXPORT_REF int tsem_timed_down(tsem_t* tsem, unsigned int milliSecondsDelay
  * @param tsem the semaphore to decrease
  */
 OSCL_EXPORT_REF void tsem_down(tsem_t* tsem) {
-  pthread_mutex_lock(&tsem->mutex);
-  while (tsem->semval == 0) {
-    pthread_cond_wait(&tsem->condition, &tsem->mutex);
+  if (tsem_try_down(tsem)) {
+    return;
   }
-  tsem->semval--;
-  pthread_mutex_unlock(&tsem->mutex);
+  OMX_TRACE(OMX_TraceSemWaitBegin, tsem, OMX_TRACE_NO_PORT, 0);
+  while (!tsem_try_down(tsem)) {
+    __sync_fetch_and_add(&tsem->nwaiters, 1);
+    futex_wait(&tsem->semval, 0, NULL);
+    __sync_fetch_and_sub(&tsem->nwaiters, 1);
+  }
+  OMX_TRACE(OMX_TraceSemWaitEnd, tsem, OMX_TRACE_NO_PORT, 0);
 }
 
 /** Increases the value of the semaphore
@@ -108,10 +146,25 @@ OSCL_EXPORT_REF void tsem_down(tsem_t* tsem) {
  * @param tsem the semaphore to increase
  */
 OSCL_EXPORT_REF void tsem_up(tsem_t* tsem) {
-  pthread_mutex_lock(&tsem->mutex);
-  tsem->semval++;
-  pthread_cond_signal(&tsem->condition);
-  pthread_mutex_unlock(&tsem->mutex);
+  __sync_fetch_and_add(&tsem->semval, 1);
+  if (tsem->nwaiters > 0) {
+    futex_wake(&tsem->semval, 1);
+  }
+}
+
+/** Increases the value of the semaphore by n
+ *
+ * @param tsem the semaphore to increase
+ * @param n the amount to add
+ */
+OSCL_EXPORT_REF void tsem_up_n(tsem_t* tsem, unsigned int n) {
+  if (n == 0) {
+    return;
+  }
+  __sync_fetch_and_add(&tsem->semval, n);
+  if (tsem->nwaiters > 0) {
+    futex_wake(&tsem->semval, n);
+  }
 }
 
 /** Reset the value of the semaphore
@@ -119,9 +172,8 @@ OSCL_EXPORT_REF void tsem_up(tsem_t* tsem) {
  * @param tsem the semaphore to reset
  */
 OSCL_EXPORT_REF void tsem_reset(tsem_t* tsem) {
-  pthread_mutex_lock(&tsem->mutex);
-  tsem->semval=0;
-  pthread_mutex_unlock(&tsem->mutex);
+  __sync_lock_test_and_set(&tsem->semval, 0);
+  __sync_synchronize();
 }
 
 /** Wait on the condition.
@@ -129,9 +181,9 @@ OSCL_EXPORT_REF void tsem_reset(tsem_t* tsem) {
  * @param tsem the semaphore to wait
  */
 OSCL_EXPORT_REF void tsem_wait(tsem_t* tsem) {
-  pthread_mutex_lock(&tsem->mutex);
-  pthread_cond_wait(&tsem->condition, &tsem->mutex);
-  pthread_mutex_unlock(&tsem->mutex);
+  unsigned int signal = tsem->signal;
+  __sync_synchronize();
+  futex_wait(&tsem->signal, signal, NULL);
 }
 
 /** Signal the condition,if waiting
@@ -139,8 +191,6 @@ OSCL_EXPORT_REF void tsem_wait(tsem_t* tsem) {
  * @param tsem the semaphore to signal
  */
 OSCL_EXPORT_REF void tsem_signal(tsem_t* tsem) {
-  pthread_mutex_lock(&tsem->mutex);
-  pthread_cond_signal(&tsem->condition);
-  pthread_mutex_unlock(&tsem->mutex);
+  __sync_fetch_and_add(&tsem->signal, 1);
+  futex_wake(&tsem->signal, 1);
 }
-
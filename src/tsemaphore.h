@@ -33,12 +33,16 @@
 #define OSCL_EXPORT_REF
 #endif
 
-/** The structure contains the semaphore value, mutex and green light flag
+/** The structure contains the semaphore value and the futex words
+ *
+ * The value is changed with atomic operations, and a thread enters the
+ * kernel only when it has to sleep or when there is a sleeper to wake up.
+ * The semval field can be read directly as a snapshot of the value.
  */
 typedef struct tsem_t{
-  pthread_cond_t condition;
-  pthread_mutex_t mutex;
-  unsigned int semval;
+  volatile unsigned int semval; /**< the semaphore value, also used as futex word by tsem_down */
+  volatile unsigned int nwaiters; /**< number of threads sleeping on semval */
+  volatile unsigned int signal; /**< generation counter used as futex word by tsem_wait and tsem_signal */
 }tsem_t;
 
 /** Initializes the semaphore at a given value
@@ -62,12 +66,22 @@ OSCL_IMPORT_REF void tsem_deinit(tsem_t* tsem);
  */
 OSCL_IMPORT_REF void tsem_down(tsem_t* tsem);
 
+/** Decreases the value of the semaphore if it is not zero.
+ * It never blocks
+ *
+ * @param tsem the semaphore to decrease
+ *
+ * @return 1 if the value has been decreased, 0 if it was zero
+ */
+OSCL_IMPORT_REF int tsem_try_down(tsem_t* tsem);
+
 /** Decreases the value of the semaphore. Blocks if the semaphore
  * value is zero. If the timeout is reached the function exits with
- * error ETIMEDOUT
+ * error ETIMEDOUT, leaving the semaphore value unchanged.
+ * The timeout is measured on the monotonic clock
  *
  * @param tsem the semaphore to decrease
- * @param timevalue the value of delay for the timeout
+ * @param milliSecondsDelay the value of delay for the timeout
  */
 OSCL_IMPORT_REF int tsem_timed_down(tsem_t* tsem, unsigned int milliSecondsDelay);
 
@@ -77,6 +91,13 @@ OSCL_IMPORT_REF int tsem_timed_down(tsem_t* tsem, unsigned int milliSecondsDelay
  */
 OSCL_IMPORT_REF void tsem_up(tsem_t* tsem);
 
+/** Increases the value of the semaphore by n, waking up at most n waiters
+ *
+ * @param tsem the semaphore to increase
+ * @param n the amount to add
+ */
+OSCL_IMPORT_REF void tsem_up_n(tsem_t* tsem, unsigned int n);
+
 /** Reset the value of the semaphore
  *
  * @param tsem the semaphore to reset
@@ -0,0 +1,728 @@
+/**
+  test/components/audio_effects/omxaudioeffectsbench.c
+
+  This benchmark application drives the volume and the audio mixer
+  components with synthetic PCM held in memory, as fast as they accept it.
+  It measures the throughput, the latency of the buffers and the CPU time
+  of each thread, for a range of buffer sizes, buffer counts, port counts
+  and gains, with and without tunnels.
+
+  The volume runs send one stream through a volume component, or through
+  two volume components tunnelled together. The mixer runs send one
+  stream to each input port of the mixer, directly or through a volume
+  component tunnelled to each input port.
+
+  Copyright (C) 2008-2009 STMicroelectronics
+  Copyright (C) 2008-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxaudioeffectsbench.h"
+
+#define VOLUME_NAME "OMX.st.volume.component"
+#define MIXER_NAME "OMX.st.audio.mixer"
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = benchEventHandler,
+                               .EmptyBufferDone = benchEmptyBufferDone,
+                               .FillBufferDone = benchFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+void display_help() {
+  printf("\n");
+  printf("Usage: omxaudioeffectsbench [-m volume|mixer] [-t|-u] [-b sizes] [-c counts] [-p ports] [-g gains] [-l buffers] [-v]\n");
+  printf("\n");
+  printf("       -m component : Runs only the volume or only the mixer [Default both]\n");
+  printf("       -t           : Runs only the tunnelled chains\n");
+  printf("       -u           : Runs only the non tunnelled chains\n");
+  printf("       -b 4096,32768: Bytes of PCM in each input buffer\n");
+  printf("       -c 2,4       : Buffers on each port\n");
+  printf("       -p 2,4       : Input ports of the mixer [1..%i]\n", BENCH_MAX_PORTS);
+  printf("       -g 50,100    : Gain of the streams [0...100]\n");
+  printf("       -l 1000      : Buffers sent on each input port in a run\n");
+  printf("       -v           : Prints the CPU time of each thread instead of the sums\n");
+  printf("       -h           : Displays this help\n");
+  printf("\n");
+  printf("       Each run sends 16 bit stereo PCM at 44100 Hz and prints the samples\n");
+  printf("       processed per second, the percentiles of the time from EmptyThisBuffer\n");
+  printf("       to the FillBufferDone of the output buffer carrying its first sample,\n");
+  printf("       and the CPU time of the threads during the run\n");
+  printf("\n");
+  exit(1);
+}
+
+/* Application private date: should go in the component field (segs...) */
+appPrivateType* appPriv;
+OMX_S16* pcmPattern;
+int flagVerbose;
+
+/** Returns the monotonic time in nanoseconds */
+static OMX_U64 benchNow(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (OMX_U64)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/** Parses a list of values separated by commas
+  * @return the number of values
+  */
+static int parseList(const char* pList, OMX_U32* pValues) {
+  int n = 0;
+
+  while (*pList && n < BENCH_MAX_VALUES) {
+    pValues[n++] = (OMX_U32)atoi(pList);
+    while (*pList && *pList != ',') {
+      pList++;
+    }
+    if (*pList == ',') {
+      pList++;
+    }
+  }
+  return n;
+}
+
+/** Reads the CPU time of each thread of the process. The scheduler
+  * statistics give nanoseconds, the thread status clock ticks
+  * @return the number of threads
+  */
+static int readThreadTimes(benchThreadTime* pTimes) {
+  DIR* dir;
+  struct dirent* entry;
+  char path[300];
+  FILE* file;
+  unsigned long long nRun;
+  unsigned long utime, stime;
+  int n = 0, k;
+  char* p;
+  char line[512];
+
+  dir = opendir("/proc/self/task");
+  if (!dir) {
+    return 0;
+  }
+  while ((entry = readdir(dir)) != NULL && n < BENCH_MAX_THREADS) {
+    if (entry->d_name[0] < '0' || entry->d_name[0] > '9') {
+      continue;
+    }
+    pTimes[n].tid = atol(entry->d_name);
+    pTimes[n].nTime = 0;
+    snprintf(path, sizeof(path), "/proc/self/task/%s/schedstat", entry->d_name);
+    file = fopen(path, "r");
+    if (file && fscanf(file, "%llu", &nRun) == 1) {
+      pTimes[n].nTime = nRun;
+    } else {
+      if (file) {
+        fclose(file);
+      }
+      snprintf(path, sizeof(path), "/proc/self/task/%s/stat", entry->d_name);
+      file = fopen(path, "r");
+      /* utime and stime are the 12th and 13th fields after the name */
+      if (file && fgets(line, sizeof(line), file) && (p = strrchr(line, ')')) != NULL) {
+        for (k = 0; k < 12 && p; k++) {
+          p = strchr(p + 1, ' ');
+        }
+        if (p && sscanf(p, "%lu %lu", &utime, &stime) == 2) {
+          pTimes[n].nTime = (OMX_U64)(utime + stime) * 1000000000ULL / sysconf(_SC_CLK_TCK);
+        }
+      }
+    }
+    if (file) {
+      fclose(file);
+    }
+    n++;
+  }
+  closedir(dir);
+  return n;
+}
+
+/** Prints the CPU time of the threads between two readings, labelled by
+  * the thread IDs the components report. The threads not reported, such
+  * as the helper threads of the mixer, are summed as other
+  */
+static void printThreadTimes(benchThreadTime* pStart, int nStart, benchThreadTime* pEnd, int nEnd) {
+  OMX_U64 nTime, nOther = 0, nMain = 0;
+  int nOthers = 0, i, j;
+  char label[32];
+  OMX_U32 c;
+
+  printf("    cpu ms:");
+  for (i = 0; i < nEnd; i++) {
+    nTime = pEnd[i].nTime;
+    for (j = 0; j < nStart; j++) {
+      if (pStart[j].tid == pEnd[i].tid) {
+        nTime -= pStart[j].nTime;
+        break;
+      }
+    }
+    label[0] = 0;
+    for (c = 0; c < appPriv->nComponents; c++) {
+      if (pEnd[i].tid == appPriv->components[c].nBufferThread) {
+        snprintf(label, sizeof(label), "%s.buffer", appPriv->components[c].name);
+      } else if (pEnd[i].tid == appPriv->components[c].nMessageThread) {
+        snprintf(label, sizeof(label), "%s.message", appPriv->components[c].name);
+      }
+    }
+    if (pEnd[i].tid == getpid()) {
+      nMain = nTime;
+    } else if (label[0]) {
+      printf(" %s %.1f", label, nTime / 1e6);
+    } else if (flagVerbose) {
+      printf(" %ld %.1f", pEnd[i].tid, nTime / 1e6);
+    } else {
+      nOther += nTime;
+      nOthers++;
+    }
+  }
+  printf(" main %.1f", nMain / 1e6);
+  if (nOthers) {
+    printf(" other(%i) %.1f", nOthers, nOther / 1e6);
+  }
+  printf("\n");
+}
+
+static int compareTimes(const void* a, const void* b) {
+  OMX_U64 x = *(const OMX_U64*)a, y = *(const OMX_U64*)b;
+  return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+/** Returns a percentile of the sorted latencies, in microseconds */
+static double percentile(int nPercent) {
+  OMX_U32 i;
+
+  if (appPriv->nLatency == 0) {
+    return 0.0;
+  }
+  i = (OMX_U32)((OMX_U64)(appPriv->nLatency - 1) * nPercent / 100);
+  return appPriv->pLatency[i] / 1e3;
+}
+
+/** Fills an input buffer with the next buffer of a stream and sends it.
+  * The last buffer of the stream carries the EOS flag
+  */
+static void sendInputBuffer(OMX_U32 nStream, OMX_BUFFERHEADERTYPE* pBuffer) {
+  pthread_mutex_lock(&appPriv->mutex);
+  if (appPriv->nSent[nStream] < appPriv->nBuffersPerStream && !appPriv->bStopping) {
+    memcpy(pBuffer->pBuffer, pcmPattern, appPriv->nFillLen);
+    pBuffer->nOffset = 0;
+    pBuffer->nFilledLen = appPriv->nFillLen;
+    pBuffer->nTimeStamp = (OMX_TICKS)benchNow();
+    appPriv->nSent[nStream]++;
+    pBuffer->nFlags = appPriv->nSent[nStream] == appPriv->nBuffersPerStream ? OMX_BUFFERFLAG_EOS : 0;
+    OMX_EmptyThisBuffer(appPriv->pInput[nStream]->handle, pBuffer);
+  }
+  pthread_mutex_unlock(&appPriv->mutex);
+}
+
+static OMX_U32 getBufferSize(benchComponentType* pComp, OMX_U32 nPort) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPort;
+  OMX_GetParameter(pComp->handle, OMX_IndexParamPortDefinition, &sPortDef);
+  return sPortDef.nBufferSize;
+}
+
+static OMX_ERRORTYPE setBufferCount(benchComponentType* pComp, OMX_U32 nPort, OMX_U32 nCount) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = nPort;
+  err = OMX_GetParameter(pComp->handle, OMX_IndexParamPortDefinition, &sPortDef);
+  if (err != OMX_ErrorNone) {
+    return err;
+  }
+  sPortDef.nBufferCountActual = nCount < sPortDef.nBufferCountMin ? sPortDef.nBufferCountMin : nCount;
+  return OMX_SetParameter(pComp->handle, OMX_IndexParamPortDefinition, &sPortDef);
+}
+
+static void setGain(benchComponentType* pComp, OMX_U32 nPort, OMX_U32 nGain) {
+  OMX_AUDIO_CONFIG_VOLUMETYPE sVolume;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sVolume, sizeof(OMX_AUDIO_CONFIG_VOLUMETYPE));
+  sVolume.nPortIndex = nPort;
+  err = OMX_GetConfig(pComp->handle, OMX_IndexConfigAudioVolume, &sVolume);
+  sVolume.sVolume.nValue = nGain;
+  err = OMX_SetConfig(pComp->handle, OMX_IndexConfigAudioVolume, &sVolume);
+  if(err!=OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR,"Error %08x In OMX_SetConfig of %s port %i\n",err, pComp->name, (int)nPort);
+  }
+}
+
+static benchComponentType* getComponent(const char* cName, const char* cLabel, int nIndex) {
+  benchComponentType* pComp = &appPriv->components[appPriv->nComponents];
+  OMX_ERRORTYPE err;
+
+  memset(pComp, 0, sizeof(benchComponentType));
+  if (nIndex >= 0) {
+    snprintf(pComp->name, sizeof(pComp->name), "%s%i", cLabel, nIndex);
+  } else {
+    snprintf(pComp->name, sizeof(pComp->name), "%s", cLabel);
+  }
+  pComp->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(pComp->eventSem, 0);
+  err = OMX_GetHandle(&pComp->handle, (OMX_STRING)cName, pComp, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "%s OMX_GetHandle failed\n", cName);
+    tsem_deinit(pComp->eventSem);
+    free(pComp->eventSem);
+    return NULL;
+  }
+  appPriv->nComponents++;
+  return pComp;
+}
+
+/** Sends a state change to all the components, then waits for all of
+  * them, as the tunnelled ports change state together
+  */
+static void setState(OMX_STATETYPE eState) {
+  OMX_U32 c;
+
+  for (c = 0; c < appPriv->nComponents; c++) {
+    OMX_SendCommand(appPriv->components[c].handle, OMX_CommandStateSet, eState, NULL);
+  }
+}
+
+static void waitState(void) {
+  OMX_U32 c;
+
+  for (c = 0; c < appPriv->nComponents; c++) {
+    tsem_down(appPriv->components[c].eventSem);
+  }
+}
+
+static void getThreadIDs(void) {
+  OMX_PARAM_BELLAGIOTHREADS_ID sThreads;
+  OMX_INDEXTYPE nIndex;
+  OMX_U32 c;
+
+  for (c = 0; c < appPriv->nComponents; c++) {
+    if (OMX_GetExtensionIndex(appPriv->components[c].handle, "OMX.st.index.param.BellagioThreadsID", &nIndex) != OMX_ErrorNone) {
+      continue;
+    }
+    setHeader(&sThreads, sizeof(OMX_PARAM_BELLAGIOTHREADS_ID));
+    if (OMX_GetParameter(appPriv->components[c].handle, nIndex, &sThreads) == OMX_ErrorNone) {
+      appPriv->components[c].nBufferThread = sThreads.nThreadBufferMngtID;
+      appPriv->components[c].nMessageThread = sThreads.nThreadMessageID;
+    }
+  }
+}
+
+/** Runs one configuration and prints its line of results
+  * @return 0, or -1 if the chain could not be built
+  */
+static int runBench(int bMixer, int bTunnel, OMX_U32 nFillLen, OMX_U32 nCount, OMX_U32 nPorts, OMX_U32 nGain) {
+  static benchThreadTime startTimes[BENCH_MAX_THREADS], endTimes[BENCH_MAX_THREADS];
+  int nStartThreads, nEndThreads;
+  OMX_PORT_PARAM_TYPE sParam;
+  benchComponentType* pVolume[BENCH_MAX_PORTS];
+  benchComponentType* pMixer = NULL;
+  OMX_U32 nStreams = bMixer ? nPorts : 1;
+  OMX_U32 nOutSize, i, j;
+  OMX_ERRORTYPE err;
+  double fSeconds;
+  int result = 0;
+
+  printf("%-7s %-6s %7i %5i %5i %4i ", bMixer ? "mixer" : "volume", bTunnel ? "yes" : "no",
+         (int)nFillLen, (int)nCount, (int)nStreams, (int)nGain);
+  fflush(stdout);
+
+  memset(appPriv->nSent, 0, sizeof(appPriv->nSent));
+  memset(appPriv->inBuffer, 0, sizeof(appPriv->inBuffer));
+  memset(appPriv->outBuffer, 0, sizeof(appPriv->outBuffer));
+  appPriv->nComponents = 0;
+  appPriv->nStreams = nStreams;
+  appPriv->nBufferCount = nCount;
+  appPriv->nFillLen = nFillLen;
+  appPriv->nLatency = 0;
+  appPriv->bStopping = OMX_FALSE;
+
+  /** Build the chain: the streams enter volume components or the mixer inputs */
+  if (bMixer) {
+    pMixer = getComponent(MIXER_NAME, "mixer", -1);
+    if (!pMixer) {
+      return -1;
+    }
+    setHeader(&sParam, sizeof(OMX_PORT_PARAM_TYPE));
+    err = OMX_GetParameter(pMixer->handle, OMX_IndexParamAudioInit, &sParam);
+    sParam.nPorts = nPorts + 1;
+    err = OMX_SetParameter(pMixer->handle, OMX_IndexParamAudioInit, &sParam);
+    if (err != OMX_ErrorNone) {
+      printf("cannot set %i mixer ports\n", (int)nPorts);
+      result = -1;
+      goto teardown;
+    }
+    appPriv->pOutput = pMixer;
+    appPriv->nOutputPort = nPorts;
+    for (i = 0; i < nPorts; i++) {
+      setGain(pMixer, i, nGain);
+      setBufferCount(pMixer, i, nCount);
+      appPriv->pInput[i] = pMixer;
+      appPriv->nInputPort[i] = i;
+      if (bTunnel) {
+        pVolume[i] = getComponent(VOLUME_NAME, "volume", i);
+        if (!pVolume[i]) {
+          result = -1;
+          goto teardown;
+        }
+        /* the volume passes the stream unchanged, the mixer applies the gain */
+        setBufferCount(pVolume[i], 0, nCount);
+        setBufferCount(pVolume[i], 1, nCount);
+        if (OMX_SetupTunnel(pVolume[i]->handle, 1, pMixer->handle, i) != OMX_ErrorNone) {
+          printf("cannot tunnel the volume to the mixer\n");
+          result = -1;
+          goto teardown;
+        }
+        appPriv->pInput[i] = pVolume[i];
+        appPriv->nInputPort[i] = 0;
+      }
+    }
+    setBufferCount(pMixer, nPorts, nCount);
+  } else {
+    pVolume[0] = getComponent(VOLUME_NAME, "volume", bTunnel ? 0 : -1);
+    if (!pVolume[0]) {
+      return -1;
+    }
+    setGain(pVolume[0], 0, nGain);
+    setBufferCount(pVolume[0], 0, nCount);
+    setBufferCount(pVolume[0], 1, nCount);
+    appPriv->pInput[0] = pVolume[0];
+    appPriv->nInputPort[0] = 0;
+    appPriv->pOutput = pVolume[0];
+    appPriv->nOutputPort = 1;
+    if (bTunnel) {
+      pVolume[1] = getComponent(VOLUME_NAME, "volume", 1);
+      if (!pVolume[1]) {
+        result = -1;
+        goto teardown;
+      }
+      setGain(pVolume[1], 0, 100);
+      setBufferCount(pVolume[1], 0, nCount);
+      setBufferCount(pVolume[1], 1, nCount);
+      if (OMX_SetupTunnel(pVolume[0]->handle, 1, pVolume[1]->handle, 0) != OMX_ErrorNone) {
+        printf("cannot tunnel the volumes\n");
+        result = -1;
+        goto teardown;
+      }
+      appPriv->pOutput = pVolume[1];
+    }
+  }
+
+  /* the tunnelled buffers have the size the ports ask for */
+  if (bTunnel && nFillLen > getBufferSize(appPriv->pOutput, appPriv->nOutputPort)) {
+    printf("skipped, the tunnelled buffers hold %i bytes\n", (int)getBufferSize(appPriv->pOutput, appPriv->nOutputPort));
+    goto teardown;
+  }
+
+  setState(OMX_StateIdle);
+  for (i = 0; i < nStreams; i++) {
+    for (j = 0; j < nCount; j++) {
+      err = OMX_AllocateBuffer(appPriv->pInput[i]->handle, &appPriv->inBuffer[i][j], appPriv->nInputPort[i], (OMX_PTR)(long)i,
+                               nFillLen > getBufferSize(appPriv->pInput[i], appPriv->nInputPort[i]) ? nFillLen : getBufferSize(appPriv->pInput[i], appPriv->nInputPort[i]));
+      if (err != OMX_ErrorNone) {
+        DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer %i on stream %i\n", (int)j, (int)i);
+        exit(1);
+      }
+    }
+  }
+  nOutSize = getBufferSize(appPriv->pOutput, appPriv->nOutputPort);
+  for (j = 0; j < nCount; j++) {
+    err = OMX_AllocateBuffer(appPriv->pOutput->handle, &appPriv->outBuffer[j], appPriv->nOutputPort, NULL,
+                             nFillLen > nOutSize ? nFillLen : nOutSize);
+    if (err != OMX_ErrorNone) {
+      DEBUG(DEB_LEV_ERR, "Error on AllocateBuffer %i on the output port\n", (int)j);
+      exit(1);
+    }
+  }
+  waitState();
+
+  setState(OMX_StateExecuting);
+  waitState();
+
+  nStartThreads = readThreadTimes(startTimes);
+  appPriv->nStart = benchNow();
+  appPriv->nEnd = 0;
+  for (j = 0; j < nCount; j++) {
+    OMX_FillThisBuffer(appPriv->pOutput->handle, appPriv->outBuffer[j]);
+  }
+  for (j = 0; j < nCount; j++) {
+    for (i = 0; i < nStreams; i++) {
+      sendInputBuffer(i, appPriv->inBuffer[i][j]);
+    }
+  }
+
+  if (tsem_timed_down(appPriv->eofSem, BENCH_TIMEOUT) != 0) {
+    printf("timed out\n");
+    result = -1;
+  } else {
+    nEndThreads = readThreadTimes(endTimes);
+    getThreadIDs();
+
+    fSeconds = (appPriv->nEnd - appPriv->nStart) / 1e9;
+    qsort(appPriv->pLatency, appPriv->nLatency, sizeof(OMX_U64), compareTimes);
+    printf("%10.2f %9.1f %9.1f %9.1f %9.1f\n",
+           (double)nStreams * appPriv->nBuffersPerStream * nFillLen / sizeof(OMX_S16) / fSeconds / 1e6,
+           percentile(50), percentile(90), percentile(99), percentile(100));
+    printThreadTimes(startTimes, nStartThreads, endTimes, nEndThreads);
+  }
+  appPriv->bStopping = OMX_TRUE;
+
+  setState(OMX_StateIdle);
+  waitState();
+
+  setState(OMX_StateLoaded);
+  for (i = 0; i < nStreams; i++) {
+    for (j = 0; j < nCount; j++) {
+      OMX_FreeBuffer(appPriv->pInput[i]->handle, appPriv->nInputPort[i], appPriv->inBuffer[i][j]);
+    }
+  }
+  for (j = 0; j < nCount; j++) {
+    OMX_FreeBuffer(appPriv->pOutput->handle, appPriv->nOutputPort, appPriv->outBuffer[j]);
+  }
+  waitState();
+
+teardown:
+  for (i = 0; i < appPriv->nComponents; i++) {
+    OMX_FreeHandle(appPriv->components[i].handle);
+    tsem_deinit(appPriv->components[i].eventSem);
+    free(appPriv->components[i].eventSem);
+  }
+  appPriv->nComponents = 0;
+  tsem_reset(appPriv->eofSem);
+  return result;
+}
+
+int main(int argc, char** argv) {
+
+  OMX_U32 sizes[BENCH_MAX_VALUES] = { 4096, 32768 };
+  OMX_U32 counts[BENCH_MAX_VALUES] = { 2, 4 };
+  OMX_U32 ports[BENCH_MAX_VALUES] = { 2, 4 };
+  OMX_U32 gains[BENCH_MAX_VALUES] = { 50, 100 };
+  int nSizes = 2, nCounts = 2, nPorts = 2, nGains = 2;
+  int bVolume = 1, bMixer = 1, bTunnel = 1, bNonTunnel = 1;
+  OMX_U32 nMaxSize = 0;
+  int argn_dec;
+  int m, t, b, c, p, g;
+  OMX_ERRORTYPE err;
+  int i;
+
+  appPriv = calloc(1, sizeof(appPrivateType));
+  appPriv->nBuffersPerStream = 1000;
+  flagVerbose = 0;
+
+  argn_dec = 1;
+  while (argn_dec<argc) {
+    if (*(argv[argn_dec]) !='-') {
+      display_help();
+    }
+    switch (*(argv[argn_dec]+1)) {
+    case 'm':
+      if (++argn_dec >= argc) {
+        display_help();
+      }
+      bVolume = !strcmp(argv[argn_dec], "volume");
+      bMixer = !strcmp(argv[argn_dec], "mixer");
+      break;
+    case 't':
+      bNonTunnel = 0;
+      break;
+    case 'u':
+      bTunnel = 0;
+      break;
+    case 'b':
+    case 'c':
+    case 'p':
+    case 'g':
+    case 'l':
+      if (++argn_dec >= argc) {
+        display_help();
+      }
+      switch (*(argv[argn_dec-1]+1)) {
+      case 'b':
+        nSizes = parseList(argv[argn_dec], sizes);
+        break;
+      case 'c':
+        nCounts = parseList(argv[argn_dec], counts);
+        break;
+      case 'p':
+        nPorts = parseList(argv[argn_dec], ports);
+        break;
+      case 'g':
+        nGains = parseList(argv[argn_dec], gains);
+        break;
+      default:
+        appPriv->nBuffersPerStream = atoi(argv[argn_dec]);
+        break;
+      }
+      break;
+    case 'v':
+      flagVerbose = 1;
+      break;
+    default:
+      display_help();
+    }
+    argn_dec++;
+  }
+  if ((!bVolume && !bMixer) || (!bTunnel && !bNonTunnel) || appPriv->nBuffersPerStream == 0) {
+    display_help();
+  }
+  for (i = 0; i < nSizes; i++) {
+    /* whole stereo frames */
+    sizes[i] &= ~3;
+    if (sizes[i] == 0) {
+      display_help();
+    }
+    nMaxSize = sizes[i] > nMaxSize ? sizes[i] : nMaxSize;
+  }
+  for (i = 0; i < nCounts; i++) {
+    if (counts[i] == 0 || counts[i] > BENCH_MAX_BUFFERS) {
+      display_help();
+    }
+  }
+  for (i = 0; i < nPorts; i++) {
+    if (ports[i] == 0 || ports[i] > BENCH_MAX_PORTS) {
+      display_help();
+    }
+  }
+
+  /* a 16 bit stereo tone, different on each channel */
+  pcmPattern = malloc(nMaxSize);
+  for (i = 0; i < nMaxSize / sizeof(OMX_S16); i++) {
+    pcmPattern[i] = (OMX_S16)((i & 1) ? ((i * 797) & 0x3fff) - 0x2000 : ((i * 331) & 0x7fff) - 0x4000);
+  }
+
+  pthread_mutex_init(&appPriv->mutex, NULL);
+  appPriv->eofSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eofSem, 0);
+  /* the output buffers of a run, bounded by the input buffers each one carries */
+  appPriv->nLatencySize = BENCH_MAX_PORTS * appPriv->nBuffersPerStream + BENCH_MAX_BUFFERS;
+  appPriv->pLatency = malloc(appPriv->nLatencySize * sizeof(OMX_U64));
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+
+  printf("%-7s %-6s %7s %5s %5s %4s %10s %9s %9s %9s %9s\n", "comp", "tunnel", "bytes", "count", "ports", "gain",
+         "Msample/s", "p50 us", "p90 us", "p99 us", "max us");
+  for (m = 0; m < 2; m++) {
+    if ((m == 0 && !bVolume) || (m == 1 && !bMixer)) {
+      continue;
+    }
+    for (t = 0; t < 2; t++) {
+      if ((t == 0 && !bNonTunnel) || (t == 1 && !bTunnel)) {
+        continue;
+      }
+      for (b = 0; b < nSizes; b++) {
+        for (c = 0; c < nCounts; c++) {
+          for (p = 0; p < (m ? nPorts : 1); p++) {
+            for (g = 0; g < nGains; g++) {
+              runBench(m, t, sizes[b], counts[c], ports[p], gains[g]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  OMX_Deinit();
+
+  tsem_deinit(appPriv->eofSem);
+  free(appPriv->eofSem);
+  free(appPriv->pLatency);
+  free(appPriv);
+  free(pcmPattern);
+
+  return 0;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE benchEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  benchComponentType* pComp = (benchComponentType*)pAppData;
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback of %s\n", __func__, pComp->name);
+  if(eEvent == OMX_EventCmdComplete) {
+    if (Data1 == OMX_CommandStateSet) {
+      tsem_up(pComp->eventSem);
+    }
+  } else if(eEvent == OMX_EventBufferFlag) {
+    /* the run ends when the output has carried the end of every stream */
+    if((int)Data2 == OMX_BUFFERFLAG_EOS && pComp == appPriv->pOutput) {
+      pComp->nEOS++;
+      if (pComp->nEOS == appPriv->nStreams) {
+        appPriv->nEnd = benchNow();
+        tsem_up(appPriv->eofSem);
+      }
+    }
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "Error %08x from %s\n", (int)Data1, pComp->name);
+  }
+
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE benchEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback from the port %i\n", __func__, (int)pBuffer->nInputPortIndex);
+  sendInputBuffer((OMX_U32)(long)pBuffer->pAppPrivate, pBuffer);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE benchFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  OMX_U64 nNow = benchNow();
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback. Got buflen %i for buffer at 0x%p\n",
+                          __func__, (int)pBuffer->nFilledLen, pBuffer);
+
+  /* the output buffer carries the time stamp of the input buffer of its first sample */
+  if (pBuffer->nFilledLen > 0 && appPriv->nLatency < appPriv->nLatencySize && !appPriv->bStopping) {
+    appPriv->pLatency[appPriv->nLatency++] = nNow - (OMX_U64)pBuffer->nTimeStamp;
+  }
+  pBuffer->nFilledLen = 0;
+  pBuffer->nFlags = 0;
+  if (!appPriv->bStopping) {
+    OMX_FillThisBuffer(hComponent, pBuffer);
+  }
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,128 @@
+/**
+  test/components/audio_effects/omxaudioeffectsbench.h
+
+  This benchmark application drives the volume and the audio mixer
+  components with synthetic PCM held in memory, as fast as they accept it.
+  It measures the throughput, the latency of the buffers and the CPU time
+  of each thread, for a range of buffer sizes, buffer counts, port counts
+  and gains, with and without tunnels.
+
+  Copyright (C) 2008-2009 STMicroelectronics
+  Copyright (C) 2008-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXAUDIOEFFECTSBENCH_H__
+#define __OMXAUDIOEFFECTSBENCH_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <time.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/extension_struct.h>
+#include <user_debug_levels.h>
+
+/** Specification version*/
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    1
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** Maximum number of input streams, one per mixer input port */
+#define BENCH_MAX_PORTS 16
+/** Maximum number of buffers on a port */
+#define BENCH_MAX_BUFFERS 16
+/** Maximum number of values of a list option */
+#define BENCH_MAX_VALUES 8
+/** Maximum number of threads whose CPU time is measured */
+#define BENCH_MAX_THREADS 256
+/** Time given to a run before it is abandoned, in milliseconds */
+#define BENCH_TIMEOUT 60000
+
+/* A component of the chain under test. It is the application data of its callbacks */
+typedef struct benchComponentType {
+  OMX_HANDLETYPE handle;
+  char name[16];
+  tsem_t* eventSem;
+  OMX_U32 nEOS;           /* EOS events received from the component */
+  long nBufferThread;     /* Thread IDs reported by the component, labelling the CPU times */
+  long nMessageThread;
+} benchComponentType;
+
+/* CPU time of a thread */
+typedef struct benchThreadTime {
+  long tid;
+  OMX_U64 nTime;          /* nanoseconds */
+} benchThreadTime;
+
+/* Application's private data */
+typedef struct appPrivateType{
+  pthread_mutex_t mutex;
+  tsem_t* eofSem;
+  benchComponentType components[BENCH_MAX_PORTS + 1];
+  OMX_U32 nComponents;
+  benchComponentType* pInput[BENCH_MAX_PORTS];   /* component and port receiving each stream */
+  OMX_U32 nInputPort[BENCH_MAX_PORTS];
+  benchComponentType* pOutput;                   /* component and port delivering the output */
+  OMX_U32 nOutputPort;
+  OMX_BUFFERHEADERTYPE* inBuffer[BENCH_MAX_PORTS][BENCH_MAX_BUFFERS];
+  OMX_BUFFERHEADERTYPE* outBuffer[BENCH_MAX_BUFFERS];
+  OMX_U32 nStreams;
+  OMX_U32 nBufferCount;
+  OMX_U32 nFillLen;       /* bytes sent in each input buffer */
+  OMX_U32 nBuffersPerStream;
+  OMX_U32 nSent[BENCH_MAX_PORTS];
+  volatile OMX_BOOL bStopping;
+  OMX_U64* pLatency;      /* EmptyThisBuffer to FillBufferDone, in nanoseconds */
+  OMX_U32 nLatency;
+  OMX_U32 nLatencySize;
+  OMX_U64 nStart;
+  OMX_U64 nEnd;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE benchEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE benchEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE benchFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,300 @@
+/**
+  test/components/audio_effects/omxconvertertest.c
+
+  This test application checks the round trips of the audio converter component:
+  the channel matrix read back as it was set, and a stream converted to another
+  layout and back unchanged.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxconvertertest.h"
+
+/* Application private date: should go in the component field (segs...) */
+appPrivateType* appPriv;
+OMX_HANDLETYPE handle;
+OMX_INDEXTYPE matrixIndex;
+int nFailures = 0;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = convEventHandler,
+                               .EmptyBufferDone = convEmptyBufferDone,
+                               .FillBufferDone = convFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+static void check(int bPassed, const char* cWhat) {
+  DEBUG(DEFAULT_MESSAGES, "%s: %s\n", bPassed ? "passed" : "FAILED", cWhat);
+  if (!bPassed) {
+    nFailures++;
+  }
+}
+
+/** Sets the PCM layout of a port, keeping its channels and rate,
+  * and checks that it is read back as it was set
+  */
+static void setLayout(OMX_U32 nPort, OMX_BOOL bFloat, OMX_BOOL bInterleaved) {
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcm, sRead;
+  OMX_ERRORTYPE err;
+
+  setHeader(&sPcm, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sPcm.nPortIndex = nPort;
+  OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sPcm);
+  sPcm.ePCMMode = bFloat ? OMX_AUDIO_PCMModeBellagioFloat : OMX_AUDIO_PCMModeLinear;
+  sPcm.nBitPerSample = bFloat ? 32 : 16;
+  sPcm.bInterleaved = bInterleaved;
+  err = OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm);
+  check(err == OMX_ErrorNone, "set the PCM layout");
+
+  setHeader(&sRead, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sRead.nPortIndex = nPort;
+  OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sRead);
+  check(sRead.ePCMMode == sPcm.ePCMMode && sRead.nBitPerSample == sPcm.nBitPerSample &&
+        sRead.bInterleaved == sPcm.bInterleaved && sRead.nChannels == sPcm.nChannels,
+        "PCM layout read back as set");
+}
+
+/** Sets the channel matrix of the stereo ports, 0 restoring the one
+  * derived from the channel mappings
+  */
+static OMX_ERRORTYPE setMatrix(OMX_U32 nInChannels, OMX_U32 nOutChannels, const OMX_S32* pCoeffs) {
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sMatrix;
+
+  memset(&sMatrix, 0, sizeof(sMatrix));
+  setHeader(&sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+  sMatrix.nPortIndex = 1;
+  sMatrix.nInChannels = nInChannels;
+  sMatrix.nOutChannels = nOutChannels;
+  if (pCoeffs) {
+    memcpy(sMatrix.xCoeffs, pCoeffs, nInChannels * nOutChannels * sizeof(OMX_S32));
+  }
+  return OMX_SetConfig(handle, matrixIndex, &sMatrix);
+}
+
+static int matrixIs(const OMX_S32* pCoeffs) {
+  OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE sMatrix;
+  int i;
+
+  setHeader(&sMatrix, sizeof(OMX_CONFIG_BELLAGIOCHANNELMATRIXTYPE));
+  sMatrix.nPortIndex = 1;
+  if (OMX_GetConfig(handle, matrixIndex, &sMatrix) != OMX_ErrorNone || sMatrix.nInChannels != 2 || sMatrix.nOutChannels != 2) {
+    return 0;
+  }
+  for (i = 0; i < 4; i++) {
+    if (sMatrix.xCoeffs[i] != pCoeffs[i]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/** Converts nChunks input buffers of nInLen bytes, one at a time, each
+  * into one output buffer. Returns the length of the output buffers
+  */
+static OMX_U32 convert(OMX_U8* pIn, OMX_U32 nInLen, OMX_U32 nChunks, OMX_U8* pOut) {
+  OMX_BUFFERHEADERTYPE *inBuffer[CONVERTER_TEST_MAX_BUFFERS], *outBuffer[CONVERTER_TEST_MAX_BUFFERS];
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_U32 nInCount, nOutCount, nOutLen = 0, i;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = 0;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nInCount = sPortDef.nBufferCountActual;
+  sPortDef.nPortIndex = 1;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nOutCount = sPortDef.nBufferCountActual;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_AllocateBuffer(handle, &inBuffer[i], 0, NULL, sPortDef.nBufferSize);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_AllocateBuffer(handle, &outBuffer[i], 1, NULL, sPortDef.nBufferSize);
+  }
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+
+  for (i = 0; i < nChunks; i++) {
+    memcpy(inBuffer[0]->pBuffer, pIn + i * nInLen, nInLen);
+    inBuffer[0]->nFilledLen = nInLen;
+    inBuffer[0]->nOffset = 0;
+    outBuffer[0]->nFilledLen = 0;
+    OMX_FillThisBuffer(handle, outBuffer[0]);
+    OMX_EmptyThisBuffer(handle, inBuffer[0]);
+    tsem_down(appPriv->fillSem);
+    tsem_down(appPriv->emptySem);
+    nOutLen = outBuffer[0]->nFilledLen;
+    memcpy(pOut + i * nOutLen, outBuffer[0]->pBuffer + outBuffer[0]->nOffset, nOutLen);
+  }
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_FreeBuffer(handle, 0, inBuffer[i]);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_FreeBuffer(handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+  return nOutLen;
+}
+
+int main(int argc, char** argv) {
+  static const OMX_S32 xIdentity[4] = { 65536, 0, 0, 65536 };
+  static const OMX_S32 xSwap[4] = { 0, 65536, 65536, 0 };
+  OMX_S16 *pStream, *pBack;
+  float* pPlanes;
+  OMX_U32 nChunks = CONVERTER_TEST_FRAMES / CONVERTER_TEST_CHUNK;
+  OMX_U32 nLen, i, k;
+  OMX_ERRORTYPE err;
+  int bSame;
+
+  appPriv = malloc(sizeof(appPrivateType));
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->emptySem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->emptySem, 0);
+  appPriv->fillSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->fillSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  /** Ask the core for a handle to the audio converter component
+    */
+  err = OMX_GetHandle(&handle, "OMX.st.audio.converter", NULL /*appPriv */, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    exit(1);
+  }
+  err = OMX_GetExtensionIndex(handle, "OMX.st.index.config.BellagioChannelMatrix", &matrixIndex);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetExtensionIndex failed\n");
+    exit(1);
+  }
+
+  /* the matrix path: read back as set, rejected for other channels, restored */
+  check(matrixIs(xIdentity), "stereo to stereo matrix derived from the channel mappings");
+  check(setMatrix(2, 2, xSwap) == OMX_ErrorNone && matrixIs(xSwap), "channel matrix read back as set");
+  check(setMatrix(3, 2, NULL) == OMX_ErrorBadParameter && matrixIs(xSwap), "matrix for other channels rejected");
+
+  /* a stereo ramp, the right channel counting down */
+  pStream = malloc(CONVERTER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+  pBack = malloc(CONVERTER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+  pPlanes = malloc(CONVERTER_TEST_FRAMES * 2 * sizeof(float));
+  for (k = 0; k < CONVERTER_TEST_FRAMES; k++) {
+    pStream[2 * k] = (OMX_S16)(k * 8 - 32768);
+    pStream[2 * k + 1] = (OMX_S16)(32767 - k * 8);
+  }
+
+  /* the layout path: S16 interleaved to planar float with the channels swapped */
+  setLayout(1, OMX_TRUE, OMX_FALSE);
+  check(matrixIs(xSwap), "matrix kept by a layout with the same channels");
+  nLen = convert((OMX_U8*)pStream, CONVERTER_TEST_CHUNK * 2 * sizeof(OMX_S16), nChunks, (OMX_U8*)pPlanes);
+  check(nLen == CONVERTER_TEST_CHUNK * 2 * sizeof(float), "planar float buffer length");
+  bSame = 1;
+  for (i = 0; i < nChunks && bSame; i++) {
+    for (k = 0; k < CONVERTER_TEST_CHUNK; k++) {
+      if (pPlanes[i * 2 * CONVERTER_TEST_CHUNK + k] != pStream[2 * (i * CONVERTER_TEST_CHUNK + k) + 1] / 32768.0f ||
+          pPlanes[i * 2 * CONVERTER_TEST_CHUNK + CONVERTER_TEST_CHUNK + k] != pStream[2 * (i * CONVERTER_TEST_CHUNK + k)] / 32768.0f) {
+        bSame = 0;
+        break;
+      }
+    }
+  }
+  check(bSame, "planar float planes hold the swapped channels");
+
+  /* and back: planar float to S16 interleaved, swapping the channels again */
+  setLayout(0, OMX_TRUE, OMX_FALSE);
+  setLayout(1, OMX_FALSE, OMX_TRUE);
+  nLen = convert((OMX_U8*)pPlanes, CONVERTER_TEST_CHUNK * 2 * sizeof(float), nChunks, (OMX_U8*)pBack);
+  check(nLen == CONVERTER_TEST_CHUNK * 2 * sizeof(OMX_S16), "S16 interleaved buffer length");
+  check(!memcmp(pStream, pBack, CONVERTER_TEST_FRAMES * 2 * sizeof(OMX_S16)), "stream unchanged by the round trip");
+
+  check(setMatrix(0, 0, NULL) == OMX_ErrorNone && matrixIs(xIdentity), "matrix derived from the channel mappings restored");
+
+  OMX_FreeHandle(handle);
+  OMX_Deinit();
+
+  free(pStream);
+  free(pBack);
+  free(pPlanes);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  tsem_deinit(appPriv->emptySem);
+  free(appPriv->emptySem);
+  tsem_deinit(appPriv->fillSem);
+  free(appPriv->fillSem);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%i checks failed\n", nFailures);
+  return nFailures ? 1 : 0;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE convEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    tsem_up(appPriv->eventSem);
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "In %s error %x\n", __func__, (int)Data1);
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE convEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback.\n", __func__);
+  tsem_up(appPriv->emptySem);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE convFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback. Got buflen %i for buffer at 0x%p\n",
+                          __func__, (int)pBuffer->nFilledLen, pBuffer);
+  tsem_up(appPriv->fillSem);
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,84 @@
+/**
+  test/components/audio_effects/omxconvertertest.h
+
+  This test application checks the round trips of the audio converter component:
+  the channel matrix read back as it was set, and a stream converted to another
+  layout and back unchanged.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXCONVERTERTEST_H__
+#define __OMXCONVERTERTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/extension_struct.h>
+#include <user_debug_levels.h>
+
+/** Specification version*/
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    1
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** Maximum number of buffers on a port */
+#define CONVERTER_TEST_MAX_BUFFERS 16
+/** Frames of the test stream */
+#define CONVERTER_TEST_FRAMES 8192
+/** Frames sent in each input buffer, an output buffer takes all of them */
+#define CONVERTER_TEST_CHUNK 1024
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* emptySem;
+  tsem_t* fillSem;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE convEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE convEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE convFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
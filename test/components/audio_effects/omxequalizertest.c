@@ -0,0 +1,327 @@
+/**
+  test/components/audio_effects/omxequalizertest.c
+
+  This test application checks the audio equalizer component: the samples pass
+  bit-exact without a band, and a band set or changed in the middle of a stream
+  is cross-faded in without a glitch.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxequalizertest.h"
+
+/* Application private date: should go in the component field (segs...) */
+appPrivateType* appPriv;
+OMX_HANDLETYPE handle;
+OMX_INDEXTYPE equalizerIndex;
+OMX_BUFFERHEADERTYPE *inBuffer[EQUALIZER_TEST_MAX_BUFFERS], *outBuffer[EQUALIZER_TEST_MAX_BUFFERS];
+OMX_U32 nInCount, nOutCount;
+int nFailures = 0;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = eqEventHandler,
+                               .EmptyBufferDone = eqEmptyBufferDone,
+                               .FillBufferDone = eqFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+static void check(int bPassed, const char* cWhat) {
+  DEBUG(DEFAULT_MESSAGES, "%s: %s\n", bPassed ? "passed" : "FAILED", cWhat);
+  if (!bPassed) {
+    nFailures++;
+  }
+}
+
+/** Sets a single peaking band of nGain millibels at the frequency of the
+  * test sine, or no band if nGain is 0
+  */
+static void setBand(OMX_S32 nGain) {
+  OMX_CONFIG_BELLAGIOEQUALIZERTYPE sEqualizer;
+
+  memset(&sEqualizer, 0, sizeof(sEqualizer));
+  setHeader(&sEqualizer, sizeof(OMX_CONFIG_BELLAGIOEQUALIZERTYPE));
+  sEqualizer.nPortIndex = 0;
+  if (nGain != 0) {
+    sEqualizer.nBands = 1;
+    sEqualizer.sBands[0].eFilter = OMX_BellagioEqPeaking;
+    sEqualizer.sBands[0].nFrequency = EQUALIZER_TEST_FREQUENCY;
+    sEqualizer.sBands[0].xQ = 65536;
+    sEqualizer.sBands[0].nGain = nGain;
+  }
+  check(OMX_SetConfig(handle, equalizerIndex, &sEqualizer) == OMX_ErrorNone, "set the bands");
+}
+
+/** Brings the component to Executing with its buffers allocated */
+static void start(void) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_U32 i;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = 0;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nInCount = sPortDef.nBufferCountActual;
+  sPortDef.nPortIndex = 1;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nOutCount = sPortDef.nBufferCountActual;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_AllocateBuffer(handle, &inBuffer[i], 0, NULL, sPortDef.nBufferSize);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_AllocateBuffer(handle, &outBuffer[i], 1, NULL, sPortDef.nBufferSize);
+  }
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+}
+
+/** Brings the component back to Loaded, freeing its buffers */
+static void stop(void) {
+  OMX_U32 i;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_FreeBuffer(handle, 0, inBuffer[i]);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_FreeBuffer(handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+}
+
+/** Disables a port in Executing, freeing its buffers */
+static void disablePort(OMX_U32 nPort) {
+  OMX_U32 i;
+
+  OMX_SendCommand(handle, OMX_CommandPortDisable, nPort, NULL);
+  if (nPort == 0) {
+    for (i = 0; i < nInCount; i++) {
+      OMX_FreeBuffer(handle, 0, inBuffer[i]);
+    }
+    nInCount = 0;
+  } else {
+    for (i = 0; i < nOutCount; i++) {
+      OMX_FreeBuffer(handle, 1, outBuffer[i]);
+    }
+    nOutCount = 0;
+  }
+  tsem_down(appPriv->eventSem);
+}
+
+/** Sends nChunks input buffers, one at a time, and copies the output
+  * buffers they give. The equalizer passes the buffers in place, so the
+  * memory of each header is read again from it
+  */
+static OMX_U32 equalize(OMX_S16* pIn, OMX_U32 nChunks, OMX_S16* pOut) {
+  OMX_U32 nLen = EQUALIZER_TEST_CHUNK * 2 * sizeof(OMX_S16);
+  OMX_U32 nOutLen = 0, i;
+
+  for (i = 0; i < nChunks; i++) {
+    memcpy(inBuffer[0]->pBuffer, pIn + i * EQUALIZER_TEST_CHUNK * 2, nLen);
+    inBuffer[0]->nFilledLen = nLen;
+    inBuffer[0]->nOffset = 0;
+    outBuffer[0]->nFilledLen = 0;
+    OMX_FillThisBuffer(handle, outBuffer[0]);
+    OMX_EmptyThisBuffer(handle, inBuffer[0]);
+    tsem_down(appPriv->fillSem);
+    tsem_down(appPriv->emptySem);
+    memcpy((OMX_U8*)pOut + nOutLen, outBuffer[0]->pBuffer + outBuffer[0]->nOffset, outBuffer[0]->nFilledLen);
+    nOutLen += outBuffer[0]->nFilledLen;
+  }
+  return nOutLen;
+}
+
+/** Returns the peak of the left channel over nFrames frames */
+static double peakOf(const OMX_S16* pSamples, OMX_U32 nFrames) {
+  double fPeak = 0.0;
+  OMX_U32 k;
+
+  for (k = 0; k < nFrames; k++) {
+    if (fabs(pSamples[2 * k] / 32768.0) > fPeak) {
+      fPeak = fabs(pSamples[2 * k] / 32768.0);
+    }
+  }
+  return fPeak;
+}
+
+int main(int argc, char** argv) {
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcm;
+  OMX_S16 *pStream, *pOut;
+  OMX_U32 nThird = EQUALIZER_TEST_CHUNKS / 3, nSettled = EQUALIZER_TEST_CHUNK * nThird / 2;
+  OMX_U32 nLen = EQUALIZER_TEST_CHUNK * 2 * sizeof(OMX_S16);
+  OMX_U32 nSeed = 1, k;
+  double fW = 2.0 * M_PI * EQUALIZER_TEST_FREQUENCY / EQUALIZER_TEST_RATE;
+  double fBoost = pow(10.0, 600 / 2000.0), fMaxStep = 0.0, fStep, fBound;
+  OMX_ERRORTYPE err;
+
+  appPriv = malloc(sizeof(appPrivateType));
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->emptySem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->emptySem, 0);
+  appPriv->fillSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->fillSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  /** Ask the core for a handle to the audio equalizer component
+    */
+  err = OMX_GetHandle(&handle, "OMX.st.audio.equalizer", NULL /*appPriv */, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    exit(1);
+  }
+  err = OMX_GetExtensionIndex(handle, "OMX.st.index.config.BellagioEqualizer", &equalizerIndex);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetExtensionIndex failed\n");
+    exit(1);
+  }
+
+  pStream = malloc(EQUALIZER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+  pOut = malloc(EQUALIZER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+
+  setHeader(&sPcm, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sPcm.nPortIndex = 0;
+  OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sPcm);
+  sPcm.nSamplingRate = EQUALIZER_TEST_RATE;
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorNone, "set the sampling rate");
+  start();
+
+  /* noise over the whole scale goes through a flat equalizer untouched */
+  for (k = 0; k < EQUALIZER_TEST_FRAMES * 2; k++) {
+    nSeed = nSeed * 1103515245 + 12345;
+    pStream[k] = (OMX_S16)(nSeed >> 16);
+  }
+  check(equalize(pStream, nThird, pOut) == nThird * nLen && !memcmp(pStream, pOut, nThird * nLen),
+        "bit-exact without a band");
+
+  /* a sine boosted, then cut, by a band at its frequency */
+  for (k = 0; k < EQUALIZER_TEST_FRAMES; k++) {
+    pStream[2 * k] = (OMX_S16)floor(EQUALIZER_TEST_AMPLITUDE * 32768.0 * sin(fW * k) + 0.5);
+    pStream[2 * k + 1] = pStream[2 * k];
+  }
+  equalize(pStream, nThird, pOut);
+  setBand(600);
+  equalize(pStream + nThird * EQUALIZER_TEST_CHUNK * 2, nThird, pOut + nThird * EQUALIZER_TEST_CHUNK * 2);
+  setBand(-600);
+  equalize(pStream + 2 * nThird * EQUALIZER_TEST_CHUNK * 2, nThird, pOut + 2 * nThird * EQUALIZER_TEST_CHUNK * 2);
+
+  check(!memcmp(pStream, pOut, nThird * nLen), "bit-exact before the band is set");
+  check(fabs(peakOf(pOut + (2 * nThird * EQUALIZER_TEST_CHUNK - nSettled) * 2, nSettled) - EQUALIZER_TEST_AMPLITUDE * fBoost) < 0.01,
+        "sine boosted by the band");
+  check(fabs(peakOf(pOut + (3 * nThird * EQUALIZER_TEST_CHUNK - nSettled) * 2, nSettled) - EQUALIZER_TEST_AMPLITUDE / fBoost) < 0.01,
+        "sine cut by the changed band");
+
+  /* a glitch is a step in the output: the second difference of the sine
+   * at its highest level bounds it, with a margin for the cross-fades */
+  fBound = 2.0 * EQUALIZER_TEST_AMPLITUDE * fBoost * fW * fW;
+  for (k = 2; k < EQUALIZER_TEST_FRAMES; k++) {
+    fStep = fabs(pOut[2 * k] - 2.0 * pOut[2 * (k - 1)] + pOut[2 * (k - 2)]) / 32768.0;
+    if (fStep > fMaxStep) {
+      fMaxStep = fStep;
+    }
+  }
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "largest second difference %f, bound %f\n", fMaxStep, fBound);
+  check(fMaxStep < fBound, "band set and changed without a glitch");
+
+  /* removing the band fades it out, then the samples pass untouched again */
+  setBand(0);
+  equalize(pStream, nThird, pOut);
+  check(!memcmp(pStream + EQUALIZER_TEST_CHUNK * 2, pOut + EQUALIZER_TEST_CHUNK * 2, (nThird - 1) * nLen),
+        "bit-exact again once the band is removed");
+
+  /* the layout applies to both ports and the bands are designed for it,
+   * it cannot change while either of them runs */
+  disablePort(0);
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorIncorrectStateOperation,
+        "PCM layout rejected while the other port is enabled");
+  disablePort(1);
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorNone, "PCM layout set with both ports disabled");
+
+  stop();
+  OMX_FreeHandle(handle);
+  OMX_Deinit();
+
+  free(pStream);
+  free(pOut);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  tsem_deinit(appPriv->emptySem);
+  free(appPriv->emptySem);
+  tsem_deinit(appPriv->fillSem);
+  free(appPriv->fillSem);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%i checks failed\n", nFailures);
+  return nFailures ? 1 : 0;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE eqEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    tsem_up(appPriv->eventSem);
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "In %s error %x\n", __func__, (int)Data1);
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE eqEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback.\n", __func__);
+  tsem_up(appPriv->emptySem);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE eqFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback. Got buflen %i for buffer at 0x%p\n",
+                          __func__, (int)pBuffer->nFilledLen, pBuffer);
+  tsem_up(appPriv->fillSem);
+  return OMX_ErrorNone;
+}
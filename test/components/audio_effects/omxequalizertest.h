@@ -0,0 +1,91 @@
+/**
+  test/components/audio_effects/omxequalizertest.h
+
+  This test application checks the audio equalizer component: the samples pass
+  bit-exact without a band, and a band set or changed in the middle of a stream
+  is cross-faded in without a glitch.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXEQUALIZERTEST_H__
+#define __OMXEQUALIZERTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/extension_struct.h>
+#include <user_debug_levels.h>
+
+/** Specification version*/
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    1
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** Maximum number of buffers on a port */
+#define EQUALIZER_TEST_MAX_BUFFERS 16
+/** Sampling rate of the test stream */
+#define EQUALIZER_TEST_RATE 48000
+/** Frames sent in each input buffer */
+#define EQUALIZER_TEST_CHUNK 1024
+/** Input buffers of the test stream, the bands change after each third of them */
+#define EQUALIZER_TEST_CHUNKS 48
+#define EQUALIZER_TEST_FRAMES (EQUALIZER_TEST_CHUNK * EQUALIZER_TEST_CHUNKS)
+/** Frequency and amplitude of the sine of the test stream */
+#define EQUALIZER_TEST_FREQUENCY 1000
+#define EQUALIZER_TEST_AMPLITUDE 0.25
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* emptySem;
+  tsem_t* fillSem;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE eqEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE eqEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE eqFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
@@ -0,0 +1,317 @@
+/**
+  test/components/audio_effects/omxmetertest.c
+
+  This test application checks the levels measured by the audio meter component
+  on a known signal: the peak, the RMS and the clips of the windows, the last
+  window published at the end of the stream, and the throttling of the events.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxmetertest.h"
+
+/* Application private date: should go in the component field (segs...) */
+appPrivateType* appPriv;
+OMX_HANDLETYPE handle;
+OMX_INDEXTYPE levelsIndex;
+OMX_BUFFERHEADERTYPE *inBuffer[METER_TEST_MAX_BUFFERS], *outBuffer[METER_TEST_MAX_BUFFERS];
+OMX_U32 nInCount, nOutCount;
+OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE sEvents[METER_TEST_MAX_EVENTS];
+int nEvents = 0;
+int nFailures = 0;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = meterEventHandler,
+                               .EmptyBufferDone = meterEmptyBufferDone,
+                               .FillBufferDone = meterFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+static void check(int bPassed, const char* cWhat) {
+  DEBUG(DEFAULT_MESSAGES, "%s: %s\n", bPassed ? "passed" : "FAILED", cWhat);
+  if (!bPassed) {
+    nFailures++;
+  }
+}
+
+/** Sets the window and the event interval of the meter */
+static void setLevels(OMX_U32 nWindowMs, OMX_U32 nEventIntervalMs) {
+  OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE sLevels;
+
+  memset(&sLevels, 0, sizeof(sLevels));
+  setHeader(&sLevels, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE));
+  sLevels.nPortIndex = 0;
+  sLevels.nWindowMs = nWindowMs;
+  sLevels.nEventIntervalMs = nEventIntervalMs;
+  check(OMX_SetConfig(handle, levelsIndex, &sLevels) == OMX_ErrorNone, "set the window and the event interval");
+}
+
+/** Checks the levels of a window of nFrames frames of the test signal:
+  * the left channel a square wave at half the full scale, the right one
+  * silent but for three samples at the top of the scale and two at the bottom
+  */
+static int levelsAre(const OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE* pLevels, OMX_U32 nFrames) {
+  double fTop = 32767.0 / 32768.0;
+  OMX_U32 nRms = (OMX_U32)(sqrt((3 * fTop * fTop + 2) / nFrames) * 65536.0 + 0.5);
+
+  return pLevels->nChannels == 2 && pLevels->nFrames == nFrames &&
+         pLevels->nPeak[0] == 32768 && pLevels->nRms[0] >= 32767 && pLevels->nRms[0] <= 32769 && pLevels->nClips[0] == 0 &&
+         pLevels->nPeak[1] == 65536 && pLevels->nRms[1] + 2 >= nRms && pLevels->nRms[1] <= nRms + 2 && pLevels->nClips[1] == 5;
+}
+
+/** Brings the component to Executing with its buffers allocated */
+static void start(void) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_U32 i;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = 0;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nInCount = sPortDef.nBufferCountActual;
+  sPortDef.nPortIndex = 1;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nOutCount = sPortDef.nBufferCountActual;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_AllocateBuffer(handle, &inBuffer[i], 0, NULL, sPortDef.nBufferSize);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_AllocateBuffer(handle, &outBuffer[i], 1, NULL, sPortDef.nBufferSize);
+  }
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+}
+
+/** Brings the component back to Loaded, freeing its buffers */
+static void stop(void) {
+  OMX_U32 i;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_FreeBuffer(handle, 0, inBuffer[i]);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_FreeBuffer(handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+}
+
+/** Disables a port in Executing, freeing its buffers */
+static void disablePort(OMX_U32 nPort) {
+  OMX_U32 i;
+
+  OMX_SendCommand(handle, OMX_CommandPortDisable, nPort, NULL);
+  if (nPort == 0) {
+    for (i = 0; i < nInCount; i++) {
+      OMX_FreeBuffer(handle, 0, inBuffer[i]);
+    }
+    nInCount = 0;
+  } else {
+    for (i = 0; i < nOutCount; i++) {
+      OMX_FreeBuffer(handle, 1, outBuffer[i]);
+    }
+    nOutCount = 0;
+  }
+  tsem_down(appPriv->eventSem);
+}
+
+/** Sends one input buffer of nInLen bytes with the given flags and copies
+  * the output buffer it gives. The meter passes the buffers in place, so
+  * the memory of each header is read again from it
+  */
+static OMX_U32 process(OMX_U8* pIn, OMX_U32 nInLen, OMX_U32 nFlags, OMX_U8* pOut) {
+  if (nInLen > 0) {
+    memcpy(inBuffer[0]->pBuffer, pIn, nInLen);
+  }
+  inBuffer[0]->nFilledLen = nInLen;
+  inBuffer[0]->nOffset = 0;
+  inBuffer[0]->nFlags = nFlags;
+  outBuffer[0]->nFilledLen = 0;
+  outBuffer[0]->nFlags = 0;
+  OMX_FillThisBuffer(handle, outBuffer[0]);
+  OMX_EmptyThisBuffer(handle, inBuffer[0]);
+  tsem_down(appPriv->fillSem);
+  tsem_down(appPriv->emptySem);
+  memcpy(pOut, outBuffer[0]->pBuffer + outBuffer[0]->nOffset, outBuffer[0]->nFilledLen);
+  return outBuffer[0]->nFilledLen;
+}
+
+/** Sends the stream in buffers across the windows, then an empty EOS buffer.
+  * Returns whether the samples went through unchanged
+  */
+static int measure(OMX_S16* pStream, OMX_S16* pOut) {
+  OMX_U32 nLen = METER_TEST_CHUNK * 2 * sizeof(OMX_S16);
+  OMX_U32 nOutLen = 0, i;
+
+  for (i = 0; i < METER_TEST_FRAMES; i += METER_TEST_CHUNK) {
+    nOutLen += process((OMX_U8*)(pStream + 2 * i), nLen, 0, (OMX_U8*)pOut + nOutLen);
+  }
+  nOutLen += process(NULL, 0, OMX_BUFFERFLAG_EOS, (OMX_U8*)pOut + nOutLen);
+  return nOutLen == METER_TEST_FRAMES * 2 * sizeof(OMX_S16) && !memcmp(pStream, pOut, nOutLen);
+}
+
+int main(int argc, char** argv) {
+  OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE sLevels;
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcm;
+  OMX_S16 *pStream, *pOut;
+  OMX_U32 k, j;
+  OMX_ERRORTYPE err;
+
+  appPriv = malloc(sizeof(appPrivateType));
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->emptySem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->emptySem, 0);
+  appPriv->fillSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->fillSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  /** Ask the core for a handle to the audio meter component
+    */
+  err = OMX_GetHandle(&handle, "OMX.st.audio.meter", NULL /*appPriv */, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    exit(1);
+  }
+  err = OMX_GetExtensionIndex(handle, "OMX.st.index.config.BellagioAudioLevels", &levelsIndex);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetExtensionIndex failed\n");
+    exit(1);
+  }
+
+  /* the test signal repeats in each window */
+  pStream = malloc(METER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+  pOut = malloc(METER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+  for (k = 0; k < METER_TEST_FRAMES; k++) {
+    j = k % METER_TEST_WINDOW_FRAMES;
+    pStream[2 * k] = (k / 24) & 1 ? -16384 : 16384;
+    pStream[2 * k + 1] = j < 3 ? 32767 : j < 5 ? -32768 : 0;
+  }
+
+  setHeader(&sPcm, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sPcm.nPortIndex = 0;
+  OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sPcm);
+  sPcm.nSamplingRate = METER_TEST_RATE;
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorNone, "set the sampling rate");
+  setLevels(METER_TEST_WINDOW_MS, 0);
+  start();
+
+  /* without an event interval the levels are only read back */
+  check(measure(pStream, pOut), "samples passed unchanged");
+  setHeader(&sLevels, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE));
+  sLevels.nPortIndex = 0;
+  check(OMX_GetConfig(handle, levelsIndex, &sLevels) == OMX_ErrorNone && sLevels.nWindows == 6,
+        "last window published by the empty EOS buffer");
+  check(levelsAre(&sLevels, METER_TEST_PARTIAL), "peak, RMS and clips of the last window");
+  check(nEvents == 0, "no event without an event interval");
+
+  /* an interval longer than the stream lets only the first and the last window through */
+  setLevels(METER_TEST_WINDOW_MS, 60000);
+  check(measure(pStream, pOut), "samples passed unchanged");
+  check(nEvents == 2, "events throttled to the first and the last window");
+  check(nEvents > 0 && sEvents[0].nWindows == 7 && levelsAre(&sEvents[0], METER_TEST_WINDOW_FRAMES),
+        "peak, RMS and clips of a full window");
+  check(nEvents > 1 && sEvents[1].nWindows == 12 && levelsAre(&sEvents[1], METER_TEST_PARTIAL),
+        "event sent for the last window");
+
+  /* the layout applies to both ports, it cannot change while either of them runs */
+  disablePort(0);
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorIncorrectStateOperation,
+        "PCM layout rejected while the other port is enabled");
+  disablePort(1);
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorNone, "PCM layout set with both ports disabled");
+
+  stop();
+  OMX_FreeHandle(handle);
+  OMX_Deinit();
+
+  free(pStream);
+  free(pOut);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  tsem_deinit(appPriv->emptySem);
+  free(appPriv->emptySem);
+  tsem_deinit(appPriv->fillSem);
+  free(appPriv->fillSem);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%i checks failed\n", nFailures);
+  return nFailures ? 1 : 0;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE meterEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    tsem_up(appPriv->eventSem);
+  } else if(eEvent == OMX_EventBellagioAudioLevels) {
+    if (nEvents < METER_TEST_MAX_EVENTS) {
+      memcpy(&sEvents[nEvents], pEventData, sizeof(OMX_CONFIG_BELLAGIOAUDIOLEVELSTYPE));
+    }
+    nEvents++;
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "In %s error %x\n", __func__, (int)Data1);
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE meterEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback.\n", __func__);
+  tsem_up(appPriv->emptySem);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE meterFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback. Got buflen %i for buffer at 0x%p\n",
+                          __func__, (int)pBuffer->nFilledLen, pBuffer);
+  tsem_up(appPriv->fillSem);
+  return OMX_ErrorNone;
+}
@@ -0,0 +1,94 @@
+/**
+  test/components/audio_effects/omxmetertest.h
+
+  This test application checks the levels measured by the audio meter component
+  on a known signal: the peak, the RMS and the clips of the windows, the last
+  window published at the end of the stream, and the throttling of the events.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#ifndef __OMXMETERTEST_H__
+#define __OMXMETERTEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include <OMX_Core.h>
+#include <OMX_Component.h>
+#include <OMX_Types.h>
+#include <OMX_Audio.h>
+
+#include <bellagio/tsemaphore.h>
+#include <bellagio/extension_struct.h>
+#include <user_debug_levels.h>
+
+/** Specification version*/
+#define VERSIONMAJOR    1
+#define VERSIONMINOR    1
+#define VERSIONREVISION 0
+#define VERSIONSTEP     0
+
+/** Maximum number of buffers on a port */
+#define METER_TEST_MAX_BUFFERS 16
+/** Sampling rate of the test stream */
+#define METER_TEST_RATE 48000
+/** Duration of a window, 480 frames */
+#define METER_TEST_WINDOW_MS 10
+#define METER_TEST_WINDOW_FRAMES (METER_TEST_RATE * METER_TEST_WINDOW_MS / 1000)
+/** Frames of the last window, ended by the end of the stream */
+#define METER_TEST_PARTIAL 200
+/** Frames of the test stream, five windows and a partial one */
+#define METER_TEST_FRAMES (5 * METER_TEST_WINDOW_FRAMES + METER_TEST_PARTIAL)
+/** Frames sent in each input buffer, across the windows */
+#define METER_TEST_CHUNK 520
+/** Most level events recorded */
+#define METER_TEST_MAX_EVENTS 16
+
+/* Application's private data */
+typedef struct appPrivateType{
+  tsem_t* eventSem;
+  tsem_t* emptySem;
+  tsem_t* fillSem;
+}appPrivateType;
+
+/* Callback prototypes */
+OMX_ERRORTYPE meterEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData);
+
+OMX_ERRORTYPE meterEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+OMX_ERRORTYPE meterFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer);
+
+#endif
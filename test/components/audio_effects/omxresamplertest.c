@@ -0,0 +1,262 @@
+/**
+  test/components/audio_effects/omxresamplertest.c
+
+  This test application checks the end of stream of the audio resampler component:
+  an empty buffer carrying the EOS flag drains the delay of the filter, and the
+  next stream starts on a clean history.
+
+  Copyright (C) 2007-2009 STMicroelectronics
+  Copyright (C) 2007-2009 Nokia Corporation and/or its subsidiary(-ies).
+
+  This library is free software; you can redistribute it and/or modify it under
+  the terms of the GNU Lesser General Public License as published by the Free
+  Software Foundation; either version 2.1 of the License, or (at your option)
+  any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT
+  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+  FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+  details.
+
+  You should have received a copy of the GNU Lesser General Public License
+  along with this library; if not, write to the Free Software Foundation, Inc.,
+  51 Franklin St, Fifth Floor, Boston, MA
+  02110-1301  USA
+
+*/
+
+#include "omxresamplertest.h"
+
+/* Application private date: should go in the component field (segs...) */
+appPrivateType* appPriv;
+OMX_HANDLETYPE handle;
+OMX_BUFFERHEADERTYPE *inBuffer[RESAMPLER_TEST_MAX_BUFFERS], *outBuffer[RESAMPLER_TEST_MAX_BUFFERS];
+OMX_U32 nInCount, nOutCount;
+int nEosEvents = 0;
+int nFailures = 0;
+
+OMX_CALLBACKTYPE callbacks = { .EventHandler = rsEventHandler,
+                               .EmptyBufferDone = rsEmptyBufferDone,
+                               .FillBufferDone = rsFillBufferDone,
+};
+
+static void setHeader(OMX_PTR header, OMX_U32 size) {
+  OMX_VERSIONTYPE* ver = (OMX_VERSIONTYPE*)(header + sizeof(OMX_U32));
+  *((OMX_U32*)header) = size;
+
+  ver->s.nVersionMajor = VERSIONMAJOR;
+  ver->s.nVersionMinor = VERSIONMINOR;
+  ver->s.nRevision = VERSIONREVISION;
+  ver->s.nStep = VERSIONSTEP;
+}
+
+static void check(int bPassed, const char* cWhat) {
+  DEBUG(DEFAULT_MESSAGES, "%s: %s\n", bPassed ? "passed" : "FAILED", cWhat);
+  if (!bPassed) {
+    nFailures++;
+  }
+}
+
+/** Sets the sampling rate of a port, keeping its layout */
+static void setRate(OMX_U32 nPort, OMX_U32 nRate) {
+  OMX_AUDIO_PARAM_PCMMODETYPE sPcm;
+
+  setHeader(&sPcm, sizeof(OMX_AUDIO_PARAM_PCMMODETYPE));
+  sPcm.nPortIndex = nPort;
+  OMX_GetParameter(handle, OMX_IndexParamAudioPcm, &sPcm);
+  sPcm.nSamplingRate = nRate;
+  check(OMX_SetParameter(handle, OMX_IndexParamAudioPcm, &sPcm) == OMX_ErrorNone, "set the sampling rate");
+}
+
+/** Brings the component to Executing with its buffers allocated */
+static void start(void) {
+  OMX_PARAM_PORTDEFINITIONTYPE sPortDef;
+  OMX_U32 i;
+
+  setHeader(&sPortDef, sizeof(OMX_PARAM_PORTDEFINITIONTYPE));
+  sPortDef.nPortIndex = 0;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nInCount = sPortDef.nBufferCountActual;
+  sPortDef.nPortIndex = 1;
+  OMX_GetParameter(handle, OMX_IndexParamPortDefinition, &sPortDef);
+  nOutCount = sPortDef.nBufferCountActual;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_AllocateBuffer(handle, &inBuffer[i], 0, NULL, sPortDef.nBufferSize);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_AllocateBuffer(handle, &outBuffer[i], 1, NULL, sPortDef.nBufferSize);
+  }
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateExecuting, NULL);
+  tsem_down(appPriv->eventSem);
+}
+
+/** Brings the component back to Loaded, freeing its buffers */
+static void stop(void) {
+  OMX_U32 i;
+
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateIdle, NULL);
+  tsem_down(appPriv->eventSem);
+  OMX_SendCommand(handle, OMX_CommandStateSet, OMX_StateLoaded, NULL);
+  for (i = 0; i < nInCount; i++) {
+    OMX_FreeBuffer(handle, 0, inBuffer[i]);
+  }
+  for (i = 0; i < nOutCount; i++) {
+    OMX_FreeBuffer(handle, 1, outBuffer[i]);
+  }
+  tsem_down(appPriv->eventSem);
+}
+
+/** Sends one input buffer of nInLen bytes with the given flags and
+  * returns the length of the output buffer it gives
+  */
+static OMX_U32 process(OMX_U8* pIn, OMX_U32 nInLen, OMX_U32 nFlags, OMX_U8* pOut, OMX_U32* pOutFlags) {
+  if (nInLen > 0) {
+    memcpy(inBuffer[0]->pBuffer, pIn, nInLen);
+  }
+  inBuffer[0]->nFilledLen = nInLen;
+  inBuffer[0]->nOffset = 0;
+  inBuffer[0]->nFlags = nFlags;
+  outBuffer[0]->nFilledLen = 0;
+  outBuffer[0]->nFlags = 0;
+  OMX_FillThisBuffer(handle, outBuffer[0]);
+  OMX_EmptyThisBuffer(handle, inBuffer[0]);
+  tsem_down(appPriv->fillSem);
+  tsem_down(appPriv->emptySem);
+  memcpy(pOut, outBuffer[0]->pBuffer + outBuffer[0]->nOffset, outBuffer[0]->nFilledLen);
+  *pOutFlags = outBuffer[0]->nFlags;
+  return outBuffer[0]->nFilledLen;
+}
+
+/** Resamples a stream of nFrames stereo frames ended by an empty EOS
+  * buffer. Returns the number of output frames, those of the EOS buffer in pTail
+  */
+static OMX_U32 resample(OMX_S16* pIn, OMX_U32 nFrames, OMX_S16* pOut, OMX_U32* pTail, OMX_U32* pEosFlags) {
+  OMX_U32 nFrameSize = 2 * sizeof(OMX_S16);
+  OMX_U32 nOut = 0, nFlags, i;
+
+  for (i = 0; i < nFrames; i += RESAMPLER_TEST_CHUNK) {
+    nOut += process((OMX_U8*)(pIn + 2 * i), RESAMPLER_TEST_CHUNK * nFrameSize, 0, (OMX_U8*)(pOut + 2 * nOut), &nFlags) / nFrameSize;
+  }
+  *pTail = process(NULL, 0, OMX_BUFFERFLAG_EOS, (OMX_U8*)(pOut + 2 * nOut), pEosFlags) / nFrameSize;
+  return nOut + *pTail;
+}
+
+int main(int argc, char** argv) {
+  OMX_S16 *pStream, *pFirst, *pSecond;
+  OMX_U32 nExpected = ((OMX_U64)RESAMPLER_TEST_FRAMES * RESAMPLER_TEST_OUT_RATE + RESAMPLER_TEST_IN_RATE - 1) / RESAMPLER_TEST_IN_RATE;
+  OMX_U32 nOutFrames, nFirst, nSecond, nTail, nFlags, k;
+  OMX_ERRORTYPE err;
+
+  appPriv = malloc(sizeof(appPrivateType));
+  appPriv->eventSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->eventSem, 0);
+  appPriv->emptySem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->emptySem, 0);
+  appPriv->fillSem = malloc(sizeof(tsem_t));
+  tsem_init(appPriv->fillSem, 0);
+
+  err = OMX_Init();
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_Init() failed\n");
+    exit(1);
+  }
+  /** Ask the core for a handle to the audio resampler component
+    */
+  err = OMX_GetHandle(&handle, "OMX.st.audio.resampler", NULL /*appPriv */, &callbacks);
+  if(err != OMX_ErrorNone) {
+    DEBUG(DEB_LEV_ERR, "OMX_GetHandle failed\n");
+    exit(1);
+  }
+
+  /* a stereo triangle wave, the right channel in opposite phase */
+  nOutFrames = nExpected + RESAMPLER_TEST_CHUNK;
+  pStream = malloc(RESAMPLER_TEST_FRAMES * 2 * sizeof(OMX_S16));
+  pFirst = malloc(nOutFrames * 2 * sizeof(OMX_S16));
+  pSecond = malloc(nOutFrames * 2 * sizeof(OMX_S16));
+  for (k = 0; k < RESAMPLER_TEST_FRAMES; k++) {
+    pStream[2 * k] = (OMX_S16)((k & 255) < 128 ? (k & 127) * 128 : (128 - (k & 127)) * 128 - 1) - 8192;
+    pStream[2 * k + 1] = -pStream[2 * k];
+  }
+
+  setRate(0, RESAMPLER_TEST_IN_RATE);
+  setRate(1, RESAMPLER_TEST_OUT_RATE);
+  start();
+
+  /* the EOS buffer drains the delay of the filter: the output covers the whole input */
+  nFirst = resample(pStream, RESAMPLER_TEST_FRAMES, pFirst, &nTail, &nFlags);
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "%i frames out, %i of them drained at EOS\n", (int)nFirst, (int)nTail);
+  check(nTail > 0, "filter delay drained by the empty EOS buffer");
+  check(nFirst == nExpected, "output length matches the input duration");
+  check((nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS, "EOS flag propagated to the output");
+
+  /* the filter was reset by the EOS: the same stream gives the same output */
+  nSecond = resample(pStream, RESAMPLER_TEST_FRAMES, pSecond, &nTail, &nFlags);
+  check(nSecond == nFirst && !memcmp(pFirst, pSecond, nFirst * 2 * sizeof(OMX_S16)), "next stream starts on a clean history");
+
+  /* a stream without samples has no tail */
+  check(process(NULL, 0, OMX_BUFFERFLAG_EOS, (OMX_U8*)pSecond, &nFlags) == 0 && (nFlags & OMX_BUFFERFLAG_EOS) == OMX_BUFFERFLAG_EOS,
+        "empty stream drains nothing");
+  check(nEosEvents == 3, "one EOS event for each stream");
+
+  stop();
+  OMX_FreeHandle(handle);
+  OMX_Deinit();
+
+  free(pStream);
+  free(pFirst);
+  free(pSecond);
+  tsem_deinit(appPriv->eventSem);
+  free(appPriv->eventSem);
+  tsem_deinit(appPriv->emptySem);
+  free(appPriv->emptySem);
+  tsem_deinit(appPriv->fillSem);
+  free(appPriv->fillSem);
+  free(appPriv);
+
+  DEBUG(DEFAULT_MESSAGES, "%i checks failed\n", nFailures);
+  return nFailures ? 1 : 0;
+}
+
+/* Callbacks implementation */
+OMX_ERRORTYPE rsEventHandler(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_EVENTTYPE eEvent,
+  OMX_U32 Data1,
+  OMX_U32 Data2,
+  OMX_PTR pEventData) {
+
+  DEBUG(DEB_LEV_SIMPLE_SEQ, "Hi there, I am in the %s callback\n", __func__);
+  if(eEvent == OMX_EventCmdComplete) {
+    tsem_up(appPriv->eventSem);
+  } else if(eEvent == OMX_EventBufferFlag && (Data2 & OMX_BUFFERFLAG_EOS)) {
+    nEosEvents++;
+  } else if(eEvent == OMX_EventError) {
+    DEBUG(DEB_LEV_ERR, "In %s error %x\n", __func__, (int)Data1);
+  }
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE rsEmptyBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback.\n", __func__);
+  tsem_up(appPriv->emptySem);
+  return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE rsFillBufferDone(
+  OMX_HANDLETYPE hComponent,
+  OMX_PTR pAppData,
+  OMX_BUFFERHEADERTYPE* pBuffer) {
+
+  DEBUG(DEB_LEV_FULL_SEQ, "Hi there, I am in the %s callback. Got buflen %i for buffer at 0x%p\n",
+                          __func__, (int)pBuffer->nFilledLen, pBuffer);
+  tsem_up(appPriv->fillSem);
+  return OMX_ErrorNone;
+}